@@ -17,7 +17,8 @@ namespace audio {
 
 constexpr float AudioCoreImpl::kMaxSystemAudioGainDb;
 
-AudioCoreImpl::AudioCoreImpl() : device_manager_(this) {
+AudioCoreImpl::AudioCoreImpl(uint32_t mix_groups_per_output)
+    : device_manager_(this, mix_groups_per_output) {
   // Stash a pointer to our async object.
   dispatcher_ = async_get_default_dispatcher();
   FXL_DCHECK(dispatcher_);
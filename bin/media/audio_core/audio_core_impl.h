@@ -25,7 +25,9 @@ namespace audio {
 
 class AudioCoreImpl : public fuchsia::media::Audio {
  public:
-  AudioCoreImpl();
+  // Each output splits its renderers into |mix_groups_per_output| groups, which
+  // it mixes in parallel.
+  explicit AudioCoreImpl(uint32_t mix_groups_per_output = 1);
   ~AudioCoreImpl() override;
 
   // Audio implementation.
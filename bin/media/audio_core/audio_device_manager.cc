@@ -18,8 +18,9 @@
 namespace media {
 namespace audio {
 
-AudioDeviceManager::AudioDeviceManager(AudioCoreImpl* service)
-    : service_(service) {}
+AudioDeviceManager::AudioDeviceManager(AudioCoreImpl* service,
+                                       uint32_t mix_groups_per_output)
+    : service_(service), mix_groups_per_output_(mix_groups_per_output) {}
 
 AudioDeviceManager::~AudioDeviceManager() {
   Shutdown();
@@ -27,7 +27,7 @@ class AudioCapturerImpl;
 
 class AudioDeviceManager : public ::fuchsia::media::AudioDeviceEnumerator {
  public:
-  explicit AudioDeviceManager(AudioCoreImpl* service);
+  AudioDeviceManager(AudioCoreImpl* service, uint32_t mix_groups_per_output);
   ~AudioDeviceManager();
 
   // Initialize the output manager.  Called from the service implementation,
@@ -50,6 +50,10 @@ class AudioDeviceManager : public ::fuchsia::media::AudioDeviceEnumerator {
   // destructor must do real work, something has gone Very Seriously Wrong.
   void Shutdown();
 
+  // The number of groups which outputs should split their renderers into, in
+  // order to mix them in parallel.
+  uint32_t mix_groups_per_output() const { return mix_groups_per_output_; }
+
   // Add a new client for the device enumerator functionality.  Called from the
   // service framework each time a new client attempts to connect.
   void AddDeviceEnumeratorClient(zx::channel ch);
@@ -206,6 +210,8 @@ class AudioDeviceManager : public ::fuchsia::media::AudioDeviceEnumerator {
   // this pointer to be bad while we still exist.
   AudioCoreImpl* service_;
 
+  const uint32_t mix_groups_per_output_;
+
   // The set of AudioDeviceEnumerator clients we are currently tending to.
   fidl::BindingSet<::fuchsia::media::AudioDeviceEnumerator> bindings_;
 
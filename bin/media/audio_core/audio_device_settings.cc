@@ -93,7 +93,12 @@ AudioDeviceSettings::AudioDeviceSettings(const AudioDriver& drv, bool is_input)
 }
 
 void AudioDeviceSettings::Initialize() {
-  FXL_DCHECK(!initialized_);
+  // Tests may create more than one device manager in a process.  The storage
+  // only needs to be set up once.
+  if (initialized_) {
+    return;
+  }
+
   if (!files::CreateDirectory(kSettingsPath)) {
     FXL_LOG(ERROR)
         << "Failed to ensure that \"" << kSettingsPath
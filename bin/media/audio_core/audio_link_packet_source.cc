@@ -19,9 +19,9 @@ AudioLinkPacketSource::AudioLinkPacketSource(
       format_info_(std::move(format_info)) {}
 
 AudioLinkPacketSource::~AudioLinkPacketSource() {
-  pending_flush_packet_queue_.clear();
-  pending_packet_queue_.clear();
-  pending_flush_token_queue_.clear();
+  // The packet queue releases its remaining packets (front to back) as it is
+  // destroyed, before any flush tokens it was holding.
+  FXL_DCHECK(!queue_locked_);
 }
 
 // static
@@ -47,122 +47,195 @@ std::shared_ptr<AudioLinkPacketSource> AudioLinkPacketSource::Create(
 
 void AudioLinkPacketSource::PushToPendingQueue(
     const fbl::RefPtr<AudioPacketRef>& pkt) {
-  std::lock_guard<std::mutex> locker(pending_mutex_);
-  pending_packet_queue_.emplace_back(pkt);
+  pending_packet_queue_.push(pkt);
 }
 
 void AudioLinkPacketSource::FlushPendingQueue(
     const fbl::RefPtr<PendingFlushToken>& flush_token) {
-  std::deque<fbl::RefPtr<AudioPacketRef>> flushed_packets;
-
+  // Publish the flush: everything we have queued so far must go, followed by
+  // the flush token (if any).
   {
-    std::lock_guard<std::mutex> locker(pending_mutex_);
-
-    flushed_ = true;
-
-    if (processing_in_progress_) {
-      // Is the sink currently mixing?  If so, the flush cannot complete until
-      // the mix operation has finished.  Move the 'waiting to be rendered'
-      // packets to the back of the 'waiting to be flushed queue', and append
-      // our flush token (if any) to the pending flush token queue.  The sink's
-      // thread will take are of releasing these objects back to the service
-      // thread for cleanup when it has finished it's current job.
-      for (size_t i = 0; i < pending_packet_queue_.size(); ++i) {
-        pending_flush_packet_queue_.emplace_back(
-            std::move(pending_packet_queue_[i]));
-      }
-      pending_packet_queue_.clear();
-
-      if (flush_token != nullptr) {
-        pending_flush_token_queue_.emplace_back(flush_token);
-      }
+    std::lock_guard<std::mutex> locker(flush_mutex_);
+    flush_pop_target_ = pending_packet_queue_.push_count();
+    if (flush_token != nullptr) {
+      pending_flush_token_queue_.emplace_back(flush_token);
+    }
+    ++flush_epoch_;
+  }
+
+  // If the sink is not currently mixing, we perform the flush ourselves, right
+  // now.  Otherwise, the flush cannot complete until the mix operation has
+  // finished; the sink's thread will release the flushed packets and tokens
+  // back to the service thread for cleanup when it unlocks the queue.
+  TryProcessFlush();
+}
+
+fbl::RefPtr<AudioPacketRef> AudioLinkPacketSource::LockPendingQueueFront(
+    bool* was_flushed) {
+  FXL_DCHECK(was_flushed);
+  FXL_DCHECK(!queue_locked_);
+
+  // If the source is in the middle of flushing, then whatever is in the queue
+  // is about to be discarded; rather than waiting, report an empty queue.  The
+  // flush is reported the next time we get the queue, once it has been applied.
+  uint32_t expected = kIdle;
+  if (!consumer_state_.compare_exchange_strong(expected, kProcessing)) {
+    FXL_DCHECK(expected == kFlushing);
+    *was_flushed = false;
+    return nullptr;
+  }
+  queue_locked_ = true;
+
+  // Apply any flush which arrived since we last held the queue, but which its
+  // source could not apply because another thread held the queue at the time.
+  if (flush_epoch_ != processed_flush_epoch_) {
+    ProcessFlush();
+  }
+
+  // Report only the flushes which have actually been applied.  A flush
+  // published from here on is applied when we unlock the queue, and reported
+  // the next time we lock it.  Nobody else applies flushes while we own the
+  // queue, so processed_flush_epoch_ cannot change under us.
+  uint32_t processed_flush_epoch = processed_flush_epoch_;
+  *was_flushed = (processed_flush_epoch != reported_flush_epoch_);
+  reported_flush_epoch_ = processed_flush_epoch;
 
+  return pending_packet_queue_.front();
+}
+
+void AudioLinkPacketSource::UnlockPendingQueueFront(bool release_packet) {
+  if (!queue_locked_) {
+    // We never obtained the queue, so we cannot have had a packet to release.
+    FXL_DCHECK(!release_packet);
+    return;
+  }
+  queue_locked_ = false;
+
+  // If the sink wants us to release the front of the pending queue, then there
+  // had better be a packet at the front of the queue to release.  No one else
+  // can pop the queue while we own it, so it is the packet the sink was given.
+  // Release it even if a flush arrived meanwhile: that flush may have been
+  // published before this packet was queued.
+  if (release_packet) {
+    FXL_DCHECK(!pending_packet_queue_.empty());
+    pending_packet_queue_.pop();
+  }
+
+  // Did a flush take place while we were working?  If so release each of the
+  // packets waiting to be flushed back to the service thread, then release
+  // each of the flush tokens.
+  if (flush_epoch_ != processed_flush_epoch_) {
+    ProcessFlush();
+  }
+
+  consumer_state_ = kIdle;
+
+  // A flush may have been requested after our check above; its source could
+  // not claim the queue, so it is up to us to apply it.
+  TryProcessFlush();
+}
+
+void AudioLinkPacketSource::TryProcessFlush() {
+  // Both sides publish their intent (the flush epoch, or the release of the
+  // queue) before checking for the other, so at least one of them will see the
+  // pending flush and perform it.
+  while (flush_epoch_ != processed_flush_epoch_) {
+    uint32_t expected = kIdle;
+    if (!consumer_state_.compare_exchange_strong(expected, kFlushing)) {
       return;
-    } else {
-      // If the sink is not currently mixing, then we just swap the contents the
-      // pending packet queues with out local queue and release the packets in
-      // the proper order once we have left the pending mutex lock.
-      FXL_DCHECK(pending_flush_packet_queue_.empty());
-      FXL_DCHECK(pending_flush_token_queue_.empty());
-      flushed_packets.swap(pending_packet_queue_);
     }
+    ProcessFlush();
+    consumer_state_ = kIdle;
+  }
+}
+
+void AudioLinkPacketSource::ProcessFlush() {
+  uint64_t pop_target;
+  std::deque<fbl::RefPtr<PendingFlushToken>> flush_tokens;
+  {
+    std::lock_guard<std::mutex> locker(flush_mutex_);
+    pop_target = flush_pop_target_;
+    flush_tokens.swap(pending_flush_token_queue_);
+    processed_flush_epoch_ = flush_epoch_.load();
   }
 
-  // Release the packets, front to back.
-  for (auto& ptr : flushed_packets) {
+  // Release the packets, front to back, then the tokens.
+  while (pending_packet_queue_.pop_count() < pop_target) {
+    pending_packet_queue_.pop();
+  }
+
+  for (auto& ptr : flush_tokens) {
     ptr.reset();
   }
 }
 
-void AudioLinkPacketSource::CopyPendingQueue(
-    const std::shared_ptr<AudioLinkPacketSource>& other) {
-  FXL_DCHECK(other != nullptr);
-  FXL_DCHECK(this != other.get());
+AudioLinkPacketSource::PacketQueue::PacketQueue()
+    : head_(new Segment), tail_(head_) {}
 
-  std::lock_guard<std::mutex> source_locker(other->pending_mutex_);
-  if (other->pending_packet_queue_.empty())
-    return;
+AudioLinkPacketSource::PacketQueue::~PacketQueue() {
+  while (!empty()) {
+    pop();
+  }
 
-  std::lock_guard<std::mutex> locker(pending_mutex_);
-  FXL_DCHECK(pending_packet_queue_.empty());
-  pending_packet_queue_ = other->pending_packet_queue_;
+  FXL_DCHECK(head_ == tail_);
+  delete head_;
+  delete spare_.load();
 }
 
-fbl::RefPtr<AudioPacketRef> AudioLinkPacketSource::LockPendingQueueFront(
-    bool* was_flushed) {
-  FXL_DCHECK(was_flushed);
-  std::lock_guard<std::mutex> locker(pending_mutex_);
+void AudioLinkPacketSource::PacketQueue::push(
+    fbl::RefPtr<AudioPacketRef> pkt) {
+  if (tail_slot_ == kSegmentSize) {
+    Segment* segment = spare_.exchange(nullptr);
+    if (segment == nullptr) {
+      segment = new Segment;
+    } else {
+      segment->next.store(nullptr, std::memory_order_relaxed);
+    }
 
-  FXL_DCHECK(!processing_in_progress_);
-  processing_in_progress_ = true;
+    tail_->next.store(segment, std::memory_order_release);
+    tail_ = segment;
+    tail_slot_ = 0;
+  }
 
-  *was_flushed = flushed_;
-  flushed_ = false;
+  tail_->slots[tail_slot_++] = std::move(pkt);
+  push_count_.store(push_count_.load(std::memory_order_relaxed) + 1,
+                    std::memory_order_release);
+}
 
-  if (pending_packet_queue_.size()) {
-    return pending_packet_queue_.front();
-  } else {
+fbl::RefPtr<AudioPacketRef> AudioLinkPacketSource::PacketQueue::front() {
+  if (empty()) {
     return nullptr;
   }
-}
 
-void AudioLinkPacketSource::UnlockPendingQueueFront(bool release_packet) {
-  {
-    std::lock_guard<std::mutex> locker(pending_mutex_);
-    FXL_DCHECK(processing_in_progress_);
-    processing_in_progress_ = false;
-
-    // Did a flush take place while we were working?  If so release each of the
-    // packets waiting to be flushed back to the service thread, then release
-    // each of the flush tokens.
-    if (!pending_flush_packet_queue_.empty() ||
-        !pending_flush_token_queue_.empty()) {
-      for (auto& ptr : pending_flush_packet_queue_) {
-        ptr.reset();
-      }
-
-      for (auto& ptr : pending_flush_token_queue_) {
-        ptr.reset();
-      }
-
-      pending_flush_packet_queue_.clear();
-      pending_flush_token_queue_.clear();
+  SkipDrainedSegment();
+  return head_->slots[head_slot_];
+}
 
-      return;
-    }
+void AudioLinkPacketSource::PacketQueue::pop() {
+  FXL_DCHECK(!empty());
 
-    // If the sink wants us to release the front of the pending queue, and no
-    // flush operation happened while they were processing, then there had
-    // better be a packet at the front of the queue to release.
+  SkipDrainedSegment();
+  head_->slots[head_slot_++].reset();
+  pop_count_.store(pop_count_.load(std::memory_order_relaxed) + 1,
+                   std::memory_order_release);
+}
 
-    // Assert that the user either got no packet when they locked the queue
-    // (because the queue was empty), or that they got the front of the queue
-    // and that the front of the queue has not changed.
-    FXL_DCHECK(!release_packet || !pending_packet_queue_.empty());
-    if (release_packet) {
-      pending_packet_queue_.pop_front();
-    }
+void AudioLinkPacketSource::PacketQueue::SkipDrainedSegment() {
+  if (head_slot_ < kSegmentSize) {
+    return;
   }
+
+  // The queue is not empty, so the producer has already linked in the segment
+  // which holds the next packet.
+  Segment* next = head_->next.load(std::memory_order_acquire);
+  FXL_DCHECK(next != nullptr);
+
+  Segment* drained = head_;
+  head_ = next;
+  head_slot_ = 0;
+
+  // If the producer has not yet picked up the previous spare, free it.
+  delete spare_.exchange(drained);
 }
 
 }  // namespace audio
@@ -6,6 +6,7 @@
 #define GARNET_BIN_MEDIA_AUDIO_CORE_AUDIO_LINK_PACKET_SOURCE_H_
 
 #include <fbl/ref_ptr.h>
+#include <atomic>
 #include <deque>
 #include <memory>
 #include <mutex>
@@ -39,17 +40,13 @@ class AudioLinkPacketSource : public AudioLink {
   const AudioRendererFormatInfo& format_info() const { return *format_info_; }
 
   // Common pending queue ops.
-  bool pending_queue_empty() const {
-    std::lock_guard<std::mutex> locker(pending_mutex_);
-    return pending_packet_queue_.empty();
-  }
+  bool pending_queue_empty() const { return pending_packet_queue_.empty(); }
 
   // PendingQueue operations used by the packet source.  Never call these from
   // the destination.
   void PushToPendingQueue(const fbl::RefPtr<AudioPacketRef>& pkt);
   void FlushPendingQueue(
       const fbl::RefPtr<PendingFlushToken>& flush_token = nullptr);
-  void CopyPendingQueue(const std::shared_ptr<AudioLinkPacketSource>& other);
 
   // PendingQueue operations used by the destination.  Never call these from the
   // source.
@@ -59,32 +56,109 @@ class AudioLinkPacketSource : public AudioLink {
   // the reference to the front of the queue they obtained in the process (even
   // if the front of the queue was nullptr).
   //
-  // Doing so ensures that sources which are attempting to flush the pending
-  // queue are forced to wait if the front of the queue is involved in a mixing
-  // operation.  This, in turn, guarantees that audio packets are always
-  // returned to the user in the order which they were queued in without forcing
-  // AudioRenderers to wait to queue new data if a mix operation is in progress.
+  // Doing so ensures that a flush which arrives while the front of the queue is
+  // involved in a mixing operation is deferred until the destination unlocks
+  // the queue.  This, in turn, guarantees that audio packets are always
+  // returned to the user in the order which they were queued in.  Queueing and
+  // mixing never wait for each other; only applying a flush briefly takes a
+  // lock, and the destination never waits for a flush to finish.
+  //
+  // |was_flushed| is set if a flush has been applied to the queue since the
+  // previous call to LockPendingQueueFront.
   fbl::RefPtr<AudioPacketRef> LockPendingQueueFront(bool* was_flushed);
   void UnlockPendingQueueFront(bool release_packet);
 
  private:
+  // A single-producer, single-consumer FIFO of packet references, stored in a
+  // chain of fixed-size segments so that it never needs to lock or to move
+  // existing entries.  The producer is the packet source.  The consumer is
+  // whichever thread currently owns the queue via consumer_state_; normally
+  // the destination, but the source also consumes while performing a flush.
+  class PacketQueue {
+   public:
+    PacketQueue();
+    ~PacketQueue();
+
+    bool empty() const {
+      return pop_count_.load(std::memory_order_acquire) ==
+             push_count_.load(std::memory_order_acquire);
+    }
+
+    // Producer operations.
+    void push(fbl::RefPtr<AudioPacketRef> pkt);
+    uint64_t push_count() const {
+      return push_count_.load(std::memory_order_relaxed);
+    }
+
+    // Consumer operations.
+    fbl::RefPtr<AudioPacketRef> front();
+    void pop();
+    uint64_t pop_count() const {
+      return pop_count_.load(std::memory_order_relaxed);
+    }
+
+   private:
+    static constexpr size_t kSegmentSize = 32;
+    struct Segment {
+      std::atomic<Segment*> next{nullptr};
+      fbl::RefPtr<AudioPacketRef> slots[kSegmentSize];
+    };
+
+    // Moves the consumer to the next segment once it has drained the current
+    // one.  Only valid when the queue is not empty.
+    void SkipDrainedSegment();
+
+    // Owned by the consumer.
+    Segment* head_;
+    size_t head_slot_ = 0;
+    std::atomic<uint64_t> pop_count_{0};
+
+    // Owned by the producer.
+    Segment* tail_;
+    size_t tail_slot_ = 0;
+    std::atomic<uint64_t> push_count_{0};
+
+    // One drained segment handed back from the consumer to the producer, so
+    // that steady-state operation does not touch the heap.
+    std::atomic<Segment*> spare_{nullptr};
+  };
+
+  // Who currently owns the consumer side of pending_packet_queue_.
+  enum ConsumerState : uint32_t { kIdle, kProcessing, kFlushing };
+
   AudioLinkPacketSource(fbl::RefPtr<AudioObject> source,
                         fbl::RefPtr<AudioObject> dest,
                         fbl::RefPtr<AudioRendererFormatInfo> format_info);
 
+  // Applies any flush which has been requested but not yet performed, if the
+  // consumer side of the queue can be claimed.  If it cannot, the current
+  // owner is guaranteed to apply the flush when it releases the queue.
+  void TryProcessFlush();
+
+  // Releases every packet queued before the most recent flush request, then
+  // the flush tokens, in order.  Callers must own the consumer side.
+  void ProcessFlush();
+
   fbl::RefPtr<AudioRendererFormatInfo> format_info_;
 
-  std::mutex flush_mutex_;
-  mutable std::mutex pending_mutex_;
+  PacketQueue pending_packet_queue_;
+  std::atomic<uint32_t> consumer_state_{kIdle};
+  // Set only by the destination, between Lock and UnlockPendingQueueFront.
+  bool queue_locked_ = false;
 
-  std::deque<fbl::RefPtr<AudioPacketRef>> pending_packet_queue_
-      FXL_GUARDED_BY(pending_mutex_);
-  std::deque<fbl::RefPtr<AudioPacketRef>> pending_flush_packet_queue_
-      FXL_GUARDED_BY(pending_mutex_);
+  // Flushes are published by bumping flush_epoch_; processed_flush_epoch_ is
+  // written only by whoever owns the consumer side when it performs them.
+  std::atomic<uint32_t> flush_epoch_{0};
+  std::atomic<uint32_t> processed_flush_epoch_{0};
+  // The last processed_flush_epoch_ reported to the destination through
+  // LockPendingQueueFront.  It starts out one behind, so that the first lock
+  // reports a flush and the destination starts from a clean state.
+  uint32_t reported_flush_epoch_ = ~0u;
+
+  std::mutex flush_mutex_;
+  uint64_t flush_pop_target_ FXL_GUARDED_BY(flush_mutex_) = 0;
   std::deque<fbl::RefPtr<PendingFlushToken>> pending_flush_token_queue_
-      FXL_GUARDED_BY(pending_mutex_);
-  bool flushed_ FXL_GUARDED_BY(pending_mutex_) = true;
-  bool processing_in_progress_ FXL_GUARDED_BY(pending_mutex_) = false;
+      FXL_GUARDED_BY(flush_mutex_);
 };
 
 }  // namespace audio
@@ -4,12 +4,58 @@
 
 #include "garnet/bin/media/audio_core/audio_packet_ref.h"
 
+#include <fbl/slab_allocator.h>
+
 #include "garnet/bin/media/audio_core/audio_core_impl.h"
 #include "lib/fxl/logging.h"
 
 namespace media {
 namespace audio {
 
+// With the default 16KB slabs, this allows for tens of thousands of packets in
+// flight across all renderers before falling back to the heap.
+static constexpr size_t kMaxAudioPacketRefSlabs = 256;
+
+class SlabAudioPacketRef;
+using SlabAudioPacketRefTraits =
+    fbl::StaticSlabAllocatorTraits<fbl::unique_ptr<SlabAudioPacketRef>>;
+
+// An AudioPacketRef carved out of a slab.
+class SlabAudioPacketRef
+    : public AudioPacketRef,
+      public fbl::SlabAllocated<SlabAudioPacketRefTraits> {
+ public:
+  SlabAudioPacketRef(fbl::RefPtr<RefCountedVmoMapper> vmo_ref,
+                     fuchsia::media::AudioRenderer::SendPacketCallback callback,
+                     fuchsia::media::StreamPacket packet,
+                     AudioCoreImpl* service, uint32_t frac_frame_len,
+                     int64_t start_pts)
+      : AudioPacketRef(std::move(vmo_ref), std::move(callback),
+                       std::move(packet), service, frac_frame_len, start_pts) {
+  }
+};
+
+// static
+fbl::RefPtr<AudioPacketRef> AudioPacketRef::Create(
+    fbl::RefPtr<RefCountedVmoMapper> vmo_ref,
+    fuchsia::media::AudioRenderer::SendPacketCallback callback,
+    fuchsia::media::StreamPacket packet, AudioCoreImpl* service,
+    uint32_t frac_frame_len, int64_t start_pts) {
+  auto slab_packet = fbl::SlabAllocator<SlabAudioPacketRefTraits>::New(
+      std::move(vmo_ref), std::move(callback), std::move(packet), service,
+      frac_frame_len, start_pts);
+  if (slab_packet != nullptr) {
+    return fbl::AdoptRef<AudioPacketRef>(slab_packet.release());
+  }
+
+  // The slabs are exhausted.  New() only moves from its arguments once it has
+  // memory for the packet, so they are still intact.
+  return fbl::AdoptRef(new AudioPacketRef(std::move(vmo_ref),
+                                          std::move(callback),
+                                          std::move(packet), service,
+                                          frac_frame_len, start_pts));
+}
+
 AudioPacketRef::AudioPacketRef(
     fbl::RefPtr<RefCountedVmoMapper> vmo_ref,
     fuchsia::media::AudioRenderer::SendPacketCallback callback,
@@ -44,3 +90,7 @@ void AudioPacketRef::fbl_recycle() {
 
 }  // namespace audio
 }  // namespace media
+
+DECLARE_STATIC_SLAB_ALLOCATOR_STORAGE(
+    ::media::audio::SlabAudioPacketRefTraits,
+    ::media::audio::kMaxAudioPacketRefSlabs, true);
@@ -20,19 +20,23 @@ namespace audio {
 
 class AudioCoreImpl;
 
-// TODO(johngro): Consider moving instances of this class to a slab allocation
-// pattern.  They are the most frequently allocated object in the mixer (easily
+// AudioPacketRefs are the most frequently allocated object in the mixer (easily
 // 100s per second) and they do not live very long at all (300-400mSec at most),
-// so they could easily be causing heap fragmentation issues.
+// so they are carved out of slabs instead of the general heap, to avoid heap
+// fragmentation.  Slabs are allocated on demand, up to a fixed limit, and are
+// never returned to the heap.  Once the limit is reached, packets come from the
+// heap instead, so one renderer with many packets in flight cannot starve the
+// others.
 class AudioPacketRef
     : public fbl::RefCounted<AudioPacketRef>,
       public fbl::Recyclable<AudioPacketRef>,
       public fbl::DoublyLinkedListable<fbl::unique_ptr<AudioPacketRef>> {
  public:
-  AudioPacketRef(fbl::RefPtr<RefCountedVmoMapper> vmo_ref,
-                 fuchsia::media::AudioRenderer::SendPacketCallback callback,
-                 fuchsia::media::StreamPacket packet, AudioCoreImpl* server,
-                 uint32_t frac_frame_len, int64_t start_pts);
+  static fbl::RefPtr<AudioPacketRef> Create(
+      fbl::RefPtr<RefCountedVmoMapper> vmo_ref,
+      fuchsia::media::AudioRenderer::SendPacketCallback callback,
+      fuchsia::media::StreamPacket packet, AudioCoreImpl* server,
+      uint32_t frac_frame_len, int64_t start_pts);
 
   // Accessors for starting and ending presentation time stamps expressed in
   // units of audio frames (note, not media time), as signed 50.13 fixed point
@@ -71,7 +75,12 @@ class AudioPacketRef
   friend class fbl::Recyclable<AudioPacketRef>;
   friend class fbl::unique_ptr<AudioPacketRef>;
 
-  ~AudioPacketRef() = default;
+  AudioPacketRef(fbl::RefPtr<RefCountedVmoMapper> vmo_ref,
+                 fuchsia::media::AudioRenderer::SendPacketCallback callback,
+                 fuchsia::media::StreamPacket packet, AudioCoreImpl* server,
+                 uint32_t frac_frame_len, int64_t start_pts);
+  // Virtual, so that slab-allocated packets go back to their slab.
+  virtual ~AudioPacketRef() = default;
 
   // Check to see if this packet has a valid callback.  If so, when it gets
   // recycled for the first time, it needs to be kept alive and posted to the
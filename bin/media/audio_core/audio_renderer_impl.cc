@@ -465,9 +465,9 @@ void AudioRendererImpl::SendPacket(fuchsia::media::StreamPacket packet,
   start_pts &= mask;
 
   // Create the packet.
-  auto packet_ref = fbl::AdoptRef(new AudioPacketRef(
+  auto packet_ref = AudioPacketRef::Create(
       payload_buffer_, std::move(callback), std::move(packet), owner_,
-      frame_count << kPtsFractionalBits, start_pts));
+      frame_count << kPtsFractionalBits, start_pts);
 
   // The end pts is the value we will use for the next packet's start PTS, if
   // the user does not provide an explicit PTS.
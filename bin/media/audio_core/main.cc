@@ -6,10 +6,32 @@
 
 #include "garnet/bin/media/audio_core/audio_core_impl.h"
 #include "lib/component/cpp/startup_context.h"
+#include "lib/fxl/command_line.h"
+#include "lib/fxl/logging.h"
+#include "lib/fxl/strings/string_number_conversions.h"
+
+// Number of groups that each output splits its renderers into, mixing the
+// groups in parallel.  The default of 1 mixes every renderer on the output's
+// own mix thread.
+static constexpr char kMixGroupsOption[] = "mix-groups";
+static constexpr uint32_t kMaxMixGroups = 8;
 
 int main(int argc, const char** argv) {
+  auto command_line = fxl::CommandLineFromArgcArgv(argc, argv);
+
+  uint32_t mix_groups = 1;
+  std::string mix_groups_str;
+  if (command_line.GetOptionValue(kMixGroupsOption, &mix_groups_str)) {
+    if (!fxl::StringToNumberWithError(mix_groups_str, &mix_groups) ||
+        (mix_groups < 1) || (mix_groups > kMaxMixGroups)) {
+      FXL_LOG(ERROR) << "--" << kMixGroupsOption << " must be between 1 and "
+                     << kMaxMixGroups;
+      return 1;
+    }
+  }
+
   async::Loop loop(&kAsyncLoopConfigAttachToThread);
-  media::audio::AudioCoreImpl impl;
+  media::audio::AudioCoreImpl impl(mix_groups);
   loop.Run();
   return 0;
 }
@@ -0,0 +1,97 @@
+// Copyright 2018 The Fuchsia Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "garnet/bin/media/audio_core/mix_worker_pool.h"
+
+#include <zircon/syscalls.h>
+
+#include "lib/fxl/logging.h"
+
+namespace media {
+namespace audio {
+
+MixWorkerPool::MixWorkerPool(uint32_t num_workers) {
+  workers_.reserve(num_workers);
+  for (uint32_t i = 0; i < num_workers; ++i) {
+    workers_.emplace_back([this, i]() { WorkerThread(i); });
+  }
+}
+
+MixWorkerPool::~MixWorkerPool() {
+  {
+    std::lock_guard<std::mutex> locker(mutex_);
+    shutting_down_ = true;
+  }
+  work_available_.notify_all();
+
+  for (auto& worker : workers_) {
+    worker.join();
+  }
+}
+
+void MixWorkerPool::Run(uint32_t num_tasks, const Task& task) {
+  FXL_DCHECK(num_tasks > 0);
+  FXL_DCHECK(num_tasks <= num_workers() + 1);
+
+  if (num_tasks > 1) {
+    {
+      std::lock_guard<std::mutex> locker(mutex_);
+      FXL_DCHECK(tasks_outstanding_ == 0);
+      task_ = &task;
+      num_tasks_ = num_tasks;
+      tasks_outstanding_ = num_tasks - 1;
+      ++generation_;
+    }
+    work_available_.notify_all();
+  }
+
+  task(0);
+
+  if (num_tasks > 1) {
+    std::unique_lock<std::mutex> locker(mutex_);
+    while (tasks_outstanding_ > 0) {
+      work_done_.wait(locker);
+    }
+    task_ = nullptr;
+  }
+}
+
+void MixWorkerPool::WorkerThread(uint32_t worker_index) {
+  // Workers act on behalf of a mix thread, so they need the same priority.  As
+  // with the service's main thread, this should change once there is a more
+  // official way of meeting real-time latency requirements (see MG-940).
+  zx_thread_set_priority(24 /* HIGH_PRIORITY in LK */);
+
+  // Worker N runs task N + 1; task 0 belongs to the thread which calls Run.
+  uint32_t task_index = worker_index + 1;
+  uint64_t last_generation = 0;
+
+  std::unique_lock<std::mutex> locker(mutex_);
+  while (true) {
+    while (!shutting_down_ && (generation_ == last_generation)) {
+      work_available_.wait(locker);
+    }
+    if (shutting_down_) {
+      return;
+    }
+
+    last_generation = generation_;
+    if (task_index >= num_tasks_) {
+      continue;
+    }
+
+    const Task* task = task_;
+    locker.unlock();
+    (*task)(task_index);
+    locker.lock();
+
+    FXL_DCHECK(tasks_outstanding_ > 0);
+    if (--tasks_outstanding_ == 0) {
+      work_done_.notify_one();
+    }
+  }
+}
+
+}  // namespace audio
+}  // namespace media
@@ -0,0 +1,61 @@
+// Copyright 2018 The Fuchsia Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef GARNET_BIN_MEDIA_AUDIO_CORE_MIX_WORKER_POOL_H_
+#define GARNET_BIN_MEDIA_AUDIO_CORE_MIX_WORKER_POOL_H_
+
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "lib/fxl/macros.h"
+#include "lib/fxl/synchronization/thread_annotations.h"
+
+namespace media {
+namespace audio {
+
+// MixWorkerPool is a small set of high priority threads which help an output's
+// mix thread get through a mix job.  The mix thread hands the pool a batch of
+// tasks, runs the first one itself, and waits for the workers to finish the
+// rest; so, from the point of view of the output, the batch runs synchronously
+// within its mix domain.
+class MixWorkerPool {
+ public:
+  using Task = std::function<void(uint32_t task_index)>;
+
+  explicit MixWorkerPool(uint32_t num_workers);
+  ~MixWorkerPool();
+
+  uint32_t num_workers() const {
+    return static_cast<uint32_t>(workers_.size());
+  }
+
+  // Run task(0) on the calling thread, and task(1) through task(num_tasks - 1)
+  // on the workers, returning once all of them have completed.  num_tasks may
+  // not exceed num_workers() + 1.  Only one thread may call Run at a time.
+  void Run(uint32_t num_tasks, const Task& task);
+
+ private:
+  void WorkerThread(uint32_t worker_index);
+
+  std::vector<std::thread> workers_;
+
+  std::mutex mutex_;
+  std::condition_variable work_available_;
+  std::condition_variable work_done_;
+  const Task* task_ FXL_GUARDED_BY(mutex_) = nullptr;
+  uint32_t num_tasks_ FXL_GUARDED_BY(mutex_) = 0;
+  uint32_t tasks_outstanding_ FXL_GUARDED_BY(mutex_) = 0;
+  uint64_t generation_ FXL_GUARDED_BY(mutex_) = 0;
+  bool shutting_down_ FXL_GUARDED_BY(mutex_) = false;
+
+  FXL_DISALLOW_COPY_AND_ASSIGN(MixWorkerPool);
+};
+
+}  // namespace audio
+}  // namespace media
+
+#endif  // GARNET_BIN_MEDIA_AUDIO_CORE_MIX_WORKER_POOL_H_
@@ -4,6 +4,8 @@
 
 #include "garnet/bin/media/audio_core/mixer/fx_processor.h"
 
+#include <algorithm>
+
 #include "garnet/bin/media/audio_core/mixer/fx_loader.h"
 #include "lib/fxl/logging.h"
 
@@ -31,7 +33,11 @@ fx_token_t FxProcessor::CreateFx(uint32_t effect_id, uint16_t channels_in,
   }
 
   // If we successfully create but can't insert, delete before returning error.
-  if (InsertFx(fx_token, position) != ZX_OK) {
+  fuchsia_audio_dfx_parameters fx_params;
+  if (fx_loader_->FxGetParameters(fx_token, &fx_params) != ZX_OK ||
+      InsertFx({fx_token, fx_params.channels_in,
+                fx_params.suggested_frames_per_buffer},
+               position) != ZX_OK) {
     fx_loader_->DeleteFx(fx_token);
     return FUCHSIA_AUDIO_DFX_INVALID_TOKEN;
   }
@@ -47,7 +53,7 @@ fx_token_t FxProcessor::GetFxAt(uint16_t position) {
     return FUCHSIA_AUDIO_DFX_INVALID_TOKEN;
   }
 
-  return fx_chain_[position];
+  return fx_chain_[position].token;
 }
 
 // Move the specified instance to a new position in the FX chain.
@@ -56,11 +62,14 @@ zx_status_t FxProcessor::ReorderFx(fx_token_t fx_token, uint8_t new_position) {
   if (new_position >= fx_chain_.size()) {
     return ZX_ERR_OUT_OF_RANGE;
   }
-  if (RemoveFx(fx_token) != ZX_OK) {
+  auto iter = FindFx(fx_token);
+  if (iter == fx_chain_.end()) {
     return ZX_ERR_NOT_FOUND;
   }
 
-  return InsertFx(fx_token, new_position);
+  FxInstance instance = *iter;
+  fx_chain_.erase(iter);
+  return InsertFx(instance, new_position);
 }
 
 // Remove and delete the specified instance.
@@ -84,6 +93,11 @@ zx_status_t FxProcessor::DeleteFx(fx_token_t fx_token) {
 // Per spec, fail if audio_buff_in_out is nullptr (even if num_frames is 0).
 // Also, if any instance fails Process, exit without calling the others.
 // TODO(mpuryear): Should we still call the other instances, if one fails?
+//
+// Each instance's output is the next instance's input, and an instance cannot
+// tell one large call from several smaller consecutive ones. So, if buffers are
+// large, we run the whole chain over each cache-sized block before moving on,
+// instead of streaming the entire buffer through the cache once per instance.
 zx_status_t FxProcessor::ProcessInPlace(uint32_t num_frames,
                                         float* audio_buff_in_out) {
   if (audio_buff_in_out == nullptr) {
@@ -93,16 +107,27 @@ zx_status_t FxProcessor::ProcessInPlace(uint32_t num_frames,
     return ZX_OK;
   }
 
-  for (auto fx_token : fx_chain_) {
-    if (fx_token == FUCHSIA_AUDIO_DFX_INVALID_TOKEN) {
-      return ZX_ERR_INTERNAL;
-    }
+  uint32_t block_frames =
+      (block_frames_ > 0 ? std::min(block_frames_, num_frames) : num_frames);
+  uint32_t block_samples =
+      (block_frames_ > 0 ? block_frames * fx_chain_[0].channels : 0);
 
-    zx_status_t ret_val =
-        fx_loader_->FxProcessInPlace(fx_token, num_frames, audio_buff_in_out);
-    if (ret_val != ZX_OK) {
-      return ret_val;
+  for (uint32_t frame = 0; frame < num_frames; frame += block_frames) {
+    uint32_t frames = std::min(block_frames, num_frames - frame);
+
+    for (const auto& instance : fx_chain_) {
+      if (instance.token == FUCHSIA_AUDIO_DFX_INVALID_TOKEN) {
+        return ZX_ERR_INTERNAL;
+      }
+
+      zx_status_t ret_val = fx_loader_->FxProcessInPlace(
+          instance.token, frames, audio_buff_in_out);
+      if (ret_val != ZX_OK) {
+        return ret_val;
+      }
     }
+
+    audio_buff_in_out += block_samples;
   }
 
   return ZX_OK;
@@ -112,12 +137,12 @@ zx_status_t FxProcessor::ProcessInPlace(uint32_t num_frames,
 // If any instance fails, exit without calling the others.
 // TODO(mpuryear): Because Flush is a cleanup, do we Flush ALL even on error?
 zx_status_t FxProcessor::Flush() {
-  for (auto fx_token : fx_chain_) {
-    if (fx_token == FUCHSIA_AUDIO_DFX_INVALID_TOKEN) {
+  for (const auto& instance : fx_chain_) {
+    if (instance.token == FUCHSIA_AUDIO_DFX_INVALID_TOKEN) {
       return ZX_ERR_INTERNAL;
     }
 
-    zx_status_t ret_val = fx_loader_->FxFlush(fx_token);
+    zx_status_t ret_val = fx_loader_->FxFlush(instance.token);
     if (ret_val != ZX_OK) {
       return ret_val;
     }
@@ -132,28 +157,72 @@ zx_status_t FxProcessor::Flush() {
 
 // Insert an already-created effect instance at the specified position.
 // If position is out-of-range, return an error (don't clamp).
-zx_status_t FxProcessor::InsertFx(fx_token_t fx_token, uint8_t position) {
-  if (fx_token == FUCHSIA_AUDIO_DFX_INVALID_TOKEN) {
+zx_status_t FxProcessor::InsertFx(const FxInstance& instance,
+                                  uint8_t position) {
+  if (instance.token == FUCHSIA_AUDIO_DFX_INVALID_TOKEN) {
     return ZX_ERR_INVALID_ARGS;
   }
   if (position > fx_chain_.size()) {
     return ZX_ERR_OUT_OF_RANGE;
   }
 
-  fx_chain_.insert(fx_chain_.begin() + position, fx_token);
+  fx_chain_.insert(fx_chain_.begin() + position, instance);
+  UpdateBlockFrames();
   return ZX_OK;
 }
 
 // Remove an existing effect instance from the FX chain.
 zx_status_t FxProcessor::RemoveFx(fx_token_t fx_token) {
-  auto iter = std::find(fx_chain_.begin(), fx_chain_.end(), fx_token);
+  auto iter = FindFx(fx_token);
   if (iter == fx_chain_.end()) {
     return ZX_ERR_NOT_FOUND;
   }
 
   fx_chain_.erase(iter);
+  UpdateBlockFrames();
   return ZX_OK;
 }
 
+// Locate an effect instance in the FX chain, by token.
+std::vector<FxProcessor::FxInstance>::iterator FxProcessor::FindFx(
+    fx_token_t fx_token) {
+  return std::find_if(
+      fx_chain_.begin(), fx_chain_.end(),
+      [fx_token](const FxInstance& instance) {
+        return instance.token == fx_token;
+      });
+}
+
+// A lone instance gains nothing from blocking. Nor can we block a chain whose
+// instances disagree on channelization, as we would not know the frame size.
+// Otherwise, blocks fill kFxBlockBytes, rounded down to a whole number of the
+// largest suggested_frames_per_buffer (but never less than one of them).
+void FxProcessor::UpdateBlockFrames() {
+  block_frames_ = 0;
+  if (fx_chain_.size() < 2) {
+    return;
+  }
+
+  uint16_t channels = fx_chain_[0].channels;
+  uint32_t suggested_frames = 0;
+  for (const auto& instance : fx_chain_) {
+    if (instance.channels != channels) {
+      return;
+    }
+    suggested_frames = std::max(suggested_frames, instance.suggested_frames);
+  }
+  if (channels == 0) {
+    return;
+  }
+
+  uint32_t block_frames = kFxBlockBytes / (channels * sizeof(float));
+  if (suggested_frames > 0) {
+    block_frames =
+        std::max<uint32_t>(block_frames / suggested_frames, 1) *
+        suggested_frames;
+  }
+  block_frames_ = block_frames;
+}
+
 }  // namespace audio
 }  // namespace media
@@ -22,6 +22,10 @@ namespace audio {
 // originate from the same .SO library (hence share a single FxLoader) and run
 // at the same frame rate. This class is designed to be used synchronously and
 // is not explicitly multi-thread-safe.
+//
+// Rather than passing the entire buffer through each instance in turn, a chain
+// of in-place effects is run over the buffer one cache-sized block at a time,
+// so that each block stays cached while every instance processes it.
 class FxProcessor {
  public:
   FxProcessor(FxLoader* loader, uint32_t frame_rate)
@@ -49,7 +53,8 @@ class FxProcessor {
   // This removes instance from the chain and directly calls the DeleteFx ABI.
   zx_status_t DeleteFx(fx_token_t fx_token);
 
-  // This maps directly to the corresponding ABI call, for each instance.
+  // This maps to the corresponding ABI call, for each instance. Instances are
+  // called once per block of the buffer, so they may see several calls.
   zx_status_t ProcessInPlace(uint32_t num_frames, float* audio_buff_in_out);
 
   // This maps directly to the corresponding ABI call, for each instance.
@@ -69,16 +74,37 @@ class FxProcessor {
   // zx_status_t Reset(fx_token_t token);
 
  private:
+  // Chained instances run over blocks no larger than this, sized to remain in
+  // a typical L1 data cache alongside the instances' own state.
+  static constexpr uint32_t kFxBlockBytes = 16384;
+
+  struct FxInstance {
+    fx_token_t token;
+    uint16_t channels;
+    uint32_t suggested_frames;
+  };
+
   // Used internally, this inserts an already-created instance into the chain.
-  zx_status_t InsertFx(fx_token_t fx_token, uint8_t position);
+  zx_status_t InsertFx(const FxInstance& instance, uint8_t position);
 
   // Used internally, this removes an already-created instance from the chain.
   zx_status_t RemoveFx(fx_token_t fx_token);
 
+  // Used internally, this locates an instance in the chain (or returns end()).
+  std::vector<FxInstance>::iterator FindFx(fx_token_t fx_token);
+
+  // Used internally, this recalculates block_frames_ when the chain changes.
+  void UpdateBlockFrames();
+
   ::media::audio::FxLoader* fx_loader_;
   uint32_t frame_rate_;
 
-  std::vector<fx_token_t> fx_chain_;
+  std::vector<FxInstance> fx_chain_;
+
+  // Frames per block for ProcessInPlace, or 0 to process the whole buffer with
+  // each instance in turn (a lone instance, or a chain whose instances do not
+  // agree on the number of channels).
+  uint32_t block_frames_ = 0;
 };
 
 }  // namespace audio
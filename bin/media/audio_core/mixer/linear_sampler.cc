@@ -8,6 +8,7 @@
 #include <limits>
 
 #include "garnet/bin/media/audio_core/mixer/constants.h"
+#include "garnet/bin/media/audio_core/mixer/mixer_simd.h"
 #include "garnet/bin/media/audio_core/mixer/mixer_utils.h"
 #include "lib/fxl/logging.h"
 
@@ -194,6 +195,35 @@ inline bool LinearSamplerImpl<DestChanCount, SrcSampleType, SrcChanCount>::Mix(
     }
 
     // Now we are fully in the current buffer and need not rely on our cache.
+    // At a fixed rate with matching channel layouts, the run is handed to the
+    // vectorized kernels. At unity rate every frame uses the same
+    // interpolation weight; otherwise each frame's neighbors and weight are
+    // gathered first.
+    if (!HasModulo && (ScaleType != ScalerType::RAMPING) &&
+        (SrcChanCount == DestChanCount) && (dest_off < dest_frames) &&
+        (src_off >= 0) && (src_off < src_end)) {
+      if (step_size == FRAC_ONE) {
+        uint32_t src_frames =
+            (src_end >> kPtsFractionalBits) - (src_off >> kPtsFractionalBits);
+        uint32_t frames = std::min(src_frames, dest_frames - dest_off);
+        InterpolateUnityRate<ScaleType, DoAccumulate>(
+            dest + (dest_off * DestChanCount),
+            src + ((src_off >> kPtsFractionalBits) * SrcChanCount),
+            frames * DestChanCount, SrcChanCount, src_off & FRAC_MASK,
+            amplitude_scale);
+        dest_off += frames;
+        src_off += frames * FRAC_ONE;
+      } else {
+        uint32_t src_frames = ((src_end - src_off) + step_size - 1) / step_size;
+        uint32_t frames = std::min(src_frames, dest_frames - dest_off);
+        InterpolateFixedRate<ScaleType, DoAccumulate>(
+            dest + (dest_off * DestChanCount), src, frames, SrcChanCount,
+            src_off, step_size, amplitude_scale);
+        dest_off += frames;
+        src_off += frames * step_size;
+      }
+    }
+
     while ((dest_off < dest_frames) && (src_off < src_end)) {
       uint32_t S = (src_off >> kPtsFractionalBits) * SrcChanCount;
       float* out = dest + (dest_off * DestChanCount);
@@ -479,6 +509,32 @@ inline bool NxNLinearSamplerImpl<SrcSampleType>::Mix(
     }
 
     // Now we are fully in the current buffer and need not rely on our cache.
+    // At unity rate every frame uses the same interpolation weight. At other
+    // fixed rates each frame's neighbors and weight are gathered first.
+    if (!HasModulo && (ScaleType != ScalerType::RAMPING) &&
+        (dest_off < dest_frames) && (src_off >= 0) && (src_off < src_end)) {
+      if (step_size == FRAC_ONE) {
+        uint32_t src_frames =
+            (src_end >> kPtsFractionalBits) - (src_off >> kPtsFractionalBits);
+        uint32_t frames = std::min(src_frames, dest_frames - dest_off);
+        InterpolateUnityRate<ScaleType, DoAccumulate>(
+            dest + (dest_off * chan_count),
+            src + ((src_off >> kPtsFractionalBits) * chan_count),
+            frames * chan_count, chan_count, src_off & FRAC_MASK,
+            amplitude_scale);
+        dest_off += frames;
+        src_off += frames * FRAC_ONE;
+      } else if (chan_count <= kFixedRateBlockSamples) {
+        uint32_t src_frames = ((src_end - src_off) + step_size - 1) / step_size;
+        uint32_t frames = std::min(src_frames, dest_frames - dest_off);
+        InterpolateFixedRate<ScaleType, DoAccumulate>(
+            dest + (dest_off * chan_count), src, frames, chan_count, src_off,
+            step_size, amplitude_scale);
+        dest_off += frames;
+        src_off += frames * step_size;
+      }
+    }
+
     while ((dest_off < dest_frames) && (src_off < src_end)) {
       uint32_t S = (src_off >> kPtsFractionalBits) * chan_count;
       float* out = dest + (dest_off * chan_count);
@@ -32,10 +32,13 @@ class Mixer {
   // optionally use this enum to specify a resampler type. Default allows an
   // algorithm to select a resampler based on the ratio of incoming and outgoing
   // rates, using Linear for all except "Integer-to-One" resampling ratios.
+  // WindowedSinc is never chosen by Default; it trades CPU for fidelity, so
+  // callers that need it must request it explicitly.
   enum class Resampler {
     Default = 0,
     SampleAndHold,
     LinearInterpolation,
+    WindowedSinc,
   };
 
   //
@@ -186,7 +189,7 @@ class Mixer {
 //
 // mixer
 // This is a pointer to the Mixer object that resamples the input. Currently the
-// resampler types include SampleAndHold and LinearInterpolation.
+// resampler types include SampleAndHold, LinearInterpolation and WindowedSinc.
 //
 // gain
 // This object maintains gain values contained in the mix path. This includes
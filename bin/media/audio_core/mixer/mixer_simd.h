@@ -0,0 +1,415 @@
+// Copyright 2018 The Fuchsia Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef GARNET_BIN_MEDIA_AUDIO_CORE_MIXER_MIXER_SIMD_H_
+#define GARNET_BIN_MEDIA_AUDIO_CORE_MIXER_MIXER_SIMD_H_
+
+#include <string.h>
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <type_traits>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#elif defined(__ARM_NEON)
+#include <arm_neon.h>
+#endif
+
+#include "garnet/bin/media/audio_core/mixer/constants.h"
+#include "garnet/bin/media/audio_core/mixer/gain.h"
+#include "garnet/bin/media/audio_core/mixer/mixer_utils.h"
+
+namespace media {
+namespace audio {
+namespace mixer {
+
+// mixer_simd.h contains vectorized inner loops for the most common mix
+// configurations: those where each destination frame consumes exactly one
+// source frame (unity rate, no rate modulo) and source and destination have
+// the same channel layout, so that a run of frames is simply a run of
+// interleaved samples that can be processed elementwise. At other fixed rates
+// (no rate modulo), source frames are first gathered into a contiguous block
+// and then processed the same way. It also contains the filter-tap kernels
+// used by the sinc sampler.
+//
+// Kernels use the baseline vector ISA of each architecture (SSE2 on x64, NEON
+// on arm64), so no runtime CPU detection is needed. Elsewhere they fall back
+// to the scalar SampleNormalizer/DestMixer path. Every vector operation is
+// the same float operation, in the same order, as the scalar code, so the
+// point-sampling kernels are bit-exact with the scalar loops they replace.
+
+// Interpolation weight (in 19.13 fixed-point) to float, as in linear_sampler.
+constexpr float kSimdFramesPerPtsSubframe = 1.0f / (1 << kPtsFractionalBits);
+
+// Number of samples the fixed-rate kernels gather into each block on the
+// stack. Callers must not pass a channel count larger than this.
+constexpr size_t kFixedRateBlockSamples = 256;
+
+namespace simd {
+
+#if defined(__SSE2__) || defined(__ARM_NEON)
+constexpr bool kEnabled = true;
+constexpr size_t kLanes = 4;
+
+#if defined(__SSE2__)
+using FloatVec = __m128;
+inline FloatVec Dup(float val) { return _mm_set1_ps(val); }
+inline FloatVec Load(const float* src) { return _mm_loadu_ps(src); }
+inline void Store(float* dest, FloatVec val) { _mm_storeu_ps(dest, val); }
+inline FloatVec Add(FloatVec a, FloatVec b) { return _mm_add_ps(a, b); }
+inline FloatVec Sub(FloatVec a, FloatVec b) { return _mm_sub_ps(a, b); }
+inline FloatVec Mul(FloatVec a, FloatVec b) { return _mm_mul_ps(a, b); }
+#else
+using FloatVec = float32x4_t;
+inline FloatVec Dup(float val) { return vdupq_n_f32(val); }
+inline FloatVec Load(const float* src) { return vld1q_f32(src); }
+inline void Store(float* dest, FloatVec val) { vst1q_f32(dest, val); }
+inline FloatVec Add(FloatVec a, FloatVec b) { return vaddq_f32(a, b); }
+inline FloatVec Sub(FloatVec a, FloatVec b) { return vsubq_f32(a, b); }
+inline FloatVec Mul(FloatVec a, FloatVec b) { return vmulq_f32(a, b); }
+#endif
+
+//
+// VecNormalizer
+//
+// Vector equivalent of SampleNormalizer: read kLanes samples and normalize
+// them into float32 [ -1.0 , 1.0 ] format.
+template <typename SrcSampleType, typename Enable = void>
+class VecNormalizer;
+
+template <typename SrcSampleType>
+class VecNormalizer<SrcSampleType,
+                    typename std::enable_if<
+                        std::is_same<SrcSampleType, uint8_t>::value>::type> {
+ public:
+  static inline FloatVec Read(const SrcSampleType* src) {
+    uint32_t packed;
+    ::memcpy(&packed, src, sizeof(packed));
+#if defined(__SSE2__)
+    const __m128i zero = _mm_setzero_si128();
+    __m128i val = _mm_cvtsi32_si128(static_cast<int32_t>(packed));
+    val = _mm_unpacklo_epi16(_mm_unpacklo_epi8(val, zero), zero);
+    val = _mm_sub_epi32(val, _mm_set1_epi32(kOffsetInt8ToUint8));
+    return _mm_mul_ps(_mm_cvtepi32_ps(val), _mm_set1_ps(kInt8ToFloat));
+#else
+    uint16x8_t wide = vmovl_u8(vreinterpret_u8_u32(vdup_n_u32(packed)));
+    int32x4_t val =
+        vreinterpretq_s32_u32(vmovl_u16(vget_low_u16(wide)));
+    val = vsubq_s32(val, vdupq_n_s32(kOffsetInt8ToUint8));
+    return vmulq_f32(vcvtq_f32_s32(val), vdupq_n_f32(kInt8ToFloat));
+#endif
+  }
+};
+
+template <typename SrcSampleType>
+class VecNormalizer<SrcSampleType,
+                    typename std::enable_if<
+                        std::is_same<SrcSampleType, int16_t>::value>::type> {
+ public:
+  static inline FloatVec Read(const SrcSampleType* src) {
+#if defined(__SSE2__)
+    __m128i val = _mm_loadl_epi64(reinterpret_cast<const __m128i*>(src));
+    val = _mm_srai_epi32(_mm_unpacklo_epi16(val, val), 16);
+    return _mm_mul_ps(_mm_cvtepi32_ps(val), _mm_set1_ps(kInt16ToFloat));
+#else
+    int32x4_t val = vmovl_s16(vld1_s16(src));
+    return vmulq_f32(vcvtq_f32_s32(val), vdupq_n_f32(kInt16ToFloat));
+#endif
+  }
+};
+
+template <typename SrcSampleType>
+class VecNormalizer<SrcSampleType,
+                    typename std::enable_if<
+                        std::is_same<SrcSampleType, int32_t>::value>::type> {
+ public:
+  // kInt24In32ToFloat is a power of two, so scaling in float rather than in
+  // double (as SampleNormalizer does) produces identical results.
+  static inline FloatVec Read(const SrcSampleType* src) {
+    const float scale = static_cast<float>(kInt24In32ToFloat);
+#if defined(__SSE2__)
+    __m128i val = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src));
+    return _mm_mul_ps(_mm_cvtepi32_ps(val), _mm_set1_ps(scale));
+#else
+    return vmulq_f32(vcvtq_f32_s32(vld1q_s32(src)), vdupq_n_f32(scale));
+#endif
+  }
+};
+
+template <typename SrcSampleType>
+class VecNormalizer<
+    SrcSampleType,
+    typename std::enable_if<std::is_same<SrcSampleType, float>::value>::type> {
+ public:
+  static inline FloatVec Read(const SrcSampleType* src) { return Load(src); }
+};
+
+//
+// VecMix
+//
+// Vector equivalent of DestMixer (SampleScaler included): scale the samples
+// as ScaleType requires, then accumulate into or overwrite |dest|. Kernels
+// take a single scale value, so callers must not use them while ramping.
+template <ScalerType ScaleType, bool DoAccumulate>
+inline void VecMix(float* dest, FloatVec sample, FloatVec scale) {
+  if (ScaleType == ScalerType::MUTED) {
+    sample = Dup(0.0f);
+  } else if (ScaleType != ScalerType::EQ_UNITY) {
+    sample = Mul(scale, sample);
+  }
+  if (DoAccumulate) {
+    sample = Add(sample, Load(dest));
+  }
+  Store(dest, sample);
+}
+#else
+constexpr bool kEnabled = false;
+constexpr size_t kLanes = 1;
+#endif
+
+}  // namespace simd
+
+//
+// MixUnityRate
+//
+// Mix |num_samples| consecutive interleaved samples from |src| into |dest|:
+// dest[i] = DestMixer::Mix(dest[i], Normalize(src[i]), scale).
+// Used by point samplers when the step size is exactly one frame.
+template <ScalerType ScaleType, bool DoAccumulate, typename SrcSampleType>
+inline void MixUnityRate(float* dest, const SrcSampleType* src,
+                         size_t num_samples, Gain::AScale scale) {
+  using DM = DestMixer<ScaleType, DoAccumulate>;
+  size_t idx = 0;
+
+#if defined(__SSE2__) || defined(__ARM_NEON)
+  const simd::FloatVec vec_scale = simd::Dup(scale);
+  for (; idx + simd::kLanes <= num_samples; idx += simd::kLanes) {
+    simd::VecMix<ScaleType, DoAccumulate>(
+        dest + idx, simd::VecNormalizer<SrcSampleType>::Read(src + idx),
+        vec_scale);
+  }
+#endif
+
+  for (; idx < num_samples; ++idx) {
+    float sample = SampleNormalizer<SrcSampleType>::Read(src + idx);
+    dest[idx] = DM::Mix(dest[idx], sample, scale);
+  }
+}
+
+//
+// InterpolateUnityRate
+//
+// Linearly interpolate |num_samples| consecutive interleaved samples, each
+// between src[i] and the same channel of the following frame
+// (src[i + chan_count]) with the fixed 19.13 weight |alpha|, and mix the result
+// into |dest|. Used by linear samplers when the step size is exactly one
+// frame, as the interpolation weight is then the same for every frame.
+//
+// This matches linear_sampler's scalar Interpolate operation for operation,
+// but a compiler may contract the scalar expression into fused multiply-adds
+// on some targets, so results are equal to within float rounding rather than
+// guaranteed bit-exact.
+template <ScalerType ScaleType, bool DoAccumulate, typename SrcSampleType>
+inline void InterpolateUnityRate(float* dest, const SrcSampleType* src,
+                                 size_t num_samples, size_t chan_count,
+                                 uint32_t alpha, Gain::AScale scale) {
+  using DM = DestMixer<ScaleType, DoAccumulate>;
+  size_t idx = 0;
+
+#if defined(__SSE2__) || defined(__ARM_NEON)
+  const simd::FloatVec vec_scale = simd::Dup(scale);
+  const simd::FloatVec vec_frames_per_subframe =
+      simd::Dup(kSimdFramesPerPtsSubframe);
+  const simd::FloatVec vec_alpha = simd::Dup(static_cast<float>(alpha));
+  for (; idx + simd::kLanes <= num_samples; idx += simd::kLanes) {
+    simd::FloatVec s1 = simd::VecNormalizer<SrcSampleType>::Read(src + idx);
+    simd::FloatVec s2 =
+        simd::VecNormalizer<SrcSampleType>::Read(src + idx + chan_count);
+    simd::FloatVec delta = simd::Mul(
+        simd::Mul(simd::Sub(s2, s1), vec_frames_per_subframe), vec_alpha);
+    simd::VecMix<ScaleType, DoAccumulate>(dest + idx, simd::Add(delta, s1),
+                                          vec_scale);
+  }
+#endif
+
+  for (; idx < num_samples; ++idx) {
+    float s1 = SampleNormalizer<SrcSampleType>::Read(src + idx);
+    float s2 = SampleNormalizer<SrcSampleType>::Read(src + idx + chan_count);
+    float sample = ((s2 - s1) * kSimdFramesPerPtsSubframe * alpha) + s1;
+    dest[idx] = DM::Mix(dest[idx], sample, scale);
+  }
+}
+
+//
+// MixFixedRate
+//
+// Point-sample |num_frames| frames of |chan_count| interleaved channels from
+// |src|, the first at 19.13 source position |src_pos| and each following one
+// |step_size| later, and mix them into consecutive frames of |dest|. Used by
+// point samplers when the step size is constant but not exactly one frame.
+//
+// Each block of source frames is gathered and normalized into a contiguous
+// buffer, which is then mixed by the unity-rate kernel. The operations are
+// the scalar loop's, so results are bit-exact with it.
+template <ScalerType ScaleType, bool DoAccumulate, typename SrcSampleType>
+inline void MixFixedRate(float* dest, const SrcSampleType* src,
+                         size_t num_frames, size_t chan_count, int32_t src_pos,
+                         uint32_t step_size, Gain::AScale scale) {
+  float block[kFixedRateBlockSamples];
+  const size_t block_frames = kFixedRateBlockSamples / chan_count;
+
+  while (num_frames > 0) {
+    size_t frames = std::min(num_frames, block_frames);
+    size_t num_samples = frames * chan_count;
+    float* gathered = block;
+    for (size_t frame = 0; frame < frames; ++frame) {
+      const SrcSampleType* frame_src =
+          src + ((src_pos >> kPtsFractionalBits) * chan_count);
+      for (size_t chan = 0; chan < chan_count; ++chan) {
+        *gathered++ = SampleNormalizer<SrcSampleType>::Read(frame_src + chan);
+      }
+      src_pos += step_size;
+    }
+
+    MixUnityRate<ScaleType, DoAccumulate>(dest, block, num_samples, scale);
+    dest += num_samples;
+    num_frames -= frames;
+  }
+}
+
+//
+// InterpolateFixedRate
+//
+// Linearly interpolate |num_frames| frames of |chan_count| interleaved
+// channels from |src|, the first at 19.13 source position |src_pos| and each
+// following one |step_size| later, and mix them into consecutive frames of
+// |dest|. Used by linear samplers when the step size is constant but not
+// exactly one frame, so that the interpolation weight changes from frame to
+// frame. Every frame read, including the one following the last position,
+// must lie within |src|.
+//
+// Each block of frames is gathered (both neighbors and the weight, for every
+// sample) into contiguous buffers, then interpolated and mixed with vector
+// operations. As with InterpolateUnityRate, results equal the scalar loop's
+// to within float rounding.
+template <ScalerType ScaleType, bool DoAccumulate, typename SrcSampleType>
+inline void InterpolateFixedRate(float* dest, const SrcSampleType* src,
+                                 size_t num_frames, size_t chan_count,
+                                 int32_t src_pos, uint32_t step_size,
+                                 Gain::AScale scale) {
+  using DM = DestMixer<ScaleType, DoAccumulate>;
+  float s1_block[kFixedRateBlockSamples];
+  float s2_block[kFixedRateBlockSamples];
+  float alpha_block[kFixedRateBlockSamples];
+  const size_t block_frames = kFixedRateBlockSamples / chan_count;
+
+#if defined(__SSE2__) || defined(__ARM_NEON)
+  const simd::FloatVec vec_scale = simd::Dup(scale);
+  const simd::FloatVec vec_frames_per_subframe =
+      simd::Dup(kSimdFramesPerPtsSubframe);
+#endif
+
+  while (num_frames > 0) {
+    size_t frames = std::min(num_frames, block_frames);
+    size_t num_samples = frames * chan_count;
+    size_t idx = 0;
+    for (size_t frame = 0; frame < frames; ++frame) {
+      const SrcSampleType* frame_src =
+          src + ((src_pos >> kPtsFractionalBits) * chan_count);
+      float alpha = static_cast<float>(src_pos & kPtsFractionalMask);
+      for (size_t chan = 0; chan < chan_count; ++chan, ++idx) {
+        s1_block[idx] = SampleNormalizer<SrcSampleType>::Read(frame_src + chan);
+        s2_block[idx] = SampleNormalizer<SrcSampleType>::Read(
+            frame_src + chan + chan_count);
+        alpha_block[idx] = alpha;
+      }
+      src_pos += step_size;
+    }
+
+    idx = 0;
+#if defined(__SSE2__) || defined(__ARM_NEON)
+    for (; idx + simd::kLanes <= num_samples; idx += simd::kLanes) {
+      simd::FloatVec s1 = simd::Load(s1_block + idx);
+      simd::FloatVec s2 = simd::Load(s2_block + idx);
+      simd::FloatVec delta =
+          simd::Mul(simd::Mul(simd::Sub(s2, s1), vec_frames_per_subframe),
+                    simd::Load(alpha_block + idx));
+      simd::VecMix<ScaleType, DoAccumulate>(dest + idx, simd::Add(delta, s1),
+                                            vec_scale);
+    }
+#endif
+
+    for (; idx < num_samples; ++idx) {
+      float s1 = s1_block[idx];
+      float sample = ((s2_block[idx] - s1) * kSimdFramesPerPtsSubframe *
+                      alpha_block[idx]) +
+                     s1;
+      dest[idx] = DM::Mix(dest[idx], sample, scale);
+    }
+
+    dest += num_samples;
+    num_frames -= frames;
+  }
+}
+
+//
+// InterpolateTaps
+//
+// Produce a set of |num_taps| filter taps that lies |alpha| (in [0.0, 1.0))
+// of the way from taps |row0| to taps |row1|. Used by the sinc sampler to
+// refine a filter phase between two neighboring precomputed phases.
+inline void InterpolateTaps(float* dest, const float* row0, const float* row1,
+                            float alpha, size_t num_taps) {
+  size_t idx = 0;
+
+#if defined(__SSE2__) || defined(__ARM_NEON)
+  const simd::FloatVec vec_alpha = simd::Dup(alpha);
+  for (; idx + simd::kLanes <= num_taps; idx += simd::kLanes) {
+    simd::FloatVec t0 = simd::Load(row0 + idx);
+    simd::FloatVec t1 = simd::Load(row1 + idx);
+    simd::Store(dest + idx,
+                simd::Add(t0, simd::Mul(simd::Sub(t1, t0), vec_alpha)));
+  }
+#endif
+
+  for (; idx < num_taps; ++idx) {
+    dest[idx] = row0[idx] + ((row1[idx] - row0[idx]) * alpha);
+  }
+}
+
+//
+// DotProduct
+//
+// Sum of the elementwise products of |src| and |taps|, each |num_taps| long.
+// Lanes are summed separately and combined at the end, so the result differs
+// from a sequential scalar sum by float rounding only.
+inline float DotProduct(const float* src, const float* taps, size_t num_taps) {
+  size_t idx = 0;
+  float sum = 0.0f;
+
+#if defined(__SSE2__) || defined(__ARM_NEON)
+  simd::FloatVec vec_sum = simd::Dup(0.0f);
+  for (; idx + simd::kLanes <= num_taps; idx += simd::kLanes) {
+    simd::FloatVec product =
+        simd::Mul(simd::Load(src + idx), simd::Load(taps + idx));
+    vec_sum = simd::Add(vec_sum, product);
+  }
+  float lanes[simd::kLanes];
+  simd::Store(lanes, vec_sum);
+  sum = (lanes[0] + lanes[1]) + (lanes[2] + lanes[3]);
+#endif
+
+  for (; idx < num_taps; ++idx) {
+    sum += src[idx] * taps[idx];
+  }
+  return sum;
+}
+
+}  // namespace mixer
+}  // namespace audio
+}  // namespace media
+
+#endif  // GARNET_BIN_MEDIA_AUDIO_CORE_MIXER_MIXER_SIMD_H_
@@ -8,6 +8,7 @@
 #include <limits>
 
 #include "garnet/bin/media/audio_core/mixer/constants.h"
+#include "garnet/bin/media/audio_core/mixer/mixer_simd.h"
 #include "garnet/bin/media/audio_core/mixer/mixer_utils.h"
 #include "lib/fxl/logging.h"
 
@@ -127,6 +128,34 @@ inline bool PointSamplerImpl<DestChanCount, SrcSampleType, SrcChanCount>::Mix(
       amplitude_scale = info->gain.GetGainScale();
     }
 
+    // At a fixed rate with matching channel layouts, hand the run to the
+    // vectorized kernels. At unity rate each dest frame takes the next source
+    // frame, so the run is an elementwise operation over contiguous samples;
+    // otherwise the evenly-spaced source frames are gathered first.
+    if (!HasModulo && (ScaleType != ScalerType::RAMPING) &&
+        (SrcChanCount == DestChanCount)) {
+      if (step_size == FRAC_ONE) {
+        uint32_t src_frames = (frac_src_frames >> kPtsFractionalBits) -
+                              (src_off >> kPtsFractionalBits);
+        uint32_t frames = std::min(src_frames, dest_frames - dest_off);
+        MixUnityRate<ScaleType, DoAccumulate>(
+            dest + (dest_off * DestChanCount),
+            src + ((src_off >> kPtsFractionalBits) * SrcChanCount),
+            frames * DestChanCount, amplitude_scale);
+        dest_off += frames;
+        src_off += frames * FRAC_ONE;
+      } else {
+        uint32_t src_frames =
+            ((frac_src_frames - src_off) + step_size - 1) / step_size;
+        uint32_t frames = std::min(src_frames, dest_frames - dest_off);
+        MixFixedRate<ScaleType, DoAccumulate>(
+            dest + (dest_off * DestChanCount), src, frames, SrcChanCount,
+            src_off, step_size, amplitude_scale);
+        dest_off += frames;
+        src_off += frames * step_size;
+      }
+    }
+
     while ((dest_off < dest_frames) &&
            (src_off < static_cast<int32_t>(frac_src_frames))) {
       if (ScaleType == ScalerType::RAMPING) {
@@ -316,6 +345,32 @@ inline bool NxNPointSamplerImpl<SrcSampleType>::Mix(
       amplitude_scale = info->gain.GetGainScale();
     }
 
+    // At unity rate each dest frame takes the next source frame, so the whole
+    // run is an elementwise operation over contiguous samples. At other fixed
+    // rates the evenly-spaced source frames are gathered first.
+    if (!HasModulo && (ScaleType != ScalerType::RAMPING)) {
+      if (step_size == FRAC_ONE) {
+        uint32_t src_frames = (frac_src_frames >> kPtsFractionalBits) -
+                              (src_off >> kPtsFractionalBits);
+        uint32_t frames = std::min(src_frames, dest_frames - dest_off);
+        MixUnityRate<ScaleType, DoAccumulate>(
+            dest + (dest_off * chan_count),
+            src + ((src_off >> kPtsFractionalBits) * chan_count),
+            frames * chan_count, amplitude_scale);
+        dest_off += frames;
+        src_off += frames * FRAC_ONE;
+      } else if (chan_count <= kFixedRateBlockSamples) {
+        uint32_t src_frames =
+            ((frac_src_frames - src_off) + step_size - 1) / step_size;
+        uint32_t frames = std::min(src_frames, dest_frames - dest_off);
+        MixFixedRate<ScaleType, DoAccumulate>(
+            dest + (dest_off * chan_count), src, frames, chan_count, src_off,
+            step_size, amplitude_scale);
+        dest_off += frames;
+        src_off += frames * step_size;
+      }
+    }
+
     while ((dest_off < dest_frames) &&
            (src_off < static_cast<int32_t>(frac_src_frames))) {
       if (ScaleType == ScalerType::RAMPING) {
@@ -0,0 +1,506 @@
+// Copyright 2018 The Fuchsia Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "garnet/bin/media/audio_core/mixer/sinc_sampler.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <map>
+#include <mutex>
+#include <vector>
+
+#include "garnet/bin/media/audio_core/mixer/constants.h"
+#include "garnet/bin/media/audio_core/mixer/mixer_simd.h"
+#include "garnet/bin/media/audio_core/mixer/mixer_utils.h"
+#include "lib/fxl/logging.h"
+
+namespace media {
+namespace audio {
+namespace mixer {
+
+constexpr uint32_t SincSampler::kSincHalfWidth;
+
+// Each output frame is computed from kNumTaps source frames: the kSincHalfWidth
+// frames at or before the sampling position, and the kSincHalfWidth after it.
+constexpr uint32_t kNumTaps = 2 * SincSampler::kSincHalfWidth;
+
+// To use the sampling position's fractional part as a table index, the table
+// holds 2^kPhaseBits filter phases. The remaining kPhaseFracBits of the 19.13
+// position select a point between two adjacent phases. The table has one extra
+// phase (for position 1.0) so that the last phase also has a neighbor.
+constexpr uint32_t kPhaseBits = 8;
+constexpr uint32_t kNumPhases = 1u << kPhaseBits;
+constexpr uint32_t kPhaseFracBits = kPtsFractionalBits - kPhaseBits;
+constexpr uint32_t kPhaseFracMask = (1u << kPhaseFracBits) - 1;
+constexpr float kPhaseFracScale = 1.0f / (1u << kPhaseFracBits);
+
+// Lowpass cutoff, relative to the lower of the source and destination Nyquist
+// frequencies. Leaving a little room lets the transition band fall mostly
+// within the part of the spectrum that is discarded anyway.
+constexpr double kCutoffRatio = 0.91;
+
+// Kaiser window shape parameter: higher values trade a wider transition band
+// for more stopband attenuation. 9.0 yields roughly 90 dB of attenuation.
+constexpr double kKaiserBeta = 9.0;
+
+// Output frames are produced in blocks: the source frames that a block needs
+// are normalized (and rechanneled) once into planar scratch buffers, so that
+// each output sample is a single contiguous dot product.
+constexpr uint32_t kBlockFrames = 256;
+
+// Source frames retained from the previous buffer, to complete the filter for
+// sampling positions near the start of the next buffer.
+constexpr uint32_t kHistoryFrames = kNumTaps - 1;
+
+// Zeroth-order modified Bessel function of the first kind (power series).
+static double BesselI0(double x) {
+  double sum = 1.0;
+  double term = 1.0;
+  double half_x_sq = (x * x) / 4.0;
+  for (uint32_t k = 1; k < 64; ++k) {
+    term *= half_x_sq / (static_cast<double>(k) * k);
+    sum += term;
+    if (term < sum * 1e-16) {
+      break;
+    }
+  }
+  return sum;
+}
+
+// Kaiser-windowed sinc, evaluated at |x| source frames from the sampling
+// position. The window reaches zero at +/- kSincHalfWidth frames.
+static double WindowedSinc(double x, double cutoff) {
+  double half_width = static_cast<double>(SincSampler::kSincHalfWidth);
+  double ratio = x / half_width;
+  if (ratio <= -1.0 || ratio >= 1.0) {
+    return 0.0;
+  }
+
+  double window = BesselI0(kKaiserBeta * std::sqrt(1.0 - ratio * ratio)) /
+                  BesselI0(kKaiserBeta);
+  double arg = M_PI * cutoff * x;
+  double sinc = (arg == 0.0) ? 1.0 : std::sin(arg) / arg;
+  return cutoff * sinc * window;
+}
+
+// Build the filter table for the given cutoff: (kNumPhases + 1) phases of
+// kNumTaps taps each.
+static std::vector<float> ComputeFilterTable(double cutoff) {
+  std::vector<float> table((kNumPhases + 1) * kNumTaps);
+  for (uint32_t phase = 0; phase <= kNumPhases; ++phase) {
+    float* row = table.data() + (phase * kNumTaps);
+    double frac = static_cast<double>(phase) / kNumPhases;
+
+    double sum = 0.0;
+    double coefficients[kNumTaps];
+    for (uint32_t tap = 0; tap < kNumTaps; ++tap) {
+      // Distance from the sampling position to the frame this tap applies to.
+      double x = frac + (SincSampler::kSincHalfWidth - 1) -
+                 static_cast<double>(tap);
+      coefficients[tap] = WindowedSinc(x, cutoff);
+      sum += coefficients[tap];
+    }
+
+    // Normalize each phase to unity gain at DC, so that the truncated filter
+    // neither boosts nor attenuates low frequencies as the phase changes.
+    for (uint32_t tap = 0; tap < kNumTaps; ++tap) {
+      row[tap] = static_cast<float>(coefficients[tap] / sum);
+    }
+  }
+  return table;
+}
+
+// Return the filter table for the given src/dest rates. Tables are computed on
+// first use and shared by every sampler with the same cutoff; only a handful of
+// distinct rate ratios occur in practice, and tables are never released.
+static const float* GetFilterTable(uint32_t src_frame_rate,
+                                   uint32_t dest_frame_rate) {
+  // When downsampling, lower the cutoff to the destination Nyquist frequency.
+  double cutoff = kCutoffRatio;
+  if (src_frame_rate > dest_frame_rate && src_frame_rate > 0) {
+    cutoff *= static_cast<double>(dest_frame_rate) / src_frame_rate;
+  }
+
+  static std::mutex mutex;
+  static std::map<double, std::vector<float>>* tables =
+      new std::map<double, std::vector<float>>();
+
+  std::lock_guard<std::mutex> lock(mutex);
+  auto iter = tables->find(cutoff);
+  if (iter == tables->end()) {
+    iter = tables->emplace(cutoff, ComputeFilterTable(cutoff)).first;
+  }
+  return iter->second.data();
+}
+
+template <typename SrcSampleType>
+class SincSamplerImpl : public SincSampler {
+ public:
+  SincSamplerImpl(uint32_t src_chan_count, uint32_t dest_chan_count,
+                  uint32_t src_frame_rate, uint32_t dest_frame_rate)
+      : SincSampler(kSincHalfWidth * FRAC_ONE - 1,
+                    kSincHalfWidth * FRAC_ONE - 1),
+        src_chan_count_(src_chan_count),
+        dest_chan_count_(dest_chan_count),
+        filter_table_(GetFilterTable(src_frame_rate, dest_frame_rate)),
+        history_(kHistoryFrames * dest_chan_count) {
+    Reset();
+  }
+
+  bool Mix(float* dest, uint32_t dest_frames, uint32_t* dest_offset,
+           const void* src, uint32_t frac_src_frames, int32_t* frac_src_offset,
+           bool accumulate, Bookkeeping* info) override;
+
+  // If/when Bookkeeping is included in this class, clear src_pos_modulo here.
+  void Reset() override { std::fill(history_.begin(), history_.end(), 0.0f); }
+
+ private:
+  template <ScalerType ScaleType, bool DoAccumulate, bool HasModulo>
+  inline bool Mix(float* dest, uint32_t dest_frames, uint32_t* dest_offset,
+                  const void* src, uint32_t frac_src_frames,
+                  int32_t* frac_src_offset, Bookkeeping* info);
+
+  // Read the given destination channel from a source frame, rechanneling from
+  // mono or to mono as needed.
+  inline float ReadSample(const SrcSampleType* frame, uint32_t dest_chan) {
+    if (src_chan_count_ == dest_chan_count_) {
+      return SampleNormalizer<SrcSampleType>::Read(frame + dest_chan);
+    }
+    if (src_chan_count_ == 1) {
+      return SampleNormalizer<SrcSampleType>::Read(frame);
+    }
+    return 0.5f * (SampleNormalizer<SrcSampleType>::Read(frame) +
+                   SampleNormalizer<SrcSampleType>::Read(frame + 1));
+  }
+
+  // Normalize source frames [first, last] into scratch_, one plane per dest
+  // channel. Frames before the buffer come from history_; frames after it are
+  // only ever reached by zero-valued taps, so they are filled with silence.
+  void FillScratch(const SrcSampleType* src, int32_t src_frames, int32_t first,
+                   int32_t last);
+
+  // Retain the final frames of a fully-consumed source buffer (or silence, if
+  // that is what we produced from it) for use with the next buffer.
+  void UpdateHistory(const SrcSampleType* src, int32_t src_frames, bool muted);
+
+  uint32_t src_chan_count_;
+  uint32_t dest_chan_count_;
+
+  // (kNumPhases + 1) phases of kNumTaps taps each. Within a phase, taps are in
+  // source frame order: tap 0 applies to the frame (kSincHalfWidth - 1) before
+  // the sampling position's frame. Shared; see GetFilterTable.
+  const float* filter_table_;
+  std::vector<float> history_;
+  std::vector<float> scratch_;
+  float taps_[kNumTaps];
+  int32_t positions_[kBlockFrames];
+};
+
+template <typename SrcSampleType>
+void SincSamplerImpl<SrcSampleType>::FillScratch(const SrcSampleType* src,
+                                                 int32_t src_frames,
+                                                 int32_t first, int32_t last) {
+  FXL_DCHECK(first >= -static_cast<int32_t>(kHistoryFrames));
+  FXL_DCHECK(last >= first);
+
+  size_t plane_len = last - first + 1;
+  if (scratch_.size() < plane_len * dest_chan_count_) {
+    scratch_.resize(plane_len * dest_chan_count_);
+  }
+
+  for (uint32_t D = 0; D < dest_chan_count_; ++D) {
+    float* plane = scratch_.data() + (D * plane_len);
+    const float* history = history_.data() + (D * kHistoryFrames);
+
+    int32_t frame = first;
+    for (; frame < 0 && frame <= last; ++frame) {
+      *plane++ = history[kHistoryFrames + frame];
+    }
+    for (; frame < src_frames && frame <= last; ++frame) {
+      *plane++ = ReadSample(src + (frame * src_chan_count_), D);
+    }
+    for (; frame <= last; ++frame) {
+      *plane++ = 0.0f;
+    }
+  }
+}
+
+template <typename SrcSampleType>
+void SincSamplerImpl<SrcSampleType>::UpdateHistory(const SrcSampleType* src,
+                                                   int32_t src_frames,
+                                                   bool muted) {
+  for (uint32_t D = 0; D < dest_chan_count_; ++D) {
+    float* history = history_.data() + (D * kHistoryFrames);
+    // Each entry moves toward the front (or is replaced by a newer source
+    // frame), so walking forward never reads an already-updated entry.
+    for (uint32_t idx = 0; idx < kHistoryFrames; ++idx) {
+      int32_t frame = src_frames - static_cast<int32_t>(kHistoryFrames) + idx;
+      if (muted) {
+        history[idx] = 0.0f;
+      } else if (frame >= 0) {
+        history[idx] = ReadSample(src + (frame * src_chan_count_), D);
+      } else {
+        history[idx] = history[kHistoryFrames + frame];
+      }
+    }
+  }
+}
+
+// If upper layers call with ScaleType MUTED, they must set DoAccumulate=TRUE.
+// They guarantee new buffers are cleared before usage; we optimize accordingly.
+template <typename SrcSampleType>
+template <ScalerType ScaleType, bool DoAccumulate, bool HasModulo>
+inline bool SincSamplerImpl<SrcSampleType>::Mix(
+    float* dest, uint32_t dest_frames, uint32_t* dest_offset,
+    const void* src_void, uint32_t frac_src_frames, int32_t* frac_src_offset,
+    Bookkeeping* info) {
+  static_assert(
+      ScaleType != ScalerType::MUTED || DoAccumulate == true,
+      "Mixing muted streams without accumulation is explicitly unsupported");
+
+  // Although the number of source frames is expressed in fixed-point 19.13
+  // format, the actual number of frames must always be an integer.
+  FXL_DCHECK((frac_src_frames & kPtsFractionalMask) == 0);
+  FXL_DCHECK(frac_src_frames >= FRAC_ONE);
+  // Sampling offset is int32, so even though frac_src_frames is a uint32,
+  // callers should not exceed int32_t::max().
+  FXL_DCHECK(frac_src_frames <=
+             static_cast<uint32_t>(std::numeric_limits<int32_t>::max()));
+
+  using DM = DestMixer<ScaleType, DoAccumulate>;
+  const SrcSampleType* src = static_cast<const SrcSampleType*>(src_void);
+  const int32_t src_frames = frac_src_frames >> kPtsFractionalBits;
+
+  uint32_t dest_off = *dest_offset;
+  uint32_t dest_off_start = dest_off;  // Only used when ramping.
+
+  int32_t src_off = *frac_src_offset;
+
+  // Cache these locally, in the template specialization that uses them.
+  // Only src_pos_modulo needs to be written back before returning.
+  uint32_t step_size = info->step_size;
+  uint32_t rate_modulo, denominator, src_pos_modulo;
+  if (HasModulo) {
+    rate_modulo = info->rate_modulo;
+    denominator = info->denominator;
+    src_pos_modulo = info->src_pos_modulo;
+
+    FXL_DCHECK(denominator > 0);
+    FXL_DCHECK(denominator > rate_modulo);
+    FXL_DCHECK(denominator > src_pos_modulo);
+  }
+  if (kVerboseRampDebug) {
+    FXL_LOG(INFO) << "Sinc(" << this
+                  << ") Ramping: " << (ScaleType == ScalerType::RAMPING)
+                  << ", dest_frames: " << dest_frames
+                  << ", dest_off: " << dest_off;
+  }
+  if (ScaleType == ScalerType::RAMPING) {
+    if (dest_frames > Bookkeeping::kScaleArrLen + dest_off) {
+      dest_frames = Bookkeeping::kScaleArrLen + dest_off;
+    }
+  }
+
+  // "Source end" is the last input sub-frame that can be sampled: the filter
+  // for any later position would need frames beyond the end of this buffer.
+  int32_t src_end =
+      static_cast<int32_t>(frac_src_frames - pos_filter_width() - 1);
+
+  FXL_DCHECK(dest_off < dest_frames);
+  // "Source offset" can be negative, but within the bounds of pos_filter_width.
+  // Otherwise, all these samples are in the future and irrelevant here. Callers
+  // explicitly avoid calling Mix in this case, so we have detected an error.
+  FXL_DCHECK(src_off + static_cast<int32_t>(pos_filter_width()) >= 0);
+  // Source offset must also be within neg_filter_width of our last sample.
+  // Otherwise, all these samples are in the past and irrelevant here. Callers
+  // explicitly avoid calling Mix in this case, so we have detected an error.
+  FXL_DCHECK(src_off + FRAC_ONE <= frac_src_frames + neg_filter_width());
+
+  Gain::AScale amplitude_scale;
+  if (ScaleType != ScalerType::RAMPING) {
+    amplitude_scale = info->gain.GetGainScale();
+  }
+
+  // Offset positions by the filter width before shifting, so that the shifted
+  // (whole-frame) value is never computed from a negative position.
+  constexpr int32_t kBiasFrames = kSincHalfWidth;
+  constexpr int32_t kFracBias = kBiasFrames << kPtsFractionalBits;
+
+  while ((dest_off < dest_frames) && (src_off <= src_end)) {
+    // Find the sampling positions for the next block of output frames.
+    uint32_t block_frames = 0;
+    while ((block_frames < kBlockFrames) &&
+           (dest_off + block_frames < dest_frames) && (src_off <= src_end)) {
+      positions_[block_frames++] = src_off;
+      src_off += step_size;
+
+      if (HasModulo) {
+        src_pos_modulo += rate_modulo;
+        if (src_pos_modulo >= denominator) {
+          ++src_off;
+          src_pos_modulo -= denominator;
+        }
+      }
+    }
+
+    // If we are not attenuated to the point of being muted, go ahead and
+    // perform the mix. Otherwise, the offsets advanced above are all we need.
+    if (ScaleType != ScalerType::MUTED) {
+      int32_t first =
+          ((positions_[0] + kFracBias) >> kPtsFractionalBits) - kBiasFrames -
+          (kSincHalfWidth - 1);
+      int32_t last =
+          ((positions_[block_frames - 1] + kFracBias) >> kPtsFractionalBits) -
+          kBiasFrames + kSincHalfWidth;
+      FillScratch(src, src_frames, first, last);
+      size_t plane_len = last - first + 1;
+
+      for (uint32_t idx = 0; idx < block_frames; ++idx) {
+        int32_t pos = positions_[idx];
+        uint32_t frac = static_cast<uint32_t>(pos + kFracBias) & FRAC_MASK;
+        int32_t start = ((pos + kFracBias) >> kPtsFractionalBits) -
+                        kBiasFrames - (kSincHalfWidth - 1) - first;
+
+        const float* row =
+            filter_table_ + ((frac >> kPhaseFracBits) * kNumTaps);
+        InterpolateTaps(taps_, row, row + kNumTaps,
+                        (frac & kPhaseFracMask) * kPhaseFracScale, kNumTaps);
+
+        if (ScaleType == ScalerType::RAMPING) {
+          amplitude_scale = info->scale_arr[dest_off + idx - dest_off_start];
+        }
+
+        float* out = dest + ((dest_off + idx) * dest_chan_count_);
+        for (uint32_t D = 0; D < dest_chan_count_; ++D) {
+          float sample = DotProduct(scratch_.data() + (D * plane_len) + start,
+                                    taps_, kNumTaps);
+          out[D] = DM::Mix(out[D], sample, amplitude_scale);
+        }
+      }
+    }
+
+    dest_off += block_frames;
+  }
+
+  // Update all our returned in-out parameters
+  *dest_offset = dest_off;
+  *frac_src_offset = src_off;
+  if (HasModulo) {
+    info->src_pos_modulo = src_pos_modulo;
+  }
+
+  // If next source position to consume is beyond the last one we can sample,
+  // the rest of this buffer is needed only as history for the next buffer.
+  if (src_off > src_end) {
+    UpdateHistory(src, src_frames, ScaleType == ScalerType::MUTED);
+    return true;
+  }
+
+  // We have not exhausted this source buffer -- return FALSE.
+  return false;
+}
+
+template <typename SrcSampleType>
+bool SincSamplerImpl<SrcSampleType>::Mix(
+    float* dest, uint32_t dest_frames, uint32_t* dest_offset, const void* src,
+    uint32_t frac_src_frames, int32_t* frac_src_offset, bool accumulate,
+    Bookkeeping* info) {
+  FXL_DCHECK(info != nullptr);
+
+  bool hasModulo = (info->denominator > 0 && info->rate_modulo > 0);
+
+  if (info->gain.IsUnity()) {
+    return accumulate
+               ? (hasModulo ? Mix<ScalerType::EQ_UNITY, true, true>(
+                                  dest, dest_frames, dest_offset, src,
+                                  frac_src_frames, frac_src_offset, info)
+                            : Mix<ScalerType::EQ_UNITY, true, false>(
+                                  dest, dest_frames, dest_offset, src,
+                                  frac_src_frames, frac_src_offset, info))
+               : (hasModulo ? Mix<ScalerType::EQ_UNITY, false, true>(
+                                  dest, dest_frames, dest_offset, src,
+                                  frac_src_frames, frac_src_offset, info)
+                            : Mix<ScalerType::EQ_UNITY, false, false>(
+                                  dest, dest_frames, dest_offset, src,
+                                  frac_src_frames, frac_src_offset, info));
+  } else if (info->gain.IsSilent()) {
+    return (hasModulo ? Mix<ScalerType::MUTED, true, true>(
+                            dest, dest_frames, dest_offset, src,
+                            frac_src_frames, frac_src_offset, info)
+                      : Mix<ScalerType::MUTED, true, false>(
+                            dest, dest_frames, dest_offset, src,
+                            frac_src_frames, frac_src_offset, info));
+  } else if (info->gain.IsRamping()) {
+    return accumulate
+               ? (hasModulo ? Mix<ScalerType::RAMPING, true, true>(
+                                  dest, dest_frames, dest_offset, src,
+                                  frac_src_frames, frac_src_offset, info)
+                            : Mix<ScalerType::RAMPING, true, false>(
+                                  dest, dest_frames, dest_offset, src,
+                                  frac_src_frames, frac_src_offset, info))
+               : (hasModulo ? Mix<ScalerType::RAMPING, false, true>(
+                                  dest, dest_frames, dest_offset, src,
+                                  frac_src_frames, frac_src_offset, info)
+                            : Mix<ScalerType::RAMPING, false, false>(
+                                  dest, dest_frames, dest_offset, src,
+                                  frac_src_frames, frac_src_offset, info));
+  } else {
+    return accumulate
+               ? (hasModulo ? Mix<ScalerType::NE_UNITY, true, true>(
+                                  dest, dest_frames, dest_offset, src,
+                                  frac_src_frames, frac_src_offset, info)
+                            : Mix<ScalerType::NE_UNITY, true, false>(
+                                  dest, dest_frames, dest_offset, src,
+                                  frac_src_frames, frac_src_offset, info))
+               : (hasModulo ? Mix<ScalerType::NE_UNITY, false, true>(
+                                  dest, dest_frames, dest_offset, src,
+                                  frac_src_frames, frac_src_offset, info)
+                            : Mix<ScalerType::NE_UNITY, false, false>(
+                                  dest, dest_frames, dest_offset, src,
+                                  frac_src_frames, frac_src_offset, info));
+  }
+}
+
+// Templates used to expand the different sample formats. Channel counts are
+// handled at runtime, since the per-frame filter cost dwarfs rechanneling.
+template <typename SrcSampleType>
+static inline MixerPtr SelectSSM(
+    const fuchsia::media::AudioStreamType& src_format,
+    const fuchsia::media::AudioStreamType& dest_format) {
+  return MixerPtr(new SincSamplerImpl<SrcSampleType>(
+      src_format.channels, dest_format.channels, src_format.frames_per_second,
+      dest_format.frames_per_second));
+}
+
+MixerPtr SincSampler::Select(
+    const fuchsia::media::AudioStreamType& src_format,
+    const fuchsia::media::AudioStreamType& dest_format) {
+  // Like the other resamplers, we support any N:N channelization, as well as
+  // mono-to-stereo and stereo-to-mono.
+  bool supported_chans =
+      (src_format.channels == dest_format.channels) ||
+      (src_format.channels == 1 && dest_format.channels == 2) ||
+      (src_format.channels == 2 && dest_format.channels == 1);
+  if (!supported_chans || src_format.channels == 0) {
+    return nullptr;
+  }
+
+  switch (src_format.sample_format) {
+    case fuchsia::media::AudioSampleFormat::UNSIGNED_8:
+      return SelectSSM<uint8_t>(src_format, dest_format);
+    case fuchsia::media::AudioSampleFormat::SIGNED_16:
+      return SelectSSM<int16_t>(src_format, dest_format);
+    case fuchsia::media::AudioSampleFormat::SIGNED_24_IN_32:
+      return SelectSSM<int32_t>(src_format, dest_format);
+    case fuchsia::media::AudioSampleFormat::FLOAT:
+      return SelectSSM<float>(src_format, dest_format);
+    default:
+      return nullptr;
+  }
+}
+
+}  // namespace mixer
+}  // namespace audio
+}  // namespace media
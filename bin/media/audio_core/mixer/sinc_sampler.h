@@ -0,0 +1,39 @@
+// Copyright 2018 The Fuchsia Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef GARNET_BIN_MEDIA_AUDIO_CORE_MIXER_SINC_SAMPLER_H_
+#define GARNET_BIN_MEDIA_AUDIO_CORE_MIXER_SINC_SAMPLER_H_
+
+#include <fuchsia/media/cpp/fidl.h>
+
+#include "garnet/bin/media/audio_core/mixer/mixer.h"
+
+namespace media {
+namespace audio {
+namespace mixer {
+
+// SincSampler is a polyphase windowed-sinc resampler. Each output frame is the
+// dot product of the surrounding kSincHalfWidth*2 source frames with a set of
+// filter taps chosen (and linearly interpolated) from a precomputed table of
+// filter phases. The lowpass cutoff tracks the src/dest rate ratio, so that
+// downsampling does not alias and upsampling does not image.
+class SincSampler : public Mixer {
+ public:
+  // Number of source frames the filter reaches on either side of the sampling
+  // position. Filter widths are just shy of this many whole frames.
+  static constexpr uint32_t kSincHalfWidth = 24;
+
+  static MixerPtr Select(const fuchsia::media::AudioStreamType& src_format,
+                         const fuchsia::media::AudioStreamType& dest_format);
+
+ protected:
+  SincSampler(uint32_t pos_filter_width, uint32_t neg_filter_width)
+      : Mixer(pos_filter_width, neg_filter_width) {}
+};
+
+}  // namespace mixer
+}  // namespace audio
+}  // namespace media
+
+#endif  // GARNET_BIN_MEDIA_AUDIO_CORE_MIXER_SINC_SAMPLER_H_
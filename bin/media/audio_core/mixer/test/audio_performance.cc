@@ -2,11 +2,17 @@
 // Use of this source code is governed by a BSD-style license that can be
 // found in the LICENSE file.
 
+#include <rapidjson/document.h>
+#include <rapidjson/stringbuffer.h>
+#include <rapidjson/writer.h>
 #include <string>
 
 #include "garnet/bin/media/audio_core/mixer/test/audio_performance.h"
+
+#include "garnet/bin/media/audio_core/mixer/mixer_simd.h"
 #include "garnet/bin/media/audio_core/mixer/test/frequency_set.h"
 #include "garnet/bin/media/audio_core/mixer/test/mixer_tests_shared.h"
+#include "lib/fxl/files/file.h"
 
 namespace media {
 namespace audio {
@@ -15,12 +21,90 @@ namespace test {
 // Convenience abbreviation within this source file to shorten names
 using Resampler = ::media::audio::Mixer::Resampler;
 
+constexpr char AudioPerformance::kTestSuite[];
+std::vector<AudioPerformance::Result> AudioPerformance::results_;
+
 // For the given resampler, measure elapsed time over a number of mix jobs.
 void AudioPerformance::Profile() {
   printf("\n\n Performance Profiling");
+  printf("\n   Vectorized unity-rate mix kernels are %s\n",
+         mixer::simd::kEnabled ? "enabled" : "not available (scalar only)");
+
+  results_.clear();
 
   AudioPerformance::ProfileMixers();
   AudioPerformance::ProfileOutputProducers();
+  AudioPerformance::ProfileGains();
+}
+
+// Results use the schema that catapult_converter expects: an array of
+// {label, test_suite, unit, split_first, values}. Our first run of each
+// configuration is "cold" and typically an outlier, so we set split_first.
+bool AudioPerformance::ExportResults(const std::string& json_path) {
+  rapidjson::StringBuffer string_buffer;
+  rapidjson::Writer<rapidjson::StringBuffer> writer(string_buffer);
+
+  writer.StartArray();
+  for (const auto& result : results_) {
+    writer.StartObject();
+    writer.Key("label");
+    writer.String(result.label.c_str());
+    writer.Key("test_suite");
+    writer.String(kTestSuite);
+    writer.Key("unit");
+    writer.String("nanoseconds");
+    writer.Key("split_first");
+    writer.Bool(true);
+    writer.Key("values");
+    writer.StartArray();
+    for (double value : result.values) {
+      writer.Double(value);
+    }
+    writer.EndArray();
+    writer.EndObject();
+  }
+  writer.EndArray();
+
+  std::string encoded = string_buffer.GetString();
+  if (!files::WriteFile(json_path, encoded.data(), encoded.size())) {
+    printf("   Could not write profile results to %s\n", json_path.c_str());
+    return false;
+  }
+
+  printf("   Wrote %zu profile results to %s\n", results_.size(),
+         json_path.c_str());
+  return true;
+}
+
+// Mean, first, best and worst are displayed per call (64k frames), in microsec,
+// as they always have been. Exported values are per frame, in nanosec, so that
+// they remain comparable if kFreqTestBufSize changes.
+void AudioPerformance::ReportResult(const std::string& config,
+                                    const std::vector<zx_duration_t>& elapsed,
+                                    uint32_t num_frames) {
+  FXL_DCHECK(!elapsed.empty());
+
+  zx_duration_t first = elapsed[0];
+  zx_duration_t worst = first;
+  zx_duration_t best = first;
+  zx_duration_t total_elapsed = 0;
+
+  Result result;
+  result.label = config;
+  result.values.reserve(elapsed.size());
+
+  for (auto run_elapsed : elapsed) {
+    worst = std::max(worst, run_elapsed);
+    best = std::min(best, run_elapsed);
+    total_elapsed += run_elapsed;
+    result.values.push_back(static_cast<double>(run_elapsed) / num_frames);
+  }
+
+  double mean = static_cast<double>(total_elapsed) / elapsed.size();
+  printf("%s:\t%9.3lf\t%9.3lf\t%9.3lf\t%9.3lf\n", config.c_str(),
+         mean / 1000.0, first / 1000.0, best / 1000.0, worst / 1000.0);
+
+  results_.push_back(std::move(result));
 }
 
 void AudioPerformance::ProfileMixers() {
@@ -31,6 +115,7 @@ void AudioPerformance::ProfileMixers() {
 
   ProfileSampler(Resampler::SampleAndHold);
   ProfileSampler(Resampler::LinearInterpolation);
+  ProfileSampler(Resampler::WindowedSinc);
 
   DisplayMixerColumnHeader();
   DisplayMixerConfigLegend();
@@ -48,7 +133,7 @@ void AudioPerformance::DisplayMixerConfigLegend() {
          kFreqTestBufSize);
   printf(
       "\n   For mixer configuration R-fff.IOGAnnnnn, where:\n"
-      "\t     R: Resampler type - [P]oint, [L]inear\n"
+      "\t     R: Resampler type - [P]oint, [L]inear, [S]inc\n"
       "\t   fff: Format - un8, i16, i24, f32,\n"
       "\t     I: Input channels (one-digit number),\n"
       "\t     O: Output channels (one-digit number),\n"
@@ -78,7 +163,8 @@ void AudioPerformance::ProfileSamplerIn(uint32_t num_input_chans,
   }
 }
 
-// Profile the samplers in scenarios with, and without, frame rate conversion
+// Profile the samplers in scenarios with, and without, frame rate conversion --
+// both with a fractional step (44.1k) and an integral one (96k).
 void AudioPerformance::ProfileSamplerChans(uint32_t num_input_chans,
                                            uint32_t num_output_chans,
                                            Resampler sampler_type) {
@@ -86,6 +172,8 @@ void AudioPerformance::ProfileSamplerChans(uint32_t num_input_chans,
                           48000);
   ProfileSamplerChansRate(num_input_chans, num_output_chans, sampler_type,
                           44100);
+  ProfileSamplerChansRate(num_input_chans, num_output_chans, sampler_type,
+                          96000);
 }
 
 // Profile the samplers with gains of: Mute, Unity, Scaling (non-mute non-unity)
@@ -167,8 +255,14 @@ void AudioPerformance::ProfileMixer(uint32_t num_input_chans,
   MixerPtr mixer = SelectMixer(sample_format, num_input_chans, source_rate,
                                num_output_chans, dest_rate, sampler_type);
 
-  uint32_t source_buffer_size = kFreqTestBufSize * dest_rate / source_rate;
-  uint32_t source_frames = source_buffer_size + 1;
+  // Enough source to produce every destination frame, at this rate ratio.
+  uint32_t source_buffer_size = static_cast<uint32_t>(
+      (static_cast<uint64_t>(kFreqTestBufSize) * source_rate + dest_rate - 1) /
+      dest_rate);
+  // Resamplers with wide filters need source beyond the last sampled position,
+  // before they will produce the final destination frames.
+  uint32_t source_frames = source_buffer_size + 1 +
+                           (mixer->pos_filter_width() >> kPtsFractionalBits);
 
   std::unique_ptr<SampleType[]> source =
       std::make_unique<SampleType[]>(source_frames * num_input_chans);
@@ -182,7 +276,7 @@ void AudioPerformance::ProfileMixer(uint32_t num_input_chans,
                   FrequencySet::kReferenceFreqs[FrequencySet::kRefFreqIdx],
                   amplitude);
 
-  zx_duration_t first, worst, best, total_elapsed = 0;
+  std::vector<zx_duration_t> elapsed(kNumMixerProfilerRuns);
 
   Bookkeeping info;
   info.step_size = (source_rate * Mixer::FRAC_ONE) / dest_rate;
@@ -220,7 +314,6 @@ void AudioPerformance::ProfileMixer(uint32_t num_input_chans,
       info.gain.SetSourceGainWithRamp(-121.0f, ZX_SEC(2));
     }
 
-    zx_duration_t elapsed;
     zx_time_t start_time = zx_clock_get(ZX_CLOCK_MONOTONIC);
 
     dest_offset = 0;
@@ -237,27 +330,21 @@ void AudioPerformance::ProfileMixer(uint32_t num_input_chans,
                         TimelineRate(source_rate, ZX_SEC(1)));
     }
 
-    elapsed = zx_clock_get(ZX_CLOCK_MONOTONIC) - start_time;
-
-    if (i > 0) {
-      worst = std::max(worst, elapsed);
-      best = std::min(best, elapsed);
-    } else {
-      first = elapsed;
-      worst = elapsed;
-      best = elapsed;
-    }
-    total_elapsed += elapsed;
+    elapsed[i] = zx_clock_get(ZX_CLOCK_MONOTONIC) - start_time;
   }
 
-  double mean = total_elapsed / kNumMixerProfilerRuns;
-  printf("%c-%s.%u%u%c%c%u:",
-         (sampler_type == Resampler::SampleAndHold ? 'P' : 'L'), format.c_str(),
-         num_input_chans, num_output_chans, gain_char, (accumulate ? '+' : '-'),
-         source_rate);
+  char sampler_char = 'S';
+  if (sampler_type == Resampler::SampleAndHold) {
+    sampler_char = 'P';
+  } else if (sampler_type == Resampler::LinearInterpolation) {
+    sampler_char = 'L';
+  }
+  char config[32];
+  snprintf(config, sizeof(config), "%c-%s.%u%u%c%c%u", sampler_char,
+           format.c_str(), num_input_chans, num_output_chans, gain_char,
+           (accumulate ? '+' : '-'), source_rate);
 
-  printf("\t%9.3lf\t%9.3lf\t%9.3lf\t%9.3lf\n", mean / 1000.0, first / 1000.0,
-         best / 1000.0, worst / 1000.0);
+  ReportResult(config, elapsed, kFreqTestBufSize);
 }
 
 void AudioPerformance::DisplayOutputColumnHeader() {
@@ -360,50 +447,101 @@ void AudioPerformance::ProfileOutputType(uint32_t num_chans,
       return;
   }
 
-  zx_duration_t first, worst, best, total_elapsed = 0;
+  std::vector<zx_duration_t> elapsed(kNumOutputProfilerRuns);
 
   if (data_range == OutputDataRange::Silence) {
     for (uint32_t i = 0; i < kNumOutputProfilerRuns; ++i) {
-      zx_duration_t elapsed;
       zx_time_t start_time = zx_clock_get(ZX_CLOCK_MONOTONIC);
 
       output_producer->FillWithSilence(dest.get(), kFreqTestBufSize);
-      elapsed = zx_clock_get(ZX_CLOCK_MONOTONIC) - start_time;
-
-      if (i > 0) {
-        worst = std::max(worst, elapsed);
-        best = std::min(best, elapsed);
-      } else {
-        first = elapsed;
-        worst = elapsed;
-        best = elapsed;
-      }
-      total_elapsed += elapsed;
+      elapsed[i] = zx_clock_get(ZX_CLOCK_MONOTONIC) - start_time;
     }
   } else {
     for (uint32_t i = 0; i < kNumOutputProfilerRuns; ++i) {
-      zx_duration_t elapsed;
       zx_time_t start_time = zx_clock_get(ZX_CLOCK_MONOTONIC);
 
       output_producer->ProduceOutput(accum.get(), dest.get(), kFreqTestBufSize);
-      elapsed = zx_clock_get(ZX_CLOCK_MONOTONIC) - start_time;
-
-      if (i > 0) {
-        worst = std::max(worst, elapsed);
-        best = std::min(best, elapsed);
-      } else {
-        first = elapsed;
-        worst = elapsed;
-        best = elapsed;
-      }
-      total_elapsed += elapsed;
+      elapsed[i] = zx_clock_get(ZX_CLOCK_MONOTONIC) - start_time;
     }
   }
 
-  double mean = total_elapsed / kNumOutputProfilerRuns;
-  printf("%s-%c%u:\t%9.3lf\t%9.3lf\t%9.3lf\t%9.3lf\n", format.c_str(), range,
-         num_chans, mean / 1000.0, first / 1000.0, best / 1000.0,
-         worst / 1000.0);
+  char config[16];
+  snprintf(config, sizeof(config), "%s-%c%u", format.c_str(), range,
+           num_chans);
+
+  ReportResult(config, elapsed, kFreqTestBufSize);
+}
+
+void AudioPerformance::DisplayGainColumnHeader() {
+  printf("Config\t    Mean\t   First\t    Best\t   Worst\n");
+}
+
+void AudioPerformance::DisplayGainConfigLegend() {
+  printf("\n   Elapsed time in microsec to GetScaleArray() for %u frames\n",
+         kFreqTestBufSize);
+  printf(
+      "\n   For gain configuration Gain-R, where:\n"
+      "\t     R: Ramp state - [S]tatic, [R]amping throughout, ramp [E]nding\n"
+      "\n");
+}
+
+void AudioPerformance::ProfileGains() {
+  zx_time_t start_time = zx_clock_get(ZX_CLOCK_MONOTONIC);
+
+  DisplayGainConfigLegend();
+  DisplayGainColumnHeader();
+
+  ProfileGain(GainRampType::Static);
+  ProfileGain(GainRampType::Ramping);
+  ProfileGain(GainRampType::Ending);
+
+  DisplayGainColumnHeader();
+  DisplayGainConfigLegend();
+
+  printf("   Total time to profile Gains: %lu ms\n   --------\n\n",
+         (zx_clock_get(ZX_CLOCK_MONOTONIC) - start_time) / 1000000);
+}
+
+// Profile the computation of per-frame gain scales that a Mix() job performs
+// before mixing, when its source gain is stable, ramping, or finishing a ramp.
+void AudioPerformance::ProfileGain(GainRampType ramp_type) {
+  constexpr uint32_t kDestRate = 48000;
+  const TimelineRate rate(kDestRate, ZX_SEC(1));
+
+  // A ramp that ends mid-buffer (Ending) is half as long as the buffer.
+  zx_duration_t ramp_duration =
+      (ramp_type == GainRampType::Ending
+           ? ZX_SEC(1) * kFreqTestBufSize / kDestRate / 2
+           : ZX_SEC(2));
+  char ramp_char = 'S';
+  if (ramp_type == GainRampType::Ramping) {
+    ramp_char = 'R';
+  } else if (ramp_type == GainRampType::Ending) {
+    ramp_char = 'E';
+  }
+
+  std::unique_ptr<Gain::AScale[]> scale_arr =
+      std::make_unique<Gain::AScale[]>(kFreqTestBufSize);
+  std::vector<zx_duration_t> elapsed(kNumGainProfilerRuns);
+
+  Gain gain;
+  gain.SetDestGain(Gain::kUnityGainDb);
+  for (uint32_t i = 0; i < kNumGainProfilerRuns; ++i) {
+    gain.SetSourceGain(-1.0f);
+    if (ramp_type != GainRampType::Static) {
+      gain.SetSourceGainWithRamp(-121.0f, ramp_duration);
+    }
+
+    zx_time_t start_time = zx_clock_get(ZX_CLOCK_MONOTONIC);
+
+    gain.GetScaleArray(scale_arr.get(), kFreqTestBufSize, rate);
+    elapsed[i] = zx_clock_get(ZX_CLOCK_MONOTONIC) - start_time;
+  }
+
+  char config[16];
+  snprintf(config, sizeof(config), "Gain-%c", ramp_char);
+
+  ReportResult(config, elapsed, kFreqTestBufSize);
 }
 
 }  // namespace test
@@ -5,6 +5,10 @@
 #ifndef GARNET_BIN_MEDIA_AUDIO_CORE_MIXER_TEST_AUDIO_PERFORMANCE_H_
 #define GARNET_BIN_MEDIA_AUDIO_CORE_MIXER_TEST_AUDIO_PERFORMANCE_H_
 
+#include <zircon/types.h>
+#include <string>
+#include <vector>
+
 #include "garnet/bin/media/audio_core/mixer/test/frequency_set.h"
 #include "garnet/bin/media/audio_core/mixer/test/mixer_tests_shared.h"
 
@@ -13,6 +17,7 @@ namespace audio {
 namespace test {
 
 enum GainType : uint32_t { Mute, Unity, Scaled, Ramped };
+enum GainRampType : uint32_t { Static, Ramping, Ending };
 enum OutputDataRange : uint32_t { Silence, OutOfRange, Normal };
 
 class AudioPerformance {
@@ -21,9 +26,14 @@ class AudioPerformance {
   // we can get a high-confidence profile assessment with fewer runs.
   //
   // These values were chosen to keep Mixer and OutputProducer profile times
-  // under 180 seconds each, on both a standard VIM2 and a standard NUC.
-  static constexpr uint32_t kNumMixerProfilerRuns = 140;
+  // under 180 seconds each, on both a standard VIM2 and a standard NUC. Mixer
+  // runs were reduced from 140 when a third source rate was added.
+  static constexpr uint32_t kNumMixerProfilerRuns = 100;
   static constexpr uint32_t kNumOutputProfilerRuns = 1200;
+  static constexpr uint32_t kNumGainProfilerRuns = 400;
+
+  // Results are labelled by configuration, and exported under this test_suite.
+  static constexpr char kTestSuite[] = "fuchsia.audio.mixer";
 
   // class is static only - prevent attempts to instantiate it
   AudioPerformance() = delete;
@@ -34,7 +44,24 @@ class AudioPerformance {
   // easily-imported format. Use the --profile flag to trigger this.
   static void Profile();
 
+  // Write the results of the preceding Profile() to the file at json_path, in
+  // the JSON format consumed by catapult_converter. Each configuration becomes
+  // one entry, whose values are the nanoseconds per frame of each profiler run.
+  // Use the --profile-json=<path> flag to trigger this.
+  static bool ExportResults(const std::string& json_path);
+
  private:
+  struct Result {
+    std::string label;
+    std::vector<double> values;
+  };
+
+  // Display a configuration's per-call timings (in microsec), and retain its
+  // per-frame timings (in nanosec) for ExportResults.
+  static void ReportResult(const std::string& config,
+                           const std::vector<zx_duration_t>& elapsed,
+                           uint32_t num_frames);
+
   static void ProfileMixers();
 
   static void DisplayMixerColumnHeader();
@@ -74,6 +101,15 @@ class AudioPerformance {
                                  OutputDataRange data_range);
   template <typename SampleType>
   static void ProfileOutputType(uint32_t num_chans, OutputDataRange data_range);
+
+  static void ProfileGains();
+
+  static void DisplayGainColumnHeader();
+  static void DisplayGainConfigLegend();
+
+  static void ProfileGain(GainRampType ramp_type);
+
+  static std::vector<Result> results_;
 };
 
 }  // namespace test
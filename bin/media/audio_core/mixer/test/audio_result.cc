@@ -71,6 +71,9 @@ constexpr double AudioResult::kPrevFloorStereoMono;
 double AudioResult::LevelToleranceInterpolation = 0.0;
 constexpr double AudioResult::kPrevLevelToleranceInterpolation;
 
+double AudioResult::LevelToleranceSinc = 0.0;
+constexpr double AudioResult::kPrevLevelToleranceSinc;
+
 std::array<double, FrequencySet::kNumReferenceFreqs>
     AudioResult::FreqRespPointUnity = {NAN};
 std::array<double, FrequencySet::kNumReferenceFreqs>
@@ -97,6 +100,19 @@ std::array<double, FrequencySet::kNumReferenceFreqs>
 std::array<double, FrequencySet::kNumReferenceFreqs>
     AudioResult::FreqRespLinearMicro = {NAN};
 
+std::array<double, FrequencySet::kNumReferenceFreqs>
+    AudioResult::FreqRespSincUnity = {NAN};
+std::array<double, FrequencySet::kNumReferenceFreqs>
+    AudioResult::FreqRespSincDown1 = {NAN};
+std::array<double, FrequencySet::kNumReferenceFreqs>
+    AudioResult::FreqRespSincDown2 = {NAN};
+std::array<double, FrequencySet::kNumReferenceFreqs>
+    AudioResult::FreqRespSincUp1 = {NAN};
+std::array<double, FrequencySet::kNumReferenceFreqs>
+    AudioResult::FreqRespSincUp2 = {NAN};
+std::array<double, FrequencySet::kNumReferenceFreqs>
+    AudioResult::FreqRespSincMicro = {NAN};
+
 std::array<double, FrequencySet::kNumReferenceFreqs>
     AudioResult::FreqRespPointNxN = {NAN};
 std::array<double, FrequencySet::kNumReferenceFreqs>
@@ -246,6 +262,72 @@ const std::array<double, FrequencySet::kNumReferenceFreqs>
         -1.2580628e+00, -1.8235695e+00, -3.2986619e+00, -5.0020980e+00, -5.2801039e+00, -5.5663757e+00,
         -5.8628714e+00, -6.5135504e+00, -7.4187285e+00, -INFINITY,      -INFINITY,      -INFINITY,
         -INFINITY,      -INFINITY,      -INFINITY,      -INFINITY,      -INFINITY        };
+
+const std::array<double, FrequencySet::kNumReferenceFreqs>
+    AudioResult::kPrevFreqRespSincUnity = {
+        -1.0000000e-06, -1.3860563e-06, -1.4324519e-06, -1.4778660e-06, -1.5725204e-06, -1.6891077e-06,
+        -1.9374444e-06, -2.3066901e-06, -2.9035648e-06, -3.9249857e-06, -5.4250938e-06, -7.5387717e-06,
+        -1.1861463e-05, -1.7008627e-05, -2.5699895e-05, -3.9108657e-05, -5.8146637e-05, -8.5172542e-05,
+        -1.1860498e-04, -1.5430403e-04, -1.7244041e-04, -1.5089171e-04, -6.5625830e-05, -5.2431504e-07,
+        -7.8227037e-05, -1.6956320e-04,  2.0054623e-06, -1.7761612e-04, -1.3657704e-05,  1.4725679e-05,
+         2.8220753e-05,  5.1623599e-05,  1.6286546e-04, -2.8828923e-02, -1.9172827e-01, -6.9866979e-01,
+        -1.8391718e+00, -7.6483884e+00, -2.6607611e+01, -3.6810598e+01, -INFINITY,      -INFINITY,
+        -INFINITY,      -INFINITY,      -INFINITY,      -INFINITY,      -INFINITY  };
+
+const std::array<double, FrequencySet::kNumReferenceFreqs>
+    AudioResult::kPrevFreqRespSincDown1 = {
+        -2.0364742e-06, -1.1307008e-06, -1.1301775e-06, -1.1195188e-06, -1.1094694e-06, -1.0987602e-06,
+        -1.0765385e-06, -1.0356384e-06, -9.7454371e-07, -8.7141421e-07, -7.1528988e-07, -4.9304122e-07,
+        -4.0534716e-08,  5.1267771e-07,  1.4709748e-06,  3.0080069e-06,  5.3458930e-06,  9.0706792e-06,
+         1.4705725e-05,  2.3598383e-05,  3.5620616e-05,  5.1845183e-05,  7.3635226e-05,  9.0655141e-05,
+         9.1036595e-05,  5.3073055e-05, -1.4722923e-05,  8.8232063e-06,  1.3336623e-04, -6.4713143e-05,
+         1.9512904e-04, -1.5425990e-04,  6.5528318e-05, -9.9879111e-01, -1.5999582e+00, -2.4220992e+00,
+        -3.5090546e+00, -6.8037123e+00, -1.3642032e+01, -1.7863870e+01, -2.7066183e+01, -9.8474568e+01,
+        -1.0120322e+02, -9.9636761e+01, -9.9364044e+01, -1.0259665e+02, -9.9294034e+01  };
+
+const std::array<double, FrequencySet::kNumReferenceFreqs>
+    AudioResult::kPrevFreqRespSincDown2 = {
+        -1.0558598e-06, -9.8014531e-07, -9.7518211e-07, -9.6692842e-07, -9.6953142e-07, -9.6014285e-07,
+        -9.4259197e-07, -9.1702121e-07, -8.6717763e-07, -7.9933011e-07, -6.8932235e-07, -5.5031935e-07,
+        -2.3019152e-07,  1.3311425e-07,  7.6864019e-07,  1.7748092e-06,  3.2678549e-06,  5.5589802e-06,
+         8.8083703e-06,  1.3376157e-05,  1.8405252e-05,  2.2868664e-05,  2.3306199e-05,  1.4788350e-05,
+        -2.1420268e-06, -9.4260756e-06,  2.3177141e-05,  2.9175070e-05, -3.3402086e-05,  6.2870568e-05,
+        -4.0915705e-05, -2.9598849e-05,  8.6436142e-05, -8.0656918e-01, -1.3821753e+00, -2.2049573e+00,
+        -3.3301502e+00, -6.8761126e+00, -1.4540127e+01, -1.9394374e+01, -3.0252978e+01, -1.0117293e+02,
+        -1.1530983e+02, -1.1046122e+02, -1.0876430e+02, -INFINITY,      -INFINITY  };
+
+const std::array<double, FrequencySet::kNumReferenceFreqs>
+    AudioResult::kPrevFreqRespSincUp1 = {
+        -1.0383996e-06, -9.5175233e-07, -9.2674784e-07, -9.0512384e-07, -8.5872282e-07, -7.9770049e-07,
+        -6.8205063e-07, -4.9423515e-07, -1.9829004e-07,  3.1578470e-07,  1.0532176e-06,  2.1040828e-06,
+         4.2328522e-06,  6.7544541e-06,  1.0973924e-05,  1.7373201e-05,  2.6204190e-05,  3.8138895e-05,
+         5.1521813e-05,  6.2532349e-05,  6.1372061e-05,  4.0342815e-05,  3.9048301e-06,  7.9505603e-06,
+         5.8743834e-05,  2.2740454e-05,  3.0576720e-05,  8.6378026e-06,  5.8317634e-05,  6.0217994e-05,
+         3.1532729e-05, -3.9354354e-05,  6.9979312e-05, -2.6324884e+00, -5.5334488e+00, -1.0119766e+01,
+        -1.6920936e+01, -4.2774866e+01, -INFINITY,      -INFINITY,      -INFINITY,      -INFINITY,
+        -INFINITY,      -INFINITY,      -INFINITY,      -INFINITY,      -INFINITY  };
+
+const std::array<double, FrequencySet::kNumReferenceFreqs>
+    AudioResult::kPrevFreqRespSincUp2 = {
+        -1.0000000e-06, -1.1028573e-06, -1.1113475e-06, -1.1225009e-06, -1.1493967e-06, -1.1720465e-06,
+        -1.2331138e-06, -1.3271024e-06, -1.4703258e-06, -1.7214545e-06, -2.0853065e-06, -2.5955267e-06,
+        -3.6289840e-06, -4.8298344e-06, -6.7956161e-06, -9.6280267e-06, -1.3152179e-05, -1.6821197e-05,
+        -1.8209045e-05, -1.2784296e-05, -6.5104756e-07,  1.8105868e-06, -2.4182422e-05,  9.0201218e-07,
+        -2.0064251e-05,  2.2236054e-05,  1.0136291e-05,  2.1162796e-05,  3.4020928e-05,  1.5203529e-04,
+        -1.8952886e-01, -4.2686938e+01, -INFINITY,      -INFINITY,      -INFINITY,      -INFINITY,
+        -INFINITY,      -INFINITY,      -INFINITY,      -INFINITY,      -INFINITY,      -INFINITY,
+        -INFINITY,      -INFINITY,      -INFINITY,      -INFINITY,      -INFINITY  };
+
+const std::array<double, FrequencySet::kNumReferenceFreqs>
+    AudioResult::kPrevFreqRespSincMicro = {
+        -1.0383996e-06, -9.8230494e-07, -9.6125017e-07, -9.4695182e-07, -8.8004467e-07, -8.3716205e-07,
+        -7.2648660e-07, -5.8025750e-07, -2.9407247e-07,  1.0606323e-07,  7.3020556e-07,  1.6161208e-06,
+         3.4513759e-06,  5.5880689e-06,  9.2141097e-06,  1.4767417e-05,  2.2579471e-05,  3.3490251e-05,
+         4.6573934e-05,  5.9485642e-05,  6.3788919e-05,  5.0866882e-05,  1.5186986e-05, -1.3005351e-06,
+         4.0309219e-05,  5.1832468e-05, -2.0035193e-06,  5.5993320e-05,  3.0266791e-05, -2.2509744e-06,
+         1.5723107e-06,  1.3512594e-05,  1.0273845e-04, -2.8935296e-02, -1.9191451e-01, -6.9898400e-01,
+        -1.8401693e+00, -7.6509235e+00, -2.6649031e+01, -INFINITY,      -INFINITY,      -INFINITY,
+        -INFINITY,      -INFINITY,      -INFINITY,      -INFINITY,      -INFINITY  };
 // clang-format on
 
 std::array<double, FrequencySet::kNumReferenceFreqs>
@@ -274,6 +356,19 @@ std::array<double, FrequencySet::kNumReferenceFreqs>
 std::array<double, FrequencySet::kNumReferenceFreqs>
     AudioResult::SinadLinearMicro = {NAN};
 
+std::array<double, FrequencySet::kNumReferenceFreqs>
+    AudioResult::SinadSincUnity = {NAN};
+std::array<double, FrequencySet::kNumReferenceFreqs>
+    AudioResult::SinadSincDown1 = {NAN};
+std::array<double, FrequencySet::kNumReferenceFreqs>
+    AudioResult::SinadSincDown2 = {NAN};
+std::array<double, FrequencySet::kNumReferenceFreqs>
+    AudioResult::SinadSincUp1 = {NAN};
+std::array<double, FrequencySet::kNumReferenceFreqs>
+    AudioResult::SinadSincUp2 = {NAN};
+std::array<double, FrequencySet::kNumReferenceFreqs>
+    AudioResult::SinadSincMicro = {NAN};
+
 std::array<double, FrequencySet::kNumReferenceFreqs>
     AudioResult::SinadPointNxN = {-INFINITY};
 std::array<double, FrequencySet::kNumReferenceFreqs>
@@ -423,6 +518,72 @@ const std::array<double, FrequencySet::kNumReferenceFreqs>
          22.207908,   18.336999,   11.618540,     6.3382417,   5.6081329,   4.8842446,
           4.1617533,   2.6594494,   0.72947217,  -INFINITY,   -INFINITY,   -INFINITY,
          -INFINITY,   -INFINITY,   -INFINITY,    -INFINITY,   -INFINITY,    };
+
+const std::array<double, FrequencySet::kNumReferenceFreqs>
+    AudioResult::kPrevSinadSincUnity = {
+        160.0,        142.9128,   142.8959,   142.9004,   142.9544,   142.9268,
+          142.8988,   142.9667,   142.9863,   142.9903,   142.9215,   142.9387,
+          142.9058,   142.9291,   142.9485,   142.9799,   142.9630,   142.9146,
+          142.9862,   142.8905,   142.9309,   142.9439,   142.9962,   142.9867,
+          143.1672,   143.2533,   143.2458,   142.9618,   142.9919,   143.2190,
+          143.0482,   142.8573,   143.2003,   143.1611,   142.9701,   142.5358,
+          141.4356,   135.7995,   116.9412, 160.0,      -INFINITY,  -INFINITY,
+        -INFINITY,  -INFINITY,  -INFINITY,  -INFINITY,  -INFINITY  };
+
+const std::array<double, FrequencySet::kNumReferenceFreqs>
+    AudioResult::kPrevSinadSincDown1 = {
+        160.0,        145.5500,   145.5904,   145.6337,   145.5440,   145.6295,
+          145.5962,   145.6169,   145.6418,   145.7311,   145.6388,   145.6250,
+          145.5640,   145.5422,   145.6471,   145.6296,   145.5660,   145.4305,
+          145.4030,   145.3829,   145.2784,   145.1656,   145.0762,   144.9667,
+          144.7915,   144.6505,   144.4964,   144.4033,   144.2180,   144.2443,
+          144.1936,   144.1672,   144.2106,   143.4890,   143.0324,   142.3305,
+          141.5317,   139.1758,   133.1941, 160.0,         -0.5000,    -0.5001,
+           -0.5002,    -0.5001,    -0.5001,    -0.5002,    -0.5001  };
+
+const std::array<double, FrequencySet::kNumReferenceFreqs>
+    AudioResult::kPrevSinadSincDown2 = {
+          144.5793,   141.7597,   140.6034,   139.7291,   138.3180,   137.0178,
+          135.1123,   133.2568,   131.3258,   129.2510,   127.3060,   125.5167,
+          123.2193,   121.4639,   119.4875,   117.4824,   115.5451,   113.5804,
+          111.6788,   109.7497,   108.0323,   106.4325,   104.8542,   103.6930,
+          102.7551,   101.6416,    99.6877,    97.4708,    95.6378,    93.6763,
+           91.7250,    90.1626,    87.6687,    85.9613,    85.7259,    85.5097,
+           85.3174,    84.8937,    84.1926,    89.3931,    -0.5000,    -0.8907,
+           -8.8122,    -5.3398,    -3.6698, -INFINITY,  -INFINITY  };
+
+const std::array<double, FrequencySet::kNumReferenceFreqs>
+    AudioResult::kPrevSinadSincUp1 = {
+          140.1484,   136.2231,   134.5850,   133.4152,   131.6544,   130.1600,
+          128.0380,   126.0542,   124.0198,   121.8613,   119.8500,   117.9832,
+          115.5552,   113.6737,   111.4965,   109.2282,   107.0012,   104.7624,
+          102.7580,   101.1683,   100.5422,   100.9989,   101.2374,    99.4352,
+           96.5493,    95.1845,    93.4006,    91.4282,    89.3072,    87.3517,
+           85.4236,    83.8865,    81.4490,    79.5109,    79.1804,    79.2140,
+           76.7939,    -0.3635, -INFINITY,  -INFINITY,  -INFINITY,  -INFINITY,
+        -INFINITY,  -INFINITY,  -INFINITY,  -INFINITY,  -INFINITY  };
+
+const std::array<double, FrequencySet::kNumReferenceFreqs>
+    AudioResult::kPrevSinadSincUp2 = {
+        160.0,        140.2744,   139.0737,   137.9414,   135.8077,   133.5169,
+          129.9278,   126.3207,   122.4824,   118.3878,   114.6064,   111.1615,
+          106.8548,   103.7191,   100.4230,    97.4948,    95.3587,    94.4423,
+           95.9587,   103.7932,   142.3205,   100.3693,    95.3560,   136.7538,
+           94.3382,   107.2054,   124.8298,   120.9436,    95.9933,   117.6038,
+          101.5584,    -0.1991, -INFINITY,  -INFINITY,  -INFINITY,  -INFINITY,
+        -INFINITY,  -INFINITY,  -INFINITY,  -INFINITY,  -INFINITY,  -INFINITY,
+        -INFINITY,  -INFINITY,  -INFINITY,  -INFINITY,  -INFINITY  };
+
+const std::array<double, FrequencySet::kNumReferenceFreqs>
+    AudioResult::kPrevSinadSincMicro = {
+          140.1484,   136.7158,   135.0179,   134.0117,   132.2283,   130.7227,
+          128.6721,   126.7242,   124.7390,   122.6118,   120.6047,   118.7342,
+          116.3284,   114.4592,   112.3036,   110.0553,   107.8325,   105.5631,
+          103.4624,   101.6484,   100.6574,   100.7162,   101.4210,   100.2673,
+           97.6988,    95.3730,    94.2413,    91.8476,    90.2579,    88.2198,
+           86.2805,    84.6956,    82.1971,    80.4218,    80.2352,    79.8923,
+           79.6933,    78.1637,    47.5075, -INFINITY,  -INFINITY,  -INFINITY,
+        -INFINITY,  -INFINITY,  -INFINITY,  -INFINITY,  -INFINITY  };
 // clang-format on
 
 //
@@ -544,6 +705,13 @@ void AudioResult::DumpThresholdValues() {
   DumpFreqRespValues(AudioResult::FreqRespLinearUp2.data(), "FR-LinearUp2");
   DumpFreqRespValues(AudioResult::FreqRespLinearMicro.data(), "FR-LinearMicro");
 
+  DumpFreqRespValues(AudioResult::FreqRespSincUnity.data(), "FR-SincUnity");
+  DumpFreqRespValues(AudioResult::FreqRespSincDown1.data(), "FR-SincDown1");
+  DumpFreqRespValues(AudioResult::FreqRespSincDown2.data(), "FR-SincDown2");
+  DumpFreqRespValues(AudioResult::FreqRespSincUp1.data(), "FR-SincUp1");
+  DumpFreqRespValues(AudioResult::FreqRespSincUp2.data(), "FR-SincUp2");
+  DumpFreqRespValues(AudioResult::FreqRespSincMicro.data(), "FR-SincMicro");
+
   DumpFreqRespValues(AudioResult::FreqRespPointNxN.data(), "FR-PointNxN");
   DumpFreqRespValues(AudioResult::FreqRespLinearNxN.data(), "FR-LinearNxN");
 
@@ -561,6 +729,13 @@ void AudioResult::DumpThresholdValues() {
   DumpSinadValues(AudioResult::SinadLinearUp2.data(), "SinadLinearUp2");
   DumpSinadValues(AudioResult::SinadLinearMicro.data(), "SinadLinearMicro");
 
+  DumpSinadValues(AudioResult::SinadSincUnity.data(), "SinadSincUnity");
+  DumpSinadValues(AudioResult::SinadSincDown1.data(), "SinadSincDown1");
+  DumpSinadValues(AudioResult::SinadSincDown2.data(), "SinadSincDown2");
+  DumpSinadValues(AudioResult::SinadSincUp1.data(), "SinadSincUp1");
+  DumpSinadValues(AudioResult::SinadSincUp2.data(), "SinadSincUp2");
+  DumpSinadValues(AudioResult::SinadSincMicro.data(), "SinadSincMicro");
+
   DumpSinadValues(AudioResult::SinadPointNxN.data(), "SinadPointNxN");
   DumpSinadValues(AudioResult::SinadLinearNxN.data(), "SinadLinearNxN");
 
@@ -637,6 +812,7 @@ void AudioResult::DumpLevelToleranceValues() {
   printf("\n       Stereo-to-Mono: %15.8le               ",
          AudioResult::LevelToleranceStereoMono);
   printf("Interpolation: %15.8le", LevelToleranceInterpolation);
+  printf("\n       Sinc: %15.8le", LevelToleranceSinc);
 }
 
 void AudioResult::DumpNoiseFloorValues() {
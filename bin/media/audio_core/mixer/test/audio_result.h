@@ -159,6 +159,12 @@ class AudioResult {
   // result magnitude EXCEEDS this tolerance, then the test case fails.
   static constexpr double kPrevLevelToleranceInterpolation = 6.5187815e-05;
 
+  // SincSampler's lowpass filter has a small passband ripple, so its level
+  // response can slightly exceed 0 dBFS at any frequency. This is the worst-
+  // case such excess, measured and previously-cached as above.
+  static double LevelToleranceSinc;
+  static constexpr double kPrevLevelToleranceSinc = 1.9632537e-04;
+
   // Frequency Response
   //
   // What is our received level (in dBFS), when sending sinusoids through our
@@ -199,6 +205,20 @@ class AudioResult {
   static std::array<double, FrequencySet::kNumReferenceFreqs>
       FreqRespLinearMicro;
 
+  // Same as the above section, but for SincSampler instead of PointSampler
+  static std::array<double, FrequencySet::kNumReferenceFreqs>
+      FreqRespSincUnity;
+  static std::array<double, FrequencySet::kNumReferenceFreqs>
+      FreqRespSincDown1;
+  static std::array<double, FrequencySet::kNumReferenceFreqs>
+      FreqRespSincDown2;
+  static std::array<double, FrequencySet::kNumReferenceFreqs>
+      FreqRespSincUp1;
+  static std::array<double, FrequencySet::kNumReferenceFreqs>
+      FreqRespSincUp2;
+  static std::array<double, FrequencySet::kNumReferenceFreqs>
+      FreqRespSincMicro;
+
   //
   // Val-being-checked (in dBFS) must be greater than or equal to this value.
   // It also cannot be more than kPrevLevelToleranceInterpolation above 0.0db.
@@ -238,6 +258,20 @@ class AudioResult {
   static const std::array<double, FrequencySet::kNumReferenceFreqs>
       kPrevFreqRespLinearMicro;
 
+  // Same as the above section, but for SincSampler instead of PointSampler
+  static const std::array<double, FrequencySet::kNumReferenceFreqs>
+      kPrevFreqRespSincUnity;
+  static const std::array<double, FrequencySet::kNumReferenceFreqs>
+      kPrevFreqRespSincDown1;
+  static const std::array<double, FrequencySet::kNumReferenceFreqs>
+      kPrevFreqRespSincDown2;
+  static const std::array<double, FrequencySet::kNumReferenceFreqs>
+      kPrevFreqRespSincUp1;
+  static const std::array<double, FrequencySet::kNumReferenceFreqs>
+      kPrevFreqRespSincUp2;
+  static const std::array<double, FrequencySet::kNumReferenceFreqs>
+      kPrevFreqRespSincMicro;
+
   static std::array<double, FrequencySet::kNumReferenceFreqs> FreqRespPointNxN;
   static std::array<double, FrequencySet::kNumReferenceFreqs> FreqRespLinearNxN;
 
@@ -271,6 +305,14 @@ class AudioResult {
   static std::array<double, FrequencySet::kNumReferenceFreqs> SinadLinearUp2;
   static std::array<double, FrequencySet::kNumReferenceFreqs> SinadLinearMicro;
 
+  // Same as the above section, but for SincSampler instead of PointSampler
+  static std::array<double, FrequencySet::kNumReferenceFreqs> SinadSincUnity;
+  static std::array<double, FrequencySet::kNumReferenceFreqs> SinadSincDown1;
+  static std::array<double, FrequencySet::kNumReferenceFreqs> SinadSincDown2;
+  static std::array<double, FrequencySet::kNumReferenceFreqs> SinadSincUp1;
+  static std::array<double, FrequencySet::kNumReferenceFreqs> SinadSincUp2;
+  static std::array<double, FrequencySet::kNumReferenceFreqs> SinadSincMicro;
+
   // These are the previous-cached results for SINAD, for this sampler and this
   // rate conversion, represented in dBr. If any current result magnitude is
   // LESS than this value, then the test case fails.
@@ -301,6 +343,20 @@ class AudioResult {
   static const std::array<double, FrequencySet::kNumReferenceFreqs>
       kPrevSinadLinearMicro;
 
+  // Same as the above section, but for SincSampler instead of PointSampler
+  static const std::array<double, FrequencySet::kNumReferenceFreqs>
+      kPrevSinadSincUnity;
+  static const std::array<double, FrequencySet::kNumReferenceFreqs>
+      kPrevSinadSincDown1;
+  static const std::array<double, FrequencySet::kNumReferenceFreqs>
+      kPrevSinadSincDown2;
+  static const std::array<double, FrequencySet::kNumReferenceFreqs>
+      kPrevSinadSincUp1;
+  static const std::array<double, FrequencySet::kNumReferenceFreqs>
+      kPrevSinadSincUp2;
+  static const std::array<double, FrequencySet::kNumReferenceFreqs>
+      kPrevSinadSincMicro;
+
   // SINAD results measured for a few frequencies during the NxN tests.
   static std::array<double, FrequencySet::kNumReferenceFreqs> SinadPointNxN;
   static std::array<double, FrequencySet::kNumReferenceFreqs> SinadLinearNxN;
@@ -2,6 +2,8 @@
 // Use of this source code is governed by a BSD-style license that can be
 // found in the LICENSE file.
 
+#include <string>
+
 #include "garnet/bin/media/audio_core/mixer/test/audio_performance.h"
 #include "garnet/bin/media/audio_core/mixer/test/audio_result.h"
 #include "garnet/bin/media/audio_core/mixer/test/frequency_set.h"
@@ -15,8 +17,15 @@ int main(int argc, char** argv) {
   // --dump     Display results in importable format.
   //            This flag is used when updating AudioResult kPrev arrays.
   // --profile  Profile the performance of Mix() across numerous configurations.
+  // --profile-json=<path>
+  //            Profile as above, and also write the results to <path> in the
+  //            JSON format that catapult_converter ingests.
   bool show_full_frequency_set = command_line.HasOption("full");
-  bool do_performance_profiling = command_line.HasOption("profile");
+  std::string profile_json_path;
+  bool export_performance_profile =
+      command_line.GetOptionValue("profile-json", &profile_json_path);
+  bool do_performance_profiling =
+      command_line.HasOption("profile") || export_performance_profile;
   bool dump_threshold_values = command_line.HasOption("dump");
 
   media::audio::test::FrequencySet::UseFullFrequencySet =
@@ -31,6 +40,10 @@ int main(int argc, char** argv) {
   if (do_performance_profiling) {
     media::audio::test::AudioPerformance::Profile();
   }
+  if (export_performance_profile &&
+      !media::audio::test::AudioPerformance::ExportResults(profile_json_path)) {
+    result = 1;
+  }
 
   return result;
 }
@@ -4,6 +4,7 @@
 
 #include <fbl/algorithm.h>
 
+#include "garnet/bin/media/audio_core/mixer/mixer_utils.h"
 #include "garnet/bin/media/audio_core/mixer/no_op.h"
 #include "garnet/bin/media/audio_core/mixer/test/mixer_tests_shared.h"
 #include "lib/fxl/logging.h"
@@ -313,6 +314,195 @@ TEST(PassThru, Accumulate) {
   EXPECT_TRUE(CompareBuffers(accum, expect2, fbl::count_of(accum)));
 }
 
+// Unity-rate mixes with matching channel counts take a vectorized path. Use a
+// buffer length that is not a multiple of the vector width, non-unity gain and
+// accumulation, and verify the result is bit-identical to the per-sample math.
+template <typename SampleType>
+void TestVectorizedPointSampler(fuchsia::media::AudioSampleFormat format,
+                                uint32_t num_chans,
+                                const SampleType* source) {
+  constexpr uint32_t kNumFrames = 37;
+  constexpr float kGainDb = -6.0f;
+  float accum[kNumFrames * 4];
+  float expect[kNumFrames * 4];
+  const uint32_t num_samples = kNumFrames * num_chans;
+
+  Gain gain;
+  gain.SetSourceGain(kGainDb);
+  Gain::AScale scale = gain.GetGainScale();
+  for (uint32_t idx = 0; idx < num_samples; ++idx) {
+    accum[idx] = static_cast<float>(idx % 7) / 16.0f - 0.1875f;
+    float sample = mixer::SampleNormalizer<SampleType>::Read(source + idx);
+    expect[idx] = (scale * sample) + accum[idx];
+  }
+
+  MixerPtr mixer = SelectMixer(format, num_chans, 48000, num_chans, 48000,
+                               Resampler::SampleAndHold);
+  DoMix(std::move(mixer), source, accum, true, kNumFrames, kGainDb);
+  EXPECT_TRUE(CompareBuffers(accum, expect, num_samples));
+}
+
+TEST(PassThru, Vectorized_MatchesScalar) {
+  constexpr uint32_t kNumSamples = 37 * 4;
+  uint8_t source_8[kNumSamples];
+  int16_t source_16[kNumSamples];
+  int32_t source_24[kNumSamples];
+  float source_float[kNumSamples];
+  for (uint32_t idx = 0; idx < kNumSamples; ++idx) {
+    int32_t val = static_cast<int32_t>((idx * 0x9E3779B1u) >> 8);
+    source_8[idx] = static_cast<uint8_t>(val);
+    source_16[idx] = static_cast<int16_t>(val);
+    source_24[idx] = val & ~0x0FF;
+    source_float[idx] = static_cast<float>(source_16[idx]) / 0x8000;
+  }
+
+  for (uint32_t num_chans : {1u, 2u, 4u}) {
+    TestVectorizedPointSampler(fuchsia::media::AudioSampleFormat::UNSIGNED_8,
+                               num_chans, source_8);
+    TestVectorizedPointSampler(fuchsia::media::AudioSampleFormat::SIGNED_16,
+                               num_chans, source_16);
+    TestVectorizedPointSampler(
+        fuchsia::media::AudioSampleFormat::SIGNED_24_IN_32, num_chans,
+        source_24);
+    TestVectorizedPointSampler(fuchsia::media::AudioSampleFormat::FLOAT,
+                               num_chans, source_float);
+  }
+}
+
+// The LinearSampler's unity-rate path interpolates a whole run of frames with
+// one fractional weight. Start half a frame in, and compare (within float
+// tolerance, as scalar code may use fused multiply-add) to per-sample math.
+TEST(PassThru, Vectorized_LinearMatchesScalar) {
+  constexpr uint32_t kNumFrames = 37;
+  constexpr uint32_t kNumChans = 2;
+  constexpr int32_t kHalfFrame = 1 << (kPtsFractionalBits - 1);
+  int16_t source[kNumFrames * kNumChans];
+  float accum[(kNumFrames - 1) * kNumChans];
+  float expect[(kNumFrames - 1) * kNumChans];
+
+  for (uint32_t idx = 0; idx < fbl::count_of(source); ++idx) {
+    source[idx] = static_cast<int16_t>((idx * 0x9E3779B1u) >> 16);
+  }
+  for (uint32_t idx = 0; idx < fbl::count_of(expect); ++idx) {
+    float s1 = mixer::SampleNormalizer<int16_t>::Read(source + idx);
+    float s2 = mixer::SampleNormalizer<int16_t>::Read(source + idx + kNumChans);
+    expect[idx] = s1 + (s2 - s1) * 0.5f;
+  }
+
+  MixerPtr mixer = SelectMixer(fuchsia::media::AudioSampleFormat::SIGNED_16,
+                               kNumChans, 48000, kNumChans, 48000,
+                               Resampler::LinearInterpolation);
+  uint32_t dest_offset = 0;
+  int32_t frac_src_offset = kHalfFrame;
+  Bookkeeping info;
+  bool mix_result = mixer->Mix(accum, kNumFrames - 1, &dest_offset, source,
+                               kNumFrames << kPtsFractionalBits,
+                               &frac_src_offset, false, &info);
+
+  EXPECT_TRUE(mix_result);
+  EXPECT_EQ(kNumFrames - 1, dest_offset);
+  EXPECT_EQ(static_cast<int32_t>((kNumFrames - 1) << kPtsFractionalBits) +
+                kHalfFrame,
+            frac_src_offset);
+  EXPECT_TRUE(CompareBuffers(accum, expect, fbl::count_of(accum), true, true));
+}
+
+// Fixed-rate (non-unity step, no rate modulo) mixes with matching channel
+// counts gather source frames and take the vectorized path. Step 1.5 frames at
+// a time, with non-unity gain and accumulation, and verify the result is
+// bit-identical to the per-sample math.
+TEST(PassThru, Vectorized_FixedRateMatchesScalar) {
+  constexpr uint32_t kNumFrames = 37;
+  constexpr uint32_t kNumSrcFrames = 56;
+  constexpr uint32_t kStepSize = 3 << (kPtsFractionalBits - 1);
+  constexpr float kGainDb = -6.0f;
+  int16_t source[kNumSrcFrames * 4];
+  float accum[kNumFrames * 4];
+  float expect[kNumFrames * 4];
+
+  for (uint32_t idx = 0; idx < fbl::count_of(source); ++idx) {
+    source[idx] = static_cast<int16_t>((idx * 0x9E3779B1u) >> 16);
+  }
+
+  Gain gain;
+  gain.SetSourceGain(kGainDb);
+  Gain::AScale scale = gain.GetGainScale();
+  for (uint32_t num_chans : {1u, 2u, 4u}) {
+    for (uint32_t frame = 0; frame < kNumFrames; ++frame) {
+      uint32_t src_frame = (frame * kStepSize) >> kPtsFractionalBits;
+      for (uint32_t chan = 0; chan < num_chans; ++chan) {
+        uint32_t idx = frame * num_chans + chan;
+        accum[idx] = static_cast<float>(idx % 7) / 16.0f - 0.1875f;
+        float sample = mixer::SampleNormalizer<int16_t>::Read(
+            source + src_frame * num_chans + chan);
+        expect[idx] = (scale * sample) + accum[idx];
+      }
+    }
+
+    MixerPtr mixer =
+        SelectMixer(fuchsia::media::AudioSampleFormat::SIGNED_16, num_chans,
+                    72000, num_chans, 48000, Resampler::SampleAndHold);
+    uint32_t dest_offset = 0;
+    int32_t frac_src_offset = 0;
+    Bookkeeping info;
+    info.gain.SetSourceGain(kGainDb);
+    info.step_size = kStepSize;
+    mixer->Mix(accum, kNumFrames, &dest_offset, source,
+               kNumSrcFrames << kPtsFractionalBits, &frac_src_offset, true,
+               &info);
+
+    EXPECT_EQ(kNumFrames, dest_offset);
+    EXPECT_EQ(static_cast<int32_t>(kNumFrames * kStepSize), frac_src_offset);
+    EXPECT_TRUE(CompareBuffers(accum, expect, kNumFrames * num_chans));
+  }
+}
+
+// The LinearSampler's fixed-rate path gathers each frame's neighbors and
+// weight. Step 1.5 frames at a time, so the weight alternates between 0 and
+// 0.5, and compare (within float tolerance) to per-sample math.
+TEST(PassThru, Vectorized_LinearFixedRateMatchesScalar) {
+  constexpr uint32_t kNumFrames = 37;
+  constexpr uint32_t kNumSrcFrames = 56;
+  constexpr uint32_t kStepSize = 3 << (kPtsFractionalBits - 1);
+  int16_t source[kNumSrcFrames * 4];
+  float accum[kNumFrames * 4];
+  float expect[kNumFrames * 4];
+
+  for (uint32_t idx = 0; idx < fbl::count_of(source); ++idx) {
+    source[idx] = static_cast<int16_t>((idx * 0x9E3779B1u) >> 16);
+  }
+
+  for (uint32_t num_chans : {1u, 2u, 4u}) {
+    for (uint32_t frame = 0; frame < kNumFrames; ++frame) {
+      uint32_t src_pos = frame * kStepSize;
+      uint32_t src_frame = src_pos >> kPtsFractionalBits;
+      float alpha = (src_pos & kPtsFractionalMask) ? 0.5f : 0.0f;
+      for (uint32_t chan = 0; chan < num_chans; ++chan) {
+        const int16_t* s = source + src_frame * num_chans + chan;
+        float s1 = mixer::SampleNormalizer<int16_t>::Read(s);
+        float s2 = mixer::SampleNormalizer<int16_t>::Read(s + num_chans);
+        expect[frame * num_chans + chan] = s1 + (s2 - s1) * alpha;
+      }
+    }
+
+    MixerPtr mixer =
+        SelectMixer(fuchsia::media::AudioSampleFormat::SIGNED_16, num_chans,
+                    72000, num_chans, 48000, Resampler::LinearInterpolation);
+    uint32_t dest_offset = 0;
+    int32_t frac_src_offset = 0;
+    Bookkeeping info;
+    info.step_size = kStepSize;
+    mixer->Mix(accum, kNumFrames, &dest_offset, source,
+               kNumSrcFrames << kPtsFractionalBits, &frac_src_offset, false,
+               &info);
+
+    EXPECT_EQ(kNumFrames, dest_offset);
+    EXPECT_EQ(static_cast<int32_t>(kNumFrames * kStepSize), frac_src_offset);
+    EXPECT_TRUE(CompareBuffers(accum, expect, kNumFrames * num_chans, true,
+                               true));
+  }
+}
+
 // Are all valid data values rounded correctly to 8-bit outputs?
 TEST(PassThru, Output_8) {
   float accum[] = {-0x08989000, -0x08000000, -0x04080000, -0x00001000,
@@ -279,7 +279,15 @@ void MeasureFreqRespSinad(MixerPtr mixer, uint32_t src_buf_size,
   // ratio, some resamplers need it in order to produce the final dest value.
   // All FFT inputs are considered periodic, so to generate a periodic output
   // from the resampler, this extra source element should equal source[0].
-  std::vector<float> source(src_buf_size + 1);
+  //
+  // Resamplers whose filters reach more than one frame in either direction
+  // (such as SincSampler) also need the signal to continue periodically before
+  // the first frame and after the last one. We pad both ends accordingly, and
+  // start sampling after the leading pad.
+  uint32_t pre_frames = mixer->neg_filter_width() >> kPtsFractionalBits;
+  uint32_t post_frames = mixer->pos_filter_width() >> kPtsFractionalBits;
+  std::vector<float> period(src_buf_size);
+  std::vector<float> source(pre_frames + src_buf_size + 1 + post_frames);
   std::vector<float> accum(kFreqTestBufSize);
 
   Bookkeeping info;
@@ -311,9 +319,13 @@ void MeasureFreqRespSinad(MixerPtr mixer, uint32_t src_buf_size,
     }
 
     // Populate the source buffer with a sinusoid at each reference frequency.
-    OverwriteCosine(source.data(), src_buf_size,
+    OverwriteCosine(period.data(), src_buf_size,
                     FrequencySet::kReferenceFreqs[freq_idx]);
-    source[src_buf_size] = source[0];
+    for (uint32_t idx = 0; idx < source.size(); ++idx) {
+      source[idx] =
+          period[(idx + src_buf_size - (pre_frames % src_buf_size)) %
+                 src_buf_size];
+    }
 
     // Resample the source into the accumulation buffer, in pieces. (Why in
     // pieces? See description of kResamplerTestNumPackets in frequency_set.h.)
@@ -330,7 +342,8 @@ void MeasureFreqRespSinad(MixerPtr mixer, uint32_t src_buf_size,
       dest_offset = kFreqTestBufSize * packet / kResamplerTestNumPackets;
       frac_src_offset =
           (static_cast<int64_t>(src_buf_size) * Mixer::FRAC_ONE * packet) /
-          kResamplerTestNumPackets;
+              kResamplerTestNumPackets +
+          (pre_frames << kPtsFractionalBits);
 
       mixer->Mix(accum.data(), dest_frames, &dest_offset, source.data(),
                  frac_src_frames, &frac_src_offset, false, &info);
@@ -352,11 +365,14 @@ void MeasureFreqRespSinad(MixerPtr mixer, uint32_t src_buf_size,
 
 // Given result and limit arrays, compare them as frequency response results.
 // I.e., ensure greater-than-or-equal-to, plus a less-than-or-equal-to check
-// against the overall level tolerance (for level results greater than 0 dB).
+// against the given level tolerance (for level results greater than 0 dB).
+// The worst-case level found is recorded in |level_tolerance_result|.
 // 'summary_only' force-limits evaluation to the three basic frequencies.
 void EvaluateFreqRespResults(double* freq_resp_results,
                              const double* freq_resp_limits,
-                             bool summary_only = false) {
+                             double level_tolerance_limit,
+                             double* level_tolerance_result,
+                             bool summary_only) {
   bool use_full_set = (!summary_only) && FrequencySet::UseFullFrequencySet;
   uint32_t num_freqs = use_full_set ? FrequencySet::kReferenceFreqs.size()
                                     : FrequencySet::kSummaryIdxs.size();
@@ -367,15 +383,34 @@ void EvaluateFreqRespResults(double* freq_resp_results,
     EXPECT_GE(freq_resp_results[freq], freq_resp_limits[freq])
         << " [" << freq << "]  " << std::scientific << std::setprecision(9)
         << freq_resp_results[freq];
-    EXPECT_LE(freq_resp_results[freq],
-              0.0 + AudioResult::kPrevLevelToleranceInterpolation)
+    EXPECT_LE(freq_resp_results[freq], 0.0 + level_tolerance_limit)
         << " [" << freq << "]  " << std::scientific << std::setprecision(9)
         << freq_resp_results[freq];
-    AudioResult::LevelToleranceInterpolation =
-        fmax(AudioResult::LevelToleranceInterpolation, freq_resp_results[freq]);
+    *level_tolerance_result =
+        fmax(*level_tolerance_result, freq_resp_results[freq]);
   }
 }
 
+// Compare frequency response results for the point and linear samplers, which
+// share an overall level tolerance.
+void EvaluateFreqRespResults(double* freq_resp_results,
+                             const double* freq_resp_limits,
+                             bool summary_only = false) {
+  EvaluateFreqRespResults(freq_resp_results, freq_resp_limits,
+                          AudioResult::kPrevLevelToleranceInterpolation,
+                          &AudioResult::LevelToleranceInterpolation,
+                          summary_only);
+}
+
+// Compare frequency response results for the sinc sampler, whose passband
+// ripple is allowed a tolerance of its own.
+void EvaluateSincFreqRespResults(double* freq_resp_results,
+                                 const double* freq_resp_limits) {
+  EvaluateFreqRespResults(freq_resp_results, freq_resp_limits,
+                          AudioResult::kPrevLevelToleranceSinc,
+                          &AudioResult::LevelToleranceSinc, false);
+}
+
 // Given result and limit arrays, compare them as SINAD results. This simply
 // means apply a strict greater-than-or-equal-to, without additional tolerance.
 // 'summary_only' force-limits evaluation to the three basic frequencies.
@@ -704,6 +739,126 @@ TEST(Sinad, Linear_MicroSRC) {
                        AudioResult::kPrevSinadLinearMicro.data());
 }
 
+// Measure Freq Response for Sinc sampler, no rate conversion.
+TEST(FrequencyResponse, Sinc_Unity) {
+  TestUnitySampleRatio(Resampler::WindowedSinc,
+                       AudioResult::FreqRespSincUnity.data(),
+                       AudioResult::SinadSincUnity.data());
+
+  EvaluateSincFreqRespResults(AudioResult::FreqRespSincUnity.data(),
+                              AudioResult::kPrevFreqRespSincUnity.data());
+}
+
+// Measure SINAD for Sinc sampler, no rate conversion.
+TEST(Sinad, Sinc_Unity) {
+  TestUnitySampleRatio(Resampler::WindowedSinc,
+                       AudioResult::FreqRespSincUnity.data(),
+                       AudioResult::SinadSincUnity.data());
+
+  EvaluateSinadResults(AudioResult::SinadSincUnity.data(),
+                       AudioResult::kPrevSinadSincUnity.data());
+}
+
+// Measure Freq Response for Sinc sampler, first down-sampling ratio.
+TEST(FrequencyResponse, Sinc_DownSamp1) {
+  TestDownSampleRatio1(Resampler::WindowedSinc,
+                       AudioResult::FreqRespSincDown1.data(),
+                       AudioResult::SinadSincDown1.data());
+
+  EvaluateSincFreqRespResults(AudioResult::FreqRespSincDown1.data(),
+                              AudioResult::kPrevFreqRespSincDown1.data());
+}
+
+// Measure SINAD for Sinc sampler, first down-sampling ratio.
+TEST(Sinad, Sinc_DownSamp1) {
+  TestDownSampleRatio1(Resampler::WindowedSinc,
+                       AudioResult::FreqRespSincDown1.data(),
+                       AudioResult::SinadSincDown1.data());
+
+  EvaluateSinadResults(AudioResult::SinadSincDown1.data(),
+                       AudioResult::kPrevSinadSincDown1.data());
+}
+
+// Measure Freq Response for Sinc sampler, second down-sampling ratio.
+TEST(FrequencyResponse, Sinc_DownSamp2) {
+  TestDownSampleRatio2(Resampler::WindowedSinc,
+                       AudioResult::FreqRespSincDown2.data(),
+                       AudioResult::SinadSincDown2.data());
+
+  EvaluateSincFreqRespResults(AudioResult::FreqRespSincDown2.data(),
+                              AudioResult::kPrevFreqRespSincDown2.data());
+}
+
+// Measure SINAD for Sinc sampler, second down-sampling ratio.
+TEST(Sinad, Sinc_DownSamp2) {
+  TestDownSampleRatio2(Resampler::WindowedSinc,
+                       AudioResult::FreqRespSincDown2.data(),
+                       AudioResult::SinadSincDown2.data());
+
+  EvaluateSinadResults(AudioResult::SinadSincDown2.data(),
+                       AudioResult::kPrevSinadSincDown2.data());
+}
+
+// Measure Freq Response for Sinc sampler, first up-sampling ratio.
+TEST(FrequencyResponse, Sinc_UpSamp1) {
+  TestUpSampleRatio1(Resampler::WindowedSinc,
+                     AudioResult::FreqRespSincUp1.data(),
+                     AudioResult::SinadSincUp1.data());
+
+  EvaluateSincFreqRespResults(AudioResult::FreqRespSincUp1.data(),
+                              AudioResult::kPrevFreqRespSincUp1.data());
+}
+
+// Measure SINAD for Sinc sampler, first up-sampling ratio.
+TEST(Sinad, Sinc_UpSamp1) {
+  TestUpSampleRatio1(Resampler::WindowedSinc,
+                     AudioResult::FreqRespSincUp1.data(),
+                     AudioResult::SinadSincUp1.data());
+
+  EvaluateSinadResults(AudioResult::SinadSincUp1.data(),
+                       AudioResult::kPrevSinadSincUp1.data());
+}
+
+// Measure Freq Response for Sinc sampler, second up-sampling ratio.
+TEST(FrequencyResponse, Sinc_UpSamp2) {
+  TestUpSampleRatio2(Resampler::WindowedSinc,
+                     AudioResult::FreqRespSincUp2.data(),
+                     AudioResult::SinadSincUp2.data());
+
+  EvaluateSincFreqRespResults(AudioResult::FreqRespSincUp2.data(),
+                              AudioResult::kPrevFreqRespSincUp2.data());
+}
+
+// Measure SINAD for Sinc sampler, second up-sampling ratio.
+TEST(Sinad, Sinc_UpSamp2) {
+  TestUpSampleRatio2(Resampler::WindowedSinc,
+                     AudioResult::FreqRespSincUp2.data(),
+                     AudioResult::SinadSincUp2.data());
+
+  EvaluateSinadResults(AudioResult::SinadSincUp2.data(),
+                       AudioResult::kPrevSinadSincUp2.data());
+}
+
+// Measure Freq Response for Sinc sampler with minimum rate change.
+TEST(FrequencyResponse, Sinc_MicroSRC) {
+  TestMicroSampleRatio(Resampler::WindowedSinc,
+                       AudioResult::FreqRespSincMicro.data(),
+                       AudioResult::SinadSincMicro.data());
+
+  EvaluateSincFreqRespResults(AudioResult::FreqRespSincMicro.data(),
+                              AudioResult::kPrevFreqRespSincMicro.data());
+}
+
+// Measure SINAD for Sinc sampler with minimum rate change.
+TEST(Sinad, Sinc_MicroSRC) {
+  TestMicroSampleRatio(Resampler::WindowedSinc,
+                       AudioResult::FreqRespSincMicro.data(),
+                       AudioResult::SinadSincMicro.data());
+
+  EvaluateSinadResults(AudioResult::SinadSincMicro.data(),
+                       AudioResult::kPrevSinadSincMicro.data());
+}
+
 // For each summary frequency, populate a sinusoid into a mono buffer, and copy-
 // interleave mono[] into one of the channels of the N-channel source.
 void PopulateNxNSourceBuffer(float* source, uint32_t num_frames,
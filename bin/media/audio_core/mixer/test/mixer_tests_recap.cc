@@ -144,6 +144,70 @@ TEST(Recap, FreqResp) {
     }
   }
 
+  printf("\n\n   Sinc resampler\n    ");
+  if (FrequencySet::UseFullFrequencySet) {
+    printf("                  No SRC                  96k->48k");
+  }
+  printf("                88.2k->48k               44.1k->48k");
+  if (FrequencySet::UseFullFrequencySet) {
+    printf("                24k->48k                 Micro-SRC");
+  }
+  for (uint32_t idx = 0; idx < num_freqs; ++idx) {
+    uint32_t freq = FrequencySet::UseFullFrequencySet
+                        ? idx
+                        : FrequencySet::kSummaryIdxs[idx];
+    printf("\n   %6u Hz", FrequencySet::kRefFreqsTranslated[freq]);
+
+    if (FrequencySet::UseFullFrequencySet) {
+      if (AudioResult::kPrevFreqRespSincUnity[freq] !=
+          -std::numeric_limits<double>::infinity()) {
+        printf("   %9.6lf  (%9.6lf)", AudioResult::FreqRespSincUnity[freq],
+               AudioResult::kPrevFreqRespSincUnity[freq]);
+      } else {
+        printf("                         ");
+      }
+      if (AudioResult::kPrevFreqRespSincDown1[freq] !=
+          -std::numeric_limits<double>::infinity()) {
+        printf("   %9.6lf  (%9.6lf)", AudioResult::FreqRespSincDown1[freq],
+               AudioResult::kPrevFreqRespSincDown1[freq]);
+      } else {
+        printf("                         ");
+      }
+    }
+
+    if (AudioResult::kPrevFreqRespSincDown2[freq] !=
+        -std::numeric_limits<double>::infinity()) {
+      printf("   %9.6lf  (%9.6lf)", AudioResult::FreqRespSincDown2[freq],
+             AudioResult::kPrevFreqRespSincDown2[freq]);
+    } else {
+      printf("                         ");
+    }
+    if (AudioResult::kPrevFreqRespSincUp1[freq] !=
+        -std::numeric_limits<double>::infinity()) {
+      printf("   %9.6lf  (%9.6lf)", AudioResult::FreqRespSincUp1[freq],
+             AudioResult::kPrevFreqRespSincUp1[freq]);
+    } else {
+      printf("                         ");
+    }
+
+    if (FrequencySet::UseFullFrequencySet) {
+      if (AudioResult::kPrevFreqRespSincUp2[freq] !=
+          -std::numeric_limits<double>::infinity()) {
+        printf("   %9.6lf  (%9.6lf)", AudioResult::FreqRespSincUp2[freq],
+               AudioResult::kPrevFreqRespSincUp2[freq]);
+      } else {
+        printf("                         ");
+      }
+      if (AudioResult::kPrevFreqRespSincMicro[freq] !=
+          -std::numeric_limits<double>::infinity()) {
+        printf("   %9.6lf  (%9.6lf)", AudioResult::FreqRespSincMicro[freq],
+               AudioResult::kPrevFreqRespSincMicro[freq]);
+      } else {
+        printf("                         ");
+      }
+    }
+  }
+
   printf("\n\n");
 }
 
@@ -277,6 +341,69 @@ TEST(Recap, SINAD) {
     }
   }
 
+  printf("\n\n   Sinc resampler\n           ");
+  if (FrequencySet::UseFullFrequencySet) {
+    printf("            No SRC             96k->48k ");
+  }
+  printf("          88.2k->48k          44.1k->48k");
+  if (FrequencySet::UseFullFrequencySet) {
+    printf("           24k->48k            Micro-SRC");
+  }
+  for (uint32_t idx = 0; idx < num_freqs; ++idx) {
+    uint32_t freq = FrequencySet::UseFullFrequencySet
+                        ? idx
+                        : FrequencySet::kSummaryIdxs[idx];
+    printf("\n   %8u Hz ", FrequencySet::kRefFreqsTranslated[freq]);
+
+    if (FrequencySet::UseFullFrequencySet) {
+      if (AudioResult::kPrevSinadSincUnity[freq] !=
+          -std::numeric_limits<double>::infinity()) {
+        printf("    %6.2lf  (%6.2lf)", AudioResult::SinadSincUnity[freq],
+               AudioResult::kPrevSinadSincUnity[freq]);
+      } else {
+        printf("                    ");
+      }
+      if (AudioResult::kPrevSinadSincDown1[freq] !=
+          -std::numeric_limits<double>::infinity()) {
+        printf("    %6.2lf  (%6.2lf)", AudioResult::SinadSincDown1[freq],
+               AudioResult::kPrevSinadSincDown1[freq]);
+      } else {
+        printf("                    ");
+      }
+    }
+
+    if (AudioResult::kPrevSinadSincDown2[freq] !=
+        -std::numeric_limits<double>::infinity()) {
+      printf("    %6.2lf  (%6.2lf)", AudioResult::SinadSincDown2[freq],
+             AudioResult::kPrevSinadSincDown2[freq]);
+    } else {
+      printf("                    ");
+    }
+    if (AudioResult::kPrevSinadSincUp1[freq] !=
+        -std::numeric_limits<double>::infinity()) {
+      printf("    %6.2lf  (%6.2lf)", AudioResult::SinadSincUp1[freq],
+             AudioResult::kPrevSinadSincUp1[freq]);
+    } else {
+      printf("                    ");
+    }
+
+    if (FrequencySet::UseFullFrequencySet) {
+      if (AudioResult::kPrevSinadSincUp2[freq] !=
+          -std::numeric_limits<double>::infinity()) {
+        printf("    %6.2lf  (%6.2lf)", AudioResult::SinadSincUp2[freq],
+               AudioResult::kPrevSinadSincUp2[freq]);
+      } else {
+        printf("                    ");
+      }
+
+      if (AudioResult::kPrevSinadSincMicro[freq] !=
+          -std::numeric_limits<double>::infinity()) {
+        printf("    %6.2lf  (%6.2lf)", AudioResult::SinadSincMicro[freq],
+               AudioResult::kPrevSinadSincMicro[freq]);
+      }
+    }
+  }
+
   printf("\n\n");
 }
 
@@ -6,8 +6,10 @@
 
 #include <fbl/auto_lock.h>
 #include <lib/fit/defer.h>
+#include <algorithm>
 #include <limits>
 
+#include "garnet/bin/media/audio_core/audio_device_manager.h"
 #include "garnet/bin/media/audio_core/audio_link.h"
 #include "garnet/bin/media/audio_core/audio_renderer_format_info.h"
 #include "garnet/bin/media/audio_core/audio_renderer_impl.h"
@@ -22,6 +24,12 @@ namespace audio {
 static constexpr fxl::TimeDelta kMaxTrimPeriod =
     fxl::TimeDelta::FromMilliseconds(10);
 
+// At verbosity 1, log the first missed mix deadline, then every Nth one.
+static constexpr uint64_t kDeadlineMissLogInterval = 100;
+
+// Verbose logging of our mix statistics happens once every N mix jobs.
+static constexpr uint64_t kMixStatsLogInterval = 1000;
+
 StandardOutputBase::StandardOutputBase(AudioDeviceManager* manager)
     : AudioOutput(manager) {
   next_sched_time_ = fxl::TimePoint::Now();
@@ -37,6 +45,8 @@ zx_status_t StandardOutputBase::Init() {
     return res;
   }
 
+  mix_groups_ = std::max(manager_->mix_groups_per_output(), 1u);
+
   mix_timer_ = ::dispatcher::Timer::Create();
   if (mix_timer_ == nullptr) {
     return ZX_ERR_NO_MEMORY;
@@ -102,9 +112,11 @@ void StandardOutputBase::Process() {
 
         // Mix each renderer into the intermediate accumulator buffer, then
         // reformat (and clip) into the final output buffer.
+        fxl::TimePoint mix_start = fxl::TimePoint::Now();
         ForeachLink(TaskType::Mix);
         output_producer_->ProduceOutput(mix_buf_.get(), cur_mix_job_.buf,
                                         cur_mix_job_.buf_frames);
+        UpdateMixStats(mix_start);
         mixed = true;
       } else {
         output_producer_->FillWithSilence(cur_mix_job_.buf,
@@ -199,6 +211,74 @@ void StandardOutputBase::SetupMixBuffer(uint32_t max_mix_frames) {
 
   mix_buf_frames_ = max_mix_frames;
   mix_buf_.reset(new float[mix_buf_frames_ * output_producer_->channels()]);
+
+  // If we have been asked to split our mix jobs into groups, each group beyond
+  // the first needs its own intermediate buffer, and a worker to mix it.
+  if (mix_groups_ > 1) {
+    size_t group_buf_samples =
+        static_cast<size_t>(mix_buf_frames_) * output_producer_->channels();
+    group_mix_bufs_.reset(new float[group_buf_samples * (mix_groups_ - 1)]);
+
+    if (mix_pool_ == nullptr) {
+      mix_pool_ = std::make_unique<MixWorkerPool>(mix_groups_ - 1);
+    }
+    group_durations_.resize(mix_groups_, 0);
+
+    fbl::AutoLock lock(&mix_stats_lock_);
+    mix_stats_.max_group_duration.resize(mix_groups_, 0);
+  }
+}
+
+float* StandardOutputBase::group_mix_buf(uint32_t group) {
+  FXL_DCHECK(group < mix_groups_);
+  if (group == 0) {
+    return mix_buf_.get();
+  }
+
+  size_t group_buf_samples =
+      static_cast<size_t>(mix_buf_frames_) * output_producer_->channels();
+  return group_mix_bufs_.get() + (group_buf_samples * (group - 1));
+}
+
+void StandardOutputBase::UpdateMixStats(fxl::TimePoint mix_start) {
+  fxl::TimePoint mix_end = fxl::TimePoint::Now();
+  zx_duration_t duration = (mix_end - mix_start).ToNanoseconds();
+
+  fbl::AutoLock lock(&mix_stats_lock_);
+  ++mix_stats_.jobs;
+  mix_stats_.last_job_duration = duration;
+  mix_stats_.total_job_duration += duration;
+  mix_stats_.max_job_duration = std::max(mix_stats_.max_job_duration, duration);
+
+  // We missed our deadline if the output's position had already reached the
+  // first frame of this job by the time we finished producing it.
+  if (cur_mix_job_.local_to_output != nullptr) {
+    int64_t deadline =
+        cur_mix_job_.local_to_output->ApplyInverse(cur_mix_job_.start_pts_of);
+    int64_t late_by = mix_end.ToEpochDelta().ToNanoseconds() - deadline;
+    if (late_by > 0) {
+      if (((mix_stats_.deadline_misses++ % kDeadlineMissLogInterval) == 0) &&
+          FXL_VLOG_IS_ON(1)) {
+        FXL_VLOG(1) << "Mix job finished " << late_by / 1000
+                    << " uSec late, after " << duration / 1000
+                    << " uSec of mixing (" << mix_stats_.deadline_misses
+                    << " of " << mix_stats_.jobs << " jobs late)";
+      }
+    }
+  }
+
+  if (FXL_VLOG_IS_ON(1) && ((mix_stats_.jobs % kMixStatsLogInterval) == 0)) {
+    FXL_VLOG(1) << "Mix jobs: " << mix_stats_.jobs
+                << ", late: " << mix_stats_.deadline_misses << ", mean "
+                << (mix_stats_.total_job_duration / mix_stats_.jobs) / 1000
+                << " uSec, max " << mix_stats_.max_job_duration / 1000
+                << " uSec";
+    for (size_t group = 0; group < mix_stats_.max_group_duration.size();
+         ++group) {
+      FXL_VLOG(1) << "  Mix group " << group << ": max "
+                  << mix_stats_.max_group_duration[group] / 1000 << " uSec";
+    }
+  }
 }
 
 void StandardOutputBase::ForeachLink(TaskType task_type) {
@@ -221,7 +301,68 @@ void StandardOutputBase::ForeachLink(TaskType task_type) {
   auto cleanup = fit::defer(
       [this]() FXL_NO_THREAD_SAFETY_ANALYSIS { source_link_refs_.clear(); });
 
-  for (const auto& link : source_link_refs_) {
+  // Trim jobs are cheap, and mix jobs with only one renderer have nothing to
+  // split up, so these are always handled directly on the mix thread.
+  uint32_t num_groups = static_cast<uint32_t>(
+      std::min<size_t>(mix_groups_, source_link_refs_.size()));
+  if ((task_type == TaskType::Trim) || (num_groups <= 1)) {
+    ProcessLinks(task_type, 0, 1, &cur_mix_job_, mix_buf_.get());
+    return;
+  }
+
+  // Otherwise, deal the renderers out across our groups.  Each group mixes into
+  // its own intermediate buffer (group 0 uses the main one) with its own copy
+  // of the job state, on a worker thread (group 0 runs on the mix thread).  The
+  // mix thread waits for all of them, so this all still happens within our mix
+  // domain; the workers are simply acting on its behalf.
+  size_t job_samples = static_cast<size_t>(cur_mix_job_.buf_frames) *
+                       output_producer_->channels();
+  for (uint32_t group = 1; group < num_groups; ++group) {
+    ::memset(group_mix_buf(group), 0, job_samples * sizeof(float));
+  }
+
+  mix_pool_->Run(num_groups, [this, num_groups](uint32_t group) {
+    AssertMixDomainHeldForWorker();
+    MixGroup(group, num_groups);
+  });
+
+  // Sum the other groups' results into the main intermediate buffer.
+  float* mix_buf = mix_buf_.get();
+  for (uint32_t group = 1; group < num_groups; ++group) {
+    const float* group_buf = group_mix_buf(group);
+    for (size_t i = 0; i < job_samples; ++i) {
+      mix_buf[i] += group_buf[i];
+    }
+  }
+
+  fbl::AutoLock lock(&mix_stats_lock_);
+  for (uint32_t group = 0; group < num_groups; ++group) {
+    mix_stats_.max_group_duration[group] = std::max(
+        mix_stats_.max_group_duration[group], group_durations_[group]);
+  }
+}
+
+void StandardOutputBase::MixGroup(uint32_t group, uint32_t num_groups) {
+  fxl::TimePoint group_start = fxl::TimePoint::Now();
+
+  MixJob group_job = cur_mix_job_;
+  ProcessLinks(TaskType::Mix, group, num_groups, &group_job,
+               group_mix_buf(group));
+
+  group_durations_[group] =
+      (fxl::TimePoint::Now() - group_start).ToNanoseconds();
+}
+
+void StandardOutputBase::ProcessLinks(TaskType task_type, uint32_t group,
+                                      uint32_t num_groups, MixJob* job,
+                                      float* mix_buf) {
+  FXL_DCHECK(num_groups > 0);
+  FXL_DCHECK(group < num_groups);
+  FXL_DCHECK(job != nullptr);
+
+  for (size_t i = group; i < source_link_refs_.size(); i += num_groups) {
+    const auto& link = source_link_refs_[i];
+
     // Quit early if we should be shutting down.
     if (is_shutting_down()) {
       return;
@@ -270,7 +411,7 @@ void StandardOutputBase::ForeachLink(TaskType task_type) {
       // fails for any reason, stop processing packets for this renderer.
       if (!setup_done) {
         setup_done = (task_type == TaskType::Mix)
-                         ? SetupMix(audio_renderer, info)
+                         ? SetupMix(audio_renderer, info, job)
                          : SetupTrim(audio_renderer, info);
         if (!setup_done) {
           // Clear our ramps, if we exit with error?
@@ -283,13 +424,13 @@ void StandardOutputBase::ForeachLink(TaskType task_type) {
       // proceed to the next one. Otherwise, we are finished.
       release_audio_renderer_packet =
           (task_type == TaskType::Mix)
-              ? ProcessMix(audio_renderer, info, pkt_ref)
+              ? ProcessMix(audio_renderer, info, pkt_ref, job, mix_buf)
               : ProcessTrim(audio_renderer, info, pkt_ref);
 
       // If we have mixed enough output frames, we are done with this mix,
       // regardless of what we should now do with the renderer packet.
       if ((task_type == TaskType::Mix) &&
-          (cur_mix_job_.frames_produced == cur_mix_job_.buf_frames)) {
+          (job->frames_produced == job->buf_frames)) {
         break;
       }
       // If we still need more output, but could not complete this renderer
@@ -309,24 +450,25 @@ void StandardOutputBase::ForeachLink(TaskType task_type) {
     // Note: there is no point in doing this for Trim tasks, but it doesn't hurt
     // anything, and its easier than adding another function to ForeachLink to
     // run after each renderer is processed, just to set this flag.
-    cur_mix_job_.accumulate = true;
+    job->accumulate = true;
   }
 }
 
 bool StandardOutputBase::SetupMix(
-    const fbl::RefPtr<AudioRendererImpl>& audio_renderer, Bookkeeping* info) {
+    const fbl::RefPtr<AudioRendererImpl>& audio_renderer, Bookkeeping* info,
+    MixJob* job) {
   // If we need to recompose our transformation from output frame space to input
   // fractional frames, do so now.
   FXL_DCHECK(info);
-  UpdateDestTrans(cur_mix_job_, info);
-  cur_mix_job_.frames_produced = 0;
+  UpdateDestTrans(*job, info);
+  job->frames_produced = 0;
 
   return true;
 }
 
 bool StandardOutputBase::ProcessMix(
     const fbl::RefPtr<AudioRendererImpl>& audio_renderer, Bookkeeping* info,
-    const fbl::RefPtr<AudioPacketRef>& packet) {
+    const fbl::RefPtr<AudioPacketRef>& packet, MixJob* job, float* mix_buf) {
   // Bookkeeping should contain: the rechannel matrix (eventually).
 
   // Sanity check our parameters.
@@ -334,8 +476,8 @@ bool StandardOutputBase::ProcessMix(
   FXL_DCHECK(packet);
 
   // We had better have a valid job, or why are we here?
-  FXL_DCHECK(cur_mix_job_.buf_frames);
-  FXL_DCHECK(cur_mix_job_.frames_produced <= cur_mix_job_.buf_frames);
+  FXL_DCHECK(job->buf_frames);
+  FXL_DCHECK(job->frames_produced <= job->buf_frames);
 
   // We also must have selected a mixer, or we are in trouble.
   FXL_DCHECK(info->mixer);
@@ -349,17 +491,17 @@ bool StandardOutputBase::ProcessMix(
   }
 
   // Have we produced enough? If so, hold this packet and move to next renderer.
-  if (cur_mix_job_.frames_produced >= cur_mix_job_.buf_frames) {
+  if (job->frames_produced >= job->buf_frames) {
     return false;
   }
 
-  uint32_t frames_left = cur_mix_job_.buf_frames - cur_mix_job_.frames_produced;
-  float* buf = mix_buf_.get() +
-               (cur_mix_job_.frames_produced * output_producer_->channels());
+  uint32_t frames_left = job->buf_frames - job->frames_produced;
+  float* buf =
+      mix_buf + (job->frames_produced * output_producer_->channels());
 
   // Calculate this job's first and last sampling points, in source sub-frames.
   int64_t first_sample_ftf = info->dest_frames_to_frac_source_frames(
-      cur_mix_job_.start_pts_of + cur_mix_job_.frames_produced);
+      job->start_pts_of + job->frames_produced);
 
   // Without the "-1", this would be the first output frame of the NEXT job.
   int64_t final_sample_ftf =
@@ -454,19 +596,19 @@ bool StandardOutputBase::ProcessMix(
       info->gain.GetScaleArray(
           info->scale_arr.get(),
           std::min(frames_left - output_offset, Bookkeeping::kScaleArrLen),
-          cur_mix_job_.local_to_output->rate());
+          job->local_to_output->rate());
     }
 
     consumed_source =
         info->mixer->Mix(buf, frames_left, &output_offset, packet->payload(),
                          packet->frac_frame_len(), &frac_input_offset,
-                         cur_mix_job_.accumulate, info);
+                         job->accumulate, info);
     FXL_DCHECK(output_offset <= frames_left);
 
     // If src is ramping, advance by delta of output_offset
     if (ramping) {
       info->gain.Advance(output_offset - prev_output_offset,
-                         cur_mix_job_.local_to_output->rate());
+                         job->local_to_output->rate());
     }
   }
 
@@ -475,9 +617,9 @@ bool StandardOutputBase::ProcessMix(
                packet->frac_frame_len());
   }
 
-  cur_mix_job_.frames_produced += output_offset;
+  job->frames_produced += output_offset;
 
-  FXL_DCHECK(cur_mix_job_.frames_produced <= cur_mix_job_.buf_frames);
+  FXL_DCHECK(job->frames_produced <= job->buf_frames);
   return consumed_source;
 }
 
@@ -6,11 +6,17 @@
 #define GARNET_BIN_MEDIA_AUDIO_CORE_STANDARD_OUTPUT_BASE_H_
 
 #include <dispatcher-pool/dispatcher-timer.h>
+#include <fbl/auto_lock.h>
+#include <fbl/mutex.h>
 #include <fuchsia/media/cpp/fidl.h>
+#include <zircon/types.h>
+#include <memory>
+#include <vector>
 
 #include "garnet/bin/media/audio_core/audio_link.h"
 #include "garnet/bin/media/audio_core/audio_link_packet_source.h"
 #include "garnet/bin/media/audio_core/audio_output.h"
+#include "garnet/bin/media/audio_core/mix_worker_pool.h"
 #include "garnet/bin/media/audio_core/mixer/constants.h"
 #include "garnet/bin/media/audio_core/mixer/gain.h"
 #include "garnet/bin/media/audio_core/mixer/mixer.h"
@@ -26,8 +32,28 @@ class AudioPacketRef;
 
 class StandardOutputBase : public AudioOutput {
  public:
+  // Counters which describe how long our mix jobs take, and how often they
+  // fail to finish before the output needs their results.  Durations are in
+  // nanoseconds.  The per-group maximums are only tracked when mixing in
+  // groups.
+  struct MixStats {
+    uint64_t jobs = 0;
+    uint64_t deadline_misses = 0;
+    zx_duration_t last_job_duration = 0;
+    zx_duration_t max_job_duration = 0;
+    zx_duration_t total_job_duration = 0;
+    std::vector<zx_duration_t> max_group_duration;
+  };
+
   ~StandardOutputBase() override;
 
+  // Returns a snapshot of this output's mix counters.  May be called from any
+  // thread.
+  MixStats mix_stats() const {
+    fbl::AutoLock lock(&mix_stats_lock_);
+    return mix_stats_;
+  }
+
  protected:
   struct MixJob {
     // Job state set up once by an output implementation, used by all AudioOuts.
@@ -87,11 +113,18 @@ class StandardOutputBase : public AudioOutput {
   void ForeachLink(TaskType task_type)
       FXL_EXCLUSIVE_LOCKS_REQUIRED(mix_domain_->token());
 
+  // Process every num_groups'th link in source_link_refs_, starting with the
+  // link at index group, using the supplied job state and intermediate buffer.
+  void ProcessLinks(TaskType task_type, uint32_t group, uint32_t num_groups,
+                    MixJob* job, float* mix_buf)
+      FXL_EXCLUSIVE_LOCKS_REQUIRED(mix_domain_->token());
+
   bool SetupMix(const fbl::RefPtr<AudioRendererImpl>& audio_renderer,
-                Bookkeeping* info)
+                Bookkeeping* info, MixJob* job)
       FXL_EXCLUSIVE_LOCKS_REQUIRED(mix_domain_->token());
   bool ProcessMix(const fbl::RefPtr<AudioRendererImpl>& audio_renderer,
-                  Bookkeeping* info, const fbl::RefPtr<AudioPacketRef>& pkt_ref)
+                  Bookkeeping* info, const fbl::RefPtr<AudioPacketRef>& pkt_ref,
+                  MixJob* job, float* mix_buf)
       FXL_EXCLUSIVE_LOCKS_REQUIRED(mix_domain_->token());
 
   bool SetupTrim(const fbl::RefPtr<AudioRendererImpl>& audio_renderer,
@@ -102,6 +135,26 @@ class StandardOutputBase : public AudioOutput {
                    const fbl::RefPtr<AudioPacketRef>& pkt_ref)
       FXL_EXCLUSIVE_LOCKS_REQUIRED(mix_domain_->token());
 
+  // Mix one group's share of the links into its intermediate buffer, recording
+  // how long that took.  Runs on the mix thread for group 0, and on a mix
+  // worker for the others.
+  void MixGroup(uint32_t group, uint32_t num_groups)
+      FXL_EXCLUSIVE_LOCKS_REQUIRED(mix_domain_->token());
+
+  // Mix workers only run while the mix thread, which holds the mix domain's
+  // token, waits for them in MixWorkerPool::Run; they act on its behalf and
+  // touch no state that another group does.  This tells the thread safety
+  // analysis as much.
+  void AssertMixDomainHeldForWorker() const
+      FXL_ASSERT_EXCLUSIVE_LOCK(mix_domain_->token()) {}
+
+  // Intermediate buffer for the given mix group; group 0 uses mix_buf_.
+  float* group_mix_buf(uint32_t group)
+      FXL_EXCLUSIVE_LOCKS_REQUIRED(mix_domain_->token());
+
+  void UpdateMixStats(fxl::TimePoint mix_start)
+      FXL_EXCLUSIVE_LOCKS_REQUIRED(mix_domain_->token());
+
   fxl::TimePoint next_sched_time_;
   bool next_sched_time_known_;
 
@@ -117,6 +170,20 @@ class StandardOutputBase : public AudioOutput {
   // State used by the mix task.
   MixJob cur_mix_job_;
 
+  // The number of groups our links are split into for mixing, plus the
+  // intermediate buffers (for groups other than the first) and workers used to
+  // mix them in parallel, when that number is greater than one.
+  uint32_t mix_groups_ = 1;
+  std::unique_ptr<float[]> group_mix_bufs_
+      FXL_GUARDED_BY(mix_domain_->token());
+  std::unique_ptr<MixWorkerPool> mix_pool_;
+  std::vector<zx_duration_t> group_durations_
+      FXL_GUARDED_BY(mix_domain_->token());
+
+  // Written by the mix thread, read by anyone who asks for the counters.
+  mutable fbl::Mutex mix_stats_lock_;
+  MixStats mix_stats_ FXL_GUARDED_BY(mix_stats_lock_);
+
   // State used by the trim task.
   int64_t trim_threshold_;
 };
@@ -0,0 +1,244 @@
+// Copyright 2018 The Fuchsia Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "garnet/bin/media/audio_core/audio_link_packet_source.h"
+
+#include <lib/zx/vmo.h>
+
+#include <atomic>
+#include <memory>
+#include <thread>
+#include <vector>
+
+#include "garnet/bin/media/audio_core/audio_core_impl.h"
+#include "garnet/bin/media/audio_core/audio_renderer_impl.h"
+#include "garnet/bin/media/audio_core/mixer/constants.h"
+#include "lib/gtest/test_loop_fixture.h"
+
+namespace media {
+namespace audio {
+namespace test {
+namespace {
+
+// Stands in for the output at the far end of the link; the tests play the part
+// of its mix thread themselves.
+class FakeDestination : public AudioObject {
+ public:
+  FakeDestination() : AudioObject(Type::Output) {}
+};
+
+class AudioLinkPacketSourceTest : public ::gtest::TestLoopFixture {
+ protected:
+  void SetUp() override {
+    ::gtest::TestLoopFixture::SetUp();
+
+    core_ = std::make_unique<AudioCoreImpl>();
+    // The device manager shuts the renderer down when the core goes away.
+    auto renderer =
+        AudioRendererImpl::Create(renderer_ptr_.NewRequest(), core_.get());
+    core_->GetDeviceManager().AddAudioRenderer(renderer);
+    fuchsia::media::AudioStreamType format;
+    format.sample_format = fuchsia::media::AudioSampleFormat::SIGNED_16;
+    format.channels = 2;
+    format.frames_per_second = 48000;
+    renderer->SetPcmStreamType(format);
+
+    link_ = AudioLinkPacketSource::Create(
+        std::move(renderer), fbl::AdoptRef(new FakeDestination()));
+    ASSERT_NE(nullptr, link_);
+
+    zx::vmo vmo;
+    ASSERT_EQ(ZX_OK, zx::vmo::create(4096, 0, &vmo));
+    payload_ = fbl::AdoptRef(new RefCountedVmoMapper());
+    ASSERT_EQ(ZX_OK, payload_->Map(vmo, 0, 0, ZX_VM_PERM_READ));
+  }
+
+  void TearDown() override {
+    link_.reset();
+    RunLoopUntilIdle();
+    core_.reset();
+    ::gtest::TestLoopFixture::TearDown();
+  }
+
+  // Returns packet |id|, whose send-packet callback records its id in
+  // released_.  Safe to call from any thread.
+  fbl::RefPtr<AudioPacketRef> MakePacket(uint32_t id) {
+    fuchsia::media::StreamPacket packet;
+    packet.payload_size = 4;
+    return AudioPacketRef::Create(
+        payload_, [this, id]() { released_.push_back(id); }, std::move(packet),
+        core_.get(), 1u << kPtsFractionalBits,
+        static_cast<int64_t>(id) << kPtsFractionalBits);
+  }
+
+  // Returns a flush token whose callback counts completed flushes.
+  fbl::RefPtr<PendingFlushToken> MakeFlushToken() {
+    return PendingFlushToken::Create(core_.get(),
+                                     [this]() { ++flushes_completed_; });
+  }
+
+  // Locks the front of the queue, returning its id (or -1 if the queue is
+  // empty) and whether a flush was reported.
+  int64_t LockFront(bool* was_flushed) {
+    auto pkt = link_->LockPendingQueueFront(was_flushed);
+    return pkt ? (pkt->start_pts() >> kPtsFractionalBits) : -1;
+  }
+
+  std::unique_ptr<AudioCoreImpl> core_;
+  fuchsia::media::AudioRendererPtr renderer_ptr_;
+  std::shared_ptr<AudioLinkPacketSource> link_;
+  fbl::RefPtr<RefCountedVmoMapper> payload_;
+
+  // Written by callbacks on the test loop.
+  std::vector<uint32_t> released_;
+  uint32_t flushes_completed_ = 0;
+};
+
+// Packets come out of the queue in order, and are released once the
+// destination is done with them.
+TEST_F(AudioLinkPacketSourceTest, LockFrontInOrder) {
+  constexpr uint32_t kPackets = 100;  // Spans several queue segments.
+  for (uint32_t id = 0; id < kPackets; ++id) {
+    link_->PushToPendingQueue(MakePacket(id));
+  }
+
+  for (uint32_t id = 0; id < kPackets; ++id) {
+    bool was_flushed;
+    EXPECT_EQ(id, LockFront(&was_flushed));
+    // A new link reports a flush, so the destination starts from scratch.
+    EXPECT_EQ(id == 0, was_flushed);
+    link_->UnlockPendingQueueFront(true);
+  }
+
+  bool was_flushed;
+  EXPECT_EQ(-1, LockFront(&was_flushed));
+  EXPECT_FALSE(was_flushed);
+  link_->UnlockPendingQueueFront(false);
+  EXPECT_TRUE(link_->pending_queue_empty());
+
+  RunLoopUntilIdle();
+  ASSERT_EQ(kPackets, released_.size());
+  for (uint32_t id = 0; id < kPackets; ++id) {
+    EXPECT_EQ(id, released_[id]);
+  }
+}
+
+// A flush which arrives while the destination holds the queue is applied when
+// the destination unlocks it, and is reported by the next lock, not before.
+TEST_F(AudioLinkPacketSourceTest, FlushWhileLockedIsDeferred) {
+  bool was_flushed;
+  EXPECT_EQ(-1, LockFront(&was_flushed));
+  EXPECT_TRUE(was_flushed);
+  link_->UnlockPendingQueueFront(false);
+
+  link_->PushToPendingQueue(MakePacket(0));
+  link_->PushToPendingQueue(MakePacket(1));
+  EXPECT_EQ(0, LockFront(&was_flushed));
+  EXPECT_FALSE(was_flushed);
+
+  link_->FlushPendingQueue(MakeFlushToken());
+  link_->PushToPendingQueue(MakePacket(2));
+  RunLoopUntilIdle();
+  EXPECT_TRUE(released_.empty());
+  EXPECT_EQ(0u, flushes_completed_);
+
+  link_->UnlockPendingQueueFront(false);
+  RunLoopUntilIdle();
+  EXPECT_EQ(std::vector<uint32_t>({0, 1}), released_);
+  EXPECT_EQ(1u, flushes_completed_);
+
+  EXPECT_EQ(2, LockFront(&was_flushed));
+  EXPECT_TRUE(was_flushed);
+  link_->UnlockPendingQueueFront(true);
+
+  EXPECT_EQ(-1, LockFront(&was_flushed));
+  EXPECT_FALSE(was_flushed);
+  link_->UnlockPendingQueueFront(false);
+}
+
+// A flush applied by the source while the destination is idle is reported by
+// the destination's next lock.
+TEST_F(AudioLinkPacketSourceTest, FlushWhileIdleIsReported) {
+  bool was_flushed;
+  EXPECT_EQ(-1, LockFront(&was_flushed));
+  link_->UnlockPendingQueueFront(false);
+
+  link_->PushToPendingQueue(MakePacket(0));
+  link_->FlushPendingQueue(MakeFlushToken());
+  RunLoopUntilIdle();
+  EXPECT_EQ(std::vector<uint32_t>({0}), released_);
+  EXPECT_EQ(1u, flushes_completed_);
+
+  link_->PushToPendingQueue(MakePacket(1));
+  EXPECT_EQ(1, LockFront(&was_flushed));
+  EXPECT_TRUE(was_flushed);
+  link_->UnlockPendingQueueFront(true);
+}
+
+// A source thread pushing and flushing races a destination thread locking and
+// releasing the front.  Every packet is released exactly once and in order,
+// every flush completes, and whenever the destination finds that packets were
+// flushed out from under it, it was told about the flush.
+TEST_F(AudioLinkPacketSourceTest, ConcurrentPushFlushAndLockFront) {
+  constexpr uint32_t kPackets = 20000;
+  constexpr uint32_t kPacketsPerFlush = 97;
+
+  std::atomic<bool> source_done{false};
+  uint32_t flushes = 0;
+  std::thread source([this, &source_done, &flushes]() {
+    for (uint32_t id = 0; id < kPackets; ++id) {
+      link_->PushToPendingQueue(MakePacket(id));
+      if ((id % kPacketsPerFlush) == kPacketsPerFlush - 1) {
+        link_->FlushPendingQueue(MakeFlushToken());
+        ++flushes;
+      }
+    }
+    source_done = true;
+  });
+
+  uint32_t unreported_gaps = 0;
+  uint32_t packets_mixed = 0;
+  std::thread destination([this, &source_done, &unreported_gaps,
+                           &packets_mixed]() {
+    int64_t next_id = 0;
+    while (!source_done || !link_->pending_queue_empty()) {
+      bool was_flushed;
+      auto pkt = link_->LockPendingQueueFront(&was_flushed);
+      if (pkt == nullptr) {
+        link_->UnlockPendingQueueFront(false);
+        continue;
+      }
+
+      int64_t id = pkt->start_pts() >> kPtsFractionalBits;
+      EXPECT_GE(id, next_id);
+      if ((id != next_id) && !was_flushed) {
+        ++unreported_gaps;
+      }
+      next_id = id + 1;
+      ++packets_mixed;
+
+      // Drop our reference first, so that the queue's is the last one and the
+      // packet is released in queue order.
+      pkt.reset();
+      link_->UnlockPendingQueueFront(true);
+    }
+  });
+
+  source.join();
+  destination.join();
+  EXPECT_EQ(0u, unreported_gaps);
+  EXPECT_GT(packets_mixed, 0u);
+
+  RunLoopUntilIdle();
+  ASSERT_EQ(kPackets, released_.size());
+  for (uint32_t id = 0; id < kPackets; ++id) {
+    ASSERT_EQ(id, released_[id]);
+  }
+  EXPECT_EQ(flushes, flushes_completed_);
+}
+
+}  // namespace
+}  // namespace test
+}  // namespace audio
+}  // namespace media
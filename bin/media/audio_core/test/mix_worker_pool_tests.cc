@@ -0,0 +1,95 @@
+// Copyright 2018 The Fuchsia Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include <atomic>
+#include <chrono>
+#include <thread>
+
+#include "garnet/bin/media/audio_core/mix_worker_pool.h"
+#include "gtest/gtest.h"
+
+namespace media {
+namespace audio {
+namespace test {
+
+// Every task of a batch runs exactly once, with task 0 on the calling thread
+// and the others elsewhere.
+TEST(MixWorkerPoolTest, RunsEachTaskOnce) {
+  MixWorkerPool pool(3);
+  ASSERT_EQ(3u, pool.num_workers());
+
+  std::atomic<uint32_t> runs[4] = {};
+  std::thread::id task_threads[4];
+  pool.Run(4, [&runs, &task_threads](uint32_t task_index) {
+    ASSERT_LT(task_index, 4u);
+    ++runs[task_index];
+    task_threads[task_index] = std::this_thread::get_id();
+  });
+
+  for (uint32_t i = 0; i < 4; ++i) {
+    EXPECT_EQ(1u, runs[i].load()) << "task " << i;
+  }
+  EXPECT_EQ(std::this_thread::get_id(), task_threads[0]);
+  for (uint32_t i = 1; i < 4; ++i) {
+    EXPECT_NE(std::this_thread::get_id(), task_threads[i]) << "task " << i;
+  }
+}
+
+// A batch may use fewer tasks than there are workers; the idle workers don't
+// run anything, and later batches still reach every worker.
+TEST(MixWorkerPoolTest, FewerTasksThanWorkers) {
+  MixWorkerPool pool(3);
+
+  std::atomic<uint32_t> runs[4] = {};
+  auto task = [&runs](uint32_t task_index) { ++runs[task_index]; };
+
+  pool.Run(1, task);
+  pool.Run(2, task);
+  pool.Run(4, task);
+
+  EXPECT_EQ(3u, runs[0].load());
+  EXPECT_EQ(2u, runs[1].load());
+  EXPECT_EQ(1u, runs[2].load());
+  EXPECT_EQ(1u, runs[3].load());
+}
+
+// Run doesn't return until every task of the batch has completed, however
+// long the workers take, and consecutive batches don't overlap.
+TEST(MixWorkerPoolTest, RunWaitsForAllTasks) {
+  MixWorkerPool pool(3);
+
+  for (uint32_t batch = 0; batch < 100; ++batch) {
+    std::atomic<uint32_t> running{0};
+    std::atomic<uint32_t> completed{0};
+    pool.Run(4, [&running, &completed, batch](uint32_t task_index) {
+      EXPECT_LT(running++, 4u);
+      if (task_index == (batch % 4) && (batch % 10) == 0) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(5));
+      }
+      --running;
+      ++completed;
+    });
+
+    EXPECT_EQ(0u, running.load());
+    EXPECT_EQ(4u, completed.load());
+  }
+}
+
+// Destroying a pool joins its workers, whether or not it has run anything.
+TEST(MixWorkerPoolTest, Shutdown) {
+  { MixWorkerPool pool(4); }
+
+  std::atomic<uint32_t> runs{0};
+  {
+    MixWorkerPool pool(4);
+    pool.Run(5, [&runs](uint32_t task_index) { ++runs; });
+  }
+  EXPECT_EQ(5u, runs.load());
+
+  { MixWorkerPool pool(0); }
+}
+
+}  // namespace test
+}  // namespace audio
+}  // namespace media
@@ -0,0 +1,215 @@
+// Copyright 2018 The Fuchsia Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include <lib/zx/vmo.h>
+
+#include <condition_variable>
+#include <mutex>
+#include <vector>
+
+#include "garnet/bin/media/audio_core/audio_core_impl.h"
+#include "garnet/bin/media/audio_core/audio_device_manager.h"
+#include "garnet/bin/media/audio_core/audio_renderer_impl.h"
+#include "garnet/bin/media/audio_core/standard_output_base.h"
+#include "lib/gtest/test_loop_fixture.h"
+
+namespace media {
+namespace audio {
+namespace test {
+namespace {
+
+constexpr uint32_t kFramesPerSecond = 48000;
+constexpr uint32_t kChannels = 2;
+constexpr uint32_t kMixFrames = 480;
+constexpr uint32_t kNumRenderers = 5;
+
+// Output which mixes one job on request, into a buffer the test can inspect,
+// instead of into a driver's ring buffer.
+class TestOutput : public StandardOutputBase {
+ public:
+  static fbl::RefPtr<TestOutput> Create(AudioDeviceManager* manager) {
+    return fbl::AdoptRef(new TestOutput(manager));
+  }
+
+  ~TestOutput() override {}
+
+  // Mixes kMixFrames frames, the first of which is presented at |start_time|,
+  // and returns them.
+  std::vector<float> Mix(zx_time_t start_time) {
+    std::unique_lock<std::mutex> lock(mutex_);
+    local_to_output_ = TimelineFunction(
+        0, start_time, TimelineRate(kFramesPerSecond, ZX_SEC(1)));
+    output_.assign(kMixFrames * kChannels, 0.0f);
+    mix_requested_ = true;
+    mix_done_ = false;
+
+    Wakeup();
+    mix_done_cv_.wait(lock, [this] { return mix_done_; });
+    return output_;
+  }
+
+ protected:
+  zx_status_t Init() override {
+    zx_status_t res = StandardOutputBase::Init();
+    if (res != ZX_OK) {
+      return res;
+    }
+
+    fuchsia::media::AudioStreamTypePtr config(
+        fuchsia::media::AudioStreamType::New());
+    config->sample_format = fuchsia::media::AudioSampleFormat::FLOAT;
+    config->channels = kChannels;
+    config->frames_per_second = kFramesPerSecond;
+    output_producer_ = OutputProducer::Select(config);
+    return (output_producer_ == nullptr) ? ZX_ERR_NOT_SUPPORTED : ZX_OK;
+  }
+
+  void OnWakeup() FXL_EXCLUSIVE_LOCKS_REQUIRED(mix_domain_->token()) override {
+    if (!mix_buffer_set_up_) {
+      SetupMixBuffer(kMixFrames);
+      mix_buffer_set_up_ = true;
+    }
+
+    SetNextSchedTime(fxl::TimePoint::Now());
+    Process();
+  }
+
+  bool StartMixJob(MixJob* job, fxl::TimePoint process_start) override {
+    SetNextSchedDelay(fxl::TimeDelta::FromMilliseconds(10));
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (!mix_requested_) {
+      return false;
+    }
+    mix_requested_ = false;
+
+    job->buf = output_.data();
+    job->buf_frames = kMixFrames;
+    job->start_pts_of = 0;
+    job->local_to_output = &local_to_output_;
+    job->local_to_output_gen = ++local_to_output_gen_;
+    job->accumulate = false;
+    job->sw_output_gain_db = 0.0f;
+    job->sw_output_muted = false;
+    return true;
+  }
+
+  bool FinishMixJob(const MixJob& job) override {
+    std::lock_guard<std::mutex> lock(mutex_);
+    mix_done_ = true;
+    mix_done_cv_.notify_all();
+    return false;
+  }
+
+ private:
+  explicit TestOutput(AudioDeviceManager* manager)
+      : StandardOutputBase(manager) {}
+
+  bool mix_buffer_set_up_ = false;
+
+  std::mutex mutex_;
+  std::condition_variable mix_done_cv_;
+  bool mix_requested_ = false;
+  bool mix_done_ = false;
+  TimelineFunction local_to_output_;
+  uint32_t local_to_output_gen_ = kInvalidGenerationId;
+  std::vector<float> output_;
+};
+
+class StandardOutputBaseTest : public ::gtest::TestLoopFixture {
+ protected:
+  // Links kNumRenderers renderers, each playing a different signal, to an
+  // output which splits them into |mix_groups| groups, and mixes one job.
+  std::vector<float> MixRenderers(uint32_t mix_groups,
+                                  StandardOutputBase::MixStats* stats_out) {
+    AudioCoreImpl core(mix_groups);
+    AudioDeviceManager& manager = core.GetDeviceManager();
+
+    auto output = TestOutput::Create(&manager);
+    EXPECT_EQ(ZX_OK, manager.AddDevice(output));
+
+    // Present the signals well in the future, so that nothing else (such as
+    // the throttle output) releases the packets before we mix them.
+    zx_time_t start_time = zx_clock_get(ZX_CLOCK_MONOTONIC) + ZX_SEC(10);
+
+    std::vector<fuchsia::media::AudioRendererPtr> renderer_ptrs(kNumRenderers);
+    for (uint32_t r = 0; r < kNumRenderers; ++r) {
+      auto renderer =
+          AudioRendererImpl::Create(renderer_ptrs[r].NewRequest(), &core);
+      manager.AddAudioRenderer(renderer);
+
+      fuchsia::media::AudioStreamType format;
+      format.sample_format = fuchsia::media::AudioSampleFormat::SIGNED_16;
+      format.channels = kChannels;
+      format.frames_per_second = kFramesPerSecond;
+      renderer->SetPcmStreamType(format);
+      manager.LinkOutputToAudioRenderer(output.get(), renderer.get());
+
+      // Each packet outlasts the mix job, so the output does not release it
+      // either.
+      std::vector<int16_t> payload(2 * kMixFrames * kChannels);
+      for (size_t i = 0; i < payload.size(); ++i) {
+        int32_t frame = static_cast<int32_t>(i / kChannels);
+        int32_t sign = (i % kChannels) ? -1 : 1;
+        payload[i] = static_cast<int16_t>(
+            sign * 8 * (static_cast<int32_t>(r + 1) * (frame % 64) - 100));
+      }
+
+      size_t payload_size = payload.size() * sizeof(payload[0]);
+      zx::vmo vmo;
+      EXPECT_EQ(ZX_OK, zx::vmo::create(payload_size, 0, &vmo));
+      EXPECT_EQ(ZX_OK, vmo.write(payload.data(), 0, payload_size));
+      renderer->AddPayloadBuffer(0, std::move(vmo));
+
+      fuchsia::media::StreamPacket packet;
+      packet.pts = 0;
+      packet.payload_buffer_id = 0;
+      packet.payload_offset = 0;
+      packet.payload_size = payload_size;
+      renderer->SendPacketNoReply(std::move(packet));
+      renderer->PlayNoReply(start_time, 0);
+    }
+
+    std::vector<float> result = output->Mix(start_time);
+    *stats_out = output->mix_stats();
+    return result;
+  }
+};
+
+// Mixing the same renderer links in groups on the mix workers produces the
+// same output as mixing them all on the mix thread, and the output's counters
+// record the jobs.
+TEST_F(StandardOutputBaseTest, GroupedMixMatchesSerialMix) {
+  constexpr uint32_t kMixGroups = 3;
+
+  StandardOutputBase::MixStats serial_stats;
+  std::vector<float> serial = MixRenderers(1, &serial_stats);
+  StandardOutputBase::MixStats grouped_stats;
+  std::vector<float> grouped = MixRenderers(kMixGroups, &grouped_stats);
+
+  ASSERT_EQ(serial.size(), grouped.size());
+  bool silent = true;
+  for (size_t i = 0; i < serial.size(); ++i) {
+    // Only the order in which the renderers' contributions are summed differs.
+    ASSERT_FLOAT_EQ(serial[i], grouped[i]) << "sample " << i;
+    silent = silent && (serial[i] == 0.0f);
+  }
+  EXPECT_FALSE(silent);
+
+  EXPECT_EQ(1u, serial_stats.jobs);
+  EXPECT_EQ(0u, serial_stats.deadline_misses);
+  EXPECT_TRUE(serial_stats.max_group_duration.empty());
+
+  EXPECT_EQ(1u, grouped_stats.jobs);
+  EXPECT_EQ(0u, grouped_stats.deadline_misses);
+  ASSERT_EQ(kMixGroups, grouped_stats.max_group_duration.size());
+  for (uint32_t group = 0; group < kMixGroups; ++group) {
+    EXPECT_GT(grouped_stats.max_group_duration[group], 0) << "group " << group;
+  }
+}
+
+}  // namespace
+}  // namespace test
+}  // namespace audio
+}  // namespace media
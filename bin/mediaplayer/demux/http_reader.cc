@@ -26,6 +26,9 @@ constexpr uint32_t kStatusOk = 200u;
 constexpr uint32_t kStatusPartialContent = 206u;
 constexpr uint32_t kStatusNotFound = 404u;
 
+// Maximum number of concurrent range requests per reader.
+constexpr size_t kMaxConnections = 3;
+
 }  // namespace
 
 // static
@@ -41,10 +44,13 @@ HttpReader::HttpReader(
     : url_(url),
       headers_(std::move(headers)),
       ready_(async_get_default_dispatcher()) {
-  http::HttpServicePtr network_service =
+  network_service_ =
       startup_context->ConnectToEnvironmentService<http::HttpService>();
 
-  network_service->CreateURLLoader(url_loader_.NewRequest());
+  // The first connection performs the HEAD request.
+  connections_.push_back(std::make_unique<Connection>());
+  network_service_->CreateURLLoader(
+      connections_.front()->url_loader.NewRequest());
 
   http::URLRequest url_request;
   url_request.url = url_;
@@ -54,8 +60,9 @@ HttpReader::HttpReader(
     url_request.headers = fidl::Clone(headers_);
   }
 
-  url_loader_->Start(std::move(url_request), [this](
-                                                 http::URLResponse response) {
+  http::URLLoaderPtr& url_loader = connections_.front()->url_loader;
+  url_loader->Start(std::move(url_request), [this](
+                                                http::URLResponse response) {
     if (response.error) {
       FXL_LOG(ERROR) << "HEAD response error " << response.error->code << " "
                      << (response.error->description
@@ -111,112 +118,171 @@ void HttpReader::ReadAt(size_t position, uint8_t* buffer, size_t bytes_to_read,
       return;
     }
 
-    read_at_position_ = position;
-    read_at_buffer_ = buffer;
+    if (position >= size_) {
+      callback(Result::kOk, 0);
+      return;
+    }
 
-    if (read_at_position_ + bytes_to_read > size_) {
-      read_at_bytes_to_read_ = size_ - read_at_position_;
-    } else {
-      read_at_bytes_to_read_ = bytes_to_read;
+    if (position + bytes_to_read > size_) {
+      bytes_to_read = size_ - position;
     }
 
-    read_at_bytes_remaining_ = read_at_bytes_to_read_;
-    read_at_callback_ = std::move(callback);
+    Connection* connection = IdleConnectionFor(position, bytes_to_read);
+    if (connection == nullptr) {
+      FXL_LOG(ERROR) << "ReadAt called with " << kMaxConnections
+                     << " reads already pending.";
+      callback(Result::kInternalError, 0);
+      return;
+    }
 
-    if (!socket_ || socket_position_ != read_at_position_) {
-      socket_.reset();
-      socket_position_ = kUnknownSize;
-      LoadAndReadFromSocket();
+    connection->busy = true;
+    connection->read_at_position = position;
+    connection->read_at_buffer = buffer;
+    connection->read_at_bytes_to_read = bytes_to_read;
+    connection->read_at_bytes_remaining = bytes_to_read;
+    connection->read_at_callback = std::move(callback);
+
+    if (!CanContinueRead(*connection, position, bytes_to_read)) {
+      connection->socket.reset();
+      connection->socket_position = kUnknownSize;
+      connection->socket_end = kUnknownSize;
+      LoadAndReadFromSocket(connection);
       return;
     }
 
-    ReadFromSocket();
+    ReadFromSocket(connection);
   });
 }
 
-void HttpReader::ReadFromSocket() {
+size_t HttpReader::max_concurrent_reads() const {
+  // Without range support, reads have to be sequential anyway.
+  return can_seek_ ? kMaxConnections : 1;
+}
+
+// static
+bool HttpReader::CanContinueRead(const Connection& connection, size_t position,
+                                 size_t bytes_to_read) {
+  return connection.socket && connection.socket_position == position &&
+         position + bytes_to_read <= connection.socket_end;
+}
+
+HttpReader::Connection* HttpReader::IdleConnectionFor(size_t position,
+                                                      size_t bytes_to_read) {
+  Connection* result = nullptr;
+
+  for (auto& connection : connections_) {
+    if (connection->busy) {
+      continue;
+    }
+
+    if (CanContinueRead(*connection, position, bytes_to_read)) {
+      // This connection can continue reading where it left off.
+      return connection.get();
+    }
+
+    if (result == nullptr) {
+      result = connection.get();
+    }
+  }
+
+  if (result == nullptr && connections_.size() < kMaxConnections) {
+    connections_.push_back(std::make_unique<Connection>());
+    result = connections_.back().get();
+    network_service_->CreateURLLoader(result->url_loader.NewRequest());
+  }
+
+  return result;
+}
+
+void HttpReader::ReadFromSocket(Connection* connection) {
   while (true) {
     size_t byte_count = 0;
-    zx_status_t status = socket_.read(0u, read_at_buffer_,
-                                      read_at_bytes_remaining_, &byte_count);
+    zx_status_t status = connection->socket.read(
+        0u, connection->read_at_buffer, connection->read_at_bytes_remaining,
+        &byte_count);
 
     if (status == ZX_ERR_SHOULD_WAIT) {
-      waiter_ = std::make_unique<async::Wait>(
-          socket_.get(), ZX_SOCKET_READABLE | ZX_SOCKET_PEER_CLOSED);
-
-      waiter_->set_handler([this](async_dispatcher_t* dispatcher,
-                                  async::Wait* wait, zx_status_t status,
-                                  const zx_packet_signal_t* signal) {
-        if (status != ZX_OK) {
-          if (status != ZX_ERR_CANCELED) {
-            FXL_LOG(ERROR) << "AsyncWait failed, status " << status;
-          }
-
-          FailReadAt(status);
-          return;
-        }
+      connection->waiter = std::make_unique<async::Wait>(
+          connection->socket.get(), ZX_SOCKET_READABLE | ZX_SOCKET_PEER_CLOSED);
 
-        ReadFromSocket();
-      });
+      connection->waiter->set_handler(
+          [this, connection](async_dispatcher_t* dispatcher, async::Wait* wait,
+                             zx_status_t status,
+                             const zx_packet_signal_t* signal) {
+            if (status != ZX_OK) {
+              if (status != ZX_ERR_CANCELED) {
+                FXL_LOG(ERROR) << "AsyncWait failed, status " << status;
+              }
 
-      waiter_->Begin(async_get_default_dispatcher());
+              FailReadAt(connection, status);
+              return;
+            }
+
+            ReadFromSocket(connection);
+          });
+
+      connection->waiter->Begin(async_get_default_dispatcher());
 
       break;
     }
 
-    waiter_.reset();
+    connection->waiter.reset();
 
     if (status != ZX_OK) {
       FXL_LOG(ERROR) << "zx::socket::read failed, status " << status;
-      FailReadAt(status);
+      FailReadAt(connection, status);
       break;
     }
 
-    read_at_buffer_ += byte_count;
-    read_at_bytes_remaining_ -= byte_count;
-    socket_position_ += byte_count;
+    connection->read_at_buffer += byte_count;
+    connection->read_at_bytes_remaining -= byte_count;
+    connection->socket_position += byte_count;
 
-    if (read_at_bytes_remaining_ == 0) {
-      CompleteReadAt(Result::kOk, read_at_bytes_to_read_);
+    if (connection->read_at_bytes_remaining == 0) {
+      CompleteReadAt(connection, Result::kOk,
+                     connection->read_at_bytes_to_read);
       break;
     }
   }
 }
 
-void HttpReader::CompleteReadAt(Result result, size_t bytes_read) {
+void HttpReader::CompleteReadAt(Connection* connection, Result result,
+                                size_t bytes_read) {
   ReadAtCallback read_at_callback;
-  read_at_callback_.swap(read_at_callback);
+  connection->read_at_callback.swap(read_at_callback);
+  connection->busy = false;
   read_at_callback(result, bytes_read);
 }
 
-void HttpReader::FailReadAt(zx_status_t status) {
+void HttpReader::FailReadAt(Connection* connection, zx_status_t status) {
   switch (status) {
     case ZX_ERR_PEER_CLOSED:
-      FailReadAt(Result::kPeerClosed);
+      FailReadAt(connection, Result::kPeerClosed);
       break;
     case ZX_ERR_CANCELED:
-      FailReadAt(Result::kCancelled);
+      FailReadAt(connection, Result::kCancelled);
       break;
     // TODO(dalesat): Expect more statuses here.
     default:
       FXL_LOG(ERROR) << "Unexpected status " << status;
-      FailReadAt(Result::kUnknownError);
+      FailReadAt(connection, Result::kUnknownError);
       break;
   }
 }
 
-void HttpReader::FailReadAt(Result result) {
+void HttpReader::FailReadAt(Connection* connection, Result result) {
   result_ = result;
-  socket_.reset();
-  socket_position_ = kUnknownSize;
-  CompleteReadAt(result_, 0);
+  connection->socket.reset();
+  connection->socket_position = kUnknownSize;
+  connection->socket_end = kUnknownSize;
+  CompleteReadAt(connection, result_, 0);
 }
 
-void HttpReader::LoadAndReadFromSocket() {
-  FXL_DCHECK(!socket_);
+void HttpReader::LoadAndReadFromSocket(Connection* connection) {
+  FXL_DCHECK(!connection->socket);
 
-  if (!can_seek_ && read_at_position_ != 0) {
-    FailReadAt(Result::kInvalidArgument);
+  if (!can_seek_ && connection->read_at_position != 0) {
+    FailReadAt(connection, Result::kInvalidArgument);
     return;
   }
 
@@ -228,9 +294,16 @@ void HttpReader::LoadAndReadFromSocket() {
     request.headers = fidl::Clone(headers_);
   }
 
-  if (read_at_position_ != 0) {
+  // Request only the bytes this read needs. An open-ended range would have to
+  // be abandoned, and a new request made, whenever the next read on this
+  // connection isn't contiguous with this one, which is usually the case when
+  // the reads are spread over several connections.
+  if (can_seek_) {
     std::ostringstream value;
-    value << kAcceptRangesHeaderBytesValue << "=" << read_at_position_ << "-";
+    value << kAcceptRangesHeaderBytesValue << "="
+          << connection->read_at_position << "-"
+          << connection->read_at_position +
+                 connection->read_at_bytes_to_read - 1;
 
     http::HttpHeader header;
     header.name = kRangeHeaderName;
@@ -238,19 +311,26 @@ void HttpReader::LoadAndReadFromSocket() {
     request.headers.push_back(std::move(header));
   }
 
-  url_loader_->Start(std::move(request), [this](http::URLResponse response) {
-    if (response.status_code != kStatusOk &&
-        response.status_code != kStatusPartialContent) {
-      FXL_LOG(WARNING) << "GET response status code " << response.status_code;
-      FailReadAt(Result::kUnknownError);
-      return;
-    }
+  connection->url_loader->Start(
+      std::move(request), [this, connection](http::URLResponse response) {
+        if (response.status_code != kStatusOk &&
+            response.status_code != kStatusPartialContent) {
+          FXL_LOG(WARNING) << "GET response status code "
+                           << response.status_code;
+          FailReadAt(connection, Result::kUnknownError);
+          return;
+        }
 
-    socket_ = std::move(response.body->stream());
-    socket_position_ = read_at_position_;
+        connection->socket = std::move(response.body->stream());
+        connection->socket_position = connection->read_at_position;
+        connection->socket_end =
+            response.status_code == kStatusPartialContent
+                ? connection->read_at_position +
+                      connection->read_at_bytes_to_read
+                : size_;
 
-    ReadFromSocket();
-  });
+        ReadFromSocket(connection);
+      });
 }
 
 }  // namespace media_player
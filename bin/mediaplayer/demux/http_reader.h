@@ -6,6 +6,7 @@
 #define GARNET_BIN_MEDIAPLAYER_DEMUX_HTTP_READER_H_
 
 #include <string>
+#include <vector>
 
 #include <fuchsia/net/oldhttp/cpp/fidl.h>
 #include <lib/async/cpp/wait.h>
@@ -35,39 +36,65 @@ class HttpReader : public Reader {
   void ReadAt(size_t position, uint8_t* buffer, size_t bytes_to_read,
               ReadAtCallback callback) override;
 
+  size_t max_concurrent_reads() const override;
+
  private:
-  // Reads from an open |socket_|.
-  void ReadFromSocket();
+  // A URL loader and the socket of its most recent GET response. Each
+  // connection services one ReadAt at a time, so concurrent ReadAt calls fetch
+  // their ranges in parallel.
+  struct Connection {
+    ::fuchsia::net::oldhttp::URLLoaderPtr url_loader;
+    zx::socket socket;
+    std::unique_ptr<async::Wait> waiter;
+    // Position of the next byte to be read from |socket|.
+    size_t socket_position = kUnknownSize;
+    // Position just past the last byte the response on |socket| will deliver.
+    size_t socket_end = kUnknownSize;
+    bool busy = false;
+
+    // Pending ReadAt parameters.
+    size_t read_at_position;
+    uint8_t* read_at_buffer;
+    size_t read_at_bytes_to_read;
+    size_t read_at_bytes_remaining;
+    ReadAtCallback read_at_callback;
+  };
+
+  // Determines whether |connection|'s socket can deliver |bytes_to_read| bytes
+  // at |position| without a new request. This is only the case for a read
+  // contiguous with the previous one that lies within the range requested.
+  static bool CanContinueRead(const Connection& connection, size_t position,
+                              size_t bytes_to_read);
+
+  // Returns an idle connection for a read of |bytes_to_read| bytes at
+  // |position|, preferring one that can continue reading where it left off.
+  // Returns nullptr if all |kMaxConnections| connections are busy.
+  Connection* IdleConnectionFor(size_t position, size_t bytes_to_read);
+
+  // Reads from an open socket.
+  void ReadFromSocket(Connection* connection);
 
   // Completes a pending ReadAt.
-  void CompleteReadAt(Result result, size_t bytes_read);
+  void CompleteReadAt(Connection* connection, Result result,
+                      size_t bytes_read);
 
   // Fails the pending ReadAt.
-  void FailReadAt(zx_status_t status);
+  void FailReadAt(Connection* connection, zx_status_t status);
 
   // Fails the pending ReadAt.
-  void FailReadAt(Result result);
+  void FailReadAt(Connection* connection, Result result);
 
   // Performs an HTTP load and reads from the resulting socket.
-  void LoadAndReadFromSocket();
+  void LoadAndReadFromSocket(Connection* connection);
 
   std::string url_;
   fidl::VectorPtr<fuchsia::net::oldhttp::HttpHeader> headers_;
-  ::fuchsia::net::oldhttp::URLLoaderPtr url_loader_;
+  ::fuchsia::net::oldhttp::HttpServicePtr network_service_;
+  std::vector<std::unique_ptr<Connection>> connections_;
   Result result_ = Result::kOk;
   uint64_t size_ = kUnknownSize;
   bool can_seek_ = false;
-  zx::socket socket_;
-  std::unique_ptr<async::Wait> waiter_;
-  size_t socket_position_ = kUnknownSize;
   Incident ready_;
-
-  // Pending ReadAt parameters.
-  size_t read_at_position_;
-  uint8_t* read_at_buffer_;
-  size_t read_at_bytes_to_read_;
-  size_t read_at_bytes_remaining_;
-  ReadAtCallback read_at_callback_;
 };
 
 }  // namespace media_player
@@ -35,6 +35,11 @@ class Reader {
   // callback.
   virtual void ReadAt(size_t position, uint8_t* buffer, size_t bytes_to_read,
                       ReadAtCallback callback) = 0;
+
+  // Returns the number of ReadAt calls the reader can service concurrently.
+  // Callers must not have more ReadAt calls than this outstanding at any
+  // time. The value is valid once Describe has called back.
+  virtual size_t max_concurrent_reads() const { return 1; }
 };
 
 }  // namespace media_player
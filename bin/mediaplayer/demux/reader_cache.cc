@@ -4,9 +4,13 @@
 
 #include "garnet/bin/mediaplayer/demux/reader_cache.h"
 
+#include <algorithm>
+
+#include "garnet/bin/mediaplayer/graph/formatting.h"
 #include "lib/async/cpp/task.h"
 #include "lib/async/default.h"
 #include "lib/fxl/logging.h"
+#include "lib/media/timeline/timeline.h"
 
 namespace media_player {
 namespace {
@@ -15,6 +19,19 @@ namespace {
 // upstream reader and whether our reads block the demuxer.
 static constexpr size_t kChunkSize = 256 * 1024;
 
+// Read-ahead never goes below this, so a stream of small reads still results
+// in reasonably large upstream reads.
+static constexpr size_t kMinReadAhead = 2 * kChunkSize;
+
+// Content consumed in this duration is always read ahead.
+static constexpr int64_t kMinReadAheadDuration =
+    media::Timeline::ns_from_seconds(2);
+
+// When upstream throughput is less than this multiple of the consumption rate,
+// read-ahead is extended proportionally, so a slow upstream reader has more
+// time to recover from hiccups.
+static constexpr double kComfortableHeadroom = 4.0;
+
 }  // namespace
 
 // static
@@ -30,10 +47,13 @@ ReaderCache::ReaderCache(std::shared_ptr<Reader> upstream_reader)
                                                      bool can_seek) {
     upstream_size_ = size;
     upstream_can_seek_ = can_seek;
+    upstream_max_reads_ =
+        std::max(upstream_reader->max_concurrent_reads(), size_t(1));
     last_result_ = result;
-    buffer_.Initialize(size);
+    buffer_.Initialize(size, capacity_);
 
-    async::PostTask(dispatcher_, [this]() { MaybeStartLoadForPosition(0); });
+    async::PostTask(dispatcher_,
+                    [this]() { MaybeStartLoadForPosition(0, 0); });
 
     describe_is_complete_.Occur();
   });
@@ -56,100 +76,335 @@ void ReaderCache::ReadAt(size_t position, uint8_t* buffer, size_t bytes_to_read,
                               callback = std::move(callback)]() mutable {
     FXL_DCHECK(position < upstream_size_);
 
-    size_t bytes_read = buffer_.ReadRange(position, bytes_to_read, buffer);
+    int64_t now = media::Timeline::local_now();
 
-    MaybeStartLoadForPosition(position);
+    // A read that doesn't follow the previous one is a seek, which shouldn't
+    // count as an interval in the consumption rate.
+    demand_rate_.AddSample(now, position == next_read_position_);
+    demand_sizes_.AddSample(bytes_to_read);
+    last_read_position_ = position;
+    next_read_position_ = position + bytes_to_read;
 
-    size_t remaining_bytes = upstream_size_ - position;
-    if ((bytes_read == bytes_to_read) || (bytes_read == remaining_bytes)) {
-      callback(Result::kOk, bytes_read);
+    PendingRead read{position, buffer, bytes_to_read, std::move(callback), now};
+    if (MaybeCompleteRead(&read)) {
+      ++hit_count_;
+      MaybeStartLoadForPosition(position, bytes_to_read);
       return;
     }
 
-    load_is_complete_.When([this, position, buffer, bytes_to_read,
-                            callback = std::move(callback)]() mutable {
-      ReadAt(position, buffer, bytes_to_read, std::move(callback));
-    });
+    ++miss_count_;
+    pending_reads_.push_back(std::move(read));
+    MaybeStartLoadForPosition(position, bytes_to_read);
   });
 }
 
 void ReaderCache::SetCacheOptions(size_t capacity, size_t max_backtrack) {
+  FXL_DCHECK(max_backtrack < capacity);
+  bool reinitialize = capacity != capacity_;
   capacity_ = capacity;
   max_backtrack_ = max_backtrack;
+
+  if (!reinitialize || !describe_is_complete_.occurred()) {
+    return;
+  }
+
+  // The upstream reader may be writing into the buffer, in which case we have
+  // to wait until it's done.
+  if (load_in_progress_) {
+    reinitialize_pending_ = true;
+    return;
+  }
+
+  buffer_.Initialize(upstream_size_, capacity_);
+}
+
+void ReaderCache::Dump(std::ostream& os) const {
+  os << fostr::NewLine << "reader cache:" << fostr::Indent;
+  os << fostr::NewLine << "capacity:            " << capacity_;
+  os << fostr::NewLine << "max backtrack:       " << max_backtrack_;
+  os << fostr::NewLine << "read-ahead:          " << ReadAheadSize();
+  os << fostr::NewLine << "reads in flight:     " << reads_in_flight_;
+  os << fostr::NewLine << "hits:                " << hit_count_;
+  os << fostr::NewLine << "misses:              " << miss_count_;
+
+  if (hit_count_ + miss_count_ != 0) {
+    os << fostr::NewLine << "hit rate:            "
+       << 100.0 * hit_count_ / (hit_count_ + miss_count_) << "%";
+  }
+
+  if (stall_durations_.count() != 0) {
+    os << fostr::NewLine << "total stall time:    "
+       << AsNs(stall_durations_.sum());
+    os << fostr::NewLine << "minimum stall:       "
+       << AsNs(stall_durations_.min());
+    os << fostr::NewLine << "average stall:       "
+       << AsNs(stall_durations_.average());
+    os << fostr::NewLine << "maximum stall:       "
+       << AsNs(stall_durations_.max());
+  }
+
+  if (upstream_read_sizes_.count() != 0) {
+    os << fostr::NewLine << "bytes prefetched:    "
+       << upstream_read_sizes_.sum();
+    os << fostr::NewLine << "upstream reads:      "
+       << upstream_read_sizes_.count();
+    os << fostr::NewLine << "average read time:   "
+       << AsNs(upstream_read_durations_.average());
+    os << fostr::NewLine << "upstream bytes/sec:  " << UpstreamThroughput();
+  }
+
+  if (demand_rate_.progress_interval_count() != 0) {
+    os << fostr::NewLine << "consumed bytes/sec:  " << ConsumptionRate();
+    os << fostr::NewLine << "reads:" << fostr::Indent << demand_rate_
+       << fostr::Outdent;
+  }
+
+  os << fostr::Outdent;
 }
 
-void ReaderCache::MaybeStartLoadForPosition(size_t position) {
-  std::pair<size_t, size_t> cache_range = CalculateCacheRange(position);
-  load_position_ = cache_range.first;
+bool ReaderCache::MaybeCompleteRead(PendingRead* read) {
+  FXL_DCHECK(read);
 
+  size_t bytes_read =
+      buffer_.ReadRange(read->position, read->bytes_to_read, read->buffer);
+
+  // A read larger than the cache can't be served in its entirety, so it's
+  // completed short once as much of it as the cache can hold is present.
+  size_t required_bytes = std::min(
+      {read->bytes_to_read, upstream_size_ - read->position, capacity_});
+  if (bytes_read < required_bytes) {
+    return false;
+  }
+
+  read->callback(Result::kOk, bytes_read);
+  return true;
+}
+
+void ReaderCache::CompletePendingReads() {
+  // Completing a read may result in a new ReadAt call, so we detach the list
+  // before iterating over it.
+  std::vector<PendingRead> reads;
+  reads.swap(pending_reads_);
+
+  for (auto& read : reads) {
+    if (load_result_ != Result::kOk) {
+      stall_durations_.AddSample(media::Timeline::local_now() -
+                                 read.start_time);
+      read.callback(load_result_, 0);
+      continue;
+    }
+
+    if (MaybeCompleteRead(&read)) {
+      stall_durations_.AddSample(media::Timeline::local_now() -
+                                 read.start_time);
+      continue;
+    }
+
+    pending_reads_.push_back(std::move(read));
+  }
+}
+
+void ReaderCache::MaybeStartLoadForPosition(size_t position,
+                                            size_t bytes_to_read) {
   if (load_in_progress_) {
+    if (position < load_start_ || position >= load_end_) {
+      // The reader has moved outside the range being loaded. Don't request
+      // any more of it. Once the reads in flight complete, a new load will
+      // start at the new position.
+      load_queue_.clear();
+    }
+
     return;
   }
 
+  std::pair<size_t, size_t> cache_range =
+      CalculateCacheRange(position, bytes_to_read);
+
   std::vector<SparseByteBuffer::Hole> holes_in_cache =
-      buffer_.FindOrCreateHolesInRange(cache_range.first, cache_range.second);
+      buffer_.FindHolesInRange(cache_range.first, cache_range.second);
 
   if (holes_in_cache.empty()) {
     return;
   }
 
-  load_in_progress_ = true;
-  size_t bytes_needed = 0;
+  // Fill the holes nearest the read position first, wrapping around to the
+  // ones behind it. Each hole is requested in chunks so that the first bytes
+  // arrive as soon as possible and the chunks can be requested concurrently.
+  // Pages are smaller than chunks, so the chunks are page-aligned.
+  FXL_DCHECK(kChunkSize % buffer_.page_size() == 0);
+  auto nearest = std::find_if(holes_in_cache.begin(), holes_in_cache.end(),
+                              [position](const SparseByteBuffer::Hole& hole) {
+                                return hole.position + hole.size > position;
+                              });
+  std::rotate(holes_in_cache.begin(), nearest, holes_in_cache.end());
+
+  FXL_DCHECK(load_queue_.empty());
   for (auto& hole : holes_in_cache) {
-    bytes_needed += hole.size();
+    for (size_t offset = 0; offset < hole.size; offset += kChunkSize) {
+      load_queue_.push_back(SparseByteBuffer::Hole{
+          hole.position + offset, std::min(kChunkSize, hole.size - offset)});
+    }
   }
 
-  buffer_.CleanUpExcept(bytes_needed, cache_range.first, cache_range.second);
-  holes_in_cache =
-      buffer_.FindOrCreateHolesInRange(cache_range.first, cache_range.second);
+  load_in_progress_ = true;
+  load_start_ = cache_range.first;
+  load_end_ = cache_range.first + cache_range.second;
+  load_result_ = Result::kOk;
 
-  FillHoles(holes_in_cache, cache_range.first, [this, cache_range]() {
-    load_in_progress_ = false;
-    load_is_complete_.Occur();
-    load_is_complete_.Reset();
-  });
+  IssueReads();
 }
 
-void ReaderCache::FillHoles(std::vector<SparseByteBuffer::Hole> holes,
-                            size_t load_position, fit::closure callback) {
-  std::vector<uint8_t> buffer(holes.back().size());
-  upstream_reader_->ReadAt(
-      holes.back().position(), buffer.data(), holes.back().size(),
-      [this, holes, load_position, buffer = std::move(buffer),
-       callback = std::move(callback)](Result result,
-                                       size_t bytes_read) mutable {
-        last_result_ = result;
-        if (result != Result::kOk) {
-          FXL_LOG(ERROR) << "ReadAt failed!";
-        }
-        buffer_.Fill(holes.back(), std::move(buffer));
-
-        holes.pop_back();
-        if (holes.empty()) {
-          callback();
-          return;
-        }
-
-        if (load_position != load_position_) {
-          callback();
-          return;
-        }
-
-        FillHoles(holes, load_position, std::move(callback));
-      });
-}
-
-std::pair<size_t, size_t> ReaderCache::CalculateCacheRange(size_t position) {
+void ReaderCache::IssueReads() {
+  while (!load_queue_.empty() && reads_in_flight_ < upstream_max_reads_) {
+    SparseByteBuffer::Hole chunk = load_queue_.front();
+    load_queue_.pop_front();
+
+    int64_t now = media::Timeline::local_now();
+    if (reads_in_flight_++ == 0) {
+      upstream_busy_since_ = now;
+    }
+
+    // The upstream reader may call back synchronously, in which case the
+    // queue may be changed before ReadAt returns.
+    upstream_reader_->ReadAt(
+        chunk.position, buffer_.StartFill(chunk), chunk.size,
+        [this, chunk, now](Result result, size_t bytes_read) {
+          OnChunkRead(chunk, now, result, bytes_read);
+        });
+  }
+}
+
+void ReaderCache::OnChunkRead(const SparseByteBuffer::Hole& chunk,
+                              int64_t start_time, Result result,
+                              size_t bytes_read) {
+  FXL_DCHECK(reads_in_flight_ > 0);
+
+  int64_t now = media::Timeline::local_now();
+  if (--reads_in_flight_ == 0) {
+    upstream_busy_time_ += now - upstream_busy_since_;
+  }
+
+  bytes_read = std::min(bytes_read, chunk.size);
+  buffer_.CompleteFill(chunk, result == Result::kOk ? bytes_read : 0);
+  upstream_read_sizes_.AddSample(bytes_read);
+  upstream_read_durations_.AddSample(now - start_time);
+
+  if (result == Result::kOk && bytes_read < chunk.size) {
+    // A short read. The pages it completed are present, so only the rest of
+    // the chunk needs to be requested again, starting at the first page that
+    // wasn't completed. If no page was completed, the upstream reader has
+    // fallen short of the size it described, and we don't retry
+    // indefinitely.
+    size_t filled = bytes_read - bytes_read % buffer_.page_size();
+    if (filled == 0) {
+      result = Result::kInternalError;
+    } else {
+      load_queue_.push_front(SparseByteBuffer::Hole{chunk.position + filled,
+                                                    chunk.size - filled});
+    }
+  }
+
+  if (result != Result::kOk) {
+    FXL_LOG(ERROR) << "ReadAt failed!";
+    load_result_ = result;
+    load_queue_.clear();
+  }
+
+  CompletePendingReads();
+
+  if (reads_in_flight_ == 0 && load_queue_.empty()) {
+    OnLoadComplete();
+    return;
+  }
+
+  IssueReads();
+}
+
+void ReaderCache::OnLoadComplete() {
+  load_in_progress_ = false;
+
+  if (reinitialize_pending_) {
+    reinitialize_pending_ = false;
+    buffer_.Initialize(upstream_size_, capacity_);
+  }
+
+  if (load_result_ != Result::kOk) {
+    // Pending reads have been failed. The next ReadAt will try again.
+    return;
+  }
+
+  // Keep the cache range around the reader filled. If a ReadAt is waiting,
+  // it's for content outside the range of the load that just completed.
+  if (pending_reads_.empty()) {
+    MaybeStartLoadForPosition(last_read_position_,
+                              next_read_position_ - last_read_position_);
+  } else {
+    MaybeStartLoadForPosition(pending_reads_.front().position,
+                              pending_reads_.front().bytes_to_read);
+  }
+}
+
+std::pair<size_t, size_t> ReaderCache::CalculateCacheRange(
+    size_t position, size_t bytes_to_read) const {
   if (upstream_size_ <= capacity_) {
     return {0, upstream_size_};
   }
 
-  size_t chunk_position = position - (position % kChunkSize);
-  size_t cache_start =
-      chunk_position > max_backtrack_ ? chunk_position - max_backtrack_ : 0;
+  // The range always covers the read itself, however far that extends beyond
+  // the read-ahead, giving up backtrack as needed to stay within capacity.
+  size_t backtrack = std::min(max_backtrack_, capacity_ / 2);
+  size_t wanted_end =
+      std::min(upstream_size_,
+               position + std::max(ReadAheadSize(),
+                                   std::min(bytes_to_read, capacity_)));
+  size_t cache_start = position > backtrack ? position - backtrack : 0;
+  if (wanted_end - cache_start > capacity_) {
+    cache_start = wanted_end - capacity_;
+  }
+  size_t cache_end = std::min(wanted_end, cache_start + capacity_);
+
+  return {cache_start, cache_end - cache_start};
+}
+
+size_t ReaderCache::ReadAheadSize() const {
+  size_t max_read_ahead = capacity_ - std::min(max_backtrack_, capacity_ / 2);
+
+  double consumption_rate = ConsumptionRate();
+  double upstream_throughput = UpstreamThroughput();
+  if (consumption_rate == 0.0 || upstream_throughput == 0.0) {
+    return max_read_ahead;
+  }
+
+  double headroom = upstream_throughput / consumption_rate;
+  double read_ahead_duration =
+      kMinReadAheadDuration * std::max(1.0, kComfortableHeadroom / headroom);
+  double read_ahead = consumption_rate * read_ahead_duration /
+                      media::Timeline::ns_from_seconds(1);
+
+  if (read_ahead >= max_read_ahead) {
+    return max_read_ahead;
+  }
+
+  return std::min(std::max(static_cast<size_t>(read_ahead), kMinReadAhead),
+                  max_read_ahead);
+}
+
+double ReaderCache::ConsumptionRate() const {
+  if (demand_rate_.progress_interval_count() == 0 ||
+      demand_rate_.average_progress_interval() <= 0) {
+    return 0.0;
+  }
+
+  return demand_sizes_.average() * demand_rate_.progress_samples_per_second();
+}
+
+double ReaderCache::UpstreamThroughput() const {
+  if (upstream_busy_time_ <= 0) {
+    return 0.0;
+  }
 
-  return {cache_start,
-          std::min(capacity_ - max_backtrack_, upstream_size_ - cache_start)};
+  return static_cast<double>(upstream_read_sizes_.sum()) *
+         media::Timeline::ns_from_seconds(1) / upstream_busy_time_;
 }
 
 }  // namespace media_player
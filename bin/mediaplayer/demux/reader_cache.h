@@ -5,10 +5,15 @@
 #ifndef GARNET_BIN_MEDIAPLAYER_DEMUX_READER_CACHE_H_
 #define GARNET_BIN_MEDIAPLAYER_DEMUX_READER_CACHE_H_
 
+#include <deque>
 #include <memory>
+#include <ostream>
+#include <vector>
 
 #include "garnet/bin/mediaplayer/demux/reader.h"
 #include "garnet/bin/mediaplayer/demux/sparse_byte_buffer.h"
+#include "garnet/bin/mediaplayer/metrics/rate_tracker.h"
+#include "garnet/bin/mediaplayer/metrics/value_tracker.h"
 #include "garnet/bin/mediaplayer/util/incident.h"
 #include "lib/async/dispatcher.h"
 #include "lib/fxl/synchronization/thread_checker.h"
@@ -18,13 +23,17 @@ namespace media_player {
 // ReaderCache implements Reader against a dynamic in-memory cache of an
 // upstream Reader's asset.
 //
-// ReaderCache is backed by a SparseByteBuffer which tracks holes (spans of the
-// asset that haven't been read) and regions (spans of the asset that have been
-// read). See SparseByteBuffer for details.
+// ReaderCache is backed by a SparseByteBuffer, a fixed-size arena of pages
+// which is allocated when the upstream reader is described (or the cache
+// options change) and into which the upstream reader reads directly. See
+// SparseByteBuffer for details.
 //
 // ReaderCache will serve ReadAt requests from its in-memory cache, and maintain
 // its cache asynchronously using the upstream reader on a schedule determined
-// by the cache options (see SetCacheOptions).
+// by the cache options (see SetCacheOptions) and by the observed rates at
+// which content is consumed and the upstream reader produces it. Loads are
+// broken into chunks, and as many chunks are requested at once as the upstream
+// reader allows (see Reader::max_concurrent_reads).
 class ReaderCache : public Reader,
                     public std::enable_shared_from_this<ReaderCache> {
  public:
@@ -45,49 +54,117 @@ class ReaderCache : public Reader,
   // is the amount of memory |ReaderCache| is allowed to spend caching the
   // upstream |Reader|'s content. |max_backtrack| is the amount of memory that
   // |ReaderCache| will maintain behind the |ReadAt| point (for skipping back).
-  // |max_backtrack| must be less than |capacity|.
+  // |max_backtrack| must be less than |capacity|. Changing the capacity
+  // discards the content of the cache.
   void SetCacheOptions(size_t capacity, size_t max_backtrack);
 
+  // Writes cache statistics to |os|.
+  void Dump(std::ostream& os) const;
+
  private:
+  // A ReadAt call waiting for content to be loaded.
+  struct PendingRead {
+    size_t position;
+    uint8_t* buffer;
+    size_t bytes_to_read;
+    ReadAtCallback callback;
+    int64_t start_time;
+  };
+
+  // Completes |read| if the content it requires is present. Returns true if
+  // the read was completed.
+  bool MaybeCompleteRead(PendingRead* read);
+
+  // Completes whichever pending reads can be completed, or fails all of them
+  // if the current load failed.
+  void CompletePendingReads();
+
   // Loads if 1) No load is in progress already. 2) There are holes in the
-  // desired cache range for this position which require filling.
+  // desired cache range for a read of |bytes_to_read| bytes at this position
+  // which require filling.
   //
   // Starts a load from the upstream |Reader| into our buffer over the given
-  // range. 1) Cleans up memory outside the desired range to pay for the new
-  // allocations. 2) Makes async calls for the upstream |Reader| to fill all the
-  // holes in the desired cache range. 3) Runs any |ReadAt| call queued on this
-  // reload.
-  void MaybeStartLoadForPosition(size_t position);
+  // range, requesting the holes nearest |position| first. Filling a hole evicts
+  // whatever content previously occupied its pages. If a load is in progress
+  // and |position| is outside its range, the load is cut short so a new one
+  // can start at |position|.
+  void MaybeStartLoadForPosition(size_t position, size_t bytes_to_read);
+
+  // Issues upstream reads for queued chunks until the queue is empty or the
+  // upstream reader's concurrency limit is reached.
+  void IssueReads();
+
+  // Handles completion of an upstream read of |chunk|.
+  void OnChunkRead(const SparseByteBuffer::Hole& chunk, int64_t start_time,
+                   Result result, size_t bytes_read);
 
-  // Makes async calls to the upstream Reader to fill the given holes in our
-  // underlying buffer. Calls callback on completion.
-  void FillHoles(std::vector<SparseByteBuffer::Hole> holes,
-                 size_t load_position, fit::closure callback);
+  // Called when a load completes.
+  void OnLoadComplete();
 
   // Calculates the desired cache range according to our cache options around
-  // the requested read position.
-  std::pair<size_t, size_t> CalculateCacheRange(size_t position);
+  // the requested read position. The range includes the read itself, up to
+  // the capacity of the cache.
+  std::pair<size_t, size_t> CalculateCacheRange(size_t position,
+                                                size_t bytes_to_read) const;
+
+  // Determines how far beyond the read position to load based on the observed
+  // consumption rate and upstream throughput.
+  size_t ReadAheadSize() const;
+
+  // Returns the rate at which the demux consumes content in bytes per second,
+  // or 0 if that isn't known yet.
+  double ConsumptionRate() const;
+
+  // Returns the rate at which the upstream reader produces content in bytes
+  // per second, or 0 if that isn't known yet.
+  double UpstreamThroughput() const;
 
   // |buffer_| is the underlying storage for the cache.
   SparseByteBuffer buffer_;
   Result last_result_;
 
   Incident describe_is_complete_;
-  Incident load_is_complete_;
 
   // These values are stable after |describe_is_complete_|.
   std::shared_ptr<Reader> upstream_reader_;
   size_t upstream_size_;
   // TODO(turnage): Respect can_seek_ == false in upstream reader.
   bool upstream_can_seek_;
+  size_t upstream_max_reads_ = 1;
 
   size_t capacity_ = 16 * 1024 * 1024;
   size_t max_backtrack_ = 0;
 
   async_dispatcher_t* dispatcher_;
 
+  std::vector<PendingRead> pending_reads_;
+  size_t last_read_position_ = 0;
+  size_t next_read_position_ = 0;
+
   bool load_in_progress_ = false;
-  size_t load_position_;
+  size_t load_start_;
+  size_t load_end_;
+  std::deque<SparseByteBuffer::Hole> load_queue_;
+  size_t reads_in_flight_ = 0;
+
+  // The result of the load in progress or the most recent one.
+  Result load_result_ = Result::kOk;
+
+  // Set when |buffer_| needs to be reinitialized once the load in progress
+  // is complete, because the cache options have changed.
+  bool reinitialize_pending_ = false;
+
+  // Statistics. The demand trackers cover ReadAt calls and the upstream
+  // trackers cover reads from the upstream reader.
+  RateTracker demand_rate_;
+  ValueTracker<int64_t> demand_sizes_;
+  size_t hit_count_ = 0;
+  size_t miss_count_ = 0;
+  ValueTracker<int64_t> stall_durations_;
+  ValueTracker<int64_t> upstream_read_sizes_;
+  ValueTracker<int64_t> upstream_read_durations_;
+  int64_t upstream_busy_time_ = 0;
+  int64_t upstream_busy_since_ = 0;
 };
 
 }  // namespace media_player
@@ -5,141 +5,108 @@
 #ifndef GARNET_BIN_MEDIAPLAYER_DEMUX_SPARSE_BYTE_BUFFER_H_
 #define GARNET_BIN_MEDIAPLAYER_DEMUX_SPARSE_BYTE_BUFFER_H_
 
-#include <map>
+#include <stddef.h>
+#include <stdint.h>
+
+#include <limits>
+#include <memory>
 #include <vector>
 
+#include "lib/fxl/macros.h"
+
 namespace media_player {
 
+// SparseByteBuffer caches pieces of an asset of known size in a fixed-capacity
+// arena which is allocated once, when the buffer is initialized.
+//
+// The asset is divided into pages of |page_size| bytes, and the arena into
+// |page_count| slots of the same size. Asset page n may only be cached in slot
+// n % page_count, so the arena behaves like a ring sliding over the asset:
+// filling a page evicts whichever page previously occupied its slot. Each slot
+// records which asset page it holds (if any), so determining whether a page is
+// present is a single lookup, and filling allocates nothing.
+//
+// Any window of the asset no larger than |capacity| bytes, wherever it starts,
+// can be cached in its entirety.
 class SparseByteBuffer {
  public:
-  struct Hole {
-    Hole();
-    Hole(const Hole& other);
-    ~Hole();
+  static constexpr size_t kDefaultPageSize = 64 * 1024;
 
-    size_t position() { return iter_->first; }
-    size_t size() { return iter_->second; }
+  // A page-aligned span of the asset which is not present in the buffer. A
+  // hole never spans the end of the arena, so it can be filled with a single
+  // contiguous write (see StartFill).
+  struct Hole {
+    size_t position;
+    size_t size;
+  };
 
-   private:
-    explicit Hole(std::map<size_t, size_t>::iterator iter);
+  SparseByteBuffer();
 
-    std::map<size_t, size_t>::iterator iter_;
+  ~SparseByteBuffer();
 
-    friend bool operator==(const Hole& a, const Hole& b);
-    friend bool operator!=(const Hole& a, const Hole& b);
-    friend class SparseByteBuffer;
-  };
+  // Initializes the buffer to cache an asset of |size| bytes, using an arena
+  // large enough that any |capacity| bytes of the asset may be present at
+  // once. Any previously cached content is discarded.
+  void Initialize(size_t size, size_t capacity,
+                  size_t page_size = kDefaultPageSize);
 
-  struct Region {
-    Region();
-    Region(const Region& other);
-    ~Region();
+  size_t size() const { return size_; }
 
-    size_t position() { return iter_->first; }
-    size_t size() { return iter_->second.size(); }
-    uint8_t* data() { return iter_->second.data(); }
+  size_t page_size() const { return page_size_; }
 
-   private:
-    explicit Region(std::map<size_t, std::vector<uint8_t>>::iterator iter);
+  size_t page_count() const { return page_count_; }
 
-    std::map<size_t, std::vector<uint8_t>>::iterator iter_;
+  // Reads a range of data from the buffer. Reading will begin at |start| and
+  // stop when |size| bytes have been copied into |dest_buffer|, the end of the
+  // asset is reached or a page that isn't present is encountered. Returns the
+  // number of bytes copied.
+  size_t ReadRange(size_t start, size_t size, uint8_t* dest_buffer) const;
 
-    friend bool operator==(const Region& a, const Region& b);
-    friend bool operator!=(const Region& a, const Region& b);
-    friend class SparseByteBuffer;
-  };
+  // Determines whether the byte at |position| is present.
+  bool IsPresent(size_t position) const {
+    return PageIsPresent(position / page_size_);
+  }
 
-  SparseByteBuffer();
+  // Returns the holes which fully describe the buffer's gaps in the given
+  // range, in ascending order of position. The first and last holes are
+  // expanded to page boundaries (but not beyond the end of the asset).
+  std::vector<Hole> FindHolesInRange(size_t start, size_t size) const;
 
-  ~SparseByteBuffer();
+  // Begins filling |hole| (as returned by FindHolesInRange), returning the
+  // location in the arena to which hole.size bytes of asset content starting
+  // at hole.position should be written. Any pages previously occupying the
+  // hole's slots are evicted. The caller must call CompleteFill once the
+  // content has been written.
+  uint8_t* StartFill(const Hole& hole);
 
-  Hole null_hole() { return Hole(holes_.end()); }
-
-  Region null_region() { return Region(regions_.end()); }
-
-  // Initialized the buffer.
-  void Initialize(size_t size);
-
-  // Reads a range of data from the SparseBuffer, which may span multiple
-  // regions. Reading will begin at |start| in the SparseBuffer and stop when
-  // |size| bytes have been copied into |dest_buffer| or a hole in the
-  // SparseBuffer is encountered.
-  //
-  // For example, when reading the range [0, 100) in a Sparsebuffer with regions
-  // [0, 50) and [50, 100), ReadRange will read across them both and read the
-  // regions' content into the first and second half of the destination buffer
-  // respectively.
-  size_t ReadRange(size_t start, size_t size, uint8_t* dest_buffer);
-
-  // Finds a region containing the specified position. This method will check
-  // hint and its successor, if they're valid, before doing a search.
-  Region FindRegionContaining(size_t position, Region hint);
-
-  // Finds or creates a hole at the specified position. This method will check
-  // hint, if it's valid, before doing a search.
-  Hole FindOrCreateHole(size_t position, Hole hint);
-
-  // Finds a hole containing the specified position.
-  Hole FindHoleContaining(size_t position);
-
-  // Finds or creates holes which fully describe the buffer's gaps in the given
-  // range.
-  std::vector<Hole> FindOrCreateHolesInRange(size_t start, size_t size);
-
-  // Creates a region that starts at hole.position(). The new region must not
-  // overlap other existing regions and cannot extend beyond the size of this
-  // sparse buffer. Holes are updated to accommodate the region. Fill returns
-  // the first hole that follows the new region in the wraparound sense. If
-  // this sparse buffer is completely filled (there are no holes), this method
-  // return null_hole().
-  Hole Fill(Hole hole, std::vector<uint8_t>&& buffer);
-
-  // Frees and shrinks regions outside the protected range until |goal| bytes
-  // have been freed from the buffer or nothing remains to free. Returns the
-  // bytes actually freed.
-  //
-  // Frees and shrinks regions outside the protected range as they are found,
-  // first cleaning up regions before the protected range, and then regions
-  // after after the protected range. In both traversals regions farther from
-  // the protected range are cleaned up first.
-  size_t CleanUpExcept(size_t goal, size_t protected_start,
-                       size_t protected_size);
-
-  // Shrinks the front of a region (e.g. shrinking [{1, 2, 3}] by 1 yields
-  // [hole, {2, 3}]). This may require a copy. Returns an updated Region handle.
-  // The handle is equal to null_region() if the region was shrunk by its whole
-  // size and therefore freed.
-  Region ShrinkRegionFront(Region region, size_t shrink_amount);
-
-  // Shrinks the back of a region (e.g. shrinking [{1, 2, 3}] by 1 yields
-  // [{1, 2}, hole]). Returns an updated Region handle. The handle is equal to
-  // null_region() if the region was shrunk by its whole size and therefore
-  // freed.
-  Region ShrinkRegionBack(Region region, size_t shrink_amount);
-
-  // Drops a region and coalesces (may modify) any adjacent holes.
-  Hole Free(Region region);
+  // Completes a fill started with StartFill. |bytes_filled| may be less than
+  // hole.size, in which case only the pages that were completely written are
+  // marked present.
+  void CompleteFill(const Hole& hole, size_t bytes_filled);
 
  private:
-  using HolesIter = std::map<size_t, size_t>::iterator;
-  using RegionsIter = std::map<size_t, std::vector<uint8_t>>::iterator;
+  static constexpr size_t kNoPage = std::numeric_limits<size_t>::max();
 
-  size_t size_ = 0u;
-  std::map<size_t, size_t> holes_;                  // Hole sizes by position.
-  std::map<size_t, std::vector<uint8_t>> regions_;  // Buffers by position.
-};
+  size_t SlotForPage(size_t page) const { return page % page_count_; }
+
+  bool PageIsPresent(size_t page) const {
+    return slot_pages_[SlotForPage(page)] == page;
+  }
 
-bool operator==(const SparseByteBuffer::Hole& a,
-                const SparseByteBuffer::Hole& b);
+  // Returns the size of the given asset page, which is |page_size_| except
+  // for the last page of the asset.
+  size_t PageSize(size_t page) const;
 
-bool operator!=(const SparseByteBuffer::Hole& a,
-                const SparseByteBuffer::Hole& b);
+  size_t size_ = 0u;
+  size_t page_size_ = kDefaultPageSize;
+  size_t page_count_ = 0u;
+  std::unique_ptr<uint8_t[]> arena_;
 
-bool operator==(const SparseByteBuffer::Region& a,
-                const SparseByteBuffer::Region& b);
+  // The asset page held by each slot of |arena_|, or |kNoPage|.
+  std::vector<size_t> slot_pages_;
 
-bool operator!=(const SparseByteBuffer::Region& a,
-                const SparseByteBuffer::Region& b);
+  FXL_DISALLOW_COPY_AND_ASSIGN(SparseByteBuffer);
+};
 
 }  // namespace media_player
 
@@ -0,0 +1,217 @@
+// Copyright 2018 The Fuchsia Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "garnet/bin/mediaplayer/demux/reader_cache.h"
+
+#include <algorithm>
+#include <sstream>
+#include <vector>
+
+#include "lib/async/cpp/task.h"
+#include "lib/gtest/test_loop_fixture.h"
+
+namespace media_player {
+namespace {
+
+static const size_t kAssetSize = 8 * 1024 * 1024 + 1000;
+
+uint8_t ByteForPosition(size_t position) {
+  return static_cast<uint8_t>(position ^ (position >> 8) ^ (position >> 16) ^
+                              (position >> 24));
+}
+
+// Upstream reader which produces ByteForPosition content asynchronously and
+// checks that its concurrency limit is respected.
+class FakeReader : public Reader {
+ public:
+  FakeReader(async_dispatcher_t* dispatcher, size_t max_concurrent_reads)
+      : dispatcher_(dispatcher), max_concurrent_reads_(max_concurrent_reads) {}
+
+  ~FakeReader() override {}
+
+  // Causes all subsequent reads to fail.
+  void Fail() { fail_ = true; }
+
+  // Causes all subsequent reads to return at most |max_bytes_per_read| bytes.
+  void SetMaxBytesPerRead(size_t max_bytes_per_read) {
+    max_bytes_per_read_ = max_bytes_per_read;
+  }
+
+  size_t read_count() const { return read_count_; }
+
+  size_t max_reads_observed() const { return max_reads_observed_; }
+
+  // Reader implementation.
+  void Describe(DescribeCallback callback) override {
+    callback(Result::kOk, kAssetSize, true);
+  }
+
+  void ReadAt(size_t position, uint8_t* buffer, size_t bytes_to_read,
+              ReadAtCallback callback) override {
+    EXPECT_LT(position, kAssetSize);
+    EXPECT_LE(position + bytes_to_read, kAssetSize);
+
+    ++read_count_;
+    ++reads_outstanding_;
+    EXPECT_LE(reads_outstanding_, max_concurrent_reads_);
+    max_reads_observed_ = std::max(max_reads_observed_, reads_outstanding_);
+
+    async::PostTask(dispatcher_, [this, position, buffer, bytes_to_read,
+                                  callback = std::move(callback)]() {
+      --reads_outstanding_;
+
+      if (fail_) {
+        callback(Result::kPeerClosed, 0);
+        return;
+      }
+
+      size_t bytes_read = std::min(bytes_to_read, max_bytes_per_read_);
+      for (size_t i = 0; i < bytes_read; ++i) {
+        buffer[i] = ByteForPosition(position + i);
+      }
+
+      callback(Result::kOk, bytes_read);
+    });
+  }
+
+  size_t max_concurrent_reads() const override {
+    return max_concurrent_reads_;
+  }
+
+ private:
+  async_dispatcher_t* dispatcher_;
+  size_t max_concurrent_reads_;
+  bool fail_ = false;
+  size_t max_bytes_per_read_ = kAssetSize;
+  size_t read_count_ = 0;
+  size_t reads_outstanding_ = 0;
+  size_t max_reads_observed_ = 0;
+};
+
+class ReaderCacheTest : public ::gtest::TestLoopFixture {
+ protected:
+  void SetUp() override {
+    ::gtest::TestLoopFixture::SetUp();
+    upstream_ = std::make_shared<FakeReader>(dispatcher(), 3);
+    under_test_ = ReaderCache::Create(upstream_);
+    under_test_->SetCacheOptions(2 * 1024 * 1024, 512 * 1024);
+  }
+
+  // Reads from |under_test_| and checks the result.
+  void ExpectRead(size_t position, size_t size) {
+    std::vector<uint8_t> buffer(size);
+    bool called_back = false;
+    under_test_->ReadAt(position, buffer.data(), size,
+                        [&called_back](Result result, size_t bytes_read) {
+                          EXPECT_EQ(Result::kOk, result);
+                          called_back = true;
+                        });
+    RunLoopUntilIdle();
+    EXPECT_TRUE(called_back);
+
+    for (size_t i = 0; i < size; ++i) {
+      if (buffer[i] != ByteForPosition(position + i)) {
+        ADD_FAILURE() << "Wrong content at position " << position + i;
+        return;
+      }
+    }
+  }
+
+  std::shared_ptr<FakeReader> upstream_;
+  std::shared_ptr<ReaderCache> under_test_;
+};
+
+// Tests reads in sequence and with seeks.
+TEST_F(ReaderCacheTest, Reads) {
+  for (size_t position = 0; position < 4 * 1024 * 1024;
+       position += 100 * 1024) {
+    ExpectRead(position, 100 * 1024);
+  }
+
+  ExpectRead(kAssetSize - 5000, 5000);
+  ExpectRead(3 * 1024 * 1024 + 17, 64 * 1024);
+  ExpectRead(17, 1);
+
+  // The upstream reader should have been kept busy.
+  EXPECT_EQ(3u, upstream_->max_reads_observed());
+}
+
+// Tests that reads from the cache don't read upstream.
+TEST_F(ReaderCacheTest, Hits) {
+  ExpectRead(0, 1000);
+  RunLoopUntilIdle();
+  size_t read_count = upstream_->read_count();
+
+  ExpectRead(1000, 1000);
+  ExpectRead(0, 1000);
+  EXPECT_EQ(read_count, upstream_->read_count());
+
+  std::ostringstream os;
+  under_test_->Dump(os);
+  EXPECT_NE(std::string::npos, os.str().find("bytes prefetched"));
+}
+
+// Tests that short upstream reads are kept and the rest is requested again.
+TEST_F(ReaderCacheTest, ShortReads) {
+  upstream_->SetMaxBytesPerRead(100 * 1024);
+
+  ExpectRead(0, 1000);
+  ExpectRead(1024 * 1024, 300 * 1024);
+  ExpectRead(kAssetSize - 5000, 5000);
+}
+
+// Tests reads that extend beyond the read-ahead. With the 2MB capacity and
+// 512KB backtrack, read-ahead is at most 1.5MB.
+TEST_F(ReaderCacheTest, LargeReads) {
+  ExpectRead(0, 1000);
+  ExpectRead(1024 * 1024, 1792 * 1024);
+  ExpectRead(4 * 1024 * 1024 + 17, 2 * 1024 * 1024);
+}
+
+// Tests that a read larger than the cache completes short, with at least as
+// much as the cache can hold.
+TEST_F(ReaderCacheTest, ReadLargerThanCapacity) {
+  std::vector<uint8_t> buffer(3 * 1024 * 1024);
+  size_t bytes_read = 0;
+  bool called_back = false;
+  under_test_->ReadAt(
+      1000, buffer.data(), buffer.size(),
+      [&bytes_read, &called_back](Result result, size_t read_size) {
+        EXPECT_EQ(Result::kOk, result);
+        bytes_read = read_size;
+        called_back = true;
+      });
+  RunLoopUntilIdle();
+  EXPECT_TRUE(called_back);
+  EXPECT_GE(bytes_read, 2u * 1024 * 1024);
+  EXPECT_LT(bytes_read, buffer.size());
+
+  for (size_t i = 0; i < bytes_read; ++i) {
+    if (buffer[i] != ByteForPosition(1000 + i)) {
+      ADD_FAILURE() << "Wrong content at position " << 1000 + i;
+      return;
+    }
+  }
+}
+
+// Tests that upstream failures are reported.
+TEST_F(ReaderCacheTest, UpstreamFailure) {
+  ExpectRead(0, 1000);
+
+  upstream_->Fail();
+
+  std::vector<uint8_t> buffer(1000);
+  bool called_back = false;
+  under_test_->ReadAt(6 * 1024 * 1024, buffer.data(), buffer.size(),
+                      [&called_back](Result result, size_t bytes_read) {
+                        EXPECT_EQ(Result::kPeerClosed, result);
+                        EXPECT_EQ(0u, bytes_read);
+                        called_back = true;
+                      });
+  RunLoopUntilIdle();
+  EXPECT_TRUE(called_back);
+}
+
+}  // namespace
+}  // namespace media_player
@@ -4,47 +4,24 @@
 
 #include "garnet/bin/mediaplayer/demux/sparse_byte_buffer.h"
 
+#include <zircon/syscalls.h>
+
+#include <cstring>
+#include <iostream>
+
 #include "gtest/gtest.h"
 
 namespace media_player {
 namespace {
 
+static const size_t kPageSize = 16u;
 static const size_t kSize = 1000u;
 
-void ExpectNullRegion(SparseByteBuffer* under_test,
-                      SparseByteBuffer::Region region) {
-  EXPECT_EQ(under_test->null_region(), region);
-}
-
 uint8_t ByteForPosition(size_t position) {
   return static_cast<uint8_t>(position ^ (position >> 8) ^ (position >> 16) ^
                               (position >> 24));
 }
 
-void ExpectRegion(SparseByteBuffer* under_test, size_t position, size_t size,
-                  SparseByteBuffer::Region region) {
-  EXPECT_NE(under_test->null_region(), region);
-  EXPECT_EQ(position, region.position());
-  EXPECT_EQ(size, region.size());
-  uint8_t* data = region.data();
-  EXPECT_NE(nullptr, data);
-  for (size_t i = 0; i < size; i++) {
-    EXPECT_EQ(data[i], ByteForPosition(position + i));
-  }
-}
-
-void ExpectNullHole(SparseByteBuffer* under_test, SparseByteBuffer::Hole hole) {
-  EXPECT_EQ(under_test->null_hole(), hole);
-}
-
-void ExpectHole(SparseByteBuffer* under_test, size_t position, size_t size,
-                SparseByteBuffer::Hole hole) {
-  EXPECT_NE(SparseByteBuffer::Hole(), hole);
-  EXPECT_NE(under_test->null_hole(), hole);
-  EXPECT_EQ(position, hole.position());
-  EXPECT_EQ(size, hole.size());
-}
-
 std::vector<uint8_t> CreateBuffer(size_t position, size_t size) {
   std::vector<uint8_t> buffer(size);
   for (size_t i = 0; i < size; i++) {
@@ -53,496 +30,286 @@ std::vector<uint8_t> CreateBuffer(size_t position, size_t size) {
   return buffer;
 }
 
-void FillRegion(SparseByteBuffer* under_test, size_t start, size_t size) {
-  SparseByteBuffer::Hole hole_to_fill =
-      under_test->FindOrCreateHole(start, under_test->null_hole());
-  if (hole_to_fill == under_test->null_hole()) {
-    return;
+// Fills a hole with the content an upstream reader would produce, writing
+// |bytes_to_fill| bytes, or the whole hole if |bytes_to_fill| is zero.
+void FillHole(SparseByteBuffer* under_test,
+              const SparseByteBuffer::Hole& hole, size_t bytes_to_fill = 0) {
+  if (bytes_to_fill == 0) {
+    bytes_to_fill = hole.size;
   }
 
-  under_test->Fill(hole_to_fill, CreateBuffer(start, size));
+  uint8_t* dest = under_test->StartFill(hole);
+  ASSERT_NE(nullptr, dest);
+  std::vector<uint8_t> content = CreateBuffer(hole.position, bytes_to_fill);
+  std::memcpy(dest, content.data(), bytes_to_fill);
+  under_test->CompleteFill(hole, bytes_to_fill);
 }
 
-SparseByteBuffer BufferWithRegions(
-    std::vector<std::pair<size_t, size_t>> regions) {
-  SparseByteBuffer under_test;
-  under_test.Initialize(kSize);
-
-  for (const auto& region_spec : regions) {
-    FillRegion(&under_test, region_spec.first, region_spec.second);
+// Fills all the holes in the given range.
+void FillRange(SparseByteBuffer* under_test, size_t start, size_t size) {
+  for (const auto& hole : under_test->FindHolesInRange(start, size)) {
+    FillHole(under_test, hole);
   }
-
-  return under_test;
 }
 
-// See HoleHints test.
-void VerifyHoleHint(size_t hole_count, size_t hint_position) {
-  SparseByteBuffer under_test;
-  under_test.Initialize(kSize);
-
-  size_t hole_size = kSize / hole_count;
+void ExpectHole(size_t position, size_t size,
+                const SparseByteBuffer::Hole& hole) {
+  EXPECT_EQ(position, hole.position);
+  EXPECT_EQ(size, hole.size);
+}
 
-  // Create the holes.
-  for (size_t position = 0; position < kSize; position += hole_size) {
-    SparseByteBuffer::Hole hole =
-        under_test.FindOrCreateHole(position, under_test.null_hole());
-    ExpectHole(&under_test, position, kSize - position, hole);
+void ExpectPresent(SparseByteBuffer* under_test, size_t start, size_t size) {
+  for (size_t position = start; position < start + size; ++position) {
+    EXPECT_TRUE(under_test->IsPresent(position)) << position;
   }
 
-  // Use the indicated hole as a hint.
-  SparseByteBuffer::Hole hint = under_test.FindHoleContaining(hint_position);
+  std::vector<uint8_t> dest_buffer(size, 0);
+  EXPECT_EQ(size, under_test->ReadRange(start, size, dest_buffer.data()));
+  EXPECT_EQ(CreateBuffer(start, size), dest_buffer);
+}
 
-  // Run FindOrCreateHole against every position for each hint.
-  for (size_t position = 0; position < kSize; position++) {
-    SparseByteBuffer::Hole hole = under_test.FindOrCreateHole(position, hint);
-    size_t expected_size = hole_size - position % hole_size;
-    if (position + expected_size > kSize) {
-      expected_size = kSize - position;
-    }
-    ExpectHole(&under_test, position, expected_size, hole);
+void ExpectAbsent(SparseByteBuffer* under_test, size_t start, size_t size) {
+  for (size_t position = start; position < start + size; ++position) {
+    EXPECT_FALSE(under_test->IsPresent(position)) << position;
   }
 }
 
 // Tests that the buffer behaves as expected immediately after initialization.
 TEST(SparseByteBufferTest, InitialState) {
   SparseByteBuffer under_test;
-  under_test.Initialize(kSize);
+  under_test.Initialize(kSize, 100, kPageSize);
 
-  // Null comparison works for regions.
-  ExpectNullRegion(&under_test, under_test.null_region());
+  EXPECT_EQ(kSize, under_test.size());
+  EXPECT_EQ(kPageSize, under_test.page_size());
+  // 100 bytes at an arbitrary position may touch 8 pages.
+  EXPECT_EQ(8u, under_test.page_count());
 
-  // No regions anywhere.
-  for (size_t position = 0; position < kSize; position++) {
-    ExpectNullRegion(&under_test, under_test.FindRegionContaining(
-                                      position, under_test.null_region()));
-  }
+  // Nothing present.
+  ExpectAbsent(&under_test, 0, kSize);
 
-  // Null comparison works for holes.
-  ExpectNullHole(&under_test, under_test.null_hole());
+  uint8_t dest;
+  EXPECT_EQ(0u, under_test.ReadRange(0, 1, &dest));
 
-  // One hole everywhere.
-  for (size_t position = 0; position < kSize; position++) {
-    ExpectHole(&under_test, 0, kSize, under_test.FindHoleContaining(position));
-  }
+  // One hole covering the range, expanded to page boundaries.
+  std::vector<SparseByteBuffer::Hole> holes =
+      under_test.FindHolesInRange(0, 100);
+  ASSERT_EQ(1u, holes.size());
+  ExpectHole(0, 7 * kPageSize, holes[0]);
 
-  // FindOrCreateHole finds the hole.
-  ExpectHole(&under_test, 0, kSize,
-             under_test.FindOrCreateHole(0, under_test.null_hole()));
+  // Small assets need no more pages than they have.
+  under_test.Initialize(40, 1000, kPageSize);
+  EXPECT_EQ(3u, under_test.page_count());
 }
 
 TEST(SparseByteBufferTest, ReadRange) {
+  SparseByteBuffer under_test;
+  under_test.Initialize(kSize, kSize, kPageSize);
+  FillRange(&under_test, 0, 200);
+
   {
-    // Read range filled with regions.
-    SparseByteBuffer under_test = BufferWithRegions({{0, 100}, {100, 200}});
+    // Read range across pages.
     std::vector<uint8_t> dest_buffer(200, 0);
-    size_t copied = under_test.ReadRange(0, 200, dest_buffer.data());
-    EXPECT_EQ(copied, 200u);
-    EXPECT_EQ(dest_buffer, CreateBuffer(0, 200));
+    EXPECT_EQ(200u, under_test.ReadRange(0, 200, dest_buffer.data()));
+    EXPECT_EQ(CreateBuffer(0, 200), dest_buffer);
   }
 
   {
-    // Read range from region stretching beyond it.
-    SparseByteBuffer under_test = BufferWithRegions({{0, 1000}});
-    std::vector<uint8_t> dest_buffer(50, 0);
-    size_t copied = under_test.ReadRange(100, 50, dest_buffer.data());
-    EXPECT_EQ(copied, 50u);
-    EXPECT_EQ(dest_buffer, CreateBuffer(100, 50));
+    // Read range within a page.
+    std::vector<uint8_t> dest_buffer(5, 0);
+    EXPECT_EQ(5u, under_test.ReadRange(101, 5, dest_buffer.data()));
+    EXPECT_EQ(CreateBuffer(101, 5), dest_buffer);
   }
 
   {
-    // Read range with only partial coverage.
-    SparseByteBuffer under_test = BufferWithRegions({{0, 50}});
-    std::vector<uint8_t> dest_buffer(25);
-    size_t copied = under_test.ReadRange(25, 50, dest_buffer.data());
-    EXPECT_EQ(copied, 25u);
-    EXPECT_EQ(dest_buffer, CreateBuffer(25, 25));
+    // Read range with only partial coverage. 200 isn't page-aligned, so the
+    // filled range extends to 208.
+    std::vector<uint8_t> dest_buffer(500, 0);
+    EXPECT_EQ(58u, under_test.ReadRange(150, 500, dest_buffer.data()));
+    dest_buffer.resize(58);
+    EXPECT_EQ(CreateBuffer(150, 58), dest_buffer);
   }
 
   {
-    // Read range with only partial coverage that should bail early.
-    SparseByteBuffer under_test = BufferWithRegions({{0, 50}, {100, 50}});
-    std::vector<uint8_t> dest_buffer(25);
-    size_t copied = under_test.ReadRange(25, 500, dest_buffer.data());
-    EXPECT_EQ(copied, 25u);
-    EXPECT_EQ(dest_buffer, CreateBuffer(25, 25));
+    // Read range past the end of the asset.
+    FillRange(&under_test, 990, 10);
+    std::vector<uint8_t> dest_buffer(100, 0);
+    EXPECT_EQ(10u, under_test.ReadRange(990, 100, dest_buffer.data()));
+    dest_buffer.resize(10);
+    EXPECT_EQ(CreateBuffer(990, 10), dest_buffer);
   }
 }
 
-// Creates a second hole.
-TEST(SparseByteBufferTest, TwoHoles) {
+TEST(SparseByteBufferTest, FindHolesInRange) {
   SparseByteBuffer under_test;
-  under_test.Initialize(kSize);
-
-  // Create a hole from kSize/2 to the end.
-  SparseByteBuffer::Hole created_hole =
-      under_test.FindOrCreateHole(kSize / 2, under_test.null_hole());
-
-  // One hole covers the first half.
-  for (size_t position = 0; position < kSize / 2; position++) {
-    ExpectHole(&under_test, 0, kSize / 2,
-               under_test.FindHoleContaining(position));
-  }
-
-  // Created hole covers the second half.
-  for (size_t position = kSize / 2; position < kSize; position++) {
-    EXPECT_EQ(created_hole, under_test.FindHoleContaining(position));
-  }
-
-  // No regions anywhere.
-  for (size_t position = 0; position < kSize; position++) {
-    ExpectNullRegion(&under_test, under_test.FindRegionContaining(
-                                      position, under_test.null_region()));
-  }
+  under_test.Initialize(kSize, kSize, kPageSize);
+
+  // Present: [32, 64) and [128, 144).
+  FillRange(&under_test, 32, 32);
+  FillRange(&under_test, 130, 2);
+  ExpectPresent(&under_test, 32, 32);
+  ExpectPresent(&under_test, 128, 16);
+  ExpectAbsent(&under_test, 64, 64);
+
+  std::vector<SparseByteBuffer::Hole> holes =
+      under_test.FindHolesInRange(10, 190);
+  ASSERT_EQ(3u, holes.size());
+  ExpectHole(0, 32, holes[0]);
+  ExpectHole(64, 64, holes[1]);
+  ExpectHole(144, 64, holes[2]);
+
+  // No holes in a present range.
+  EXPECT_TRUE(under_test.FindHolesInRange(33, 20).empty());
+
+  // The last hole is truncated at the end of the asset.
+  holes = under_test.FindHolesInRange(980, 100);
+  ASSERT_EQ(1u, holes.size());
+  ExpectHole(976, 24, holes[0]);
+
+  // Nothing beyond the end of the asset.
+  EXPECT_TRUE(under_test.FindHolesInRange(kSize, 100).empty());
 }
 
-// Creates a single region that covers the entire buffer.
-TEST(SparseByteBufferTest, BigRegion) {
+// Tests that holes are split where they wrap around the arena, and that
+// filling a page evicts the page previously occupying its slot.
+TEST(SparseByteBufferTest, Wraparound) {
   SparseByteBuffer under_test;
-  under_test.Initialize(kSize);
-
-  // Fill the whole buffer. No hole should be returned, because there are no
-  // holes anymore.
-  ExpectNullHole(&under_test, under_test.Fill(under_test.FindHoleContaining(0),
-                                              CreateBuffer(0, kSize)));
-
-  // Find the new region.
-  SparseByteBuffer::Region big_region =
-      under_test.FindRegionContaining(0, under_test.null_region());
-  ExpectRegion(&under_test, 0, kSize, big_region);
-
-  // Same region everywhere.
-  for (size_t position = 0; position < kSize; position++) {
-    EXPECT_EQ(big_region, under_test.FindRegionContaining(
-                              position, under_test.null_region()));
-  }
-
-  // No holes anywhere.
-  for (size_t position = 0; position < kSize; position++) {
-    ExpectNullHole(&under_test, under_test.FindHoleContaining(position));
-  }
+  under_test.Initialize(kSize, 60, kPageSize);
+  ASSERT_EQ(5u, under_test.page_count());
+
+  FillRange(&under_test, 0, 60);
+  ExpectPresent(&under_test, 0, 64);
+
+  // Pages 5 and 6 use the slots of pages 0 and 1.
+  std::vector<SparseByteBuffer::Hole> holes =
+      under_test.FindHolesInRange(40, 60);
+  ASSERT_EQ(2u, holes.size());
+  ExpectHole(64, 16, holes[0]);
+  ExpectHole(80, 32, holes[1]);
+
+  // Pages 4 through 8 wrap around the end of the arena between pages 4 and 5.
+  holes = under_test.FindHolesInRange(64, 80);
+  ASSERT_EQ(2u, holes.size());
+  ExpectHole(64, 16, holes[0]);
+  ExpectHole(80, 64, holes[1]);
+
+  FillRange(&under_test, 70, 40);
+  ExpectPresent(&under_test, 48, 64);
+  ExpectAbsent(&under_test, 0, 32);
+  ExpectPresent(&under_test, 32, 16);
 }
 
-// Creates a region for every other byte, then fills in the holes.
-TEST(SparseByteBufferTest, TinyRegions) {
+// Tests that a short fill only marks complete pages present.
+TEST(SparseByteBufferTest, ShortFill) {
   SparseByteBuffer under_test;
-  under_test.Initialize(kSize);
-
-  // Create the regions.
-  for (size_t position = 0; position < kSize; position += 2) {
-    SparseByteBuffer::Hole hole =
-        under_test.FindOrCreateHole(position, under_test.null_hole());
-    ExpectHole(&under_test, position, kSize - position, hole);
-    ExpectHole(&under_test, position + 1, kSize - position - 1,
-               under_test.Fill(hole, CreateBuffer(position, 1)));
-  }
-
-  // Find them again.
-  for (size_t position = 0; position < kSize; position += 2) {
-    ExpectRegion(
-        &under_test, position, 1,
-        under_test.FindRegionContaining(position, under_test.null_region()));
-  }
+  under_test.Initialize(kSize, kSize, kPageSize);
 
-  // Find the holes.
-  for (size_t position = 1; position < kSize; position += 2) {
-    ExpectHole(&under_test, position, 1,
-               under_test.FindHoleContaining(position));
-  }
+  std::vector<SparseByteBuffer::Hole> holes =
+      under_test.FindHolesInRange(0, 64);
+  ASSERT_EQ(1u, holes.size());
+  FillHole(&under_test, holes[0], 40);
 
-  // Fill in the holes.
-  for (size_t position = 1; position < kSize; position += 2) {
-    SparseByteBuffer::Hole hole = under_test.FindHoleContaining(position);
-    ExpectHole(&under_test, position, 1, hole);
-    hole = under_test.Fill(hole, CreateBuffer(position, 1));
-    if (position + 2 < kSize) {
-      ExpectHole(&under_test, position + 2, 1, hole);
-    } else {
-      ExpectNullHole(&under_test, hole);
-    }
-  }
+  ExpectPresent(&under_test, 0, 32);
+  ExpectAbsent(&under_test, 32, 32);
 
-  // Tiny regions everywhere.
-  for (size_t position = 0; position < kSize; position++) {
-    ExpectRegion(
-        &under_test, position, 1,
-        under_test.FindRegionContaining(position, under_test.null_region()));
-  }
+  holes = under_test.FindHolesInRange(0, 64);
+  ASSERT_EQ(1u, holes.size());
+  ExpectHole(32, 32, holes[0]);
 
-  // No holes anywhere.
-  for (size_t position = 0; position < kSize; position++) {
-    ExpectNullHole(&under_test, under_test.FindHoleContaining(position));
-  }
+  // A fill which fails altogether leaves the hole in place.
+  uint8_t* dest = under_test.StartFill(holes[0]);
+  EXPECT_NE(nullptr, dest);
+  under_test.CompleteFill(holes[0], 0);
+  ExpectAbsent(&under_test, 32, 32);
 }
 
-// Verifies that FindRegionContaining works regardless of the hints it's given.
-TEST(SparseByteBufferTest, RegionHints) {
+// Tests that the partial page at the end of the asset can be filled.
+TEST(SparseByteBufferTest, LastPage) {
   SparseByteBuffer under_test;
-  under_test.Initialize(kSize);
-
-  static const size_t region_count = 11u;
-  size_t region_size = kSize / region_count;
-
-  // Create the regions.
-  for (size_t position = 0; position < kSize; position += region_size) {
-    SparseByteBuffer::Hole hole =
-        under_test.FindOrCreateHole(position, under_test.null_hole());
-    ExpectHole(&under_test, position, kSize - position, hole);
-    if (position + region_size >= kSize) {
-      ExpectNullHole(
-          &under_test,
-          under_test.Fill(hole, CreateBuffer(position, kSize - position)));
-    } else {
-      ExpectHole(&under_test, position + region_size,
-                 kSize - position - region_size,
-                 under_test.Fill(hole, CreateBuffer(position, region_size)));
-    }
-  }
+  under_test.Initialize(kSize, kSize, kPageSize);
 
-  // Use each region as a hint.
-  for (size_t hint_position = 0; hint_position < kSize;
-       hint_position += region_size) {
-    SparseByteBuffer::Region hint = under_test.FindRegionContaining(
-        hint_position, under_test.null_region());
-    // Run FindRegionContaining against every position for each hint.
-    for (size_t position = 0; position < kSize; position++) {
-      SparseByteBuffer::Region region =
-          under_test.FindRegionContaining(position, hint);
-      size_t region_position = position - (position % region_size);
-      ExpectRegion(&under_test, region_position,
-                   region_position + region_size > kSize
-                       ? kSize - region_position
-                       : region_size,
-                   region);
-    }
-  }
+  std::vector<SparseByteBuffer::Hole> holes =
+      under_test.FindHolesInRange(kSize - 1, 1);
+  ASSERT_EQ(1u, holes.size());
+  ExpectHole(992, 8, holes[0]);
 
-  // Make sure null_region works as a hint.
-  for (size_t position = 0; position < kSize; position++) {
-    SparseByteBuffer::Region region =
-        under_test.FindRegionContaining(position, under_test.null_region());
-    size_t region_position = position - (position % region_size);
-    ExpectRegion(&under_test, region_position,
-                 region_position + region_size > kSize ? kSize - region_position
-                                                       : region_size,
-                 region);
-  }
-}
-
-// Verifies that FindOrCreateHole works regardless of the hints it's given.
-TEST(SparseByteBufferTest, HoleHints) {
-  static const size_t hole_count = 11u;
-  size_t hole_size = kSize / hole_count;
-
-  for (size_t hint_position = 0; hint_position < kSize;
-       hint_position += hole_size) {
-    VerifyHoleHint(hole_count, hint_position);
-  }
+  FillHole(&under_test, holes[0]);
+  ExpectPresent(&under_test, 992, 8);
+  EXPECT_TRUE(under_test.FindHolesInRange(992, 100).empty());
 }
 
-TEST(SparseByteBufferTest, FindOrCreateHolesInRange) {
-  {
-    // Test buffer diagram:
-    //       | Selected Range |
-    // [   =   ==== ===      ==== ....]
-    // Regions (corresponding to diagram):
-    SparseByteBuffer under_test =
-        BufferWithRegions({{3, 1}, {7, 4}, {12, 3}, {21, 4}});
-
-    std::vector<SparseByteBuffer::Hole> holes =
-        under_test.FindOrCreateHolesInRange(5, 17);
-
-    // Expected holes in range (corresponding to diagram):
-    EXPECT_EQ(holes.size(), 3u) << "Number of holes vs Expected";
-    ExpectHole(&under_test, 5, 2, holes[0]);
-    ExpectHole(&under_test, 11, 1, holes[1]);
-    ExpectHole(&under_test, 15, 6, holes[2]);
-
-    // Expected holes outside of range (corresponding to diagram):
-    ExpectHole(&under_test, 0, 3, under_test.FindHoleContaining(0));
-    ExpectHole(&under_test, 4, 1, under_test.FindHoleContaining(4));
-    ExpectHole(&under_test, 25, kSize - 25, under_test.FindHoleContaining(25));
-  }
-
-  {
-    // Find hole on end of range.
-    SparseByteBuffer under_test = BufferWithRegions({{0, 100}});
-    std::vector<SparseByteBuffer::Hole> holes =
-        under_test.FindOrCreateHolesInRange(50, 100);
-
-    EXPECT_EQ(holes.size(), 1u);
-    ExpectHole(&under_test, 100, 50, holes[0]);
-    ExpectHole(&under_test, 150, kSize - 150,
-               under_test.FindHoleContaining(150));
-  }
-
-  {
-    // Find hole in empty buffer.
-    SparseByteBuffer under_test = BufferWithRegions({});
-    std::vector<SparseByteBuffer::Hole> holes =
-        under_test.FindOrCreateHolesInRange(100, 100);
-
-    EXPECT_EQ(holes.size(), 1u);
-    ExpectHole(&under_test, 100, 100, holes[0]);
-    ExpectHole(&under_test, 0, 100, under_test.FindHoleContaining(0));
-    ExpectHole(&under_test, 200, kSize - 200,
-               under_test.FindHoleContaining(200));
-  }
-}
-
-TEST(SparseByteBufferTest, FreeRegion) {
-  {
-    // Free a region with a hole before and after it.
-    SparseByteBuffer under_test = BufferWithRegions({{40, 50}});
-    SparseByteBuffer::Region region_to_free =
-        under_test.FindRegionContaining(40, under_test.null_region());
-    SparseByteBuffer::Hole enclosing_hole = under_test.Free(region_to_free);
-
-    ExpectHole(&under_test, 0, kSize, enclosing_hole);
-  }
-
-  {
-    // Free a region at the buffer beginning.
-    SparseByteBuffer under_test = BufferWithRegions({{0, 20}});
-    SparseByteBuffer::Region region_to_free =
-        under_test.FindRegionContaining(0, under_test.null_region());
-    SparseByteBuffer::Hole enclosing_hole = under_test.Free(region_to_free);
-
-    ExpectHole(&under_test, 0, kSize, enclosing_hole);
-  }
-
-  {
-    // Free a sandwiched Region.
-    SparseByteBuffer under_test =
-        BufferWithRegions({{10, 10}, {20, 10}, {30, 10}});
-
-    SparseByteBuffer::Region region_to_free =
-        under_test.FindRegionContaining(20, under_test.null_region());
-    SparseByteBuffer::Hole enclosing_hole = under_test.Free(region_to_free);
-
-    ExpectHole(&under_test, 20, 10, enclosing_hole);
-  }
-
-  {
-    // Free region with holes not adjacent.
-    SparseByteBuffer under_test =
-        BufferWithRegions({{10, 10}, {20, 10}, {30, 10}, {50, 10}, {90, 10}});
-
-    SparseByteBuffer::Region region_to_free =
-        under_test.FindRegionContaining(20, under_test.null_region());
-    SparseByteBuffer::Hole enclosing_hole = under_test.Free(region_to_free);
-
-    ExpectHole(&under_test, 20, 10, enclosing_hole);
-  }
-}
-
-TEST(SparseByteBufferTest, CleanUpExcept) {
-  {
-    // Flagship usecase.
-    // Clean up except a space with regions on the border.
-    // Visually:
-    //      | Protected Range |
-    // [  ====   ====    ========  ==== ...]
-    //
-    // Regions (corresponding to diagram):
-    SparseByteBuffer under_test =
-        BufferWithRegions({{2, 4}, {9, 4}, {17, 8}, {27, 4}});
-    // Protected range:
-    size_t protected_start = 4;
-    size_t protected_size = 19;
-
-    size_t freed = under_test.CleanUpExcept(
-        /* >= the buffer size so it cleans the most it can */ kSize,
-        protected_start, protected_size);
-
-    // Full expectation layout corresponding to diagram.
-    EXPECT_EQ(freed, 8u);
-    ExpectHole(&under_test, 0, 4, under_test.FindHoleContaining(0));
-    ExpectRegion(&under_test, 4, 2,
-                 under_test.FindRegionContaining(4, under_test.null_region()));
-    ExpectHole(&under_test, 6, 3, under_test.FindHoleContaining(6));
-    ExpectRegion(&under_test, 9, 4,
-                 under_test.FindRegionContaining(9, under_test.null_region()));
-    ExpectHole(&under_test, 13, 4, under_test.FindHoleContaining(13));
-    ExpectRegion(&under_test, 17, 6,
-                 under_test.FindRegionContaining(17, under_test.null_region()));
-    ExpectHole(&under_test, 23, kSize - 23, under_test.FindHoleContaining(23));
-  }
-
-  {
-    // Clean up less than available excess; should truncate excess region after
-    // protected range.
-    SparseByteBuffer under_test = BufferWithRegions({{0, 100}, {900, 100}});
-    size_t freed = under_test.CleanUpExcept(50, 0, 100);
-
-    EXPECT_EQ(freed, 50u);
-    ExpectRegion(
-        &under_test, 900, 50,
-        under_test.FindRegionContaining(900, under_test.null_region()));
-    ExpectHole(&under_test, 950, 50, under_test.FindHoleContaining(950));
-  }
+// Tests that reinitializing discards content.
+TEST(SparseByteBufferTest, Reinitialize) {
+  SparseByteBuffer under_test;
+  under_test.Initialize(kSize, kSize, kPageSize);
+  FillRange(&under_test, 0, kSize);
+  ExpectPresent(&under_test, 0, kSize);
 
-  {
-    // Clean up a buffer with no regions; ensure graceful return.
-    SparseByteBuffer under_test;
-    under_test.Initialize(100);
-    EXPECT_EQ(under_test.CleanUpExcept(100, 0, 10), 0u);
-  }
+  under_test.Initialize(kSize, 100, kPageSize);
+  ExpectAbsent(&under_test, 0, kSize);
 }
 
-TEST(SparseByteBufferTest, ShrinkRegionFront) {
-  {
-    // Shrink a region with a hole before it.
-    SparseByteBuffer under_test = BufferWithRegions({{1, 4}});
-    SparseByteBuffer::Region result = under_test.ShrinkRegionFront(
-        under_test.FindRegionContaining(1, under_test.null_region()), 1);
-    ExpectRegion(&under_test, 2, 3, result);
-    ExpectHole(&under_test, 0, 2, under_test.FindHoleContaining(0));
-  }
-
-  {
-    // Shrink a region with a region before it.
-    SparseByteBuffer under_test = BufferWithRegions({{2, 4}, {6, 4}});
-    SparseByteBuffer::Region result = under_test.ShrinkRegionFront(
-        under_test.FindRegionContaining(6, under_test.null_region()), 2);
-    ExpectRegion(&under_test, 8, 2, result);
-    ExpectHole(&under_test, 6, 2, under_test.FindHoleContaining(6));
-  }
-
-  {
-    // Shrink a region totally (free it).
-    SparseByteBuffer under_test = BufferWithRegions({{2, 4}, {6, 4}, {10, 2}});
-    under_test.ShrinkRegionFront(
-        under_test.FindRegionContaining(6, under_test.null_region()), 4);
-    ExpectHole(&under_test, 6, 4, under_test.FindHoleContaining(6));
-  }
-}
+static const size_t kProfileAssetSize = 256 * 1024 * 1024;
+static const size_t kProfileCapacity = 16 * 1024 * 1024;
+static const size_t kProfileReadAheadSize = 4 * 1024 * 1024;
+static const size_t kProfileReadSize = 32 * 1024;
+static const size_t kProfileReads = 32768;
+
+// Simulates a demuxer reading an asset through a ReaderCache-sized buffer:
+// sequentially, and with a seek every |seek_interval| reads. Profiling tests
+// are disabled by default; run them with --gtest_also_run_disabled_tests.
+class SparseByteBufferProfileTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    buffer_.Initialize(kProfileAssetSize, kProfileCapacity);
+    // Holes are expanded to page boundaries at either end.
+    upstream_.resize(kProfileReadAheadSize + 2 * buffer_.page_size());
+  }
+
+  // Returns the average time per read in nanoseconds.
+  double Profile(size_t seek_interval) {
+    std::vector<uint8_t> dest(kProfileReadSize);
+    size_t position = 0;
+    uint32_t seed = 1;
+
+    zx_time_t start_time = zx_clock_get(ZX_CLOCK_MONOTONIC);
+    for (size_t read = 0; read < kProfileReads; ++read) {
+      if (seek_interval != 0 && read % seek_interval == seek_interval - 1) {
+        seed = seed * 1103515245u + 12345u;
+        position = (static_cast<size_t>(seed) * 4096) %
+                   (kProfileAssetSize - kProfileReadSize);
+      }
+
+      if (buffer_.ReadRange(position, kProfileReadSize, dest.data()) !=
+          kProfileReadSize) {
+        // Miss. Load the read-ahead range, as ReaderCache would.
+        for (const auto& hole :
+             buffer_.FindHolesInRange(position, kProfileReadAheadSize)) {
+          std::memcpy(buffer_.StartFill(hole), upstream_.data(), hole.size);
+          buffer_.CompleteFill(hole, hole.size);
+        }
+        EXPECT_EQ(kProfileReadSize,
+                  buffer_.ReadRange(position, kProfileReadSize, dest.data()));
+      }
+
+      position =
+          (position + kProfileReadSize) % (kProfileAssetSize - kProfileReadSize);
+    }
 
-TEST(SparseByteBufferTest, ShrinkRegionBack) {
-  {
-    // Shrink a region with a hole after it.
-    SparseByteBuffer under_test = BufferWithRegions({{0, 4}});
-    SparseByteBuffer::Region result = under_test.ShrinkRegionBack(
-        under_test.FindRegionContaining(0, under_test.null_region()), 1);
-    ExpectRegion(&under_test, 0, 3, result);
-    ExpectHole(&under_test, 3, kSize - 3, under_test.FindHoleContaining(0));
+    return static_cast<double>(zx_clock_get(ZX_CLOCK_MONOTONIC) - start_time) /
+           kProfileReads;
   }
 
-  {
-    // Shrink a region with a region after it.
-    SparseByteBuffer under_test = BufferWithRegions({{2, 4}, {6, 4}});
-    SparseByteBuffer::Region result = under_test.ShrinkRegionBack(
-        under_test.FindRegionContaining(2, under_test.null_region()), 2);
-    ExpectRegion(&under_test, 2, 2, result);
-    ExpectHole(&under_test, 4, 2, under_test.FindHoleContaining(4));
-  }
+  SparseByteBuffer buffer_;
+  std::vector<uint8_t> upstream_;
+};
 
-  {
-    // Shrink a region totally (free it).
-    SparseByteBuffer under_test = BufferWithRegions({{2, 4}, {6, 4}, {10, 2}});
-    under_test.ShrinkRegionBack(
-        under_test.FindRegionContaining(6, under_test.null_region()), 4);
-    ExpectHole(&under_test, 6, 4, under_test.FindHoleContaining(6));
-  }
+TEST_F(SparseByteBufferProfileTest, DISABLED_ReadPatterns) {
+  std::cout << "Sequential:            " << Profile(0) << " ns/read"
+            << std::endl;
+  std::cout << "Seek every 256 reads:  " << Profile(256) << " ns/read"
+            << std::endl;
+  std::cout << "Seek every 16 reads:   " << Profile(16) << " ns/read"
+            << std::endl;
 }
 
 }  // namespace
@@ -39,6 +39,11 @@ void FfmpegDecoderFactory::CreateDecoder(
     return;
   }
 
+  if (av_codec_context->codec_type == AVMEDIA_TYPE_VIDEO) {
+    FfmpegVideoDecoder::ConfigureThreading(av_codec_context.get(),
+                                           ffmpeg_decoder);
+  }
+
   int r = avcodec_open2(av_codec_context.get(), ffmpeg_decoder, nullptr);
   if (r < 0) {
     FXL_LOG(ERROR) << "couldn't open the decoder " << r;
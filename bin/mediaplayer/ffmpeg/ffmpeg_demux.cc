@@ -243,6 +243,7 @@ void FfmpegDemuxImpl::Dump(std::ostream& os) const {
     }
   }
 
+  reader_cache_->Dump(os);
   stage()->Dump(os);
   os << fostr::Outdent;
 }
@@ -5,6 +5,7 @@
 #include "garnet/bin/mediaplayer/ffmpeg/ffmpeg_video_decoder.h"
 
 #include <lib/sync/completion.h>
+#include <zircon/syscalls.h>
 #include <algorithm>
 #include "garnet/bin/mediaplayer/ffmpeg/ffmpeg_formatting.h"
 #include "lib/fxl/logging.h"
@@ -19,8 +20,54 @@ namespace {
 
 constexpr uint32_t kOutputMaxPayloadCount = 6;
 
+// Decoding threads beyond this number don't help at any resolution we play.
+constexpr uint32_t kMaxThreadCount = 8;
+
+// Each decoding thread is given at least this many pixels per frame. This is
+// roughly 640x360, so 720p streams get four threads, and 1080p streams get the
+// maximum.
+constexpr uint32_t kMinPixelsPerThread = 640 * 360;
+
+// Thread count used when the coded size isn't known when the decoder is
+// created.
+constexpr uint32_t kDefaultThreadCount = 4;
+
+// Returns the number of threads to use for decoding frames of the given coded
+// size.
+uint32_t ThreadCountForSize(uint32_t coded_width, uint32_t coded_height) {
+  uint32_t thread_count = kDefaultThreadCount;
+  uint64_t pixels = static_cast<uint64_t>(coded_width) * coded_height;
+  if (pixels != 0) {
+    thread_count = static_cast<uint32_t>(std::min<uint64_t>(
+        (pixels + kMinPixelsPerThread - 1) / kMinPixelsPerThread,
+        kMaxThreadCount));
+  }
+
+  return std::max(1u, std::min(thread_count, zx_system_get_num_cpus()));
+}
+
 }  // namespace
 
+// static
+void FfmpegVideoDecoder::ConfigureThreading(AVCodecContext* av_codec_context,
+                                            const AVCodec* av_codec) {
+  FXL_DCHECK(av_codec_context);
+  FXL_DCHECK(av_codec);
+
+  av_codec_context->thread_count = ThreadCountForSize(
+      std::max(av_codec_context->coded_width, av_codec_context->width),
+      std::max(av_codec_context->coded_height, av_codec_context->height));
+
+  bool low_delay = (av_codec_context->flags & AV_CODEC_FLAG_LOW_DELAY) != 0;
+  if ((av_codec->capabilities & AV_CODEC_CAP_FRAME_THREADS) && !low_delay) {
+    av_codec_context->thread_type = FF_THREAD_FRAME;
+  } else if (av_codec->capabilities & AV_CODEC_CAP_SLICE_THREADS) {
+    av_codec_context->thread_type = FF_THREAD_SLICE;
+  } else {
+    av_codec_context->thread_count = 1;
+  }
+}
+
 // static
 std::shared_ptr<Decoder> FfmpegVideoDecoder::Create(
     AvCodecContextPtr av_codec_context) {
@@ -31,13 +78,6 @@ FfmpegVideoDecoder::FfmpegVideoDecoder(AvCodecContextPtr av_codec_context)
     : FfmpegDecoderBase(std::move(av_codec_context)) {
   FXL_DCHECK(context());
 
-  // Turn on multi-proc decoding by allowing the decoder to use three threads
-  // (the calling thread and the two specified here). FF_THREAD_FRAME means
-  // that threads are assigned an entire frame.
-  // TODO(dalesat): Consider using FF_THREAD_SLICE.
-  context()->thread_count = 2;
-  context()->thread_type = FF_THREAD_FRAME;
-
   frame_layout_.Update(*context());
 }
 
@@ -52,7 +92,7 @@ void FfmpegVideoDecoder::ConfigureConnectors() {
 
   if (has_size()) {
     configured_output_buffer_size_ = frame_layout_.buffer_size();
-    stage()->ConfigureOutputToUseLocalMemory(0, kOutputMaxPayloadCount,
+    stage()->ConfigureOutputToUseLocalMemory(0, output_max_payload_count(),
                                              configured_output_buffer_size_);
   } else {
     stage()->ConfigureOutputDeferred();
@@ -134,9 +174,9 @@ int FfmpegVideoDecoder::BuildAVFrame(const AVCodecContext& av_codec_context,
     sync_completion completion;
     stage()->PostTask([this, buffer_size, &completion]() {
       stage()->ConfigureOutputToUseLocalMemory(
-          0,                       // max_aggregate_payload_size
-          kOutputMaxPayloadCount,  // max_payload_count
-          buffer_size);            // max_payload_size
+          0,                           // max_aggregate_payload_size
+          output_max_payload_count(),  // max_payload_count
+          buffer_size);                // max_payload_size
       sync_completion_signal(&completion);
     });
 
@@ -201,6 +241,15 @@ PacketPtr FfmpegVideoDecoder::CreateOutputPacket(
   return packet;
 }
 
+uint32_t FfmpegVideoDecoder::output_max_payload_count() {
+  // With frame threading, each thread holds the frame it's decoding.
+  if (context()->active_thread_type == FF_THREAD_FRAME) {
+    return kOutputMaxPayloadCount + context()->thread_count;
+  }
+
+  return kOutputMaxPayloadCount;
+}
+
 const char* FfmpegVideoDecoder::label() const { return "video_decoder"; }
 
 }  // namespace media_player
@@ -16,6 +16,17 @@ class FfmpegVideoDecoder : public FfmpegDecoderBase {
  public:
   static std::shared_ptr<Decoder> Create(AvCodecContextPtr av_codec_context);
 
+  // Sets the threading fields of |av_codec_context| for decoding with
+  // |av_codec|. Must be called before the context is opened, because ffmpeg
+  // establishes its thread pool in |avcodec_open2|.
+  //
+  // The thread count is chosen from the number of CPUs and the coded size of
+  // the stream. Frame threading is used when |av_codec| supports it, because
+  // it scales better, but it delays output by one frame per thread. Streams
+  // that request |AV_CODEC_FLAG_LOW_DELAY| use slice threading instead.
+  static void ConfigureThreading(AVCodecContext* av_codec_context,
+                                 const AVCodec* av_codec);
+
   FfmpegVideoDecoder(AvCodecContextPtr av_codec_context);
 
   ~FfmpegVideoDecoder() override;
@@ -41,6 +52,9 @@ class FfmpegVideoDecoder : public FfmpegDecoderBase {
   // operations.
   static const int kFrameBufferAlign = 32;
 
+  // Returns the number of output payloads the decoder may hold at once.
+  uint32_t output_max_payload_count();
+
   // Indicates whether the decoder has a non-zero coded size.
   bool has_size() const {
     return coded_size_.width() != 0 && coded_size_.height() != 0;
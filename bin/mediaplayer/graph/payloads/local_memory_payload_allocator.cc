@@ -4,23 +4,210 @@
 
 #include "garnet/bin/mediaplayer/graph/payloads/local_memory_payload_allocator.h"
 
+#include <algorithm>
+#include <cstdlib>
+
 #include <fbl/ref_ptr.h>
+#include "garnet/bin/mediaplayer/graph/formatting.h"
 #include "garnet/bin/mediaplayer/graph/payloads/payload_buffer.h"
+#include "lib/fxl/logging.h"
 
 namespace media_player {
+namespace {
+
+// The smallest size class is 2^kMinSizeClassShift bytes. Size classes must be
+// multiples of |PayloadBuffer::kByteAlignment|.
+static constexpr size_t kMinSizeClassShift = 8;
+static constexpr uint64_t kMinSizeClassSize = 1u << kMinSizeClassShift;
+
+// Number of size classes between consecutive powers of two.
+static constexpr size_t kSizeClassesPerDoubling = 4;
+
+// Number of buffer releases after which the high-water mark decays to the peak
+// usage observed since the last decay.
+static constexpr uint64_t kTrimInterval = 256;
+
+}  // namespace
 
 // static
 fbl::RefPtr<LocalMemoryPayloadAllocator> LocalMemoryPayloadAllocator::Create() {
   return fbl::MakeRefCounted<LocalMemoryPayloadAllocator>();
 }
 
+LocalMemoryPayloadAllocator::~LocalMemoryPayloadAllocator() {
+  // Outstanding buffers hold references to this allocator, so they've all
+  // been released by now.
+  FXL_DCHECK(bytes_in_use_ == 0);
+  for (auto& free_list : free_lists_) {
+    for (void* block : free_list) {
+      std::free(block);
+    }
+  }
+}
+
 void LocalMemoryPayloadAllocator::Dump(std::ostream& os) const {
-  os << "no report (not tracking allocations)";
+  std::lock_guard<std::mutex> locker(mutex_);
+
+  os << fostr::Indent;
+  os << fostr::NewLine << "allocations:      " << allocation_count_;
+  if (allocation_count_ != 0) {
+    os << fostr::NewLine << "pool hits:        " << pool_hit_count_ << " ("
+       << pool_hit_count_ * 100 / allocation_count_ << "%)";
+  }
+  if (unpooled_count_ != 0) {
+    os << fostr::NewLine << "unpooled:         " << unpooled_count_;
+  }
+  os << fostr::NewLine << "bytes in use:     " << bytes_in_use_;
+  os << fostr::NewLine << "bytes pooled:     " << bytes_pooled_;
+  os << fostr::NewLine << "high water mark:  " << high_water_mark_;
+  if (max_aggregate_payload_size_ != 0) {
+    os << fostr::NewLine << "aggregate limit:  "
+       << max_aggregate_payload_size_;
+  }
+  os << fostr::NewLine << "bytes trimmed:    " << bytes_trimmed_;
+  os << fostr::Outdent;
+}
+
+void LocalMemoryPayloadAllocator::SetConfig(const PayloadConfig& config) {
+  std::lock_guard<std::mutex> locker(mutex_);
+  max_pooled_payload_size_ = config.max_payload_size_;
+  max_aggregate_payload_size_ = config.max_aggregate_payload_size_;
+  TrimTo(RetentionLimit());
 }
 
 fbl::RefPtr<PayloadBuffer> LocalMemoryPayloadAllocator::AllocatePayloadBuffer(
     uint64_t size) {
-  return PayloadBuffer::CreateWithMalloc(size);
+  FXL_DCHECK(size > 0);
+
+  void* block = nullptr;
+
+  {
+    std::lock_guard<std::mutex> locker(mutex_);
+    ++allocation_count_;
+
+    if (max_pooled_payload_size_ != 0 && size > max_pooled_payload_size_) {
+      // Oversized buffers are rare enough that pooling them would only hold
+      // memory we're unlikely to need again.
+      ++unpooled_count_;
+      return PayloadBuffer::CreateWithMalloc(size);
+    }
+
+    size_t index = SizeClassIndex(size);
+    uint64_t block_size = SizeClassSize(index);
+
+    if (index < free_lists_.size() && !free_lists_[index].empty()) {
+      block = free_lists_[index].back();
+      free_lists_[index].pop_back();
+      bytes_pooled_ -= block_size;
+      ++pool_hit_count_;
+    } else {
+      // Make room for the new block before allocating it, so memory in use
+      // and pooled stays within the retention limit wherever possible.
+      uint64_t limit = RetentionLimit();
+      TrimTo(limit > block_size ? limit - block_size : 0);
+      block = aligned_alloc(PayloadBuffer::kByteAlignment, block_size);
+      if (block == nullptr) {
+        FXL_LOG(ERROR) << "Couldn't allocate buffer of size " << size << ".";
+        return nullptr;
+      }
+    }
+
+    bytes_in_use_ += block_size;
+    interval_peak_ = std::max(interval_peak_, bytes_in_use_);
+    high_water_mark_ = std::max(high_water_mark_, bytes_in_use_);
+  }
+
+  // The recycler captures only the reference, so it fits in the function's
+  // inline storage. The block and its size class are recovered from the
+  // buffer itself.
+  return PayloadBuffer::Create(
+      size, block,
+      [this_ref = fbl::WrapRefPtr(this)](PayloadBuffer* payload_buffer) {
+        FXL_DCHECK(payload_buffer);
+        this_ref->ReleaseBlock(payload_buffer->data(), payload_buffer->size());
+        // The |PayloadBuffer| deletes itself.
+      });
+}
+
+// static
+size_t LocalMemoryPayloadAllocator::SizeClassIndex(uint64_t size) {
+  if (size <= kMinSizeClassSize) {
+    return 0;
+  }
+
+  // Size classes between 2^n and 2^(n+1) are multiples of 2^(n-2).
+  uint64_t n = size - 1;
+  size_t msb = 63 - __builtin_clzll(n);
+  size_t step = (n >> (msb - 2)) & (kSizeClassesPerDoubling - 1);
+  return (msb - kMinSizeClassShift) * kSizeClassesPerDoubling + step + 1;
+}
+
+// static
+uint64_t LocalMemoryPayloadAllocator::SizeClassSize(size_t index) {
+  if (index == 0) {
+    return kMinSizeClassSize;
+  }
+
+  --index;
+  size_t msb = index / kSizeClassesPerDoubling + kMinSizeClassShift;
+  uint64_t step = index % kSizeClassesPerDoubling;
+  return (kSizeClassesPerDoubling + step + 1) << (msb - 2);
+}
+
+void LocalMemoryPayloadAllocator::ReleaseBlock(void* block, uint64_t size) {
+  FXL_DCHECK(block);
+
+  size_t index = SizeClassIndex(size);
+  uint64_t block_size = SizeClassSize(index);
+
+  std::lock_guard<std::mutex> locker(mutex_);
+  FXL_DCHECK(bytes_in_use_ >= block_size);
+  bytes_in_use_ -= block_size;
+
+  if (++releases_this_interval_ == kTrimInterval) {
+    // Let the high-water mark fall to the recent peak, so a burst doesn't
+    // pin memory for the life of the connection.
+    high_water_mark_ = interval_peak_;
+    interval_peak_ = bytes_in_use_;
+    releases_this_interval_ = 0;
+    TrimTo(RetentionLimit());
+  }
+
+  if (bytes_in_use_ + bytes_pooled_ + block_size > RetentionLimit()) {
+    std::free(block);
+    bytes_trimmed_ += block_size;
+    return;
+  }
+
+  if (free_lists_.size() <= index) {
+    free_lists_.resize(index + 1);
+  }
+
+  free_lists_[index].push_back(block);
+  bytes_pooled_ += block_size;
+}
+
+uint64_t LocalMemoryPayloadAllocator::RetentionLimit() const {
+  if (max_aggregate_payload_size_ == 0) {
+    return high_water_mark_;
+  }
+
+  return std::min(high_water_mark_, max_aggregate_payload_size_);
+}
+
+void LocalMemoryPayloadAllocator::TrimTo(uint64_t limit) {
+  for (size_t index = free_lists_.size();
+       index-- > 0 && bytes_in_use_ + bytes_pooled_ > limit;) {
+    std::vector<void*>& free_list = free_lists_[index];
+    uint64_t block_size = SizeClassSize(index);
+
+    while (!free_list.empty() && bytes_in_use_ + bytes_pooled_ > limit) {
+      std::free(free_list.back());
+      free_list.pop_back();
+      bytes_pooled_ -= block_size;
+      bytes_trimmed_ += block_size;
+    }
+  }
 }
 
 }  // namespace media_player
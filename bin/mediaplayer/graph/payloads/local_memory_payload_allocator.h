@@ -9,9 +9,25 @@
 
 #include <fbl/ref_counted.h>
 #include <fbl/ref_ptr.h>
+#include <mutex>
+#include <vector>
+#include "garnet/bin/mediaplayer/graph/payloads/payload_config.h"
+#include "lib/fxl/synchronization/thread_annotations.h"
 
 namespace media_player {
 
+// Allocates |PayloadBuffers| from process heap memory.
+//
+// Memory for released buffers is retained in per-size-class free lists and
+// reused for subsequent allocations, so a connection that allocates payloads
+// of similar sizes at a steady rate stops calling into the heap once it has
+// warmed up. Size classes are spaced four per power of two, so a buffer wastes
+// at most a quarter of its size.
+//
+// Retained memory is bounded by the high-water mark of memory in use and, if
+// the configuration supplies one, by its |max_aggregate_payload_size_|. The
+// high-water mark decays periodically to the peak observed in the most recent
+// interval, so memory isn't held indefinitely after a burst.
 class LocalMemoryPayloadAllocator
     : public PayloadAllocator,
       public fbl::RefCounted<LocalMemoryPayloadAllocator> {
@@ -20,13 +36,55 @@ class LocalMemoryPayloadAllocator
 
   LocalMemoryPayloadAllocator() = default;
 
-  ~LocalMemoryPayloadAllocator() override = default;
+  ~LocalMemoryPayloadAllocator() override;
 
   // Dumps this |LocalMemoryPayloadAllocator|'s state to |os|.
   void Dump(std::ostream& os) const;
 
+  // Applies the size constraints in |config|. Buffers larger than
+  // |config.max_payload_size_| (if non-zero) aren't pooled, and pooled memory
+  // is limited to |config.max_aggregate_payload_size_| (if non-zero). May be
+  // called at any time.
+  void SetConfig(const PayloadConfig& config);
+
   // PayloadAllocator implementation.
   fbl::RefPtr<PayloadBuffer> AllocatePayloadBuffer(uint64_t size) override;
+
+ private:
+  // Returns the index of the smallest size class that holds |size| bytes.
+  static size_t SizeClassIndex(uint64_t size);
+
+  // Returns the size in bytes of the size class at |index|.
+  static uint64_t SizeClassSize(size_t index);
+
+  // Returns memory for a released buffer to the pool.
+  void ReleaseBlock(void* block, uint64_t size);
+
+  // Returns the number of bytes that may be in use or pooled without
+  // releasing pooled memory to the heap.
+  uint64_t RetentionLimit() const FXL_EXCLUSIVE_LOCKS_REQUIRED(mutex_);
+
+  // Frees pooled memory, largest size classes first, until in-use and pooled
+  // memory together amount to no more than |limit| bytes.
+  void TrimTo(uint64_t limit) FXL_EXCLUSIVE_LOCKS_REQUIRED(mutex_);
+
+  mutable std::mutex mutex_;
+  uint64_t max_pooled_payload_size_ FXL_GUARDED_BY(mutex_) = 0;
+  uint64_t max_aggregate_payload_size_ FXL_GUARDED_BY(mutex_) = 0;
+
+  // Free blocks indexed by size class.
+  std::vector<std::vector<void*>> free_lists_ FXL_GUARDED_BY(mutex_);
+
+  uint64_t bytes_in_use_ FXL_GUARDED_BY(mutex_) = 0;
+  uint64_t bytes_pooled_ FXL_GUARDED_BY(mutex_) = 0;
+  uint64_t high_water_mark_ FXL_GUARDED_BY(mutex_) = 0;
+  uint64_t interval_peak_ FXL_GUARDED_BY(mutex_) = 0;
+  uint64_t releases_this_interval_ FXL_GUARDED_BY(mutex_) = 0;
+
+  uint64_t allocation_count_ FXL_GUARDED_BY(mutex_) = 0;
+  uint64_t pool_hit_count_ FXL_GUARDED_BY(mutex_) = 0;
+  uint64_t unpooled_count_ FXL_GUARDED_BY(mutex_) = 0;
+  uint64_t bytes_trimmed_ FXL_GUARDED_BY(mutex_) = 0;
 };
 
 }  // namespace media_player
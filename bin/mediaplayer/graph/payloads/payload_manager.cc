@@ -254,7 +254,7 @@ void PayloadManager::UpdateAllocators() {
         case PayloadMode::kUsesLocalMemory:
           // The output will allocate from its local memory allocator.
           // The input will read from local memory.
-          output_.EnsureLocalMemoryAllocator();
+          output_.EnsureLocalMemoryAllocator(CombinedConfig());
           input_.EnsureNoAllocator();
           break;
         case PayloadMode::kProvidesLocalMemory:
@@ -557,10 +557,7 @@ void PayloadManager::ProvideVmos(VmoPayloadAllocator* allocator,
   }
 }
 
-void PayloadManager::ProvideVmosForSharedAllocator(
-    VmoPayloadAllocator* allocator) const {
-  FXL_DCHECK(allocator);
-
+PayloadConfig PayloadManager::CombinedConfig() const {
   PayloadConfig config;
 
   config.max_payload_size_ = std::max(output_.config_.max_payload_size_,
@@ -588,6 +585,14 @@ void PayloadManager::ProvideVmosForSharedAllocator(
   config.max_aggregate_payload_size_ =
       output_max_aggregate_payload_size + input_max_aggregate_payload_size;
 
+  return config;
+}
+
+void PayloadManager::ProvideVmosForSharedAllocator(
+    VmoPayloadAllocator* allocator) const {
+  FXL_DCHECK(allocator);
+
+  PayloadConfig config = CombinedConfig();
   config.vmo_allocation_ = CombinedVmoAllocation();
   config.physically_contiguous_ = output_.config_.physically_contiguous_ ||
                                   input_.config_.physically_contiguous_;
@@ -651,12 +656,15 @@ void PayloadManager::Connector::EnsureNoAllocator() {
   vmo_allocator_.reset();
 }
 
-void PayloadManager::Connector::EnsureLocalMemoryAllocator() {
+void PayloadManager::Connector::EnsureLocalMemoryAllocator(
+    const PayloadConfig& config) {
   vmo_allocator_.reset();
 
   if (!local_memory_allocator_) {
     local_memory_allocator_ = LocalMemoryPayloadAllocator::Create();
   }
+
+  local_memory_allocator_->SetConfig(config);
 }
 
 VmoPayloadAllocator* PayloadManager::Connector::EnsureVmoAllocator() {
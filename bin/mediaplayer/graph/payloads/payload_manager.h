@@ -154,8 +154,9 @@ class PayloadManager {
     // Ensure that this |Connector| has no allocators.
     void EnsureNoAllocator();
 
-    // Ensure that this |Connector| has only a local memory allocator.
-    void EnsureLocalMemoryAllocator();
+    // Ensure that this |Connector| has only a local memory allocator, and
+    // apply |config| to it.
+    void EnsureLocalMemoryAllocator(const PayloadConfig& config);
 
     // Ensure that this |Connector| has only a VMO allocator. Returns a raw
     // pointer to the VMO allocator.
@@ -191,6 +192,10 @@ class PayloadManager {
   VmoAllocation CombinedVmoAllocation() const
       FXL_EXCLUSIVE_LOCKS_REQUIRED(mutex_);
 
+  // Returns the size constraints of the output and input combined. Only the
+  // max_xxx fields of the result are set.
+  PayloadConfig CombinedConfig() const FXL_EXCLUSIVE_LOCKS_REQUIRED(mutex_);
+
   // Creates VMOs for an allocator shared by the input and output and adds them
   // to |allocator|. The VMOs created will satisfy the requirements of both the
   // output and the input.
@@ -0,0 +1,126 @@
+// Copyright 2018 The Fuchsia Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "garnet/bin/mediaplayer/graph/payloads/local_memory_payload_allocator.h"
+
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "garnet/bin/mediaplayer/graph/payloads/payload_buffer.h"
+#include "gtest/gtest.h"
+
+namespace media_player {
+namespace {
+
+// Returns the value of the named field from |allocator|'s Dump output.
+uint64_t DumpValue(const LocalMemoryPayloadAllocator& allocator,
+                   const std::string& field) {
+  std::ostringstream os;
+  allocator.Dump(os);
+  std::string dump = os.str();
+  size_t position = dump.find(field + ":");
+  EXPECT_NE(std::string::npos, position) << field;
+  if (position == std::string::npos) {
+    return 0;
+  }
+
+  return std::stoull(dump.substr(position + field.size() + 1));
+}
+
+// Tests that released buffers are reused for allocations in the same size
+// class.
+TEST(LocalMemoryPayloadAllocatorTest, Reuse) {
+  auto under_test = LocalMemoryPayloadAllocator::Create();
+
+  auto buffer = under_test->AllocatePayloadBuffer(1000);
+  ASSERT_TRUE(buffer);
+  EXPECT_EQ(1000u, buffer->size());
+  EXPECT_TRUE(PayloadBuffer::IsAligned(buffer->data()));
+  void* data = buffer->data();
+  buffer = nullptr;
+
+  // 1020 is in the same size class as 1000.
+  buffer = under_test->AllocatePayloadBuffer(1020);
+  ASSERT_TRUE(buffer);
+  EXPECT_EQ(1020u, buffer->size());
+  EXPECT_EQ(data, buffer->data());
+
+  // 1500 isn't.
+  auto other_buffer = under_test->AllocatePayloadBuffer(1500);
+  ASSERT_TRUE(other_buffer);
+  EXPECT_NE(data, other_buffer->data());
+
+  EXPECT_EQ(3u, DumpValue(*under_test, "allocations"));
+  EXPECT_EQ(1u, DumpValue(*under_test, "pool hits"));
+}
+
+// Tests that steady-state allocation is satisfied entirely from the pool.
+TEST(LocalMemoryPayloadAllocatorTest, SteadyState) {
+  auto under_test = LocalMemoryPayloadAllocator::Create();
+
+  std::vector<fbl::RefPtr<PayloadBuffer>> buffers;
+  for (size_t i = 0; i < 8; ++i) {
+    buffers.push_back(under_test->AllocatePayloadBuffer(100000 + i * 1000));
+  }
+
+  // Release and reallocate buffers in FIFO order, as a decoder would.
+  for (size_t i = 0; i < 1000; ++i) {
+    buffers.erase(buffers.begin());
+    buffers.push_back(under_test->AllocatePayloadBuffer(100000 + i % 8 * 1000));
+    ASSERT_TRUE(buffers.back());
+  }
+
+  EXPECT_EQ(1008u, DumpValue(*under_test, "allocations"));
+  EXPECT_EQ(1000u, DumpValue(*under_test, "pool hits"));
+  EXPECT_EQ(0u, DumpValue(*under_test, "bytes trimmed"));
+}
+
+// Tests that the pool is limited by |max_aggregate_payload_size_| and that
+// oversized buffers bypass the pool.
+TEST(LocalMemoryPayloadAllocatorTest, Config) {
+  auto under_test = LocalMemoryPayloadAllocator::Create();
+
+  PayloadConfig config;
+  config.max_payload_size_ = 4096;
+  config.max_aggregate_payload_size_ = 4 * 4096;
+  under_test->SetConfig(config);
+
+  std::vector<fbl::RefPtr<PayloadBuffer>> buffers;
+  for (size_t i = 0; i < 8; ++i) {
+    buffers.push_back(under_test->AllocatePayloadBuffer(4096));
+  }
+
+  buffers.push_back(under_test->AllocatePayloadBuffer(4097));
+  EXPECT_EQ(1u, DumpValue(*under_test, "unpooled"));
+  EXPECT_EQ(8u * 4096, DumpValue(*under_test, "bytes in use"));
+
+  buffers.clear();
+  EXPECT_EQ(0u, DumpValue(*under_test, "bytes in use"));
+  EXPECT_EQ(4u * 4096, DumpValue(*under_test, "bytes pooled"));
+}
+
+// Tests that memory pooled after a burst is trimmed once usage falls.
+TEST(LocalMemoryPayloadAllocatorTest, Trim) {
+  auto under_test = LocalMemoryPayloadAllocator::Create();
+
+  std::vector<fbl::RefPtr<PayloadBuffer>> buffers;
+  for (size_t i = 0; i < 16; ++i) {
+    buffers.push_back(under_test->AllocatePayloadBuffer(65536));
+  }
+
+  buffers.clear();
+  EXPECT_EQ(16u * 65536, DumpValue(*under_test, "bytes pooled"));
+
+  // Two trim intervals with only one buffer in use at a time.
+  for (size_t i = 0; i < 512; ++i) {
+    ASSERT_TRUE(under_test->AllocatePayloadBuffer(65536));
+  }
+
+  EXPECT_EQ(65536u, DumpValue(*under_test, "high water mark"));
+  EXPECT_EQ(65536u, DumpValue(*under_test, "bytes pooled"));
+}
+
+}  // namespace
+}  // namespace media_player
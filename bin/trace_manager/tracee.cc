@@ -6,6 +6,8 @@
 
 #include <fbl/algorithm.h>
 #include <lib/async/default.h>
+
+#include <algorithm>
 #include <trace-engine/fields.h>
 #include <trace-provider/provider.h>
 
@@ -69,15 +71,26 @@ fuchsia::tracelink::BufferingMode EngineBufferingModeToTracelinkMode(
   }
 }
 
-uint64_t GetBufferWordsWritten(const uint64_t* buffer, uint64_t size_in_words) {
+// Returns the number of words of |buffer| occupied by complete records.
+// If |truncated| is non-null it is set to true if the scan stopped because
+// the next record extends past the end of |buffer|, as opposed to there
+// being no more records.
+uint64_t GetBufferWordsWritten(const uint64_t* buffer, uint64_t size_in_words,
+                               bool* truncated = nullptr) {
   const uint64_t* start = buffer;
   const uint64_t* current = start;
   const uint64_t* end = start + size_in_words;
 
+  if (truncated)
+    *truncated = false;
   while (current < end) {
     auto length = trace::RecordFields::RecordSize::Get<uint16_t>(*current);
-    if (length == 0 || length > trace::RecordFields::kMaxRecordSizeBytes ||
-        current + length >= end) {
+    if (length == 0 || length > trace::RecordFields::kMaxRecordSizeBytes) {
+      break;
+    }
+    if (current + length >= end) {
+      if (truncated)
+        *truncated = true;
       break;
     }
     current += length;
@@ -240,6 +253,7 @@ void Tracee::OnFifoReadable(async_dispatcher_t* dispatcher,
       }
       if (state_ == State::kStartPending) {
         TransitionToState(State::kStarted);
+        start_time_ = zx::clock::get_monotonic();
         fit::closure started_callback = std::move(started_callback_);
         FXL_DCHECK(started_callback);
         started_callback();
@@ -313,35 +327,54 @@ Tracee::TransferStatus Tracee::DoWriteChunk(const zx::socket& socket,
               << std::hex << vmo_offset << ", size 0x" << std::hex << size
               << (by_size ? ", by-size" : ", by-record");
 
-  // TODO(dje): Loop on smaller buffer.
-  // Better yet, be able to pass the entire vmo to the socket (still need to
+  // TODO(dje): Be able to pass the entire vmo to the socket (still need to
   // support multiple chunks: the writer will need vmo,offset,size parameters).
 
-  uint64_t size_in_words = trace::BytesToWords(size);
   // For paranoia purposes verify size is a multiple of the word size so we
   // don't risk overflowing the buffer later.
-  FXL_DCHECK(trace::WordsToBytes(size_in_words) == size);
-  std::vector<uint64_t> buffer(size_in_words);
+  FXL_DCHECK(trace::WordsToBytes(trace::BytesToWords(size)) == size);
+
+  while (size > 0) {
+    uint64_t chunk_size = std::min(size, kMaxChunkSizeBytes);
+    uint64_t chunk_size_in_words = trace::BytesToWords(chunk_size);
+    chunk_buffer_.resize(chunk_size_in_words);
+
+    if (buffer_vmo_.read(chunk_buffer_.data(), vmo_offset, chunk_size) !=
+        ZX_OK) {
+      FXL_LOG(ERROR) << *bundle_ << ": Failed to read data from buffer_vmo: "
+                     << "offset=" << vmo_offset << ", size=" << chunk_size;
+      return TransferStatus::kProviderError;
+    }
 
-  if (buffer_vmo_.read(buffer.data(), vmo_offset, size) != ZX_OK) {
-    FXL_LOG(ERROR) << *bundle_ << ": Failed to read data from buffer_vmo: "
-                   << "offset=" << vmo_offset << ", size=" << size;
-    return TransferStatus::kProviderError;
-  }
+    uint64_t bytes_written;
+    bool truncated = false;
+    if (!by_size) {
+      uint64_t words_written = GetBufferWordsWritten(
+          chunk_buffer_.data(), chunk_size_in_words, &truncated);
+      bytes_written = trace::WordsToBytes(words_written);
+    } else {
+      bytes_written = chunk_size;
+    }
 
-  uint64_t bytes_written;
-  if (!by_size) {
-    uint64_t words_written = GetBufferWordsWritten(buffer.data(), size_in_words);
-    bytes_written = trace::WordsToBytes(words_written);
-  } else {
-    bytes_written = size;
-  }
+    auto status =
+        WriteBufferToSocket(socket, chunk_buffer_.data(), bytes_written);
+    if (status != TransferStatus::kComplete) {
+      FXL_LOG(ERROR) << *bundle_ << ": Failed to write " << name << " records";
+      return status;
+    }
+    stats_.bytes_transferred += bytes_written;
 
-  auto status = WriteBufferToSocket(socket, buffer.data(), bytes_written);
-  if (status != TransferStatus::kComplete) {
-    FXL_LOG(ERROR) << *bundle_ << ": Failed to write " << name << " records";
+    if (!by_size && bytes_written < chunk_size) {
+      // Either we've reached the end of the records, or the next record
+      // straddles the chunk boundary, in which case resume the walk with it.
+      if (!truncated || bytes_written == 0 || chunk_size == size)
+        break;
+    }
+    vmo_offset += bytes_written;
+    size -= bytes_written;
   }
-  return status;
+
+  return TransferStatus::kComplete;
 }
 
 Tracee::TransferStatus Tracee::WriteChunkByRecords(const zx::socket& socket,
@@ -407,6 +440,7 @@ Tracee::TransferStatus Tracee::TransferRecords(const zx::socket& socket) const {
     return TransferStatus::kProviderError;
   }
 
+  stats_.records_dropped = header->num_records_dropped();
   if (header->num_records_dropped() > 0) {
     FXL_LOG(WARNING) << *bundle_ << ": " << header->num_records_dropped()
                      << " records were dropped";
@@ -484,6 +518,7 @@ Tracee::TransferStatus Tracee::TransferRecords(const zx::socket& socket) const {
                   << header->rolling_data_end(0) << ",0x" << std::hex
                   << header->rolling_data_end(1) << ", size 0x" << std::hex
                   << header->rolling_buffer_size();
+    LogStats();
   }
 
   return TransferStatus::kComplete;
@@ -497,6 +532,8 @@ void Tracee::TransferBuffer(const zx::socket& socket, uint32_t wrapped_count,
 
   if (!DoTransferBuffer(socket, wrapped_count, durable_data_end)) {
     Stop();
+  } else {
+    ++stats_.buffers_saved;
   }
 
   last_wrapped_count_ = wrapped_count;
@@ -546,6 +583,7 @@ bool Tracee::DoTransferBuffer(const zx::socket& socket, uint32_t wrapped_count,
   if (!VerifyBufferHeader(header.get())) {
     return false;
   }
+  UpdateRecordsDropped(header->num_records_dropped());
 
   // Don't use |header.durable_data_end| here, we want the value at the time
   // the message was sent.
@@ -673,6 +711,28 @@ Tracee::TransferStatus Tracee::WriteProviderBufferOverflowEvent(
                              trace::WordsToBytes(num_words));
 }
 
+void Tracee::UpdateRecordsDropped(uint64_t num_records_dropped) const {
+  if (num_records_dropped > stats_.records_dropped) {
+    FXL_LOG(WARNING) << *bundle_ << ": "
+                     << num_records_dropped - stats_.records_dropped
+                     << " more records were dropped";
+  }
+  stats_.records_dropped = num_records_dropped;
+}
+
+void Tracee::LogStats() const {
+  FXL_LOG(INFO) << "Bytes transferred: " << stats_.bytes_transferred;
+  if (buffering_mode_ != fuchsia::tracelink::BufferingMode::STREAMING)
+    return;
+  FXL_LOG(INFO) << "Buffers saved: " << stats_.buffers_saved;
+  zx::duration elapsed = zx::clock::get_monotonic() - start_time_;
+  if (start_time_ != zx::time() && elapsed >= zx::msec(1)) {
+    FXL_LOG(INFO) << "Throughput: "
+                  << stats_.bytes_transferred * 1000 / elapsed.to_msecs()
+                  << " bytes/sec over " << elapsed.to_msecs() << " ms";
+  }
+}
+
 const char* Tracee::ModeName(fuchsia::tracelink::BufferingMode mode) {
   switch (mode) {
     case fuchsia::tracelink::BufferingMode::ONESHOT:
@@ -9,10 +9,12 @@
 #include <lib/fit/function.h>
 #include <lib/zx/fifo.h>
 #include <lib/zx/socket.h>
+#include <lib/zx/time.h>
 #include <lib/zx/vmo.h>
 #include <trace-reader/reader_internal.h>
 
 #include <iosfwd>
+#include <vector>
 
 #include "garnet/bin/trace_manager/trace_provider_bundle.h"
 #include "lib/fidl/cpp/string.h"
@@ -86,6 +88,20 @@ class Tracee {
   // TODO(dje): The value will need playing with.
   static constexpr size_t kFifoSizeInPackets = 4u;
 
+  // The maximum number of bytes read from the buffer and written to the
+  // socket in one go.
+  static constexpr uint64_t kMaxChunkSizeBytes = 256u * 1024u;
+
+  // Statistics to help size provider buffers.
+  struct Stats {
+    // Number of bytes of records written to the socket.
+    uint64_t bytes_transferred = 0u;
+    // Number of buffers saved at the request of the provider.
+    uint64_t buffers_saved = 0u;
+    // The number of dropped records last reported in the buffer header.
+    uint64_t records_dropped = 0u;
+  };
+
   // Given |wrapped_count|, return the corresponding buffer number.
   static int get_buffer_number(uint32_t wrapped_count) {
     return wrapped_count & 1;
@@ -144,6 +160,11 @@ class Tracee {
 
   void NotifyBufferSaved(uint32_t wrapped_count, uint64_t durable_data_end);
 
+  // Log a warning if the provider dropped records since the last check.
+  void UpdateRecordsDropped(uint64_t num_records_dropped) const;
+
+  void LogStats() const;
+
   const TraceSession* const session_;
   const TraceProviderBundle* const bundle_;
   State state_ = State::kReady;
@@ -158,6 +179,11 @@ class Tracee {
   uint32_t last_wrapped_count_ = 0u;
   uint64_t last_durable_data_end_ = 0;
   mutable bool provider_info_record_written_ = false;
+  // Scratch space for reading the buffer, reused to avoid allocating for
+  // every chunk.
+  mutable std::vector<uint64_t> chunk_buffer_;
+  mutable Stats stats_;
+  zx::time start_time_;
 
   fxl::WeakPtrFactory<Tracee> weak_ptr_factory_;
   FXL_DISALLOW_COPY_AND_ASSIGN(Tracee);
@@ -0,0 +1,237 @@
+// Copyright 2018 The Fuchsia Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "garnet/bin/trace_manager/tracee.h"
+
+#include <lib/fidl/cpp/binding.h>
+#include <lib/zx/fifo.h>
+#include <lib/zx/socket.h>
+#include <lib/zx/vmo.h>
+#include <trace-provider/provider.h>
+
+#include <algorithm>
+#include <vector>
+
+#include "garnet/bin/trace_manager/trace_session.h"
+#include "lib/gtest/test_loop_fixture.h"
+
+namespace tracing {
+namespace {
+
+constexpr size_t kHeaderSize = sizeof(trace::internal::trace_buffer_header);
+constexpr size_t kDurableBufferSize = 64 * 1024;
+constexpr size_t kRollingBufferSize = 512 * 1024;
+constexpr size_t kBufferSize =
+    kHeaderSize + kDurableBufferSize + 2 * kRollingBufferSize;
+
+// Provider that lets the test write the trace buffer and talk to the tracee
+// over the fifo, in place of the trace engine.
+class FakeProvider : public fuchsia::tracelink::Provider {
+ public:
+  explicit FakeProvider(
+      fidl::InterfaceRequest<fuchsia::tracelink::Provider> request)
+      : binding_(this, std::move(request)) {}
+
+  bool started() const { return buffer_.is_valid(); }
+
+  // Provider implementation.
+  void Start(fuchsia::tracelink::BufferingMode buffering_mode, zx::vmo buffer,
+             zx::fifo fifo, fidl::VectorPtr<fidl::StringPtr> categories)
+      override {
+    buffer_ = std::move(buffer);
+    fifo_ = std::move(fifo);
+
+    header_ = trace::internal::trace_buffer_header{};
+    header_.magic = TRACE_BUFFER_HEADER_MAGIC;
+    header_.version = TRACE_BUFFER_HEADER_V0;
+    header_.buffering_mode = TRACE_BUFFERING_MODE_STREAMING;
+    header_.total_size = kBufferSize;
+    header_.durable_buffer_size = kDurableBufferSize;
+    header_.rolling_buffer_size = kRollingBufferSize;
+    WriteHeader();
+  }
+
+  void Stop() override {}
+
+  // Appends |words| to the durable buffer.
+  void WriteDurable(const std::vector<uint64_t>& words) {
+    WriteWords(kHeaderSize + header_.durable_data_end, words);
+    header_.durable_data_end += words.size() * sizeof(uint64_t);
+    WriteHeader();
+  }
+
+  // Appends |words| to rolling buffer |buffer_number|.
+  void WriteRolling(int buffer_number, const std::vector<uint64_t>& words) {
+    WriteWords(kHeaderSize + kDurableBufferSize +
+                   buffer_number * kRollingBufferSize +
+                   header_.rolling_data_end[buffer_number],
+               words);
+    header_.rolling_data_end[buffer_number] +=
+        words.size() * sizeof(uint64_t);
+    WriteHeader();
+  }
+
+  // Switches to the other rolling buffer and asks for the full one to be
+  // saved, as the engine does when a rolling buffer fills.
+  void SaveBuffer() {
+    SendPacket(TRACE_PROVIDER_SAVE_BUFFER, header_.wrapped_count,
+               header_.durable_data_end);
+    ++header_.wrapped_count;
+    header_.rolling_data_end[header_.wrapped_count & 1] = 0;
+    WriteHeader();
+  }
+
+  void SendStarted() {
+    SendPacket(TRACE_PROVIDER_STARTED, TRACE_PROVIDER_FIFO_PROTOCOL_VERSION, 0);
+  }
+
+  // Reads a packet sent by the tracee, returning false if there is none.
+  bool ReadPacket(trace_provider_packet_t* packet) {
+    return fifo_.read(sizeof(*packet), packet, 1u, nullptr) == ZX_OK;
+  }
+
+ private:
+  void WriteWords(uint64_t offset, const std::vector<uint64_t>& words) {
+    EXPECT_EQ(ZX_OK, buffer_.write(words.data(), offset,
+                                   words.size() * sizeof(uint64_t)));
+  }
+
+  void WriteHeader() {
+    EXPECT_EQ(ZX_OK, buffer_.write(&header_, 0, sizeof(header_)));
+  }
+
+  void SendPacket(uint16_t request, uint32_t data32, uint64_t data64) {
+    trace_provider_packet_t packet{};
+    packet.request = request;
+    packet.data32 = data32;
+    packet.data64 = data64;
+    EXPECT_EQ(ZX_OK, fifo_.write(sizeof(packet), &packet, 1u, nullptr));
+  }
+
+  fidl::Binding<fuchsia::tracelink::Provider> binding_;
+  zx::vmo buffer_;
+  zx::fifo fifo_;
+  trace::internal::trace_buffer_header header_{};
+};
+
+// Returns |count| words which are unlikely to occur elsewhere in the output,
+// starting with |first|.
+std::vector<uint64_t> MakeWords(uint64_t first, size_t count) {
+  std::vector<uint64_t> words(count);
+  for (size_t i = 0; i < count; ++i) {
+    words[i] = first + i;
+  }
+  return words;
+}
+
+class TraceeTest : public ::gtest::TestLoopFixture {
+ protected:
+  void SetUp() override {
+    ::gtest::TestLoopFixture::SetUp();
+
+    zx::socket outgoing;
+    ASSERT_EQ(ZX_OK, zx::socket::create(0u, &outgoing, &incoming_));
+
+    fuchsia::tracelink::ProviderPtr provider_ptr;
+    provider_ = std::make_unique<FakeProvider>(provider_ptr.NewRequest());
+    bundle_ = std::make_unique<TraceProviderBundle>(
+        TraceProviderBundle{std::move(provider_ptr), 1u, 1u, "test"});
+
+    session_ = fxl::MakeRefCounted<TraceSession>(
+        std::move(outgoing), fidl::VectorPtr<fidl::StringPtr>::New(0),
+        kBufferSize, fuchsia::tracelink::BufferingMode::STREAMING,
+        [] { FAIL() << "Session aborted"; });
+
+    tracee_ = std::make_unique<Tracee>(session_.get(), bundle_.get());
+    ASSERT_TRUE(tracee_->Start(
+        fidl::VectorPtr<fidl::StringPtr>::New(0), kBufferSize,
+        fuchsia::tracelink::BufferingMode::STREAMING, [] {}, [] {}));
+    RunLoopUntilIdle();
+    ASSERT_TRUE(provider_->started());
+
+    provider_->SendStarted();
+    RunLoopUntilIdle();
+    ASSERT_EQ(Tracee::State::kStarted, tracee_->state());
+  }
+
+  // Returns everything written to the destination socket so far.
+  std::vector<uint64_t> ReadOutput() {
+    std::vector<uint64_t> output;
+    uint64_t words[256];
+    size_t actual;
+    while (incoming_.read(0u, words, sizeof(words), &actual) == ZX_OK) {
+      EXPECT_EQ(0u, actual % sizeof(uint64_t));
+      output.insert(output.end(), words, words + actual / sizeof(uint64_t));
+    }
+    return output;
+  }
+
+  // Returns true if |output| contains |words| as a contiguous sequence.
+  static bool Contains(const std::vector<uint64_t>& output,
+                       const std::vector<uint64_t>& words) {
+    return std::search(output.begin(), output.end(), words.begin(),
+                       words.end()) != output.end();
+  }
+
+  zx::socket incoming_;
+  std::unique_ptr<FakeProvider> provider_;
+  std::unique_ptr<TraceProviderBundle> bundle_;
+  fxl::RefPtr<TraceSession> session_;
+  std::unique_ptr<Tracee> tracee_;
+};
+
+// Records in a full rolling buffer, and the durable records written before it
+// filled, reach the receiver when the buffer is saved, while tracing is still
+// running.
+TEST_F(TraceeTest, SavedBufferArrivesBeforeStop) {
+  auto durable = MakeWords(0xd000000000000000u, 4);
+  auto rolling = MakeWords(0xa000000000000000u, 16);
+  provider_->WriteDurable(durable);
+  provider_->WriteRolling(0, rolling);
+  EXPECT_TRUE(ReadOutput().empty());
+
+  provider_->SaveBuffer();
+  RunLoopUntilIdle();
+
+  auto output = ReadOutput();
+  EXPECT_TRUE(Contains(output, durable));
+  EXPECT_TRUE(Contains(output, rolling));
+  EXPECT_EQ(Tracee::State::kStarted, tracee_->state());
+
+  trace_provider_packet_t packet;
+  ASSERT_TRUE(provider_->ReadPacket(&packet));
+  EXPECT_EQ(TRACE_PROVIDER_BUFFER_SAVED, packet.request);
+  EXPECT_EQ(0u, packet.data32);
+  EXPECT_EQ(durable.size() * sizeof(uint64_t), packet.data64);
+}
+
+// Each saved buffer is written once, and only the durable records added since
+// the previous save are written with it.
+TEST_F(TraceeTest, DurableRecordsAreWrittenOnce) {
+  auto durable0 = MakeWords(0xd000000000000000u, 4);
+  auto rolling0 = MakeWords(0xa000000000000000u, 16);
+  provider_->WriteDurable(durable0);
+  provider_->WriteRolling(0, rolling0);
+  provider_->SaveBuffer();
+  RunLoopUntilIdle();
+  auto output = ReadOutput();
+  EXPECT_TRUE(Contains(output, durable0));
+  EXPECT_TRUE(Contains(output, rolling0));
+
+  auto durable1 = MakeWords(0xd100000000000000u, 6);
+  auto rolling1 = MakeWords(0xa100000000000000u, 16);
+  provider_->WriteDurable(durable1);
+  provider_->WriteRolling(1, rolling1);
+  provider_->SaveBuffer();
+  RunLoopUntilIdle();
+  output = ReadOutput();
+  EXPECT_FALSE(Contains(output, durable0));
+  EXPECT_FALSE(Contains(output, rolling0));
+  EXPECT_TRUE(Contains(output, durable1));
+  EXPECT_TRUE(Contains(output, rolling1));
+  EXPECT_EQ(Tracee::State::kStarted, tracee_->state());
+}
+
+}  // namespace
+}  // namespace tracing
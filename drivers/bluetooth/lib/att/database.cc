@@ -4,27 +4,16 @@
 
 #include "database.h"
 
-#include <algorithm>
-
 #include <zircon/assert.h>
+#include <zircon/compiler.h>
 
 #include "garnet/drivers/bluetooth/lib/common/log.h"
 
 namespace btlib {
 namespace att {
-namespace {
-
-bool StartLessThan(const AttributeGrouping& grp, const Handle handle) {
-  return grp.start_handle() < handle;
-}
-
-bool EndLessThan(const AttributeGrouping& grp, const Handle handle) {
-  return grp.end_handle() < handle;
-}
-
-}  // namespace
 
 Database::Iterator::Iterator(GroupingList* list,
+                             GroupingList::iterator first,
                              Handle start,
                              Handle end,
                              const common::UUID* type,
@@ -36,12 +25,13 @@ Database::Iterator::Iterator(GroupingList* list,
   if (type)
     type_filter_ = *type;
 
-  // Initialize the iterator by performing a binary search over the attributes.
   // If we were asked to iterate over groupings only, then look strictly within
   // the range. Otherwise we allow the first grouping to partially overlap the
   // range.
-  grp_iter_ = std::lower_bound(list->begin(), grp_end_, start_,
-                               grp_only_ ? StartLessThan : EndLessThan);
+  grp_iter_ = first;
+  if (grp_only_ && !AtEnd() && grp_iter_->start_handle() < start_) {
+    grp_iter_++;
+  }
 
   if (AtEnd())
     return;
@@ -147,7 +137,8 @@ Database::Iterator Database::GetIterator(Handle start,
   ZX_DEBUG_ASSERT(end <= range_end_);
   ZX_DEBUG_ASSERT(start <= end);
 
-  return Iterator(&groupings_, start, end, type, groups_only);
+  return Iterator(&groupings_, FindGrouping(start), start, end, type,
+                  groups_only);
 }
 
 AttributeGrouping* Database::NewGrouping(const common::UUID& group_type,
@@ -198,16 +189,19 @@ AttributeGrouping* Database::NewGrouping(const common::UUID& group_type,
       groupings_.emplace(pos, group_type, start_handle, attr_count, decl_value);
   ZX_DEBUG_ASSERT(iter != groupings_.end());
 
+  __UNUSED bool inserted =
+      grouping_index_.emplace(iter->end_handle(), iter).second;
+  ZX_DEBUG_ASSERT(inserted);
+
   return &*iter;
 }
 
 bool Database::RemoveGrouping(Handle start_handle) {
-  auto iter = std::lower_bound(groupings_.begin(), groupings_.end(),
-                               start_handle, StartLessThan);
-
+  auto iter = FindGrouping(start_handle);
   if (iter == groupings_.end() || iter->start_handle() != start_handle)
     return false;
 
+  grouping_index_.erase(iter->end_handle());
   groupings_.erase(iter);
   return true;
 }
@@ -216,9 +210,7 @@ const Attribute* Database::FindAttribute(Handle handle) {
   if (handle == kInvalidHandle)
     return nullptr;
 
-  // Do a binary search to find the grouping that this handle is in.
-  auto iter = std::lower_bound(groupings_.begin(), groupings_.end(), handle,
-                               EndLessThan);
+  auto iter = FindGrouping(handle);
   if (iter == groupings_.end() || iter->start_handle() > handle)
     return nullptr;
 
@@ -231,5 +223,13 @@ const Attribute* Database::FindAttribute(Handle handle) {
   return &iter->attributes()[index];
 }
 
+Database::GroupingList::iterator Database::FindGrouping(Handle handle) {
+  auto iter = grouping_index_.lower_bound(handle);
+  if (iter == grouping_index_.end())
+    return groupings_.end();
+
+  return iter->second;
+}
+
 }  // namespace att
 }  // namespace btlib
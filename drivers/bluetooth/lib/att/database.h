@@ -6,6 +6,7 @@
 #define GARNET_DRIVERS_BLUETOOTH_LIB_ATT_DATABASE_H_
 
 #include <list>
+#include <map>
 #include <memory>
 
 #include "garnet/drivers/bluetooth/lib/att/att.h"
@@ -64,7 +65,11 @@ class Database final : public fxl::RefCountedThreadSafe<Database> {
     inline void MarkEnd() { grp_iter_ = grp_end_; }
 
     friend class Database;
+
+    // |first| must be the first grouping in |list| that ends at or after
+    // |start|.
     Iterator(GroupingList* list,
+             GroupingList::iterator first,
              Handle start,
              Handle end,
              const common::UUID* type,
@@ -138,6 +143,11 @@ class Database final : public fxl::RefCountedThreadSafe<Database> {
   Database(Handle range_start, Handle range_end);
   ~Database() = default;
 
+  // Returns the first grouping that ends at or after |handle|, i.e. the
+  // grouping that contains |handle| if there is one, or else the first one
+  // after it. Returns groupings_.end() if there is no such grouping.
+  GroupingList::iterator FindGrouping(Handle handle);
+
   Handle range_start_;
   Handle range_end_;
 
@@ -145,11 +155,18 @@ class Database final : public fxl::RefCountedThreadSafe<Database> {
   // non-overlapping handle range. Successive groupings don't necessarily
   // represent contiguous handle ranges as any grouping can be removed.
   //
-  // Note: This uses a std::list because fbl::lower_bound doesn't work with a
-  // common::LinkedList (aka fbl::DoublyLinkedList). This is only marginally
-  // less space efficient.
+  // Note: This uses a std::list, rather than a vector, so that the pointers
+  // returned by NewGrouping() remain valid as other groupings are added and
+  // removed.
   GroupingList groupings_;
 
+  // Indexes |groupings_| by the end handle of each grouping. A binary search
+  // over a std::list has to walk the list, so lookups by handle go through
+  // this map instead. This keeps FindAttribute() and positioning an Iterator
+  // at O(log n), which matters when a client discovers a large database with
+  // one request per MTU-sized chunk of the handle range.
+  std::map<Handle, GroupingList::iterator> grouping_index_;
+
   FXL_DISALLOW_COPY_AND_ASSIGN(Database);
 };
 
@@ -4,10 +4,14 @@
 
 #include "database.h"
 
+#include <chrono>
+
 #include <zircon/assert.h>
 
 #include "gtest/gtest.h"
 
+#include "garnet/drivers/bluetooth/lib/common/log.h"
+
 namespace btlib {
 namespace att {
 namespace {
@@ -139,6 +143,51 @@ TEST(ATT_DatabaseTest, NewGroupingMultipleInsertions) {
   EXPECT_FALSE(db->NewGrouping(kTestType1, 0, kTestValue1));
 }
 
+TEST(ATT_DatabaseTest, FindAttributeAfterRemovingAndReinserting) {
+  constexpr size_t kGroupingCount = 100;
+  constexpr size_t kAttrCount = 3;
+
+  // Leave no room after the last grouping, so that new groupings go into the
+  // gaps left by removed ones.
+  constexpr Handle kRangeEnd = kGroupingCount * (kAttrCount + 1);
+  auto db = Database::Create(kHandleMin, kRangeEnd);
+
+  auto new_grouping = [&db] {
+    auto* grp = db->NewGrouping(kTestType1, kAttrCount, kTestValue1);
+    ZX_DEBUG_ASSERT(grp);
+    for (size_t i = 0; i < kAttrCount; i++) {
+      grp->AddAttribute(kTestType2);
+    }
+    grp->set_active(true);
+    return grp;
+  };
+
+  std::vector<Handle> start_handles;
+  for (size_t i = 0; i < kGroupingCount; i++) {
+    start_handles.push_back(new_grouping()->start_handle());
+  }
+
+  // Remove every other grouping and fill the resulting gaps again.
+  for (size_t i = 0; i < kGroupingCount; i += 2) {
+    EXPECT_TRUE(db->RemoveGrouping(start_handles[i]));
+    EXPECT_EQ(nullptr, db->FindAttribute(start_handles[i]));
+  }
+  for (size_t i = 0; i < kGroupingCount; i += 2) {
+    EXPECT_EQ(start_handles[i], new_grouping()->start_handle());
+  }
+
+  const Handle last_handle = start_handles.back() + kAttrCount;
+  for (Handle handle = kHandleMin; handle <= last_handle; handle++) {
+    const Attribute* attr = db->FindAttribute(handle);
+    ASSERT_NE(nullptr, attr);
+    EXPECT_EQ(handle, attr->handle());
+  }
+  EXPECT_EQ(nullptr, db->FindAttribute(last_handle + 1));
+
+  auto iter = db->GetIterator(kHandleMin, kRangeEnd, nullptr, true);
+  EXPECT_EQ(start_handles, IterHandles(&iter));
+}
+
 TEST(ATT_DatabaseTest, RemoveWhileEmpty) {
   auto db = Database::Create(kTestRangeStart, kTestRangeEnd);
   EXPECT_FALSE(db->RemoveGrouping(kTestRangeStart));
@@ -521,6 +570,108 @@ TEST_F(ATT_DatabaseIteratorManyTest, Range) {
   }
 }
 
+// Populates a database with |service_count| groupings that resemble GATT
+// services, each containing two "characteristics" (kTestType2 followed by a
+// kTestType3 value) and a kTestType3 "descriptor".
+fxl::RefPtr<Database> CreateLargeDatabase(size_t service_count) {
+  constexpr size_t kAttrCount = 5;
+  auto db = Database::Create();
+  for (size_t i = 0; i < service_count; i++) {
+    auto* grp = db->NewGrouping(kTestType1, kAttrCount, kTestValue1);
+    ZX_DEBUG_ASSERT(grp);
+    grp->AddAttribute(kTestType2);
+    grp->AddAttribute(kTestType3);
+    grp->AddAttribute(kTestType2);
+    grp->AddAttribute(kTestType3);
+    grp->AddAttribute(kTestType3);
+    grp->set_active(true);
+  }
+  return db;
+}
+
+struct DiscoveryResult {
+  size_t service_count = 0;
+  size_t characteristic_count = 0;
+  size_t request_count = 0;
+};
+
+// Performs the database lookups of a GATT client discovering all services and
+// then all characteristics of each service, the way gatt::Server handles the
+// resulting Read By Group Type and Read By Type requests: each request is for
+// the rest of the handle range and its response holds at most
+// |results_per_request| attributes.
+DiscoveryResult DiscoverAll(Database* db, size_t results_per_request) {
+  DiscoveryResult result;
+  std::vector<std::pair<Handle, Handle>> service_ranges;
+
+  Handle start = kHandleMin;
+  while (true) {
+    ++result.request_count;
+    auto iter = db->GetIterator(start, kHandleMax, &kTestType1, true);
+    if (iter.AtEnd())
+      break;
+
+    Handle last_end = start;
+    for (size_t i = 0; i < results_per_request && !iter.AtEnd();
+         i++, iter.Advance()) {
+      const Attribute* attr = iter.get();
+      service_ranges.emplace_back(attr->handle(), attr->group().end_handle());
+      last_end = attr->group().end_handle();
+    }
+    if (last_end == kHandleMax)
+      break;
+    start = last_end + 1;
+  }
+  result.service_count = service_ranges.size();
+
+  for (const auto& range : service_ranges) {
+    start = range.first;
+    while (start <= range.second) {
+      ++result.request_count;
+      auto iter = db->GetIterator(start, range.second, &kTestType2);
+      if (iter.AtEnd())
+        break;
+
+      Handle last_handle = start;
+      for (size_t i = 0; i < results_per_request && !iter.AtEnd();
+           i++, iter.Advance()) {
+        last_handle = iter.get()->handle();
+        ++result.characteristic_count;
+      }
+      start = last_handle + 1;
+    }
+  }
+
+  return result;
+}
+
+TEST(ATT_DatabaseTest, DiscoverLargeDatabase) {
+  constexpr size_t kServiceCount = 2000;
+  auto db = CreateLargeDatabase(kServiceCount);
+
+  auto result = DiscoverAll(db.get(), 4);
+  EXPECT_EQ(kServiceCount, result.service_count);
+  EXPECT_EQ(2 * kServiceCount, result.characteristic_count);
+}
+
+// Measures the time taken to discover a database with thousands of attributes.
+// Run with --gtest_also_run_disabled_tests.
+TEST(ATT_DatabaseTest, DISABLED_DiscoverLargeDatabaseBenchmark) {
+  for (size_t service_count : {100u, 1000u, 10000u}) {
+    auto db = CreateLargeDatabase(service_count);
+
+    const auto start = std::chrono::steady_clock::now();
+    auto result = DiscoverAll(db.get(), 4);
+    const std::chrono::duration<double, std::micro> elapsed =
+        std::chrono::steady_clock::now() - start;
+    EXPECT_EQ(service_count, result.service_count);
+
+    bt_log(INFO, "att", "%zu attributes: %zu requests in %.0f us (%.2f us/req)",
+           service_count * 6, result.request_count, elapsed.count(),
+           elapsed.count() / result.request_count);
+  }
+}
+
 }  // namespace
 }  // namespace att
 }  // namespace btlib
@@ -4,6 +4,7 @@
 
 #include "socket_channel_relay.h"
 
+#include <memory>
 #include <utility>
 
 #include <lib/async/default.h>
@@ -200,10 +201,19 @@ bool SocketChannelRelay::CopyFromSocketToChannel() {
   // else on |dispatcher|), if a misbehaving process spams its L2CAP socket. And
   // even if starvation isn't an issue, latency/jitter might be.
   zx_status_t read_res;
-  uint8_t read_buf[read_buf_size];
   do {
+    // Read directly into the buffer that is handed off to |channel_|, so that
+    // the SDU is only copied once more, when it is fragmented into ACL data
+    // packets. The buffer is left uninitialized as the read overwrites it.
+    //
+    // TODO(NET-1391): For low latency and low jitter, IWBN to avoid allocating
+    // dynamic memory for every SDU.
+    if (!socket_read_buf_) {
+      socket_read_buf_.reset(new uint8_t[read_buf_size]);
+    }
     size_t n_bytes_read = 0;
-    read_res = socket_.read(0, read_buf, read_buf_size, &n_bytes_read);
+    read_res = socket_.read(0, socket_read_buf_.get(), read_buf_size,
+                            &n_bytes_read);
     ZX_DEBUG_ASSERT_MSG(read_res == ZX_OK || read_res == ZX_ERR_SHOULD_WAIT ||
                             read_res == ZX_ERR_PEER_CLOSED,
                         "%s", zx_status_get_string(read_res));
@@ -227,11 +237,9 @@ bool SocketChannelRelay::CopyFromSocketToChannel() {
       return false;
     }
 
-    // TODO(NET-1391): For low latency and low jitter, IWBN to avoid allocating
-    // dynamic memory on every read.
     bool write_success =
         channel_->Send(std::make_unique<common::DynamicByteBuffer>(
-            common::BufferView(read_buf, n_bytes_read)));
+            n_bytes_read, std::move(socket_read_buf_)));
     if (!write_success) {
       bt_log(DEBUG, "l2cap", "Failed to write %zu bytes to channel %u",
              n_bytes_read, channel_->id());
@@ -5,6 +5,8 @@
 #ifndef GARNET_DRIVERS_BLUETOOTH_LIB_DATA_SOCKET_CHANNEL_RELAY_H_
 #define GARNET_DRIVERS_BLUETOOTH_LIB_DATA_SOCKET_CHANNEL_RELAY_H_
 
+#include <memory>
+
 #include <lib/async/cpp/wait.h>
 #include <lib/fit/function.h>
 #include <zircon/status.h>
@@ -139,6 +141,12 @@ class SocketChannelRelay final {
   // TODO(NET-1476): We should set an upper bound on the size of this queue.
   std::deque<l2cap::SDU> socket_write_queue_;
 
+  // Buffer for the next read from |socket_|, of |channel_->tx_mtu() + 1|
+  // bytes. It is handed off to |channel_| after each successful read, and kept
+  // for the next read otherwise, so that a read that finds no data doesn't
+  // cost an allocation.
+  std::unique_ptr<uint8_t[]> socket_read_buf_;
+
   const fxl::ThreadChecker thread_checker_;
   fxl::WeakPtrFactory<SocketChannelRelay> weak_ptr_factory_;  // Keep last.
 
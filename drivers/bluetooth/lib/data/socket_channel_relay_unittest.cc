@@ -346,6 +346,22 @@ TEST_F(DATA_SocketChannelRelayRxTest,
       kExpectedMessage2, ReadDatagramFromSocket(kExpectedMessage2.size())));
 }
 
+TEST_F(DATA_SocketChannelRelayRxTest,
+       SduSpanningMultipleFragmentsIsCopiedToSocket) {
+  // FakeChannel fragments SDUs into ACL data packets of at most
+  // hci::kMaxACLPayloadSize bytes, so this SDU spans several fragments.
+  common::DynamicByteBuffer expected_message(3 * hci::kMaxACLPayloadSize);
+  for (size_t i = 0; i < expected_message.size(); ++i) {
+    expected_message[i] = static_cast<uint8_t>(i);
+  }
+  ASSERT_TRUE(relay()->Activate());
+  channel()->Receive(expected_message);
+  RunLoopUntilIdle();
+
+  EXPECT_TRUE(common::ContainersEqual(
+      expected_message, ReadDatagramFromSocket(expected_message.size())));
+}
+
 TEST_F(DATA_SocketChannelRelayRxTest,
        SduFromChannelIsCopiedToSocketWhenSocketUnblocks) {
   size_t n_junk_bytes = StuffSocket();
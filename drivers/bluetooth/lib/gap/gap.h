@@ -135,6 +135,14 @@ constexpr uint16_t kLEInitialConnIntervalCodedMax = 0x0078;  // 150 ms
 // cache.
 constexpr zx::duration kCacheTimeout = zx::sec(60);
 
+// During LE discovery, advertising reports that repeat a device's advertising
+// data within this interval of the last report from the device that was
+// processed are dropped. This mostly matters in crowded environments, where the
+// controller's duplicate filter cannot keep track of every advertiser. The RSSI
+// of a dropped report is dropped with it, so RSSI updates for a device whose
+// advertising data does not change arrive at most once per window.
+constexpr zx::duration kLEDuplicateReportWindow = zx::sec(1);
+
 }  // namespace gap
 }  // namespace btlib
 
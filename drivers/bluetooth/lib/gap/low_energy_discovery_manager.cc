@@ -4,6 +4,7 @@
 
 #include "low_energy_discovery_manager.h"
 
+#include <lib/async/cpp/time.h>
 #include <zircon/assert.h>
 
 #include "garnet/drivers/bluetooth/lib/hci/legacy_low_energy_scanner.h"
@@ -188,12 +189,25 @@ void LowEnergyDiscoveryManager::OnDeviceFound(
     return;
   }
 
+  // Drop reports which repeat the advertising data we processed for the same
+  // address less than kLEDuplicateReportWindow ago.  The RSSI of a dropped
+  // report is not recorded, so the RSSI reported for a device that keeps
+  // advertising the same data is up to kLEDuplicateReportWindow old.
+  const zx::time now = async::Now(dispatcher_);
   auto device = device_cache_->FindDeviceByAddress(result.address);
-  if (!device) {
+  if (device) {
+    auto iter = last_report_times_.find(result.address);
+    if (iter != last_report_times_.end() &&
+        now - iter->second < kLEDuplicateReportWindow && device->le() &&
+        device->le()->advertising_data() == data) {
+      return;
+    }
+  } else {
     device = device_cache_->NewDevice(result.address, result.connectable);
   }
   device->MutLe().SetAdvertisingData(result.rssi, data);
 
+  last_report_times_[result.address] = now;
   cached_scan_results_.insert(device->identifier());
 
   for (const auto& session : sessions_) {
@@ -294,6 +308,7 @@ void LowEnergyDiscoveryManager::OnScanStatus(
       bt_log(TRACE, "gap-le", "stopped scanning");
 
       cached_scan_results_.clear();
+      last_report_times_.clear();
 
       // Some clients might have requested to start scanning while we were
       // waiting for it to stop. Restart active scanning if that is the case.
@@ -309,6 +324,7 @@ void LowEnergyDiscoveryManager::OnScanStatus(
     case hci::LowEnergyScanner::ScanStatus::kComplete:
       bt_log(SPEW, "gap-le", "end of scan period");
       cached_scan_results_.clear();
+      last_report_times_.clear();
 
       // If |sessions_| is empty this is because sessions were stopped while the
       // scanner was shutting down after the end of the scan period. Restart the
@@ -7,10 +7,12 @@
 
 #include <memory>
 #include <queue>
+#include <unordered_map>
 #include <unordered_set>
 
 #include <lib/async/dispatcher.h>
 #include <lib/fit/function.h>
+#include <lib/zx/time.h>
 
 #include "garnet/drivers/bluetooth/lib/common/byte_buffer.h"
 #include "garnet/drivers/bluetooth/lib/common/device_address.h"
@@ -270,6 +272,11 @@ class LowEnergyDiscoveryManager final : public hci::LowEnergyScanner::Delegate {
   // the currently cached results for this period.
   std::unordered_set<std::string> cached_scan_results_;
 
+  // The time at which the last advertising report from each address was
+  // processed during the current scan period, which is used to drop duplicate
+  // reports (see kLEDuplicateReportWindow).
+  std::unordered_map<common::DeviceAddress, zx::time> last_report_times_;
+
   // The value (in ms) that we use for the duration of each scan period.
   int64_t scan_period_ = kLEGeneralDiscoveryScanMinMs;
 
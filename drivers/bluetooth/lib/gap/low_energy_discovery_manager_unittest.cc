@@ -4,6 +4,7 @@
 
 #include "garnet/drivers/bluetooth/lib/gap/low_energy_discovery_manager.h"
 
+#include <chrono>
 #include <unordered_set>
 #include <vector>
 
@@ -1011,6 +1012,100 @@ TEST_F(GAP_LowEnergyDiscoveryManagerTest, BackgroundScanPeriodRestart) {
   EXPECT_TRUE(scan_states()[2]);
 }
 
+TEST_F(GAP_LowEnergyDiscoveryManagerTest, DuplicateAdvertisingReportsDropped) {
+  const auto kAdvData = common::CreateStaticByteBuffer(
+      // Complete local name
+      0x09, 0x09, 'D', 'e', 'v', 'i', 'c', 'e', ' ', '0');
+  const auto kNewAdvData = common::CreateStaticByteBuffer(
+      // Complete local name
+      0x09, 0x09, 'D', 'e', 'v', 'i', 'c', 'e', ' ', '1');
+  auto fake_device = std::make_unique<FakeDevice>(kAddress0, true, false);
+  fake_device->SetAdvertisingData(kAdvData);
+  FakeDevice* fake_device_ptr = fake_device.get();
+  test_device()->AddDevice(std::move(fake_device));
+
+  auto session = StartDiscoverySession();
+  int result_count = 0;
+  session->SetResultCallback([&](const auto& device) { result_count++; });
+  RunLoopUntilIdle();
+  EXPECT_EQ(1, result_count);
+
+  // The controller may not filter all duplicates, e.g. when it is tracking too
+  // many devices. Identical reports within the window should be dropped.
+  test_device()->SendCommandChannelPacket(
+      fake_device_ptr->CreateAdvertisingReportEvent(false));
+  RunLoopUntilIdle();
+  EXPECT_EQ(1, result_count);
+
+  // Reports with new advertising data are always processed.
+  fake_device_ptr->SetAdvertisingData(kNewAdvData);
+  test_device()->SendCommandChannelPacket(
+      fake_device_ptr->CreateAdvertisingReportEvent(false));
+  RunLoopUntilIdle();
+  EXPECT_EQ(2, result_count);
+
+  auto device = device_cache()->FindDeviceByAddress(kAddress0);
+  ASSERT_TRUE(device);
+  ASSERT_TRUE(device->name());
+  EXPECT_EQ("Device 1", *device->name());
+
+  // Once the window has elapsed, the same report is processed again.
+  RunLoopFor(kLEDuplicateReportWindow);
+  test_device()->SendCommandChannelPacket(
+      fake_device_ptr->CreateAdvertisingReportEvent(false));
+  RunLoopUntilIdle();
+  EXPECT_EQ(3, result_count);
+}
+
+// Measures how fast advertising reports from a crowded environment are
+// processed when the controller fails to filter duplicates. Run with
+// --gtest_also_run_disabled_tests.
+TEST_F(GAP_LowEnergyDiscoveryManagerTest,
+       DISABLED_AdvertisingReportThroughput) {
+  constexpr size_t kDeviceCount = 1000;
+  constexpr size_t kRounds = 20;
+  const auto kAdvData = common::CreateStaticByteBuffer(
+      // Flags
+      0x02, 0x01, 0x02,
+
+      // Complete 16-bit service UUIDs
+      0x05, 0x03, 0x0d, 0x18, 0x0f, 0x18,
+
+      // Complete local name
+      0x09, 0x09, 'D', 'e', 'v', 'i', 'c', 'e', ' ', '0');
+
+  std::vector<common::DynamicByteBuffer> events;
+  for (size_t i = 0; i < kDeviceCount; i++) {
+    common::DeviceAddress address(
+        common::DeviceAddress::Type::kLEPublic,
+        common::DeviceAddressBytes({static_cast<uint8_t>(i),
+                                    static_cast<uint8_t>(i >> 8), 0, 0, 0,
+                                    0}));
+    FakeDevice fake_device(address, true, false);
+    fake_device.SetAdvertisingData(kAdvData);
+    events.push_back(fake_device.CreateAdvertisingReportEvent(false));
+  }
+
+  auto session = StartDiscoverySession();
+  size_t result_count = 0;
+  session->SetResultCallback([&](const auto& device) { result_count++; });
+
+  const auto start = std::chrono::steady_clock::now();
+  for (size_t round = 0; round < kRounds; round++) {
+    for (const auto& event : events) {
+      test_device()->SendCommandChannelPacket(event);
+    }
+    RunLoopUntilIdle();
+  }
+  const std::chrono::duration<double> elapsed =
+      std::chrono::steady_clock::now() - start;
+
+  EXPECT_EQ(kDeviceCount, device_cache()->count());
+  EXPECT_EQ(kDeviceCount, result_count);
+  bt_log(INFO, "gap-test", "%zu devices: %.0f reports/s", kDeviceCount,
+         kDeviceCount * kRounds / elapsed.count());
+}
+
 }  // namespace
 }  // namespace gap
 }  // namespace btlib
@@ -52,6 +52,15 @@ void RemoteDevice::LowEnergyData::SetAdvertisingData(
 
   bool notify_listeners = dev_->SetRssiInternal(rssi);
 
+  // Devices usually advertise the same data over and over, so there is nothing
+  // to copy or parse unless it changed.
+  if (adv == advertising_data()) {
+    if (notify_listeners) {
+      dev_->NotifyListeners();
+    }
+    return;
+  }
+
   // Update the advertising data
   // TODO(armansito): Validate that the advertising data is not malformed?
   if (adv_data_buffer_.size() < adv.size()) {
@@ -78,7 +87,6 @@ void RemoteDevice::LowEnergyData::SetAdvertisingData(
   }
 
   if (notify_listeners) {
-    dev_->UpdateExpiry();
     dev_->NotifyListeners();
   }
 }
@@ -36,7 +36,7 @@ RemoteDevice* RemoteDeviceCache::NewDevice(const common::DeviceAddress& address,
       std::forward_as_tuple(std::unique_ptr<RemoteDevice>(device),
                             [this, device] { RemoveDevice(device); }));
 
-  address_map_[device->address()] = device->identifier();
+  address_map_[device->address()] = device;
   UpdateExpiry(*device);
   NotifyDeviceUpdated(*device);
   return device;
@@ -94,7 +94,7 @@ bool RemoteDeviceCache::AddBondedDevice(const std::string& identifier,
       std::piecewise_construct, std::forward_as_tuple(device->identifier()),
       std::forward_as_tuple(std::unique_ptr<RemoteDevice>(device),
                             [this, device] { RemoveDevice(device); }));
-  address_map_[device->address()] = device->identifier();
+  address_map_[device->address()] = device;
 
   device->MutLe().SetBondData(bond_data);
   ZX_DEBUG_ASSERT(!device->temporary());
@@ -132,8 +132,8 @@ bool RemoteDeviceCache::StoreLowEnergyBond(const std::string& identifier,
       // this device in the cache in case there are any pending controller
       // procedures that expect them.
       // TODO(armansito): Maybe expire the old address after a while?
-      address_map_[*bond_data.identity_address] = identifier;
-    } else if (iter->second != identifier) {
+      address_map_[*bond_data.identity_address] = device;
+    } else if (iter->second != device) {
       bt_log(TRACE, "gap-le", "identity address belongs to another device!");
       return false;
     }
@@ -166,10 +166,8 @@ RemoteDevice* RemoteDeviceCache::FindDeviceByAddress(
   if (iter == address_map_.end())
     return nullptr;
 
-  auto* dev = FindDeviceById(iter->second);
-  ZX_DEBUG_ASSERT(dev);
-
-  return dev;
+  ZX_DEBUG_ASSERT(iter->second);
+  return iter->second;
 }
 
 // Private methods below.
@@ -221,6 +219,14 @@ void RemoteDeviceCache::RemoveDevice(RemoteDevice* device) {
 
   const std::string identifier_copy = device->identifier();
   address_map_.erase(device->address());
+  if (device->le() && device->le()->bond_data() &&
+      device->le()->bond_data()->identity_address) {
+    auto iter =
+        address_map_.find(*device->le()->bond_data()->identity_address);
+    if (iter != address_map_.end() && iter->second == device) {
+      address_map_.erase(iter);
+    }
+  }
   devices_.erase(device_record_it);  // Destroys |device|.
   if (device_removed_callback_) {
     device_removed_callback_(identifier_copy);
@@ -173,14 +173,16 @@ class RemoteDeviceCache final {
   // Owns the corresponding RemoteDevices.
   std::unordered_map<std::string, RemoteDeviceRecord> devices_;
 
-  // Mapping from device addresses to unique device identifiers for all known
-  // devices. This is used to look-up and update existing cached data for a
-  // particular scan result so as to avoid creating duplicate entries for the
-  // same device.
+  // Mapping from device addresses to the corresponding RemoteDevices, which are
+  // owned by |devices_|, for all known devices. This is used to look-up and
+  // update existing cached data for a particular scan result so as to avoid
+  // creating duplicate entries for the same device. As this happens for every
+  // advertising report received while scanning, the device is found with a
+  // single lookup keyed by address rather than via its string identifier.
   //
   // TODO(armansito): Replace this with an implementation that can resolve
   // device identity, to handle bonded LE devices that use privacy.
-  std::unordered_map<common::DeviceAddress, std::string> address_map_;
+  std::unordered_map<common::DeviceAddress, RemoteDevice*> address_map_;
 
   DeviceCallback device_updated_callback_;
   DeviceIdCallback device_removed_callback_;
@@ -6,6 +6,8 @@
 
 #include <endian.h>
 
+#include <algorithm>
+
 #include <lib/async/default.h>
 #include <zircon/assert.h>
 #include <zircon/status.h>
@@ -115,7 +117,18 @@ void ACLDataChannel::ShutDown() {
 
   {
     std::lock_guard<std::mutex> lock(send_mutex_);
-    send_queue_.clear();
+    // Drop all queued packets, but keep accounting for the pending ones.
+    for (auto iter = links_.begin(); iter != links_.end();) {
+      iter->second.send_queue.clear();
+      iter->second.scheduled = false;
+      if (iter->second.pending_count) {
+        ++iter;
+      } else {
+        iter = links_.erase(iter);
+      }
+    }
+    bredr_send_order_.clear();
+    le_send_order_.clear();
   }
 
   io_dispatcher_ = nullptr;
@@ -146,7 +159,9 @@ bool ACLDataChannel::SendPacket(ACLDataPacketPtr data_packet,
 
   std::lock_guard<std::mutex> lock(send_mutex_);
 
-  send_queue_.emplace_back(QueuedDataPacket(ll_type, std::move(data_packet)));
+  ConnectionHandle handle = 0u;
+  LinkData* link = nullptr;
+  QueuePacketLocked(std::move(data_packet), ll_type, &handle, &link);
 
   TrySendNextQueuedPacketsLocked();
 
@@ -175,8 +190,12 @@ bool ACLDataChannel::SendPackets(common::LinkedList<ACLDataPacket> packets,
 
   std::lock_guard<std::mutex> lock(send_mutex_);
 
+  // The packets are usually the fragments of a single PDU, so they share a
+  // link and only the first one requires a lookup.
+  ConnectionHandle handle = 0u;
+  LinkData* link = nullptr;
   while (!packets.is_empty()) {
-    send_queue_.emplace_back(QueuedDataPacket(ll_type, packets.pop_front()));
+    QueuePacketLocked(packets.pop_front(), ll_type, &handle, &link);
   }
 
   TrySendNextQueuedPacketsLocked();
@@ -186,21 +205,35 @@ bool ACLDataChannel::SendPackets(common::LinkedList<ACLDataPacket> packets,
 
 bool ACLDataChannel::ClearLinkState(hci::ConnectionHandle handle) {
   std::lock_guard<std::mutex> lock(send_mutex_);
-  auto iter = pending_links_.find(handle);
-  if (iter == pending_links_.end()) {
+  auto iter = links_.find(handle);
+  if (iter == links_.end()) {
     bt_log(TRACE, "hci", "no pending packets on connection (handle: %#.4x)",
            handle);
     return false;
   }
 
-  const PendingPacketData& data = iter->second;
+  // Drop any packets that are still queued for the link.
+  const LinkData& data = iter->second;
+  if (data.scheduled) {
+    auto* send_order = GetSendOrderLocked(data.ll_type);
+    send_order->erase(
+        std::find(send_order->begin(), send_order->end(), handle));
+  }
+
+  const size_t pending_count = data.pending_count;
   if (data.ll_type == Connection::LinkType::kLE) {
-    DecrementLETotalNumPacketsLocked(data.count);
+    DecrementLETotalNumPacketsLocked(pending_count);
   } else {
-    DecrementTotalNumPacketsLocked(data.count);
+    DecrementTotalNumPacketsLocked(pending_count);
   }
 
-  pending_links_.erase(iter);
+  links_.erase(iter);
+
+  if (!pending_count) {
+    bt_log(TRACE, "hci", "no pending packets on connection (handle: %#.4x)",
+           handle);
+    return false;
+  }
 
   // Try sending the next batch of packets in case buffer space opened up.
   TrySendNextQueuedPacketsLocked();
@@ -237,41 +270,41 @@ void ACLDataChannel::NumberOfCompletedPacketsCallback(
   for (uint8_t i = 0; i < payload.number_of_handles; ++i) {
     const NumberOfCompletedPacketsEventData* data = payload.data + i;
 
-    auto iter = pending_links_.find(le16toh(data->connection_handle));
-    if (iter == pending_links_.end()) {
+    auto iter = links_.find(le16toh(data->connection_handle));
+    if (iter == links_.end() || !iter->second.pending_count) {
       bt_log(WARN, "hci",
              "controller reported sent packets on unknown connection handle!");
       continue;
     }
 
     uint16_t comp_packets = le16toh(data->hc_num_of_completed_packets);
+    LinkData& link = iter->second;
 
-    ZX_DEBUG_ASSERT(iter->second.count);
-    if (iter->second.count < comp_packets) {
+    if (link.pending_count < comp_packets) {
       bt_log(WARN, "hci",
              "packet tx count mismatch! (handle: %#.4x, expected: %zu, "
              "actual : %u)",
-             le16toh(data->connection_handle), iter->second.count,
+             le16toh(data->connection_handle), link.pending_count,
              comp_packets);
 
-      iter->second.count = 0u;
+      link.pending_count = 0u;
 
       // On debug builds it's better to assert and crash so that we can catch
       // controller bugs. On release builds we log the warning message above and
       // continue.
       ZX_PANIC("controller reported incorrect packet count!");
     } else {
-      iter->second.count -= comp_packets;
+      link.pending_count -= comp_packets;
     }
 
-    if (iter->second.ll_type == Connection::LinkType::kACL) {
+    if (link.ll_type == Connection::LinkType::kACL) {
       total_comp_packets += comp_packets;
     } else {
       le_total_comp_packets += comp_packets;
     }
 
-    if (!iter->second.count) {
-      pending_links_.erase(iter);
+    if (!link.pending_count && !link.scheduled) {
+      links_.erase(iter);
     }
   }
 
@@ -280,76 +313,95 @@ void ACLDataChannel::NumberOfCompletedPacketsCallback(
   TrySendNextQueuedPacketsLocked();
 }
 
-void ACLDataChannel::TrySendNextQueuedPacketsLocked() {
-  if (!is_initialized_)
-    return;
-
-  size_t avail_bredr_packets = GetNumFreeBREDRPacketsLocked();
-  size_t avail_le_packets = GetNumFreeLEPacketsLocked();
-
-  // Based on what we know about controller buffer availability, we process
-  // packets that are currently in |send_queue_|. The packets that can be sent
-  // are added to |to_send|. Packets that cannot be sent remain in
-  // |send_queue_|.
-  DataPacketQueue to_send;
-  for (auto iter = send_queue_.begin(); iter != send_queue_.end();) {
-    if (!avail_bredr_packets && !avail_le_packets)
-      break;
-
-    if (send_queue_.front().ll_type == Connection::LinkType::kACL &&
-        avail_bredr_packets) {
-      --avail_bredr_packets;
-    } else if (send_queue_.front().ll_type == Connection::LinkType::kLE &&
-               avail_le_packets) {
-      --avail_le_packets;
-    } else {
-      // Cannot send packet yet, so skip it.
-      ++iter;
-      continue;
+void ACLDataChannel::QueuePacketLocked(ACLDataPacketPtr packet,
+                                       Connection::LinkType ll_type,
+                                       ConnectionHandle* last_handle,
+                                       LinkData** link) {
+  const ConnectionHandle handle = packet->connection_handle();
+  if (!*link || *last_handle != handle) {
+    auto iter = links_.find(handle);
+    if (iter == links_.end()) {
+      iter = links_
+                 .emplace(std::piecewise_construct,
+                          std::forward_as_tuple(handle),
+                          std::forward_as_tuple(ll_type))
+                 .first;
     }
+    *last_handle = handle;
+    *link = &iter->second;
+  }
 
-    to_send.push_back(std::move(*iter));
-    send_queue_.erase(iter++);
+  ZX_DEBUG_ASSERT((*link)->ll_type == ll_type);
+  (*link)->send_queue.push_back(std::move(packet));
+  if (!(*link)->scheduled) {
+    (*link)->scheduled = true;
+    GetSendOrderLocked(ll_type)->push_back(handle);
   }
+}
+
+std::deque<ConnectionHandle>* ACLDataChannel::GetSendOrderLocked(
+    Connection::LinkType ll_type) {
+  if (ll_type == Connection::LinkType::kLE && le_buffer_info_.IsAvailable())
+    return &le_send_order_;
+  return &bredr_send_order_;
+}
 
-  if (to_send.empty())
+void ACLDataChannel::TrySendNextQueuedPacketsLocked() {
+  if (!is_initialized_)
     return;
 
-  size_t bredr_packets_sent = 0;
-  size_t le_packets_sent = 0;
-  while (!to_send.empty()) {
-    const QueuedDataPacket& packet = to_send.front();
+  // Only the packets that are sent are visited, so this is cheap even when
+  // many packets are queued, e.g. while the controller buffers are full.
+  size_t bredr_packets_sent = SendQueuedPacketsLocked(
+      &bredr_send_order_, GetNumFreeBREDRPacketsLocked());
+  if (bredr_packets_sent)
+    IncrementTotalNumPacketsLocked(bredr_packets_sent);
+
+  if (le_buffer_info_.IsAvailable()) {
+    size_t le_packets_sent = SendQueuedPacketsLocked(
+        &le_send_order_, GetNumFreeLEPacketsLocked());
+    if (le_packets_sent)
+      IncrementLETotalNumPacketsLocked(le_packets_sent);
+  }
+}
+
+size_t ACLDataChannel::SendQueuedPacketsLocked(
+    std::deque<ConnectionHandle>* send_order, size_t avail_packets) {
+  size_t packets_sent = 0;
+  while (packets_sent < avail_packets && !send_order->empty()) {
+    const ConnectionHandle handle = send_order->front();
+    send_order->pop_front();
+
+    auto iter = links_.find(handle);
+    ZX_DEBUG_ASSERT(iter != links_.end());
+    LinkData& link = iter->second;
+    ZX_DEBUG_ASSERT(link.scheduled);
+    ZX_DEBUG_ASSERT(!link.send_queue.is_empty());
+
+    auto packet = link.send_queue.pop_front();
+    if (link.send_queue.is_empty()) {
+      link.scheduled = false;
+    } else {
+      send_order->push_back(handle);
+    }
 
-    auto packet_bytes = packet.packet->view().data();
+    auto packet_bytes = packet->view().data();
     zx_status_t status =
         channel_.write(0, packet_bytes.data(), packet_bytes.size(), nullptr, 0);
     if (status < 0) {
       bt_log(ERROR, "hci",
              "failed to send data packet to HCI driver (%s) - dropping packet",
              zx_status_get_string(status));
-      to_send.pop_front();
+      if (!link.scheduled && !link.pending_count) {
+        links_.erase(iter);
+      }
       continue;
     }
 
-    if (packet.ll_type == Connection::LinkType::kACL) {
-      ++bredr_packets_sent;
-    } else {
-      ++le_packets_sent;
-    }
-
-    auto iter = pending_links_.find(packet.packet->connection_handle());
-    if (iter == pending_links_.end()) {
-      pending_links_[packet.packet->connection_handle()] =
-          PendingPacketData(packet.ll_type);
-    } else {
-      iter->second.count++;
-    }
-
-    to_send.pop_front();
+    ++link.pending_count;
+    ++packets_sent;
   }
-
-  IncrementTotalNumPacketsLocked(bredr_packets_sent);
-  IncrementLETotalNumPacketsLocked(le_packets_sent);
+  return packets_sent;
 }
 
 size_t ACLDataChannel::GetNumFreeBREDRPacketsLocked() const {
@@ -414,9 +466,17 @@ void ACLDataChannel::OnChannelReady(
   ZX_DEBUG_ASSERT(async_get_default_dispatcher() == io_dispatcher_);
   ZX_DEBUG_ASSERT(signal->observed & ZX_CHANNEL_READABLE);
 
-  std::lock_guard<std::mutex> lock(rx_mutex_);
-  if (!rx_callback_) {
-    return;
+  // Take a reference to the handler so that the lock isn't held while reading
+  // and dispatching packets.
+  DataReceivedCallback rx_callback;
+  async_dispatcher_t* rx_dispatcher;
+  {
+    std::lock_guard<std::mutex> lock(rx_mutex_);
+    if (!rx_callback_) {
+      return;
+    }
+    rx_callback = rx_callback_.share();
+    rx_dispatcher = rx_dispatcher_;
   }
 
   for (size_t count = 0; count < signal->count; count++) {
@@ -463,10 +523,10 @@ void ACLDataChannel::OnChannelReady(
 
     packet->InitializeFromBuffer();
 
-    ZX_DEBUG_ASSERT(rx_dispatcher_);
+    ZX_DEBUG_ASSERT(rx_dispatcher);
 
-    async::PostTask(rx_dispatcher_,
-                    [cb = rx_callback_.share(), packet = std::move(packet)]() mutable {
+    async::PostTask(rx_dispatcher,
+                    [cb = rx_callback.share(), packet = std::move(packet)]() mutable {
                       cb(std::move(packet));
                     });
   }
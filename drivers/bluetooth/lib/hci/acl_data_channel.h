@@ -5,9 +5,8 @@
 #ifndef GARNET_DRIVERS_BLUETOOTH_LIB_HCI_ACL_DATA_CHANNEL_H_
 #define GARNET_DRIVERS_BLUETOOTH_LIB_HCI_ACL_DATA_CHANNEL_H_
 
-#include <list>
+#include <deque>
 #include <mutex>
-#include <queue>
 #include <unordered_map>
 
 #include <lib/async/cpp/wait.h>
@@ -17,6 +16,7 @@
 #include <zircon/compiler.h>
 
 #include "garnet/drivers/bluetooth/lib/common/byte_buffer.h"
+#include "garnet/drivers/bluetooth/lib/common/linked_list.h"
 #include "garnet/drivers/bluetooth/lib/hci/acl_data_packet.h"
 #include "garnet/drivers/bluetooth/lib/hci/command_channel.h"
 #include "garnet/drivers/bluetooth/lib/hci/connection.h"
@@ -68,6 +68,11 @@ class DataBufferInfo {
 //
 // This currently only supports the Packet-based Data Flow Control as defined in
 // Core Spec v5.0, Vol 2, Part E, Section 4.1.1.
+//
+// Outgoing packets are queued separately for each logical link. Packets on the
+// same link are sent in the order in which they were queued, while the
+// controller's buffer space is shared among the links with queued packets in
+// round-robin order, so that one busy link cannot starve the others.
 class ACLDataChannel final {
  public:
   ACLDataChannel(Transport* transport, zx::channel hci_acl_channel);
@@ -126,15 +131,15 @@ class ACLDataChannel final {
                    Connection::LinkType ll_type);
 
   // Cleans up all outgoing data buffering state related to the logical link
-  // with the given |handle|. This must be called upon disconnection of a link
-  // to ensure that ACL flow-control works correctly.
+  // with the given |handle|, dropping any of its packets that are still
+  // queued. This must be called upon disconnection of a link to ensure that ACL
+  // flow-control works correctly. Returns false if the controller had no
+  // pending packets for the link.
   //
   // TODO(armansito): This doesn't fix things for subsequent data packets on
-  // this |handle| (either already queued by ACLDataChannel or waiting to be
-  // sent in an async task). Support enabling/disabling data flow with separate
-  // packet queues for each link so that we can drop packets for closed links.
-  // This is also needed to correctly pause TX data flow during encryption pause
-  // (NET-1169).
+  // this |handle| that are waiting to be sent in an async task. Support
+  // enabling/disabling data flow on a link, which is also needed to correctly
+  // pause TX data flow during encryption pause (NET-1169).
   bool ClearLinkState(hci::ConnectionHandle handle);
 
   // Returns the underlying channel handle.
@@ -150,22 +155,49 @@ class ACLDataChannel final {
   const DataBufferInfo& GetLEBufferInfo() const;
 
  private:
-  // Represents a queued ACL data packet.
-  struct QueuedDataPacket {
-    QueuedDataPacket(Connection::LinkType ll_type, ACLDataPacketPtr packet)
-        : ll_type(ll_type), packet(std::move(packet)) {}
-
-    QueuedDataPacket() = default;
-    QueuedDataPacket(QueuedDataPacket&& other) = default;
-    QueuedDataPacket& operator=(QueuedDataPacket&& other) = default;
+  // The outgoing data state of a logical link.
+  struct LinkData {
+    explicit LinkData(Connection::LinkType ll_type) : ll_type(ll_type) {}
 
     Connection::LinkType ll_type;
-    ACLDataPacketPtr packet;
+
+    // Packets waiting for space in the controller's buffer, in the order in
+    // which they will be sent.
+    common::LinkedList<ACLDataPacket> send_queue;
+
+    // True if this link is in one of the round-robin send orders. This is the
+    // case whenever |send_queue| is not empty.
+    bool scheduled = false;
+
+    // The number of packets that have been sent to the controller, and that it
+    // has not yet reported as completed.
+    size_t pending_count = 0u;
   };
 
   // Returns the data buffer MTU for the given connection.
   size_t GetBufferMTU(Connection::LinkType ll_type) const;
 
+  // Appends |packet| to the send queue for its link, creating the link's state
+  // if needed. |link| caches the state of the link that the previous packet
+  // was queued on, so that a run of packets for the same link is only looked
+  // up once.
+  void QueuePacketLocked(ACLDataPacketPtr packet, Connection::LinkType ll_type,
+                         ConnectionHandle* last_handle, LinkData** link)
+      __TA_REQUIRES(send_mutex_);
+
+  // Returns the round-robin send order for links of type |ll_type|. LE links
+  // share the BR/EDR order if the controller has no dedicated LE buffer, as
+  // they then compete for the same buffer space.
+  std::deque<ConnectionHandle>* GetSendOrderLocked(Connection::LinkType ll_type)
+      __TA_REQUIRES(send_mutex_);
+
+  // Sends queued packets from the links in |send_order|, one packet per link
+  // in turn, until |avail_packets| packets have been sent or no packets are
+  // left. Returns the number of packets that were sent.
+  size_t SendQueuedPacketsLocked(std::deque<ConnectionHandle>* send_order,
+                                 size_t avail_packets)
+      __TA_REQUIRES(send_mutex_);
+
   // Handler for the HCI Number of Completed Packets Event, used for
   // packet-based data flow control.
   void NumberOfCompletedPacketsCallback(const EventPacket& event);
@@ -254,35 +286,19 @@ class ACLDataChannel final {
   size_t num_sent_packets_ __TA_GUARDED(send_mutex_);
   size_t le_num_sent_packets_ __TA_GUARDED(send_mutex_);
 
-  // The ACL data packet queue contains the data packets that are waiting to be
-  // sent to the controller.
-  // TODO(armansito): Use priority_queue based on L2CAP channel priority.
-  // TODO(NET-1211): Keep a separate queue for each open connection. Benefits:
-  //   * Helps address the packet-prioritization TODO above.
-  //   * Also: having separate queues, which know their own
-  //     Connection::LinkType, would let us replace std::list<QueuedDataPacket>
-  //     with common::LinkedList<ACLDataPacket> which has a more efficient
-  //     memory layout.
-  using DataPacketQueue = std::list<QueuedDataPacket>;
-  DataPacketQueue send_queue_ __TA_GUARDED(send_mutex_);
-
-  // Stores the link type of connections on which we have a pending packet that
-  // has been sent to the controller. Entries are removed on the HCI Number Of
-  // Completed Packets event.
-  struct PendingPacketData {
-    PendingPacketData() = default;
-
-    // We initialize the packet count at 1 since a new entry will only be
-    // created once.
-    PendingPacketData(Connection::LinkType ll_type)
-        : ll_type(ll_type), count(1u) {}
-
-    Connection::LinkType ll_type;
-    size_t count;
-  };
-  std::unordered_map<ConnectionHandle, PendingPacketData> pending_links_
+  // The outgoing data state of each link that has packets that are queued or
+  // pending in the controller. Entries are removed once a link has neither.
+  // TODO(armansito): Prioritize links based on L2CAP channel priority.
+  std::unordered_map<ConnectionHandle, LinkData> links_
       __TA_GUARDED(send_mutex_);
 
+  // The links with queued packets, in the order in which they will next be
+  // allowed to send a packet. A link that sends a packet and still has more
+  // queued moves to the back. The packets themselves are slab-allocated and
+  // intrusively linked, so queueing a packet does not allocate.
+  std::deque<ConnectionHandle> bredr_send_order_ __TA_GUARDED(send_mutex_);
+  std::deque<ConnectionHandle> le_send_order_ __TA_GUARDED(send_mutex_);
+
   FXL_DISALLOW_COPY_AND_ASSIGN(ACLDataChannel);
 };
 
@@ -9,6 +9,7 @@
 #include <lib/async/cpp/task.h>
 #include <zircon/assert.h>
 
+#include "garnet/drivers/bluetooth/lib/common/test_helpers.h"
 #include "garnet/drivers/bluetooth/lib/hci/connection.h"
 #include "garnet/drivers/bluetooth/lib/hci/defaults.h"
 #include "garnet/drivers/bluetooth/lib/hci/transport.h"
@@ -40,6 +41,24 @@ class ACLDataChannelTest : public TestingBase {
 
 using HCI_ACLDataChannelTest = ACLDataChannelTest;
 
+// Returns a Number Of Completed Packets event for |num_packets| on |handle|.
+common::DynamicByteBuffer NumberOfCompletedPacketsEvent(
+    ConnectionHandle handle, uint16_t num_packets) {
+  return common::DynamicByteBuffer(common::CreateStaticByteBuffer(
+      0x13, 0x05,  // Event header
+      0x01,        // Number of handles
+      common::LowerBits(handle), common::UpperBits(handle),
+      common::LowerBits(num_packets), common::UpperBits(num_packets)));
+}
+
+// Returns the connection handle of the ACL data packet in |bytes|.
+ConnectionHandle GetConnectionHandle(const common::ByteBuffer& bytes) {
+  ZX_DEBUG_ASSERT(bytes.size() >= sizeof(ACLDataHeader));
+  common::PacketView<hci::ACLDataHeader> packet(
+      &bytes, bytes.size() - sizeof(ACLDataHeader));
+  return le16toh(packet.header().handle_and_flags) & 0xFFF;
+}
+
 TEST_F(HCI_ACLDataChannelTest, VerifyMTUs) {
   const DataBufferInfo kBREDRBufferInfo(1024, 50);
   const DataBufferInfo kLEBufferInfo(64, 16);
@@ -614,6 +633,145 @@ TEST_F(HCI_ACLDataChannelTest, ClearLinkState) {
   ASSERT_EQ(3, packet_count);
 }
 
+TEST_F(HCI_ACLDataChannelTest, ClearLinkStateDropsQueuedPackets) {
+  constexpr size_t kMaxMTU = 1024;
+  constexpr size_t kMaxNumPackets = 1;
+  constexpr ConnectionHandle kHandle1 = 1;
+  constexpr ConnectionHandle kHandle2 = 2;
+
+  InitializeACLDataChannel(DataBufferInfo(), DataBufferInfo(kMaxMTU,
+                                                            kMaxNumPackets));
+
+  std::vector<ConnectionHandle> sent;
+  test_device()->SetDataCallback(
+      [&](const auto& bytes) { sent.push_back(GetConnectionHandle(bytes)); },
+      dispatcher());
+
+  // The first packet fills up the buffer and the second one is queued.
+  for (int i = 0; i < 2; ++i) {
+    ASSERT_TRUE(acl_data_channel()->SendPacket(
+        ACLDataPacket::New(kHandle1, ACLPacketBoundaryFlag::kFirstNonFlushable,
+                           ACLBroadcastFlag::kPointToPoint, 1),
+        Connection::LinkType::kLE));
+  }
+  RunLoopUntilIdle();
+  ASSERT_EQ(1u, sent.size());
+
+  // Disconnecting |kHandle1| frees up its buffer space and drops its queued
+  // packet, so a packet on another link goes out instead.
+  EXPECT_TRUE(acl_data_channel()->ClearLinkState(kHandle1));
+  EXPECT_FALSE(acl_data_channel()->ClearLinkState(kHandle1));
+  ASSERT_TRUE(acl_data_channel()->SendPacket(
+      ACLDataPacket::New(kHandle2, ACLPacketBoundaryFlag::kFirstNonFlushable,
+                         ACLBroadcastFlag::kPointToPoint, 1),
+      Connection::LinkType::kLE));
+  RunLoopUntilIdle();
+
+  EXPECT_EQ((std::vector<ConnectionHandle>{kHandle1, kHandle2}), sent);
+}
+
+// Test that links share the controller buffer in round-robin order, rather
+// than in the order in which their packets were queued.
+TEST_F(HCI_ACLDataChannelTest, SendPacketsRoundRobin) {
+  constexpr size_t kMaxMTU = 1024;
+  constexpr size_t kMaxNumPackets = 2;
+  constexpr ConnectionHandle kHandleA = 1;
+  constexpr ConnectionHandle kHandleB = 2;
+  constexpr ConnectionHandle kHandleC = 3;
+
+  InitializeACLDataChannel(DataBufferInfo(), DataBufferInfo(kMaxMTU,
+                                                            kMaxNumPackets));
+
+  std::vector<ConnectionHandle> sent;
+  test_device()->SetDataCallback(
+      [&](const auto& bytes) { sent.push_back(GetConnectionHandle(bytes)); },
+      dispatcher());
+
+  auto send_packets = [this](ConnectionHandle handle, size_t count) {
+    common::LinkedList<ACLDataPacket> packets;
+    for (size_t i = 0; i < count; ++i) {
+      packets.push_back(
+          ACLDataPacket::New(handle, ACLPacketBoundaryFlag::kFirstNonFlushable,
+                             ACLBroadcastFlag::kPointToPoint, 1));
+    }
+    EXPECT_TRUE(acl_data_channel()->SendPackets(std::move(packets),
+                                                Connection::LinkType::kLE));
+  };
+  send_packets(kHandleA, 6);
+  send_packets(kHandleB, 2);
+  send_packets(kHandleC, 2);
+  RunLoopUntilIdle();
+  EXPECT_EQ(2u, sent.size());
+
+  // Complete the two packets in the controller's buffer at a time, making room
+  // for the next two.
+  while (sent.size() < 10u) {
+    const size_t sent_count = sent.size();
+    const ConnectionHandle first = sent[sent_count - 2];
+    const ConnectionHandle second = sent[sent_count - 1];
+    test_device()->SendCommandChannelPacket(
+        NumberOfCompletedPacketsEvent(first, 1));
+    test_device()->SendCommandChannelPacket(
+        NumberOfCompletedPacketsEvent(second, 1));
+    RunLoopUntilIdle();
+    ASSERT_LT(sent_count, sent.size());
+  }
+
+  EXPECT_EQ((std::vector<ConnectionHandle>{kHandleA, kHandleA, kHandleA,
+                                           kHandleB, kHandleC, kHandleA,
+                                           kHandleB, kHandleC, kHandleA,
+                                           kHandleA}),
+            sent);
+}
+
+// Stream packets on many links at once, with the controller completing each
+// packet as soon as it receives it.
+TEST_F(HCI_ACLDataChannelTest, SendPacketsManyLinks) {
+  constexpr size_t kMaxMTU = 27;
+  constexpr size_t kMaxNumPackets = 8;
+  constexpr size_t kLinkCount = 32;
+  constexpr size_t kPacketsPerLink = 128;
+
+  InitializeACLDataChannel(DataBufferInfo(), DataBufferInfo(kMaxMTU,
+                                                            kMaxNumPackets));
+
+  std::unordered_map<ConnectionHandle, size_t> received;
+  size_t total_received = 0;
+  bool in_order = true;
+  test_device()->SetDataCallback(
+      [&](const common::ByteBuffer& bytes) {
+        common::PacketView<hci::ACLDataHeader> packet(
+            &bytes, bytes.size() - sizeof(ACLDataHeader));
+        ConnectionHandle handle = GetConnectionHandle(bytes);
+        size_t& count = received[handle];
+        in_order &= (packet.payload_bytes()[0] == count % 256);
+        ++count;
+        ++total_received;
+        test_device()->SendCommandChannelPacket(
+            NumberOfCompletedPacketsEvent(handle, 1));
+      },
+      dispatcher());
+
+  for (size_t i = 0; i < kPacketsPerLink; ++i) {
+    for (ConnectionHandle handle = 1; handle <= kLinkCount; ++handle) {
+      auto packet =
+          ACLDataPacket::New(handle, ACLPacketBoundaryFlag::kFirstNonFlushable,
+                             ACLBroadcastFlag::kPointToPoint, kMaxMTU);
+      packet->mutable_view()->mutable_payload_bytes()[0] = i % 256;
+      EXPECT_TRUE(acl_data_channel()->SendPacket(std::move(packet),
+                                                 Connection::LinkType::kLE));
+    }
+  }
+  RunLoopUntilIdle();
+
+  EXPECT_TRUE(in_order);
+  EXPECT_EQ(kLinkCount * kPacketsPerLink, total_received);
+  EXPECT_EQ(kLinkCount, received.size());
+  for (const auto& link : received) {
+    EXPECT_EQ(kPacketsPerLink, link.second) << "handle: " << link.first;
+  }
+}
+
 TEST_F(HCI_ACLDataChannelTest, ReceiveData) {
   constexpr size_t kMaxMTU = 5;
   constexpr size_t kMaxNumPackets = 5;
@@ -4,12 +4,14 @@
 
 #include "pdu.h"
 
-#include "garnet/drivers/bluetooth/lib/common/log.h"
+#include "garnet/drivers/bluetooth/lib/common/byte_buffer.h"
 #include "garnet/drivers/bluetooth/lib/hci/acl_data_packet.h"
 
 namespace btlib {
 namespace l2cap {
 
+constexpr size_t PDU::Reader::kMaxStackReadSize;
+
 PDU::Reader::Reader(const PDU* pdu)
     : offset_(sizeof(BasicHeader)),
       frag_offset_(sizeof(BasicHeader)),
@@ -49,18 +51,20 @@ bool PDU::Reader::ReadNext(size_t size, const ReadFunc& func) {
     return true;
   }
 
-  // TODO(armansito): This will work fine for small sizes but we'll need to
-  // dynamically allocate for packets that are large. Fix this once L2CAP slab
-  // allocators have been wired up.
-  if (size > 1024) {
-    bt_log(WARN, "l2cap", "need to dynamically allocate buffer (size: %zu)",
-           size);
-    return false;
+  // The read crosses a fragment boundary, so the data has to be copied into a
+  // contiguous buffer. Small reads use the stack; larger ones, e.g. whole SDUs
+  // that were fragmented over several ACL data packets, are copied into a
+  // single heap allocation rather than failing.
+  uint8_t stack_buffer[kMaxStackReadSize];
+  common::DynamicByteBuffer heap_buffer;
+  common::MutableBufferView out;
+  if (size <= kMaxStackReadSize) {
+    out = common::MutableBufferView(stack_buffer, size);
+  } else {
+    heap_buffer = common::DynamicByteBuffer(size);
+    out = common::MutableBufferView(&heap_buffer);
   }
 
-  uint8_t buffer[size];
-  common::MutableBufferView out(buffer, size);
-
   size_t remaining = size;
   while (cur_fragment_ != pdu_->fragments_.cend() && remaining) {
     // Calculate how much to copy from the current fragment.
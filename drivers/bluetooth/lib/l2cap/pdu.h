@@ -36,8 +36,11 @@ class PDU final {
  public:
   using FragmentList = common::LinkedList<hci::ACLDataPacket>;
 
-  // Reader allows sequential access to the payload of a (B-frame) PDU using no
-  // dynamic allocations and as little copying as possible.
+  // Reader allows sequential access to the payload of a (B-frame) PDU using as
+  // little copying as possible. Reads that fall within a single fragment are
+  // views into the fragment's ACL data packet. Reads that cross fragment
+  // boundaries are copied into a stack buffer, or into a dynamically allocated
+  // buffer if they are larger than kMaxStackReadSize.
   //
   // A Reader is valid as long as the underlying PDU is valid. Deleting or
   // invalidating a PDU (e.g. via ReleaseFragments()) while using a Reader will
@@ -49,6 +52,10 @@ class PDU final {
   // it is invoked as a tail-call.)
   class Reader final {
    public:
+    // The largest read across fragment boundaries that is served without a
+    // dynamic allocation.
+    static constexpr size_t kMaxStackReadSize = 1024;
+
     explicit Reader(const PDU* pdu);
 
     // Calls |func| with the next segment of data with the given |size|. Returns
@@ -6,8 +6,11 @@
 #include "fragmenter.h"
 #include "recombiner.h"
 
+#include <chrono>
+
 #include "gtest/gtest.h"
 
+#include "garnet/drivers/bluetooth/lib/common/log.h"
 #include "garnet/drivers/bluetooth/lib/common/test_helpers.h"
 #include "garnet/drivers/bluetooth/lib/hci/hci.h"
 #include "garnet/drivers/bluetooth/lib/hci/packet.h"
@@ -34,6 +37,32 @@ hci::ACLDataPacketPtr PacketFromBytes(T... data) {
   return packet;
 }
 
+// ACL payload sizes of a minimal LE link, an LE link using the Data Length
+// Extension, and a typical BR/EDR link.
+constexpr uint16_t kAclMtus[] = {27, 251, 1021};
+
+common::DynamicByteBuffer MakePayload(size_t size) {
+  common::DynamicByteBuffer payload(size);
+  for (size_t i = 0; i < size; i++) {
+    payload[i] = static_cast<uint8_t>(i * 7);
+  }
+  return payload;
+}
+
+// Passes the fragments of |pdu| through a Recombiner, as if they had been
+// received from the controller, and returns the recombined PDU.
+PDU Recombine(PDU pdu) {
+  Recombiner recombiner;
+  auto fragments = pdu.ReleaseFragments();
+  while (!fragments.is_empty()) {
+    EXPECT_TRUE(recombiner.AddFragment(fragments.pop_front()));
+  }
+
+  PDU out_pdu;
+  EXPECT_TRUE(recombiner.Release(&out_pdu));
+  return out_pdu;
+}
+
 std::unique_ptr<PDU> PduFromByteBuffer(const common::ByteBuffer& buf,
                                        size_t first_fragment_payload_size) {
   return std::make_unique<PDU>(
@@ -434,6 +463,77 @@ TEST(L2CAP_PduTest,
   EXPECT_EQ(1u, call_count);
 }
 
+TEST(L2CAP_PduTest, ReadLargeFragmentedPdu) {
+  // Large enough that reading the whole payload in one go needs a dynamically
+  // allocated buffer.
+  auto payload = MakePayload(3 * PDU::Reader::kMaxStackReadSize);
+  std::unique_ptr<PDU> pdu = PduFromByteBuffer(payload, 1000);
+  ASSERT_TRUE(pdu->is_valid());
+  ASSERT_EQ(4u, pdu->fragment_count());
+
+  size_t call_count = 0;
+  EXPECT_TRUE(
+      PDU::Reader(pdu.get()).ReadNext(payload.size(), [&](const auto& buf) {
+        ++call_count;
+        EXPECT_TRUE(common::ContainersEqual(payload, buf));
+      }));
+  EXPECT_EQ(1u, call_count);
+}
+
+TEST(L2CAP_PduTest, FragmentAndRecombineAcrossMtus) {
+  for (uint16_t acl_mtu : kAclMtus) {
+    Fragmenter fragmenter(kConnectionHandle, acl_mtu);
+    for (size_t size : {1u, 23u, 672u, 1691u, 8192u}) {
+      auto payload = MakePayload(size);
+      PDU pdu = Recombine(fragmenter.BuildBasicFrame(kChannelId, payload));
+      ASSERT_TRUE(pdu.is_valid());
+
+      const size_t frame_size = size + sizeof(BasicHeader);
+      EXPECT_EQ((frame_size + acl_mtu - 1) / acl_mtu, pdu.fragment_count());
+      EXPECT_EQ(size, pdu.length());
+      EXPECT_EQ(kChannelId, pdu.channel_id());
+
+      // The recombined PDU refers to the same ACL data packets that the
+      // Fragmenter built; the payload is only copied to read it contiguously.
+      bool read = false;
+      EXPECT_TRUE(PDU::Reader(&pdu).ReadNext(size, [&](const auto& buf) {
+        read = true;
+        EXPECT_TRUE(common::ContainersEqual(payload, buf))
+            << "ACL MTU: " << acl_mtu << ", SDU size: " << size;
+      }));
+      EXPECT_TRUE(read);
+    }
+  }
+}
+
+// Measures the throughput of fragmenting SDUs into ACL data packets,
+// recombining them and reading them back, as done for data relayed between an
+// L2CAP socket and a logical link. Run with
+// --gtest_also_run_disabled_tests.
+TEST(L2CAP_PduTest, DISABLED_FragmentAndRecombineThroughput) {
+  constexpr size_t kSduSize = 1691;  // The default BR/EDR MTU for A2DP.
+  constexpr size_t kTotalBytes = 64 * 1024 * 1024;
+  auto payload = MakePayload(kSduSize);
+
+  for (uint16_t acl_mtu : kAclMtus) {
+    Fragmenter fragmenter(kConnectionHandle, acl_mtu);
+    size_t checksum = 0;
+    const auto start = std::chrono::steady_clock::now();
+    for (size_t total = 0; total < kTotalBytes; total += kSduSize) {
+      PDU pdu = Recombine(fragmenter.BuildBasicFrame(kChannelId, payload));
+      PDU::Reader(&pdu).ReadNext(pdu.length(), [&](const auto& buf) {
+        checksum += buf[buf.size() / 2];
+      });
+    }
+    const std::chrono::duration<double> elapsed =
+        std::chrono::steady_clock::now() - start;
+    EXPECT_NE(0u, checksum);
+
+    bt_log(INFO, "l2cap", "ACL MTU %u: %.1f MB/s", acl_mtu,
+           kTotalBytes / elapsed.count() / (1024 * 1024));
+  }
+}
+
 }  // namespace
 }  // namespace l2cap
 }  // namespace btlib
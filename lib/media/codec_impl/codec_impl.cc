@@ -549,14 +549,31 @@ void CodecImpl::RecycleOutputPacket(
     fuchsia::mediacodec::CodecPacketHeader available_output_packet) {
   ZX_DEBUG_ASSERT(thrd_current() == fidl_thread());
   CodecPacket* packet = nullptr;
-  {  // scope lock
-    std::unique_lock<std::mutex> lock(lock_);
-    if (!CheckOldBufferLifetimeOrdinalLocked(
-            kOutputPort, available_output_packet.buffer_lifetime_ordinal)) {
-      return;
-    }
-    if (available_output_packet.buffer_lifetime_ordinal <
-        buffer_lifetime_ordinal_[kOutputPort]) {
+  const char* error = nullptr;
+  {  // scope port_lock
+    // This is the per-packet path for output, so we avoid lock_ here.  The
+    // state checked below is only written with port_lock_[kOutputPort] held,
+    // and the packet's free/busy state is atomic.  On failure we release
+    // port_lock_[kOutputPort] before calling Fail(), since Fail() acquires
+    // lock_, which is "before" port_lock_[kOutputPort].
+    std::lock_guard<std::mutex> port_lock(port_lock_[kOutputPort]);
+    uint64_t buffer_lifetime_ordinal =
+        available_output_packet.buffer_lifetime_ordinal;
+    uint32_t packet_index = available_output_packet.packet_index;
+    // These first two checks are the same as
+    // CheckOldBufferLifetimeOrdinalLocked(), without needing lock_.
+    //
+    // The client must only send odd values.  0 is even so we don't need a
+    // separate check for that.
+    if (buffer_lifetime_ordinal % 2 == 0) {
+      error = "RecycleOutputPacket() - buffer_lifetime_ordinal must be odd";
+    } else if (buffer_lifetime_ordinal >
+               protocol_buffer_lifetime_ordinal_[kOutputPort]) {
+      error =
+          "client sent new buffer_lifetime_ordinal in message type that "
+          "doesn't allow new buffer_lifetime_ordinals";
+    } else if (buffer_lifetime_ordinal <
+               buffer_lifetime_ordinal_[kOutputPort]) {
       // ignore arbitrarily-stale required by protocol
       //
       // Thanks to even values from the client being prohibited, this also
@@ -567,40 +584,37 @@ void CodecImpl::RecycleOutputPacket(
       // when de-configuring output server-side until the client has
       // re-configured output.
       return;
-    }
-    ZX_DEBUG_ASSERT(available_output_packet.buffer_lifetime_ordinal ==
-                    buffer_lifetime_ordinal_[kOutputPort]);
-    if (!IsOutputConfiguredLocked()) {
-      FailLocked(
+    } else if (!is_port_configured_[kOutputPort]) {
+      ZX_DEBUG_ASSERT(buffer_lifetime_ordinal ==
+                      buffer_lifetime_ordinal_[kOutputPort]);
+      error =
           "client sent RecycleOutputPacket() for buffer_lifetime_ordinal that "
-          "isn't fully configured yet - bad client behavior");
-      return;
-    }
-    ZX_DEBUG_ASSERT(IsOutputConfiguredLocked());
-    if (available_output_packet.packet_index >=
-        all_packets_[kOutputPort].size()) {
-      FailLocked(
-          "out of range packet_index from client in RecycleOutputPacket()");
-      return;
-    }
-    uint32_t packet_index = available_output_packet.packet_index;
-    if (all_packets_[kOutputPort][packet_index]->is_free()) {
-      FailLocked(
+          "isn't fully configured yet - bad client behavior";
+    } else if (packet_index >= all_packets_[kOutputPort].size()) {
+      error = "out of range packet_index from client in RecycleOutputPacket()";
+    } else if (all_packets_[kOutputPort][packet_index]->ExchangeFree(true)) {
+      // ExchangeFree() marks the packet free at protocol level in the same
+      // atomic step as checking that it wasn't already free, since the core
+      // codec marks output packets busy from its own thread(s) without any
+      // lock held.
+      error =
           "packet_index already free at protocol level - invalid client "
-          "message");
-      return;
+          "message";
+    } else {
+      // Before handing the packet to the core codec, clear some fields that
+      // the core codec is expected to set (or optionally set in the case of
+      // timstamp_ish).  In addition to these parameters, a core codec can emit
+      // output config changes via onCoreCodecMidStreamOutputConfigChange().
+      packet = all_packets_[kOutputPort][packet_index].get();
+      packet->ClearStartOffset();
+      packet->ClearValidLengthBytes();
+      packet->ClearTimestampIsh();
     }
-    // Mark free at protocol level.
-    all_packets_[kOutputPort][packet_index]->SetFree(true);
+  }  // ~port_lock
 
-    // Before handing the packet to the core codec, clear some fields that the
-    // core codec is expected to set (or optionally set in the case of
-    // timstamp_ish).  In addition to these parameters, a core codec can emit
-    // output config changes via onCoreCodecMidStreamOutputConfigChange().
-    packet = all_packets_[kOutputPort][packet_index].get();
-    packet->ClearStartOffset();
-    packet->ClearValidLengthBytes();
-    packet->ClearTimestampIsh();
+  if (error) {
+    Fail("%s", error);
+    return;
   }
 
   // Recycle to core codec.
@@ -678,7 +692,13 @@ void CodecImpl::QueueInputFormatDetails_StreamControl(
 
 void CodecImpl::QueueInputPacket(fuchsia::mediacodec::CodecPacket packet) {
   ZX_DEBUG_ASSERT(thrd_current() == fidl_thread());
-  {  // scope lock
+  if (was_unbind_started_) {
+    return;
+  }
+  // Only this thread changes future_stream_lifetime_ordinal_, so a packet for
+  // the stream we've already seen (nearly every packet) has nothing to update
+  // and doesn't need lock_.
+  if (packet.stream_lifetime_ordinal != future_stream_lifetime_ordinal_) {
     std::unique_lock<std::mutex> lock(lock_);
     if (IsStoppingLocked()) {
       return;
@@ -696,8 +716,19 @@ void CodecImpl::QueueInputPacket_StreamControl(
     fuchsia::mediacodec::CodecPacket packet) {
   ZX_DEBUG_ASSERT(thrd_current() == stream_control_thread_);
 
+  // Only StreamControl changes stream_lifetime_ordinal_, so we can check it
+  // here without lock_.  Packets for the current stream don't need lock_ at
+  // all.
+  if (packet.stream_lifetime_ordinal == stream_lifetime_ordinal_ &&
+      stream_lifetime_ordinal_ % 2 == 1) {
+    QueueInputPacketToCurrentStream(std::move(packet));
+    return;
+  }
+
   fuchsia::mediacodec::CodecPacketHeader temp_header_copy =
       fidl::Clone(packet.header);
+  CodecPacket* core_codec_packet = nullptr;
+  const CodecBuffer* buffer = nullptr;
 
   {  // scope lock
     std::unique_lock<std::mutex> lock(lock_);
@@ -717,7 +748,7 @@ void CodecImpl::QueueInputPacket_StreamControl(
           // IsStoppingLocked(), the Codec channel will close soon, making this
           // response unnecessary.
           if (!IsStoppingLocked()) {
-            SendFreeInputPacketLocked(std::move(header));
+            SendFreeInputPacket(std::move(header));
           }
         });
 
@@ -780,12 +811,15 @@ void CodecImpl::QueueInputPacket_StreamControl(
     }
 
     // Protocol check re. free/busy coherency.  This applies to packets only,
-    // not buffers.
-    if (!all_packets_[kInputPort][packet.header.packet_index]->is_free()) {
+    // not buffers.  The core codec frees input packets without lock_, so the
+    // check and the claim are one atomic step.
+    core_codec_packet =
+        all_packets_[kInputPort][packet.header.packet_index].get();
+    buffer = all_buffers_[kInputPort][packet.buffer_index].get();
+    if (!core_codec_packet->ExchangeFree(false)) {
       FailLocked("client QueueInputPacket() with packet_index !free");
       return;
     }
-    all_packets_[kInputPort][packet.header.packet_index]->SetFree(false);
 
     if (stream_->input_end_of_stream()) {
       FailLocked("QueueInputPacket() after QueueInputEndOfStream() unexpeted");
@@ -807,8 +841,11 @@ void CodecImpl::QueueInputPacket_StreamControl(
       // is just an optimization to avoid giving the core codec more work to do
       // for a stream the client has already discarded.
       //
+      // The packet goes straight back to the client, so it's free again.
+      //
       // ~send_free_input_packet_locked
       // ~lock
+      core_codec_packet->SetFree(true);
       return;
     }
 
@@ -817,15 +854,93 @@ void CodecImpl::QueueInputPacket_StreamControl(
     send_free_input_packet_locked.cancel();
   }  // ~lock
 
+  QueueInputPacketToCoreCodec(packet, core_codec_packet, buffer);
+}
+
+void CodecImpl::QueueInputPacketToCurrentStream(
+    fuchsia::mediacodec::CodecPacket packet) {
+  ZX_DEBUG_ASSERT(thrd_current() == stream_control_thread_);
+  ZX_DEBUG_ASSERT(packet.stream_lifetime_ordinal == stream_lifetime_ordinal_);
+  ZX_DEBUG_ASSERT(stream_);
+
+  // was_unbind_started_ never goes back to false, and also covers a stream
+  // that StartNewStream() gave up on starting because we're stopping.
+  if (was_unbind_started_) {
+    return;
+  }
+
+  CodecPacket* core_codec_packet = nullptr;
+  const CodecBuffer* buffer = nullptr;
+  const char* error = nullptr;
+  {  // scope port_lock
+    // The input port state checked below is only written with
+    // port_lock_[kInputPort] held, and the packet's free/busy state is atomic.
+    // These are the same checks QueueInputPacket_StreamControl() makes under
+    // lock_, in the same order.  On failure we release port_lock_[kInputPort]
+    // before calling Fail(), since Fail() acquires lock_, which is "before"
+    // port_lock_[kInputPort].
+    std::lock_guard<std::mutex> port_lock(port_lock_[kInputPort]);
+    uint64_t buffer_lifetime_ordinal = packet.header.buffer_lifetime_ordinal;
+    uint32_t packet_index = packet.header.packet_index;
+    if (buffer_lifetime_ordinal % 2 == 0) {
+      error = "QueueInputPacket() - buffer_lifetime_ordinal must be odd";
+    } else if (buffer_lifetime_ordinal >
+               protocol_buffer_lifetime_ordinal_[kInputPort]) {
+      error =
+          "client sent new buffer_lifetime_ordinal in message type that "
+          "doesn't allow new buffer_lifetime_ordinals";
+    } else if (buffer_lifetime_ordinal !=
+               port_settings_[kInputPort]->buffer_lifetime_ordinal) {
+      error =
+          "client QueueInputPacket() with invalid buffer_lifetime_ordinal.";
+    } else if (!is_port_configured_[kInputPort]) {
+      error = "client QueueInputPacket() with input buffers not configured";
+    } else if (packet_index >= all_packets_[kInputPort].size()) {
+      error = "client QueueInputPacket() with packet_index out of range";
+    } else if (packet.buffer_index >= all_buffers_[kInputPort].size()) {
+      error = "client QueueInputPacket() with buffer_index out of range";
+    } else if (!all_packets_[kInputPort][packet_index]->ExchangeFree(false)) {
+      error = "client QueueInputPacket() with packet_index !free";
+    } else {
+      core_codec_packet = all_packets_[kInputPort][packet_index].get();
+      buffer = all_buffers_[kInputPort][packet.buffer_index].get();
+    }
+  }  // ~port_lock
+
+  if (error) {
+    Fail("%s", error);
+    return;
+  }
+
+  // Only StreamControl sets input_end_of_stream(), and future_discarded() is
+  // atomic.  A stream discarded just after this check gets this packet anyway,
+  // which only costs the core codec a bit of unnecessary work.
+  if (stream_->input_end_of_stream()) {
+    Fail("QueueInputPacket() after QueueInputEndOfStream() unexpeted");
+    return;
+  }
+  if (stream_->future_discarded()) {
+    // See QueueInputPacket_StreamControl() re. why we don't queue to the core
+    // codec.  The packet goes straight back to the client instead.
+    core_codec_packet->SetFree(true);
+    SendFreeInputPacket(fidl::Clone(packet.header));
+    return;
+  }
+
+  QueueInputPacketToCoreCodec(packet, core_codec_packet, buffer);
+}
+
+void CodecImpl::QueueInputPacketToCoreCodec(
+    const fuchsia::mediacodec::CodecPacket& packet,
+    CodecPacket* core_codec_packet, const CodecBuffer* buffer) {
+  ZX_DEBUG_ASSERT(thrd_current() == stream_control_thread_);
+
   if (stream_->oob_config_pending()) {
     HandlePendingInputFormatDetails();
     stream_->SetOobConfigPending(false);
   }
 
-  CodecPacket* core_codec_packet =
-      all_packets_[kInputPort][packet.header.packet_index].get();
-  core_codec_packet->SetBuffer(
-      all_buffers_[kInputPort][packet.buffer_index].get());
+  core_codec_packet->SetBuffer(buffer);
   core_codec_packet->SetStartOffset(packet.start_offset);
   core_codec_packet->SetValidLengthBytes(packet.valid_length_bytes);
   if (packet.has_timestamp_ish) {
@@ -1102,7 +1217,10 @@ void CodecImpl::SetBufferSettingsCommon(
         port);
     return;
   }
-  protocol_buffer_lifetime_ordinal_[port] = settings.buffer_lifetime_ordinal;
+  {  // scope port_lock
+    std::lock_guard<std::mutex> port_lock(port_lock_[port]);
+    protocol_buffer_lifetime_ordinal_[port] = settings.buffer_lifetime_ordinal;
+  }  // ~port_lock
 
   if (settings.buffer_lifetime_ordinal % 2 == 0) {
     FailLocked(
@@ -1147,6 +1265,7 @@ void CodecImpl::SetBufferSettingsCommon(
   EnsureBuffersNotConfigured(lock, port);
 
   // This also starts the new buffer_lifetime_ordinal.
+  std::lock_guard<std::mutex> port_lock(port_lock_[port]);
   port_settings_[port] =
       std::make_unique<fuchsia::mediacodec::CodecPortBufferSettings>(
           std::move(settings));
@@ -1167,7 +1286,10 @@ void CodecImpl::EnsureBuffersNotConfigured(std::unique_lock<std::mutex>& lock,
   ZX_DEBUG_ASSERT(thrd_current() == stream_control_thread_ ||
                   (port == kOutputPort && (thrd_current() == fidl_thread())));
 
-  is_port_configured_[port] = false;
+  {  // scope port_lock
+    std::lock_guard<std::mutex> port_lock(port_lock_[port]);
+    is_port_configured_[port] = false;
+  }  // ~port_lock
 
   // Ensure that buffers aren't with the core codec.
   {  // scope unlock
@@ -1183,6 +1305,7 @@ void CodecImpl::EnsureBuffersNotConfigured(std::unique_lock<std::mutex>& lock,
   // ZX_DEBUG_ASSERT(all_packets_[port].empty() ||
   // !all_packets_[port][0]->is_with_hw());
 
+  std::lock_guard<std::mutex> port_lock(port_lock_[port]);
   all_packets_[port].clear();
   all_buffers_[port].clear();
   ZX_DEBUG_ASSERT(all_packets_[port].empty());
@@ -1302,7 +1425,10 @@ bool CodecImpl::AddBufferCommon(CodecPort port,
     }
     // Inform the core codec up-front about each buffer.
     CoreCodecAddBuffer(port, local_buffer.get());
-    all_buffers_[port].push_back(std::move(local_buffer));
+    {  // scope port_lock
+      std::lock_guard<std::mutex> port_lock(port_lock_[port]);
+      all_buffers_[port].push_back(std::move(local_buffer));
+    }  // ~port_lock
     if (all_buffers_[port].size() == required_buffer_count) {
       ZX_DEBUG_ASSERT(buffer_lifetime_ordinal_[port] ==
                       port_settings_[port]->buffer_lifetime_ordinal);
@@ -1313,13 +1439,17 @@ bool CodecImpl::AddBufferCommon(CodecPort port,
       ZX_DEBUG_ASSERT(all_packets_[port].empty());
       uint32_t packet_count =
           PacketCountFromPortSettings(*port_settings_[port]);
-      for (uint32_t i = 0; i < packet_count; i++) {
-        // Private constructor to prevent core codec maybe creating its own
-        // Packet instances (which isn't the intent) seems worth the hassle of
-        // not using make_unique<>() here.
-        all_packets_[port].push_back(std::unique_ptr<CodecPacket>(
-            new CodecPacket(port_settings_[port]->buffer_lifetime_ordinal, i)));
-      }
+      {  // scope port_lock
+        std::lock_guard<std::mutex> port_lock(port_lock_[port]);
+        for (uint32_t i = 0; i < packet_count; i++) {
+          // Private constructor to prevent core codec maybe creating its own
+          // Packet instances (which isn't the intent) seems worth the hassle
+          // of not using make_unique<>() here.
+          all_packets_[port].push_back(
+              std::unique_ptr<CodecPacket>(new CodecPacket(
+                  port_settings_[port]->buffer_lifetime_ordinal, i)));
+        }
+      }  // ~port_lock
 
       {  // scope unlock
         ScopedUnlock unlock(lock);
@@ -1348,7 +1478,10 @@ bool CodecImpl::AddBufferCommon(CodecPort port,
       // currently, and OMX UseBuffer() isn't valid until we're moving from
       // OMX_StateLoaded to OMX_StateIdle.
 
-      is_port_configured_[port] = true;
+      {  // scope port_lock
+        std::lock_guard<std::mutex> port_lock(port_lock_[port]);
+        is_port_configured_[port] = true;
+      }  // ~port_lock
       done_configuring = true;
     }
   }
@@ -1549,7 +1682,10 @@ bool CodecImpl::StartNewStream(std::unique_lock<std::mutex>& lock,
   // Track this so the core codec doesn't have to bother with "ensure"
   // semantics, just start/stop, where stop isn't called unless the core codec
   // has a started stream.
-  is_core_codec_stream_started_ = true;
+  {  // scope port_lock
+    std::lock_guard<std::mutex> port_lock(port_lock_[kInputPort]);
+    is_core_codec_stream_started_ = true;
+  }  // ~port_lock
 
   return true;
 }
@@ -1565,6 +1701,7 @@ void CodecImpl::EnsureStreamClosed(std::unique_lock<std::mutex>& lock) {
       ScopedUnlock unlock(lock);
       CoreCodecStopStream();
     }
+    std::lock_guard<std::mutex> port_lock(port_lock_[kInputPort]);
     is_core_codec_stream_started_ = false;
   }
 
@@ -1728,7 +1865,10 @@ void CodecImpl::StartIgnoringClientOldOutputConfig(
     ZX_DEBUG_ASSERT(buffer_lifetime_ordinal_[kOutputPort] % 2 == 1);
     ZX_DEBUG_ASSERT(buffer_lifetime_ordinal_[kOutputPort] ==
                     port_settings_[kOutputPort]->buffer_lifetime_ordinal);
-    buffer_lifetime_ordinal_[kOutputPort]++;
+    {  // scope port_lock
+      std::lock_guard<std::mutex> port_lock(port_lock_[kOutputPort]);
+      buffer_lifetime_ordinal_[kOutputPort]++;
+    }  // ~port_lock
     ZX_DEBUG_ASSERT(buffer_lifetime_ordinal_[kOutputPort] % 2 == 0);
     ZX_DEBUG_ASSERT(buffer_lifetime_ordinal_[kOutputPort] ==
                     port_settings_[kOutputPort]->buffer_lifetime_ordinal + 1);
@@ -1916,7 +2056,7 @@ void CodecImpl::MidStreamOutputConfigChange(uint64_t stream_lifetime_ordinal) {
 
 thrd_t CodecImpl::fidl_thread() { return shared_fidl_thread_; }
 
-void CodecImpl::SendFreeInputPacketLocked(
+void CodecImpl::SendFreeInputPacket(
     fuchsia::mediacodec::CodecPacketHeader header) {
   // We allow calling this method on StreamControl or InputData ordering domain.
   // Because the InputData ordering domain thread isn't visible to this code,
@@ -2231,77 +2371,96 @@ void CodecImpl::onCoreCodecMidStreamOutputConfigChange(
 void CodecImpl::onCoreCodecInputPacketDone(CodecPacket* packet) {
   // Free/busy coherency from Codec interface to OMX doesn't involve trusting
   // the client, so assert we're doing it right server-side.
-  {  // scope lock
-    std::unique_lock<std::mutex> lock(lock_);
-    // The core codec says the buffer-referening in-flight lifetime of this
-    // packet is over.  We'll set the buffer again when this packet get's used
-    // by the client again to deliver more input data.
-    packet->SetBuffer(nullptr);
-    // Unfortunately we have to insist that the core codec not call
-    // onCoreCodecInputPacketDone() arbitrarily late because we need to know
-    // when it's safe to deallocate binding_, and the core codec, etc.  So the
-    // rule is the core codec needs to ensure that all calls to stream-related
-    // callbacks have completed (to structure-touching degree; not
-    // code-unloading degree) before CoreCodecStopStream() returns.
+  //
+  // This is called once per input packet, so it doesn't acquire lock_.  The
+  // packet is owned by the core codec until SetFree(true) below, and
+  // all_packets_[kInputPort] can't change while a stream is active.
+  //
+  // Unfortunately we have to insist that the core codec not call
+  // onCoreCodecInputPacketDone() arbitrarily late because we need to know
+  // when it's safe to deallocate binding_, and the core codec, etc.  So the
+  // rule is the core codec needs to ensure that all calls to stream-related
+  // callbacks have completed (to structure-touching degree; not
+  // code-unloading degree) before CoreCodecStopStream() returns.
+  {  // scope port_lock
+    std::lock_guard<std::mutex> port_lock(port_lock_[kInputPort]);
     ZX_DEBUG_ASSERT(is_core_codec_stream_started_);
-    ZX_DEBUG_ASSERT(
-        !all_packets_[kInputPort][packet->packet_index()]->is_free());
-    all_packets_[kInputPort][packet->packet_index()]->SetFree(true);
-    SendFreeInputPacketLocked(fuchsia::mediacodec::CodecPacketHeader{
-        .buffer_lifetime_ordinal = packet->buffer_lifetime_ordinal(),
-        .packet_index = packet->packet_index()});
-  }  // ~lock
+  }  // ~port_lock
+  ZX_DEBUG_ASSERT(packet ==
+                  all_packets_[kInputPort][packet->packet_index()].get());
+  // The core codec says the buffer-referening in-flight lifetime of this
+  // packet is over.  We'll set the buffer again when this packet get's used
+  // by the client again to deliver more input data.
+  packet->SetBuffer(nullptr);
+  fuchsia::mediacodec::CodecPacketHeader header{
+      .buffer_lifetime_ordinal = packet->buffer_lifetime_ordinal(),
+      .packet_index = packet->packet_index()};
+  // Once the packet is free, QueueInputPacket_StreamControl() may re-use it
+  // (for a well-behaved client, only after the OnFreeInputPacket() below), so
+  // this is the last touch of packet.
+  packet->SetFree(true);
+  SendFreeInputPacket(std::move(header));
 }
 
 void CodecImpl::onCoreCodecOutputPacket(CodecPacket* packet,
                                         bool error_detected_before,
                                         bool error_detected_during) {
-  {  // scope lock
-    std::unique_lock<std::mutex> lock(lock_);
-    // This helps verify that packet lifetimes are coherent, but we can't do the
-    // same for buffer_index because VP9 has show_existing_frame which is
-    // allowed to output the same buffer repeatedly.
-    //
-    // TODO(dustingreen): We could _optionally_ verify that buffer lifetimes are
-    // coherent for codecs that don't output the same buffer repeatedly and
-    // concurrently.
-    all_packets_[kOutputPort][packet->packet_index()]->SetFree(false);
-    ZX_DEBUG_ASSERT(packet->has_start_offset());
-    ZX_DEBUG_ASSERT(packet->has_valid_length_bytes());
-    // packet->has_timestamp_ish() is optional even if
-    // promise_separate_access_units_on_input is true.  We do want to enforce
-    // that the client gets no set timestamp_ish values if the client didn't
-    // promise_separate_access_units_on_input.
-    bool has_timestamp_ish =
-        decoder_params_->promise_separate_access_units_on_input &&
-        packet->has_timestamp_ish();
-    uint64_t timestamp_ish = has_timestamp_ish ? packet->timestamp_ish() : 0;
-    PostToSharedFidl(
-        [this,
-         p =
-             fuchsia::mediacodec::CodecPacket{
-                 .header.buffer_lifetime_ordinal =
-                     packet->buffer_lifetime_ordinal(),
-                 .header.packet_index = packet->packet_index(),
-                 .buffer_index = packet->buffer()->buffer_index(),
-                 .stream_lifetime_ordinal = stream_lifetime_ordinal_,
-                 .start_offset = packet->start_offset(),
-                 .valid_length_bytes = packet->valid_length_bytes(),
-                 .has_timestamp_ish = has_timestamp_ish,
-                 .timestamp_ish = timestamp_ish,
-                 // TODO(dustingreen): These two "true" values should be fine
-                 // for decoders, but need to revisit here for encoders.
-                 .start_access_unit = decoder_params_ ? true : false,
-                 .known_end_access_unit = decoder_params_ ? true : false,
-             },
-         error_detected_before, error_detected_during] {
-          // See "is_bound_checks" comment up top.
-          if (binding_.is_bound()) {
-            binding_.events().OnOutputPacket(
-                std::move(p), error_detected_before, error_detected_during);
-          }
-        });
-  }  // ~lock
+  // This is called once per output packet, so it doesn't acquire lock_.  The
+  // core codec only emits output while a stream is active and output is
+  // configured, during which stream_lifetime_ordinal_ and
+  // all_packets_[kOutputPort] don't change, and decoder_params_ doesn't
+  // change after construction.
+  //
+  // Messages to the client stay in order without lock_, since they're all
+  // posted to the same serial FIDL dispatcher, and the core codec emits a
+  // stream's output (including any OnOutputConfig() not requiring buffer
+  // re-config, and OnOutputEndOfStream()) in order from its own thread.
+  //
+  // This helps verify that packet lifetimes are coherent, but we can't do the
+  // same for buffer_index because VP9 has show_existing_frame which is
+  // allowed to output the same buffer repeatedly.
+  //
+  // TODO(dustingreen): We could _optionally_ verify that buffer lifetimes are
+  // coherent for codecs that don't output the same buffer repeatedly and
+  // concurrently.
+  ZX_DEBUG_ASSERT(packet ==
+                  all_packets_[kOutputPort][packet->packet_index()].get());
+  packet->SetFree(false);
+  ZX_DEBUG_ASSERT(packet->has_start_offset());
+  ZX_DEBUG_ASSERT(packet->has_valid_length_bytes());
+  // packet->has_timestamp_ish() is optional even if
+  // promise_separate_access_units_on_input is true.  We do want to enforce
+  // that the client gets no set timestamp_ish values if the client didn't
+  // promise_separate_access_units_on_input.
+  bool has_timestamp_ish =
+      decoder_params_->promise_separate_access_units_on_input &&
+      packet->has_timestamp_ish();
+  uint64_t timestamp_ish = has_timestamp_ish ? packet->timestamp_ish() : 0;
+  PostToSharedFidl(
+      [this,
+       p =
+           fuchsia::mediacodec::CodecPacket{
+               .header.buffer_lifetime_ordinal =
+                   packet->buffer_lifetime_ordinal(),
+               .header.packet_index = packet->packet_index(),
+               .buffer_index = packet->buffer()->buffer_index(),
+               .stream_lifetime_ordinal = stream_lifetime_ordinal_,
+               .start_offset = packet->start_offset(),
+               .valid_length_bytes = packet->valid_length_bytes(),
+               .has_timestamp_ish = has_timestamp_ish,
+               .timestamp_ish = timestamp_ish,
+               // TODO(dustingreen): These two "true" values should be fine
+               // for decoders, but need to revisit here for encoders.
+               .start_access_unit = decoder_params_ ? true : false,
+               .known_end_access_unit = decoder_params_ ? true : false,
+           },
+       error_detected_before, error_detected_during] {
+        // See "is_bound_checks" comment up top.
+        if (binding_.is_bound()) {
+          binding_.events().OnOutputPacket(
+              std::move(p), error_detected_before, error_detected_during);
+        }
+      });
 }
 
 void CodecImpl::onCoreCodecOutputEndOfStream(bool error_detected_before) {
@@ -7,6 +7,7 @@
 #include <lib/media/codec_impl/codec_buffer.h>
 
 #include <stdint.h>
+#include <zircon/compiler.h>
 
 CodecPacket::CodecPacket(uint64_t buffer_lifetime_ordinal,
                          uint32_t packet_index)
@@ -72,8 +73,8 @@ uint64_t CodecPacket::timestamp_ish() const {
 void CodecPacket::SetFree(bool is_free) {
   // We shouldn't need to be calling this method unless we're changing the
   // is_free state.
-  ZX_DEBUG_ASSERT(is_free_ != is_free);
-  is_free_ = is_free;
+  __UNUSED bool was_free = is_free_.exchange(is_free);
+  ZX_DEBUG_ASSERT(was_free != is_free);
 }
 
 bool CodecPacket::is_free() const { return is_free_; }
@@ -82,6 +83,10 @@ void CodecPacket::SetIsNew(bool is_new) { is_new_ = is_new; }
 
 bool CodecPacket::is_new() const { return is_new_; }
 
+bool CodecPacket::ExchangeFree(bool is_free) {
+  return is_free_.exchange(is_free);
+}
+
 void CodecPacket::ClearStartOffset() { start_offset_ = kStartOffsetNotSet; }
 
 void CodecPacket::ClearValidLengthBytes() {
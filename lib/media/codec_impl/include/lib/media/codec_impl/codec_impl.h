@@ -18,6 +18,7 @@
 #include <lib/fit/function.h>
 #include <zircon/compiler.h>
 
+#include <atomic>
 #include <list>
 
 // The CodecImpl class can be used for both SW and HW codecs.
@@ -215,7 +216,9 @@ class CodecImpl : public fuchsia::mediacodec::Codec,
 
    private:
     const uint64_t stream_lifetime_ordinal_ = 0;
-    bool future_discarded_ = false;
+    // Set on the FIDL thread, and read on StreamControl without lock_ for each
+    // input packet of the current stream.
+    std::atomic<bool> future_discarded_{false};
     bool future_flush_end_of_stream_ = false;
     // Starts as nullptr for each new stream with implicit fallback to
     // initial_input_format_details_, but can be overriden on a per-stream basis
@@ -250,6 +253,25 @@ class CodecImpl : public fuchsia::mediacodec::Codec,
   // thread(s).
   std::mutex lock_;
 
+  // Writes to the per-port buffer state that the per-packet paths check
+  // (port_settings_, buffer_lifetime_ordinal_,
+  // protocol_buffer_lifetime_ordinal_, all_buffers_, is_port_configured_,
+  // all_packets_) are made with both lock_ and port_lock_[port] held, in that
+  // order.  This lets RecycleOutputPacket(), which runs once per output packet,
+  // validate the client's message under port_lock_[kOutputPort] alone instead
+  // of contending with input processing and stream control for lock_.
+  //
+  // Packet free/busy state is tracked with atomics instead (see
+  // CodecPacket::is_free_), so the core codec's per-packet callbacks take
+  // neither lock, other than onCoreCodecInputPacketDone() checking
+  // is_core_codec_stream_started_, which is also written with
+  // port_lock_[kInputPort] held.
+  //
+  // Input packets for the current stream are likewise validated under
+  // port_lock_[kInputPort] alone, by QueueInputPacketToCurrentStream().  Only a
+  // packet that starts a new stream takes lock_.
+  std::mutex port_lock_[kPortCount];
+
   //
   // Setup/teardown aspects.
   //
@@ -342,7 +364,9 @@ class CodecImpl : public fuchsia::mediacodec::Codec,
   async::Loop stream_control_loop_;
   thrd_t stream_control_thread_ = 0;
   fit::closure owner_error_handler_;
-  bool was_unbind_started_ = false;
+  // Written with lock_ held.  Atomic so that the per-packet input path can
+  // check it without lock_.
+  std::atomic<bool> was_unbind_started_{false};
   bool was_unbind_completed_ = false;
   std::condition_variable wake_stream_control_condition_;
 
@@ -365,6 +389,13 @@ class CodecImpl : public fuchsia::mediacodec::Codec,
       uint64_t stream_lifetime_ordinal,
       fuchsia::mediacodec::CodecFormatDetails format_details);
   void QueueInputPacket_StreamControl(fuchsia::mediacodec::CodecPacket packet);
+  // The per-packet path of QueueInputPacket_StreamControl(), for packets of the
+  // stream StreamControl already has current.  Doesn't acquire lock_.
+  void QueueInputPacketToCurrentStream(fuchsia::mediacodec::CodecPacket packet);
+  // Hands a validated input packet to the core codec.
+  void QueueInputPacketToCoreCodec(
+      const fuchsia::mediacodec::CodecPacket& packet,
+      CodecPacket* core_codec_packet, const CodecBuffer* buffer);
   void QueueInputEndOfStream_StreamControl(uint64_t stream_lifetime_ordinal);
 
   __WARN_UNUSED_RESULT bool IsStreamActiveLocked();
@@ -592,7 +623,7 @@ class CodecImpl : public fuchsia::mediacodec::Codec,
 
   // Send OnFreeInputPacket() using shared_fidl_thread().  This can be called
   // on any thread other than shared_fidl_thread().
-  void SendFreeInputPacketLocked(fuchsia::mediacodec::CodecPacketHeader header);
+  void SendFreeInputPacket(fuchsia::mediacodec::CodecPacketHeader header);
 
   __WARN_UNUSED_RESULT bool IsInputConfiguredLocked();
   __WARN_UNUSED_RESULT bool IsOutputConfiguredLocked();
@@ -652,6 +683,7 @@ class CodecImpl : public fuchsia::mediacodec::Codec,
   // CoreCodecInit() was ever called.
   bool is_core_codec_init_called_ = false;
 
+  // Written with lock_ and port_lock_[kInputPort] held; see port_lock_.
   bool is_core_codec_stream_started_ = false;
 
   //
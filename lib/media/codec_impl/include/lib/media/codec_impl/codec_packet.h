@@ -8,6 +8,7 @@
 #include <fuchsia/mediacodec/cpp/fidl.h>
 
 #include <stdint.h>
+#include <atomic>
 #include <limits>
 #include <memory>
 
@@ -65,6 +66,11 @@ class CodecPacket {
   void ClearStartOffset();
   void ClearValidLengthBytes();
 
+  // Sets is_free() to is_free and returns the previous value, as one atomic
+  // step.  This lets CodecImpl check a client's claim about a packet's
+  // free/busy state and act on it without holding lock_.
+  bool ExchangeFree(bool is_free);
+
   uint64_t buffer_lifetime_ordinal_ = 0;
   uint32_t packet_index_ = 0;
 
@@ -92,7 +98,11 @@ class CodecPacket {
   //
   // An input packet starts out free with the client, and and output packet
   // starts out free with the codec server.  Either way, it starts free.
-  bool is_free_ = true;
+  //
+  // This is atomic because the core codec marks packets free/busy from its own
+  // threads without holding lock_, concurrently with CodecImpl checking client
+  // messages on the FIDL and StreamControl threads.
+  std::atomic<bool> is_free_{true};
 
   // Starts true when a packet is truly new.  In addition, a CodecAdapter may
   // set this back to true whenever the packet is logically new from the
@@ -0,0 +1,712 @@
+// Copyright 2018 The Fuchsia Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include <lib/media/codec_impl/codec_impl.h>
+
+#include <lib/async-loop/cpp/loop.h>
+#include <lib/async/cpp/task.h>
+#include <lib/fit/function.h>
+#include <lib/media/codec_impl/codec_adapter.h>
+#include <lib/media/codec_impl/codec_admission_control.h>
+#include <lib/zx/vmo.h>
+#include <string.h>
+
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+namespace {
+
+constexpr uint64_t kInputBufferLifetimeOrdinal = 1;
+
+constexpr uint32_t kOutputPacketCountForCodec = 8;
+constexpr uint32_t kOutputPacketCountForClient = 2;
+constexpr uint32_t kOutputPerPacketBufferBytes = 4096;
+
+// How long RunStress() waits for its codecs to finish, and then to be deleted,
+// before failing the test.
+constexpr std::chrono::seconds kStressTimeout(120);
+
+// Posts |to_run| to |dispatcher| and waits for it to finish.
+void PostAndWait(async_dispatcher_t* dispatcher, fit::closure to_run) {
+  std::mutex lock;
+  std::condition_variable done_condition;
+  bool done = false;
+  async::PostTask(dispatcher, [&lock, &done_condition, &done, &to_run] {
+    to_run();
+    {  // scope lock
+      std::lock_guard<std::mutex> locker(lock);
+      done = true;
+    }  // ~lock
+    done_condition.notify_all();
+  });
+  std::unique_lock<std::mutex> locker(lock);
+  while (!done) {
+    done_condition.wait(locker);
+  }
+}
+
+// A CodecAdapter that copies each input packet's payload into a free output
+// packet on its own thread, as fast as input and free output packets allow.
+// This exercises CodecImpl's per-packet paths without any real codec work.
+//
+// If |output_reconfig_interval| is non-zero, the adapter demands a mid-stream
+// output buffer re-config after every |output_reconfig_interval| output
+// packets, and emits no more output until the re-config is finished.
+class FakeCodecAdapter : public CodecAdapter {
+ public:
+  FakeCodecAdapter(std::mutex& lock, CodecAdapterEvents* codec_adapter_events,
+                   uint32_t output_reconfig_interval)
+      : CodecAdapter(lock, codec_adapter_events),
+        processing_loop_(&kAsyncLoopConfigNoAttachToThread),
+        output_reconfig_interval_(output_reconfig_interval) {}
+
+  ~FakeCodecAdapter() override {
+    processing_loop_.Quit();
+    processing_loop_.JoinThreads();
+    processing_loop_.Shutdown();
+  }
+
+  bool IsCoreCodecRequiringOutputConfigForFormatDetection() override {
+    // This gets the output config sent right away, so the client can configure
+    // both ports before queueing any input.
+    return true;
+  }
+
+  void CoreCodecInit(const fuchsia::mediacodec::CodecFormatDetails&
+                         initial_input_format_details) override {
+    if (processing_loop_.StartThread("FakeCodecAdapter") != ZX_OK) {
+      events_->onCoreCodecFailCodec("StartThread() failed");
+    }
+  }
+
+  void CoreCodecStartStream() override {
+    std::lock_guard<std::mutex> lock(lock_);
+    is_stream_stopping_ = false;
+    // A re-config left unfinished by the previous stream is moot; CodecImpl
+    // has the client configure output before starting this one.
+    is_output_reconfig_pending_ = false;
+  }
+
+  void CoreCodecQueueInputFormatDetails(
+      const fuchsia::mediacodec::CodecFormatDetails&
+          per_stream_override_format_details) override {}
+
+  void CoreCodecQueueInputPacket(CodecPacket* packet) override {
+    QueueInputItem(CodecInputItem::Packet(packet));
+  }
+
+  void CoreCodecQueueInputEndOfStream() override {
+    QueueInputItem(CodecInputItem::EndOfStream());
+  }
+
+  void CoreCodecStopStream() override {
+    std::unique_lock<std::mutex> lock(lock_);
+    is_stream_stopping_ = true;
+    // Once this runs, any previously-posted ProcessInput() has returned, so
+    // there will be no more callbacks for this stream other than giving back
+    // the input packets that weren't processed.
+    bool is_stopped = false;
+    std::condition_variable stopped_condition;
+    async::PostTask(processing_loop_.dispatcher(),
+                    [this, &is_stopped, &stopped_condition] {
+                      std::list<CodecInputItem> dropped_input;
+                      {  // scope lock
+                        std::lock_guard<std::mutex> lock(lock_);
+                        dropped_input.swap(input_queue_);
+                      }  // ~lock
+                      for (auto& item : dropped_input) {
+                        if (item.is_packet()) {
+                          events_->onCoreCodecInputPacketDone(item.packet());
+                        }
+                      }
+                      {  // scope lock
+                        std::lock_guard<std::mutex> lock(lock_);
+                        is_stopped = true;
+                      }  // ~lock
+                      stopped_condition.notify_all();
+                    });
+    while (!is_stopped) {
+      stopped_condition.wait(lock);
+    }
+  }
+
+  void CoreCodecAddBuffer(CodecPort port, const CodecBuffer* buffer) override {
+    // output_buffers_ is only touched here, by
+    // CoreCodecEnsureBuffersNotConfigured(), and by ProcessInput() while output
+    // is configured and no re-config is pending, none of which overlap.
+    if (port == kOutputPort) {
+      output_buffers_.push_back(buffer);
+    }
+  }
+
+  void CoreCodecConfigureBuffers(
+      CodecPort port,
+      const std::vector<std::unique_ptr<CodecPacket>>& packets) override {}
+
+  void CoreCodecRecycleOutputPacket(CodecPacket* packet) override {
+    {  // scope lock
+      std::lock_guard<std::mutex> lock(lock_);
+      free_output_packets_.push_back(packet);
+    }  // ~lock
+    PostProcessInput();
+  }
+
+  void CoreCodecEnsureBuffersNotConfigured(CodecPort port) override {
+    if (port != kOutputPort) {
+      return;
+    }
+    std::lock_guard<std::mutex> lock(lock_);
+    free_output_packets_.clear();
+    output_buffers_.clear();
+  }
+
+  std::unique_ptr<const fuchsia::mediacodec::CodecOutputConfig>
+  CoreCodecBuildNewOutputConfig(
+      uint64_t stream_lifetime_ordinal,
+      uint64_t new_output_buffer_constraints_version_ordinal,
+      uint64_t new_output_format_details_version_ordinal,
+      bool buffer_constraints_action_required) override {
+    std::unique_ptr<fuchsia::mediacodec::CodecOutputConfig> config =
+        std::make_unique<fuchsia::mediacodec::CodecOutputConfig>();
+    config->stream_lifetime_ordinal = stream_lifetime_ordinal;
+    config->buffer_constraints_action_required =
+        buffer_constraints_action_required;
+
+    fuchsia::mediacodec::CodecBufferConstraints& constraints =
+        config->buffer_constraints;
+    constraints.buffer_constraints_version_ordinal =
+        new_output_buffer_constraints_version_ordinal;
+    constraints.default_settings.buffer_lifetime_ordinal = 0;
+    constraints.default_settings.buffer_constraints_version_ordinal =
+        new_output_buffer_constraints_version_ordinal;
+    constraints.default_settings.packet_count_for_codec =
+        kOutputPacketCountForCodec;
+    constraints.default_settings.packet_count_for_client =
+        kOutputPacketCountForClient;
+    constraints.default_settings.per_packet_buffer_bytes =
+        kOutputPerPacketBufferBytes;
+    constraints.default_settings.single_buffer_mode = false;
+    constraints.per_packet_buffer_bytes_min = kOutputPerPacketBufferBytes;
+    constraints.per_packet_buffer_bytes_recommended =
+        kOutputPerPacketBufferBytes;
+    constraints.per_packet_buffer_bytes_max = kOutputPerPacketBufferBytes;
+    constraints.packet_count_for_codec_min = kOutputPacketCountForCodec;
+    constraints.packet_count_for_codec_recommended = kOutputPacketCountForCodec;
+    constraints.packet_count_for_codec_recommended_max =
+        kOutputPacketCountForCodec;
+    constraints.packet_count_for_codec_max = kOutputPacketCountForCodec;
+    constraints.packet_count_for_client_min = kOutputPacketCountForClient;
+    constraints.packet_count_for_client_max = kOutputPacketCountForClient;
+    constraints.single_buffer_mode_allowed = false;
+    constraints.is_physically_contiguous_required = false;
+
+    config->format_details.format_details_version_ordinal =
+        new_output_format_details_version_ordinal;
+    config->format_details.mime_type = "application/octet-stream";
+    return config;
+  }
+
+  void CoreCodecMidStreamOutputBufferReConfigPrepare() override {}
+
+  void CoreCodecMidStreamOutputBufferReConfigFinish() override {
+    {  // scope lock
+      std::lock_guard<std::mutex> lock(lock_);
+      is_output_reconfig_pending_ = false;
+    }  // ~lock
+    PostProcessInput();
+  }
+
+ private:
+  void QueueInputItem(CodecInputItem input_item) {
+    {  // scope lock
+      std::lock_guard<std::mutex> lock(lock_);
+      input_queue_.push_back(std::move(input_item));
+    }  // ~lock
+    PostProcessInput();
+  }
+
+  void PostProcessInput() {
+    async::PostTask(processing_loop_.dispatcher(), [this] { ProcessInput(); });
+  }
+
+  // Pairs queued input with free output packets until one or the other runs
+  // out.  Runs only on the processing thread.
+  void ProcessInput() {
+    while (true) {
+      CodecInputItem item = CodecInputItem::Invalid();
+      CodecPacket* output_packet = nullptr;
+      {  // scope lock
+        std::lock_guard<std::mutex> lock(lock_);
+        if (is_stream_stopping_ || is_output_reconfig_pending_ ||
+            input_queue_.empty()) {
+          return;
+        }
+        if (input_queue_.front().is_packet()) {
+          if (free_output_packets_.empty()) {
+            // CoreCodecRecycleOutputPacket() will post another ProcessInput().
+            return;
+          }
+          output_packet = free_output_packets_.front();
+          free_output_packets_.pop_front();
+        }
+        item = std::move(input_queue_.front());
+        input_queue_.pop_front();
+      }  // ~lock
+
+      if (item.is_end_of_stream()) {
+        events_->onCoreCodecOutputEndOfStream(false);
+        continue;
+      }
+
+      if (!item.is_packet()) {
+        continue;
+      }
+
+      CodecPacket* input_packet = item.packet();
+      const CodecBuffer* output_buffer =
+          output_buffers_[output_packet->packet_index()];
+      uint32_t length =
+          std::min(input_packet->valid_length_bytes(),
+                   static_cast<uint32_t>(output_buffer->buffer_size()));
+      memcpy(output_buffer->buffer_base(),
+             input_packet->buffer()->buffer_base() +
+                 input_packet->start_offset(),
+             length);
+
+      output_packet->SetBuffer(output_buffer);
+      output_packet->SetStartOffset(0);
+      output_packet->SetValidLengthBytes(length);
+      if (input_packet->has_timestamp_ish()) {
+        output_packet->SetTimstampIsh(input_packet->timestamp_ish());
+      }
+
+      events_->onCoreCodecInputPacketDone(input_packet);
+      events_->onCoreCodecOutputPacket(output_packet, false, false);
+
+      if (output_reconfig_interval_ != 0 &&
+          ++output_packets_since_reconfig_ == output_reconfig_interval_) {
+        output_packets_since_reconfig_ = 0;
+        {  // scope lock
+          std::lock_guard<std::mutex> lock(lock_);
+          is_output_reconfig_pending_ = true;
+        }  // ~lock
+        // CoreCodecMidStreamOutputBufferReConfigFinish() will post another
+        // ProcessInput().
+        events_->onCoreCodecMidStreamOutputConfigChange(true);
+        return;
+      }
+    }
+  }
+
+  async::Loop processing_loop_;
+  const uint32_t output_reconfig_interval_;
+  // Only touched on the processing thread.
+  uint32_t output_packets_since_reconfig_ = 0;
+  bool is_stream_stopping_ = false;
+  bool is_output_reconfig_pending_ = false;
+  std::list<CodecPacket*> free_output_packets_;
+  std::vector<const CodecBuffer*> output_buffers_;
+};
+
+// Drives one Codec through |stream_count| streams of |packets_per_stream|
+// input packets each, recycling each output packet as soon as it arrives.
+// Each input packet carries its sequence number within its stream as payload
+// and timestamp_ish, and each output packet is checked against both.
+//
+// Each stream after the first is started as soon as all of the previous
+// stream's input has been queued, without flushing it, so the switch races
+// with output packets of the previous stream still being recycled.  Only the
+// last stream is ended, and is expected to produce all of its output.
+class StressClient {
+ public:
+  StressClient(uint32_t stream_count, uint32_t packets_per_stream,
+               fit::closure done_callback)
+      : stream_count_(stream_count),
+        packets_per_stream_(packets_per_stream),
+        done_callback_(std::move(done_callback)) {}
+
+  // Must be called on the client thread.
+  fidl::InterfaceRequest<fuchsia::mediacodec::Codec> NewRequest(
+      async_dispatcher_t* dispatcher) {
+    auto request = codec_.NewRequest(dispatcher);
+    codec_.set_error_handler([this](zx_status_t status) {
+      ADD_FAILURE() << "Codec channel failed, status " << status;
+      Done();
+    });
+    codec_.events().OnInputConstraints =
+        [this](fuchsia::mediacodec::CodecBufferConstraints constraints) {
+          OnInputConstraints(std::move(constraints));
+        };
+    codec_.events().OnOutputConfig =
+        [this](fuchsia::mediacodec::CodecOutputConfig output_config) {
+          OnOutputConfig(std::move(output_config));
+        };
+    codec_.events().OnFreeInputPacket =
+        [this](fuchsia::mediacodec::CodecPacketHeader header) {
+          QueueInputPacket(header.packet_index);
+        };
+    codec_.events().OnOutputPacket =
+        [this](fuchsia::mediacodec::CodecPacket packet,
+               bool error_detected_before, bool error_detected_during) {
+          OnOutputPacket(std::move(packet));
+        };
+    codec_.events().OnOutputEndOfStream =
+        [this](uint64_t stream_lifetime_ordinal, bool error_detected_before) {
+          EXPECT_EQ(StreamLifetimeOrdinal(stream_count_ - 1),
+                    stream_lifetime_ordinal);
+          EXPECT_EQ(stream_lifetime_ordinal, output_stream_lifetime_ordinal_);
+          EXPECT_EQ(packets_per_stream_, output_packet_count_);
+          Done();
+        };
+    return request;
+  }
+
+ private:
+  static uint64_t StreamLifetimeOrdinal(uint32_t stream_index) {
+    return 2 * stream_index + 1;
+  }
+
+  // Creates a buffer of |size| bytes for the Codec, keeping a duplicate of its
+  // VMO in |vmos|.
+  fuchsia::mediacodec::CodecBuffer CreateBuffer(
+      uint64_t buffer_lifetime_ordinal, uint32_t buffer_index, uint32_t size,
+      std::vector<zx::vmo>* vmos) {
+    zx::vmo vmo;
+    zx::vmo dup_vmo;
+    EXPECT_EQ(ZX_OK, zx::vmo::create(size, 0, &vmo));
+    EXPECT_EQ(ZX_OK, vmo.duplicate(ZX_RIGHT_SAME_RIGHTS, &dup_vmo));
+    vmos->push_back(std::move(vmo));
+
+    fuchsia::mediacodec::CodecBuffer buffer{
+        .buffer_lifetime_ordinal = buffer_lifetime_ordinal,
+        .buffer_index = buffer_index,
+    };
+    buffer.data.set_vmo(fuchsia::mediacodec::CodecBufferDataVmo{
+        .vmo_handle = std::move(dup_vmo),
+        .vmo_usable_start = 0,
+        .vmo_usable_size = size,
+    });
+    return buffer;
+  }
+
+  void OnInputConstraints(
+      fuchsia::mediacodec::CodecBufferConstraints constraints) {
+    fuchsia::mediacodec::CodecPortBufferSettings settings =
+        fidl::Clone(constraints.default_settings);
+    settings.buffer_lifetime_ordinal = kInputBufferLifetimeOrdinal;
+    settings.buffer_constraints_version_ordinal =
+        constraints.buffer_constraints_version_ordinal;
+    settings.per_packet_buffer_bytes = constraints.per_packet_buffer_bytes_min;
+    input_packet_count_ =
+        settings.packet_count_for_codec + settings.packet_count_for_client;
+    uint32_t size = settings.per_packet_buffer_bytes;
+    codec_->SetInputBufferSettings(std::move(settings));
+
+    for (uint32_t i = 0; i < input_packet_count_; ++i) {
+      codec_->AddInputBuffer(
+          CreateBuffer(kInputBufferLifetimeOrdinal, i, size, &input_vmos_));
+    }
+
+    MaybeStart();
+  }
+
+  void OnOutputConfig(fuchsia::mediacodec::CodecOutputConfig output_config) {
+    if (!output_config.buffer_constraints_action_required) {
+      return;
+    }
+
+    const fuchsia::mediacodec::CodecBufferConstraints& constraints =
+        output_config.buffer_constraints;
+    fuchsia::mediacodec::CodecPortBufferSettings settings =
+        fidl::Clone(constraints.default_settings);
+    uint64_t buffer_lifetime_ordinal = next_output_buffer_lifetime_ordinal_;
+    next_output_buffer_lifetime_ordinal_ += 2;
+    output_buffer_lifetime_ordinal_ = buffer_lifetime_ordinal;
+    settings.buffer_lifetime_ordinal = buffer_lifetime_ordinal;
+    uint32_t buffer_count =
+        settings.packet_count_for_codec + settings.packet_count_for_client;
+    uint32_t size = settings.per_packet_buffer_bytes;
+    codec_->SetOutputBufferSettings(std::move(settings));
+
+    output_vmos_.clear();
+    for (uint32_t i = 0; i < buffer_count; ++i) {
+      codec_->AddOutputBuffer(
+          CreateBuffer(buffer_lifetime_ordinal, i, size, &output_vmos_));
+    }
+
+    is_output_configured_ = true;
+    MaybeStart();
+  }
+
+  // Queues every input packet once both ports are configured.
+  void MaybeStart() {
+    if (is_started_ || input_packet_count_ == 0 || !is_output_configured_) {
+      return;
+    }
+
+    is_started_ = true;
+    for (uint32_t i = 0; i < input_packet_count_; ++i) {
+      QueueInputPacket(i);
+    }
+  }
+
+  void QueueInputPacket(uint32_t packet_index) {
+    if (stream_index_ == stream_count_) {
+      return;
+    }
+
+    uint64_t stream_lifetime_ordinal = StreamLifetimeOrdinal(stream_index_);
+    uint64_t sequence_number = queued_packet_count_++;
+    EXPECT_EQ(ZX_OK, input_vmos_[packet_index].write(&sequence_number, 0,
+                                                     sizeof(sequence_number)));
+
+    fuchsia::mediacodec::CodecPacket packet{
+        .header.buffer_lifetime_ordinal = kInputBufferLifetimeOrdinal,
+        .header.packet_index = packet_index,
+        .buffer_index = packet_index,
+        .stream_lifetime_ordinal = stream_lifetime_ordinal,
+        .start_offset = 0,
+        .valid_length_bytes = sizeof(sequence_number),
+        .has_timestamp_ish = true,
+        .timestamp_ish = sequence_number,
+        .start_access_unit = true,
+        .known_end_access_unit = true,
+    };
+    codec_->QueueInputPacket(std::move(packet));
+
+    if (queued_packet_count_ == packets_per_stream_) {
+      if (++stream_index_ == stream_count_) {
+        codec_->QueueInputEndOfStream(stream_lifetime_ordinal);
+      }
+      queued_packet_count_ = 0;
+    }
+  }
+
+  void OnOutputPacket(fuchsia::mediacodec::CodecPacket packet) {
+    // A stream that was switched away from may have been cut short, but its
+    // output is still in order, and no stream's output follows a later one's.
+    EXPECT_GE(packet.stream_lifetime_ordinal, output_stream_lifetime_ordinal_);
+    if (packet.stream_lifetime_ordinal != output_stream_lifetime_ordinal_) {
+      output_stream_lifetime_ordinal_ = packet.stream_lifetime_ordinal;
+      output_packet_count_ = 0;
+    }
+    EXPECT_EQ(output_buffer_lifetime_ordinal_,
+              packet.header.buffer_lifetime_ordinal);
+    EXPECT_TRUE(packet.has_timestamp_ish);
+    EXPECT_EQ(output_packet_count_, packet.timestamp_ish);
+    ++output_packet_count_;
+
+    uint64_t sequence_number = ~0ull;
+    EXPECT_EQ(sizeof(sequence_number), packet.valid_length_bytes);
+    EXPECT_LT(packet.buffer_index, output_vmos_.size());
+    if (packet.buffer_index < output_vmos_.size()) {
+      EXPECT_EQ(ZX_OK, output_vmos_[packet.buffer_index].read(
+                           &sequence_number, packet.start_offset,
+                           sizeof(sequence_number)));
+    }
+    EXPECT_EQ(packet.timestamp_ish, sequence_number);
+
+    codec_->RecycleOutputPacket(std::move(packet.header));
+  }
+
+  void Done() {
+    if (done_callback_) {
+      fit::closure done_callback = std::move(done_callback_);
+      done_callback();
+    }
+  }
+
+  fuchsia::mediacodec::CodecPtr codec_;
+  const uint32_t stream_count_;
+  const uint32_t packets_per_stream_;
+  fit::closure done_callback_;
+
+  uint32_t input_packet_count_ = 0;
+  uint64_t next_output_buffer_lifetime_ordinal_ = 1;
+  uint64_t output_buffer_lifetime_ordinal_ = 0;
+  bool is_output_configured_ = false;
+  bool is_started_ = false;
+  uint32_t stream_index_ = 0;
+  uint32_t queued_packet_count_ = 0;
+  uint64_t output_stream_lifetime_ordinal_ = 0;
+  uint64_t output_packet_count_ = 0;
+  std::vector<zx::vmo> input_vmos_;
+  std::vector<zx::vmo> output_vmos_;
+};
+
+struct StressParams {
+  uint32_t codec_count = 1;
+  uint32_t stream_count = 1;
+  uint32_t packets_per_stream = 1;
+  // See FakeCodecAdapter.
+  uint32_t output_reconfig_interval = 0;
+};
+
+// Runs |params.codec_count| codecs concurrently, all sharing one FIDL thread
+// as codecs in a devhost do, each driven by a StressClient.  If non-null,
+// |packets_per_second| is set to the aggregate rate of input packets queued.
+void RunStress(const StressParams& params, double* packets_per_second) {
+  // Everything the loops' threads touch is declared before the loops, so that
+  // if an assertion below returns early, the loops are shut down before any of
+  // it is destroyed.
+  std::mutex lock;
+  std::condition_variable condition_changed;
+  uint32_t done_count = 0;
+  uint32_t deleted_count = 0;
+  std::vector<std::unique_ptr<StressClient>> clients;
+  std::unique_ptr<CodecAdmissionControl> admission_control;
+
+  async::Loop fidl_loop(&kAsyncLoopConfigNoAttachToThread);
+  thrd_t fidl_thread;
+  ASSERT_EQ(ZX_OK, fidl_loop.StartThread("fidl", &fidl_thread));
+  async::Loop client_loop(&kAsyncLoopConfigNoAttachToThread);
+  ASSERT_EQ(ZX_OK, client_loop.StartThread("client"));
+  admission_control =
+      std::make_unique<CodecAdmissionControl>(fidl_loop.dispatcher());
+
+  std::vector<fidl::InterfaceRequest<fuchsia::mediacodec::Codec>> requests;
+  for (uint32_t i = 0; i < params.codec_count; ++i) {
+    clients.push_back(std::make_unique<StressClient>(
+        params.stream_count, params.packets_per_stream,
+        [&lock, &condition_changed, &done_count] {
+          {  // scope lock
+            std::lock_guard<std::mutex> locker(lock);
+            ++done_count;
+          }  // ~lock
+          condition_changed.notify_all();
+        }));
+  }
+
+  auto start_time = std::chrono::steady_clock::now();
+
+  PostAndWait(client_loop.dispatcher(), [&clients, &requests, &client_loop] {
+    for (auto& client : clients) {
+      requests.push_back(client->NewRequest(client_loop.dispatcher()));
+    }
+  });
+
+  for (auto& request : requests) {
+    admission_control->TryAddCodec(
+        true, [&fidl_loop, fidl_thread, &lock, &condition_changed,
+               &deleted_count, &params, request = std::move(request)](
+                  std::unique_ptr<CodecAdmission> codec_admission) mutable {
+          ASSERT_TRUE(codec_admission);
+          auto decoder_params =
+              std::make_unique<fuchsia::mediacodec::CreateDecoder_Params>();
+          decoder_params->input_details.format_details_version_ordinal = 0;
+          decoder_params->input_details.mime_type = "application/octet-stream";
+          decoder_params->promise_separate_access_units_on_input = true;
+
+          // The error handler deletes the CodecImpl on the FIDL thread once
+          // the client closes the channel.
+          CodecImpl* codec_impl = new CodecImpl(
+              std::move(codec_admission), fidl_loop.dispatcher(), fidl_thread,
+              std::move(decoder_params), std::move(request));
+          codec_impl->SetCoreCodecAdapter(std::make_unique<FakeCodecAdapter>(
+              codec_impl->lock(), codec_impl,
+              params.output_reconfig_interval));
+          codec_impl->BindAsync(
+              [codec_impl, &lock, &condition_changed, &deleted_count] {
+                delete codec_impl;
+                {  // scope lock
+                  std::lock_guard<std::mutex> locker(lock);
+                  ++deleted_count;
+                }  // ~lock
+                condition_changed.notify_all();
+              });
+        });
+  }
+
+  {  // scope lock
+    std::unique_lock<std::mutex> locker(lock);
+    ASSERT_TRUE(condition_changed.wait_for(
+        locker, kStressTimeout,
+        [&done_count, &params] { return done_count == params.codec_count; }))
+        << "only " << done_count << " of " << params.codec_count
+        << " codecs finished";
+  }  // ~lock
+
+  std::chrono::duration<double> elapsed =
+      std::chrono::steady_clock::now() - start_time;
+
+  // Closing the channels makes each CodecImpl unbind and delete itself.
+  PostAndWait(client_loop.dispatcher(), [&clients] { clients.clear(); });
+
+  {  // scope lock
+    std::unique_lock<std::mutex> locker(lock);
+    ASSERT_TRUE(condition_changed.wait_for(
+        locker, kStressTimeout,
+        [&deleted_count, &params] {
+          return deleted_count == params.codec_count;
+        }))
+        << "only " << deleted_count << " of " << params.codec_count
+        << " codecs were deleted";
+  }  // ~lock
+
+  client_loop.Quit();
+  client_loop.JoinThreads();
+  client_loop.Shutdown();
+
+  // Shut down before ~admission_control, since the FIDL loop may still hold
+  // CodecAdmission instances posted by ~CodecImpl.
+  fidl_loop.Quit();
+  fidl_loop.JoinThreads();
+  fidl_loop.Shutdown();
+
+  if (packets_per_second) {
+    *packets_per_second = params.codec_count * params.stream_count *
+                          params.packets_per_stream / elapsed.count();
+  }
+}
+
+// Streams packets through one codec, then through several codecs sharing one
+// FIDL thread, checking output for ordering and content.
+TEST(CodecImplStressTest, Streams) {
+  for (uint32_t codec_count : {1u, 4u}) {
+    StressParams params;
+    params.codec_count = codec_count;
+    params.packets_per_stream = 1000;
+    RunStress(params, nullptr);
+  }
+}
+
+// Switches streams without flushing, and has the core codec demand output
+// buffer re-configs mid-stream, while the clients keep recycling output
+// packets, including packets from buffers that have just been de-configured.
+TEST(CodecImplStressTest, StreamSwitchesAndOutputReconfigRaceRecycle) {
+  StressParams params;
+  params.codec_count = 2;
+  params.stream_count = 20;
+  params.packets_per_stream = 200;
+  params.output_reconfig_interval = 37;
+  RunStress(params, nullptr);
+}
+
+// Measures packets per second through one codec and through several codecs
+// sharing one FIDL thread, with the per-packet paths contending with each
+// other but not with lock_.  The rates are recorded as test properties in the
+// --gtest_output report.
+TEST(CodecImplStressTest, PacketsPerSecond) {
+  for (uint32_t codec_count : {1u, 4u}) {
+    StressParams params;
+    params.codec_count = codec_count;
+    params.packets_per_stream = 10000;
+    double packets_per_second = 0.0;
+    RunStress(params, &packets_per_second);
+    EXPECT_GT(packets_per_second, 0.0);
+    ::testing::Test::RecordProperty(
+        "packets_per_second_" + std::to_string(codec_count) + "_codecs",
+        static_cast<int>(packets_per_second));
+  }
+}
+
+}  // namespace
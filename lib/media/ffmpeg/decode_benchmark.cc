@@ -0,0 +1,195 @@
+// Copyright 2018 The Fuchsia Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+// Reports how fast ffmpeg decodes the video stream of a file, for each thread
+// count and threading type the codec supports.
+//
+// Usage: ffmpeg_decode_benchmark <file>
+
+#include <inttypes.h>
+#include <stdio.h>
+#include <zircon/syscalls.h>
+
+extern "C" {
+#include "libavcodec/avcodec.h"
+#include "libavformat/avformat.h"
+}
+
+namespace {
+
+// The most threads the mediaplayer's video decoder uses.
+constexpr int kMaxThreadCount = 8;
+
+constexpr size_t kIoBufferSize = 64 * 1024;
+
+int ReadFile(void* opaque, uint8_t* buffer, int size) {
+  size_t bytes_read = fread(buffer, 1, size, reinterpret_cast<FILE*>(opaque));
+  return bytes_read == 0 ? AVERROR_EOF : static_cast<int>(bytes_read);
+}
+
+int64_t SeekFile(void* opaque, int64_t offset, int whence) {
+  FILE* file = reinterpret_cast<FILE*>(opaque);
+  if (whence == AVSEEK_SIZE) {
+    long position = ftell(file);
+    fseek(file, 0, SEEK_END);
+    long size = ftell(file);
+    fseek(file, position, SEEK_SET);
+    return size;
+  }
+
+  return fseek(file, offset, whence) == 0 ? ftell(file) : -1;
+}
+
+// Decodes every frame of the best video stream in |file| with |thread_count|
+// threads of type |thread_type| (0 when |thread_count| is 1).  Returns the
+// number of frames decoded, or -1 if the file couldn't be decoded.  If
+// |capabilities_out| is not null, it receives the codec's capabilities.
+// |*duration_out| is set to the time spent decoding.
+int64_t DecodeFile(FILE* file, int thread_count, int thread_type,
+                   int* capabilities_out, zx_duration_t* duration_out) {
+  rewind(file);
+
+  AVIOContext* io_context = avio_alloc_context(
+      reinterpret_cast<uint8_t*>(av_malloc(kIoBufferSize)), kIoBufferSize, 0,
+      file, ReadFile, nullptr, SeekFile);
+  AVFormatContext* format_context = avformat_alloc_context();
+  format_context->flags |= AVFMT_FLAG_CUSTOM_IO;
+  format_context->pb = io_context;
+
+  int64_t frame_count = -1;
+  AVCodec* codec = nullptr;
+  int stream_index = -1;
+
+  if (avformat_open_input(&format_context, nullptr, nullptr, nullptr) < 0) {
+    format_context = nullptr;
+  } else if (avformat_find_stream_info(format_context, nullptr) >= 0) {
+    stream_index = av_find_best_stream(format_context, AVMEDIA_TYPE_VIDEO, -1,
+                                       -1, &codec, 0);
+  }
+
+  if (stream_index >= 0) {
+    if (capabilities_out) {
+      *capabilities_out = codec->capabilities;
+    }
+
+    AVCodecContext* codec_context = avcodec_alloc_context3(codec);
+    avcodec_parameters_to_context(
+        codec_context, format_context->streams[stream_index]->codecpar);
+
+    // As in the mediaplayer, threading has to be configured before the codec
+    // is opened, which is when ffmpeg creates its threads.
+    codec_context->thread_count = thread_count;
+    codec_context->thread_type = thread_type;
+
+    if (avcodec_open2(codec_context, codec, nullptr) >= 0) {
+      AVPacket packet;
+      av_init_packet(&packet);
+      AVFrame* frame = av_frame_alloc();
+      frame_count = 0;
+
+      zx_time_t start_time = zx_clock_get(ZX_CLOCK_MONOTONIC);
+
+      bool draining = false;
+      while (true) {
+        if (!draining) {
+          if (av_read_frame(format_context, &packet) < 0) {
+            draining = true;
+            avcodec_send_packet(codec_context, nullptr);
+          } else {
+            if (packet.stream_index == stream_index) {
+              avcodec_send_packet(codec_context, &packet);
+            }
+
+            av_packet_unref(&packet);
+          }
+        }
+
+        int result;
+        while ((result = avcodec_receive_frame(codec_context, frame)) == 0) {
+          ++frame_count;
+          av_frame_unref(frame);
+        }
+
+        if (result == AVERROR_EOF || (draining && result != AVERROR(EAGAIN))) {
+          break;
+        }
+      }
+
+      *duration_out = zx_clock_get(ZX_CLOCK_MONOTONIC) - start_time;
+      av_frame_free(&frame);
+    }
+
+    avcodec_free_context(&codec_context);
+  }
+
+  avformat_close_input(&format_context);
+  av_freep(&io_context->buffer);
+  avio_context_free(&io_context);
+
+  return frame_count;
+}
+
+void Report(const char* setting, int64_t frame_count, zx_duration_t duration) {
+  printf("%-24s %8" PRId64 " frames %10.1f frames/s\n", setting, frame_count,
+         duration == 0 ? 0.0 : frame_count * 1e9 / duration);
+}
+
+}  // namespace
+
+int main(int argc, const char** argv) {
+  if (argc != 2) {
+    fprintf(stderr, "Usage: %s <file>\n", argv[0]);
+    return 1;
+  }
+
+  FILE* file = fopen(argv[1], "rb");
+  if (file == nullptr) {
+    fprintf(stderr, "%s: couldn't open\n", argv[1]);
+    return 1;
+  }
+
+  av_register_all();
+
+  // Decode single-threaded first, which also finds out what threading the
+  // codec supports.
+  int capabilities = 0;
+  zx_duration_t duration = 0;
+  int64_t frame_count = DecodeFile(file, 1, 0, &capabilities, &duration);
+  if (frame_count < 0) {
+    fprintf(stderr, "%s: couldn't decode\n", argv[1]);
+    fclose(file);
+    return 1;
+  }
+
+  uint32_t cpu_count = zx_system_get_num_cpus();
+  printf("%s, %u cpus\n", argv[1], cpu_count);
+  Report("1 thread", frame_count, duration);
+
+  for (int thread_type : {FF_THREAD_FRAME, FF_THREAD_SLICE}) {
+    int capability = (thread_type == FF_THREAD_FRAME)
+                         ? AV_CODEC_CAP_FRAME_THREADS
+                         : AV_CODEC_CAP_SLICE_THREADS;
+    if ((capabilities & capability) == 0) {
+      continue;
+    }
+
+    for (int thread_count = 2; thread_count <= kMaxThreadCount &&
+                               thread_count <= static_cast<int>(cpu_count);
+         thread_count *= 2) {
+      frame_count =
+          DecodeFile(file, thread_count, thread_type, nullptr, &duration);
+      if (frame_count < 0) {
+        continue;
+      }
+
+      char setting[32];
+      snprintf(setting, sizeof(setting), "%d threads (%s)", thread_count,
+               (thread_type == FF_THREAD_FRAME) ? "frame" : "slice");
+      Report(setting, frame_count, duration);
+    }
+  }
+
+  fclose(file);
+  return 0;
+}
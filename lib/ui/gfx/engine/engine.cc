@@ -22,6 +22,7 @@
 #include "garnet/lib/ui/gfx/resources/nodes/traversal.h"
 #include "garnet/lib/ui/gfx/swapchain/display_swapchain.h"
 #include "garnet/lib/ui/gfx/swapchain/vulkan_display_swapchain.h"
+#include "garnet/lib/ui/gfx/util/time.h"
 #include "garnet/lib/ui/scenic/session.h"
 #include "lib/escher/impl/vulkan_utils.h"
 #include "lib/escher/renderer/batch_gpu_uploader.h"
@@ -109,6 +110,7 @@ void Engine::InitializeFrameScheduler() {
     frame_scheduler_ =
         std::make_unique<FrameScheduler>(display_manager_->default_display());
     frame_scheduler_->set_delegate(this);
+    frame_scheduler_->SetPredictiveScheduling(SCENIC_PREDICTIVE_SCHEDULING);
   }
 }
 
@@ -163,6 +165,10 @@ bool Engine::RenderFrame(const FrameTimingsPtr& timings,
     command_context_.Invalidate();
   }
 
+  if (timings) {
+    timings->OnUpdatesApplied(dispatcher_clock_now());
+  }
+
   if (!has_updates && !force_render) {
     return false;
   }
@@ -223,15 +229,11 @@ void Engine::UpdateAndDeliverMetrics(uint64_t presentation_time) {
   if (scenes.empty())
     return;
 
-  // TODO(MZ-216): Traversing the whole graph just to compute this is pretty
-  // inefficient.  We should optimize this.
-  ::fuchsia::ui::gfx::Metrics metrics;
-  metrics.scale_x = 1.f;
-  metrics.scale_y = 1.f;
-  metrics.scale_z = 1.f;
+  // Only the subtrees which changed since the previous frame are visited; see
+  // Node::UpdateMetrics().
   std::vector<Node*> updated_nodes;
   for (auto scene : scenes) {
-    UpdateMetrics(scene, metrics, &updated_nodes);
+    scene->UpdateMetrics(&updated_nodes);
   }
 
   // TODO(MZ-216): Deliver events to sessions in batches.
@@ -249,33 +251,6 @@ void Engine::UpdateAndDeliverMetrics(uint64_t presentation_time) {
   }
 }
 
-// TODO(mikejurka): move this to appropriate util file
-bool MetricsEquals(const ::fuchsia::ui::gfx::Metrics& a,
-                   const ::fuchsia::ui::gfx::Metrics& b) {
-  return a.scale_x == b.scale_x && a.scale_y == b.scale_y &&
-         a.scale_z == b.scale_z;
-}
-
-void Engine::UpdateMetrics(Node* node,
-                           const ::fuchsia::ui::gfx::Metrics& parent_metrics,
-                           std::vector<Node*>* updated_nodes) {
-  ::fuchsia::ui::gfx::Metrics local_metrics;
-  local_metrics.scale_x = parent_metrics.scale_x * node->scale().x;
-  local_metrics.scale_y = parent_metrics.scale_y * node->scale().y;
-  local_metrics.scale_z = parent_metrics.scale_z * node->scale().z;
-
-  if ((node->event_mask() & ::fuchsia::ui::gfx::kMetricsEventMask) &&
-      !MetricsEquals(node->reported_metrics(), local_metrics)) {
-    node->set_reported_metrics(local_metrics);
-    updated_nodes->push_back(node);
-  }
-
-  ForEachDirectDescendantFrontToBack(
-      *node, [this, &local_metrics, updated_nodes](Node* node) {
-        UpdateMetrics(node, local_metrics, updated_nodes);
-      });
-}
-
 void Engine::CleanupEscher() {
   // Either there is already a cleanup scheduled (meaning that this was already
   // called recently), or there is no Escher because we're running tests.
@@ -171,12 +171,6 @@ class Engine : public UpdateScheduler, private FrameSchedulerDelegate {
   // Update and deliver metrics for all nodes which subscribe to metrics events.
   void UpdateAndDeliverMetrics(uint64_t presentation_time);
 
-  // Update reported metrics for nodes which subscribe to metrics events.
-  // If anything changed, append the node to |updated_nodes|.
-  void UpdateMetrics(Node* node,
-                     const ::fuchsia::ui::gfx::Metrics& parent_metrics,
-                     std::vector<Node*>* updated_nodes);
-
   DisplayManager* const display_manager_;
   const escher::EscherWeakPtr escher_;
   escher::PaperRendererPtr paper_renderer_;
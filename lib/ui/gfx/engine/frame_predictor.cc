@@ -0,0 +1,52 @@
+// Copyright 2018 The Fuchsia Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "garnet/lib/ui/gfx/engine/frame_predictor.h"
+
+#include <algorithm>
+
+#include "lib/fxl/logging.h"
+
+namespace scenic_impl {
+namespace gfx {
+
+constexpr size_t FramePredictor::kWindowSize;
+constexpr size_t FramePredictor::kPercentile;
+constexpr zx_duration_t FramePredictor::kMargin;
+constexpr zx_duration_t FramePredictor::kMinPrediction;
+constexpr zx_duration_t FramePredictor::kMaxPrediction;
+
+FramePredictor::FramePredictor(zx_duration_t initial_prediction)
+    : prediction_(initial_prediction) {
+  recent_durations_.reserve(kWindowSize);
+  sorted_durations_.reserve(kWindowSize);
+}
+
+void FramePredictor::ReportFrameDurations(const FrameDurations& durations) {
+  FXL_DCHECK(durations.update >= 0);
+  FXL_DCHECK(durations.render >= 0);
+  const zx_duration_t duration = durations.update + durations.render;
+  if (recent_durations_.size() < kWindowSize) {
+    recent_durations_.push_back(duration);
+  } else {
+    recent_durations_[next_index_] = duration;
+  }
+  next_index_ = (next_index_ + 1) % kWindowSize;
+  ++frame_count_;
+
+  // The smallest duration which at least kPercentile percent of the recent
+  // frames didn't exceed.
+  sorted_durations_.assign(recent_durations_.begin(), recent_durations_.end());
+  const size_t count = sorted_durations_.size();
+  const size_t index = (count * kPercentile + 99) / 100 - 1;
+  std::nth_element(sorted_durations_.begin(),
+                   sorted_durations_.begin() + index, sorted_durations_.end());
+
+  prediction_ = std::min(
+      kMaxPrediction,
+      std::max(kMinPrediction, sorted_durations_[index] + kMargin));
+}
+
+}  // namespace gfx
+}  // namespace scenic_impl
@@ -0,0 +1,76 @@
+// Copyright 2018 The Fuchsia Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef GARNET_LIB_UI_GFX_ENGINE_FRAME_PREDICTOR_H_
+#define GARNET_LIB_UI_GFX_ENGINE_FRAME_PREDICTOR_H_
+
+#include <zircon/types.h>
+#include <vector>
+
+#include "lib/fxl/macros.h"
+
+namespace scenic_impl {
+namespace gfx {
+
+// How long each stage of a frame took.
+struct FrameDurations {
+  // From waking up to render the frame until all session updates were applied.
+  zx_duration_t update = 0;
+  // From the session updates being applied until the GPU finished rendering.
+  zx_duration_t render = 0;
+  // From the GPU finishing rendering until the frame was presented.  This is
+  // mostly spent waiting for vsync, so it doesn't contribute to the prediction.
+  zx_duration_t present = 0;
+};
+
+// Predicts how long the next frame will take to update and render, from the
+// durations of recent frames.  The prediction is a high percentile of the
+// recent update + render durations, plus a margin, so that an occasional slow
+// frame doesn't cause every following frame to wake up earlier than needed,
+// but a frame that is consistently slower does.
+class FramePredictor {
+ public:
+  // Number of recent frames that the prediction is based on.
+  static constexpr size_t kWindowSize = 60;
+  // The percentile of recent frames that the prediction must cover.
+  static constexpr size_t kPercentile = 90;
+  // Added to the prediction, to absorb wakeup latency and small variations.
+  static constexpr zx_duration_t kMargin = 1'000'000;  // 1ms
+  // Bounds for the prediction, so that a few very fast or very slow frames
+  // cannot make the scheduler wake up absurdly late or early.
+  static constexpr zx_duration_t kMinPrediction = 2'000'000;   // 2ms
+  static constexpr zx_duration_t kMaxPrediction = 50'000'000;  // 50ms
+
+  // |initial_prediction| is returned until the first frame is reported.
+  explicit FramePredictor(zx_duration_t initial_prediction);
+
+  // Records the durations of a frame that was presented.
+  void ReportFrameDurations(const FrameDurations& durations);
+
+  // Returns the time required to update and render the next frame.  This is
+  // only recomputed when a frame is reported, so it is cheap to call.
+  zx_duration_t PredictRequiredFrameRenderTime() const { return prediction_; }
+
+  // Number of frames that have been reported, including those that have
+  // since fallen out of the window.
+  size_t frame_count() const { return frame_count_; }
+
+ private:
+  // Ring buffer of the update + render durations of the last kWindowSize
+  // frames; |next_index_| is where the next frame's duration will be written.
+  std::vector<zx_duration_t> recent_durations_;
+  size_t next_index_ = 0;
+  size_t frame_count_ = 0;
+  zx_duration_t prediction_;
+
+  // Scratch space for computing the percentile, to avoid allocating per frame.
+  std::vector<zx_duration_t> sorted_durations_;
+
+  FXL_DISALLOW_COPY_AND_ASSIGN(FramePredictor);
+};
+
+}  // namespace gfx
+}  // namespace scenic_impl
+
+#endif  // GARNET_LIB_UI_GFX_ENGINE_FRAME_PREDICTOR_H_
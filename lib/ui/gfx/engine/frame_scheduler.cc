@@ -17,9 +17,12 @@
 namespace scenic_impl {
 namespace gfx {
 
+constexpr zx_duration_t FrameScheduler::kDefaultFrameRenderTime;
+
 FrameScheduler::FrameScheduler(Display* display)
     : dispatcher_(async_get_default_dispatcher()),
       display_(display),
+      frame_predictor_(kDefaultFrameRenderTime),
       weak_factory_(this) {
   outstanding_frames_.reserve(kMaxOutstandingFrames);
 }
@@ -43,12 +46,17 @@ void FrameScheduler::SetRenderContinuously(bool render_continuously) {
   }
 }
 
+void FrameScheduler::SetPredictiveScheduling(bool predictive_scheduling) {
+  predictive_scheduling_ = predictive_scheduling;
+}
+
 zx_time_t FrameScheduler::PredictRequiredFrameRenderTime() const {
-  // TODO(MZ-400): more sophisticated prediction.  This might require more info,
-  // e.g. about how many compositors will be rendering scenes, at what
-  // resolutions, etc.
-  constexpr zx_time_t kHardcodedPrediction = 8'000'000;  // 8ms
-  return kHardcodedPrediction;
+  // TODO(MZ-400): the prediction could take more into account, e.g. how many
+  // compositors will be rendering scenes, at what resolutions, etc.
+  if (predictive_scheduling_) {
+    return frame_predictor_.PredictRequiredFrameRenderTime();
+  }
+  return kDefaultFrameRenderTime;
 }
 
 std::pair<zx_time_t, zx_time_t>
@@ -61,11 +69,21 @@ FrameScheduler::ComputeNextPresentationAndWakeupTimes() const {
 std::pair<zx_time_t, zx_time_t>
 FrameScheduler::ComputeTargetPresentationAndWakeupTimes(
     const zx_time_t requested_presentation_time) const {
-  const zx_time_t last_vsync_time = display_->GetLastVsyncTime();
-  const zx_time_t vsync_interval = display_->GetVsyncInterval();
   const zx_time_t now = async_now(dispatcher_);
-  const zx_time_t required_render_time = PredictRequiredFrameRenderTime();
+#if SCENIC_IGNORE_VSYNC
+  return std::make_pair(now, now);
+#else
+  return ComputeTargetPresentationAndWakeupTimes(
+      requested_presentation_time, display_->GetLastVsyncTime(),
+      display_->GetVsyncInterval(), now, PredictRequiredFrameRenderTime());
+#endif
+}
 
+std::pair<zx_time_t, zx_time_t>
+FrameScheduler::ComputeTargetPresentationAndWakeupTimes(
+    const zx_time_t requested_presentation_time,
+    const zx_time_t last_vsync_time, const zx_duration_t vsync_interval,
+    const zx_time_t now, const zx_duration_t required_render_time) {
   // Compute the number of full vsync intervals between the last vsync and the
   // requested presentation time.  Notes:
   //   - The requested time might be earlier than the last vsync time,
@@ -133,11 +151,7 @@ FrameScheduler::ComputeTargetPresentationAndWakeupTimes(
     wakeup_time += vsync_interval;
   }
 
-#if SCENIC_IGNORE_VSYNC
-  return std::make_pair(now, now);
-#else
   return std::make_pair(target_presentation_time, wakeup_time);
-#endif
 }
 
 void FrameScheduler::ScheduleFrame() {
@@ -197,7 +211,7 @@ void FrameScheduler::MaybeRenderFrame(zx_time_t presentation_time,
   if (delegate_) {
     FXL_DCHECK(outstanding_frames_.size() < kMaxOutstandingFrames);
     auto frame_timings = fxl::MakeRefCounted<FrameTimings>(
-        this, ++frame_number_, presentation_time);
+        this, ++frame_number_, presentation_time, async_now(dispatcher_));
     if (delegate_->RenderFrame(frame_timings, presentation_time,
                                display_->GetVsyncInterval(),
                                render_continuously_)) {
@@ -225,6 +239,22 @@ void FrameScheduler::OnFramePresented(FrameTimings* timings) {
     // TODO(MZ-400): This needs to be generalized for multi-display support.
     display_->set_last_vsync_time(timings->actual_presentation_time());
 
+    // Frames whose updates weren't timed (e.g. rendered without a delegate
+    // that reports them) would skew the prediction, so they are ignored.
+    if (timings->updates_applied_time() > 0) {
+      const zx_time_t rendered_time = timings->rendering_finished_time();
+      FrameDurations durations;
+      durations.update =
+          timings->updates_applied_time() - timings->rendering_started_time();
+      durations.render = rendered_time - timings->updates_applied_time();
+      durations.present = timings->actual_presentation_time() - rendered_time;
+      frame_predictor_.ReportFrameDurations(durations);
+      TRACE_COUNTER("gfx", "FramePrediction", 0, "update (usecs)",
+                    durations.update / 1000, "render (usecs)",
+                    durations.render / 1000, "predicted (usecs)",
+                    frame_predictor_.PredictRequiredFrameRenderTime() / 1000);
+    }
+
     // Log trace data.
     // TODO(MZ-400): just pass the whole Frame to a listener.
     int64_t target_vs_actual_usecs =
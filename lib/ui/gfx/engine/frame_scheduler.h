@@ -10,6 +10,7 @@
 #include <lib/async/dispatcher.h>
 #include <lib/zx/time.h>
 
+#include "garnet/lib/ui/gfx/engine/frame_predictor.h"
 #include "lib/fxl/macros.h"
 #include "lib/fxl/memory/ref_ptr.h"
 #include "lib/fxl/memory/weak_ptr.h"
@@ -67,12 +68,34 @@ class FrameScheduler {
   // they're requested using RequestFrame().
   void SetRenderContinuously(bool render_continuously);
 
+  // If |predictive_scheduling|, the time required to render a frame is
+  // predicted from the timings of recently presented frames, instead of
+  // assuming a fixed duration.  This lets cheap frames wake up later, reducing
+  // latency, and expensive frames wake up earlier, instead of missing vsync.
+  void SetPredictiveScheduling(bool predictive_scheduling);
+
   // Helper method for ScheduleFrame().  Returns the target presentation time
   // for the requested presentation time, and a wake-up time that is early
   // enough to start rendering in order to hit the target presentation time.
   std::pair<zx_time_t, zx_time_t> ComputeTargetPresentationAndWakeupTimes(
       zx_time_t requested_presentation_time) const;
 
+  // The computation behind the method above, with all of its inputs explicit
+  // so that it can be used to simulate scheduling.  The target is the first
+  // vsync after |requested_presentation_time| that can still be reached by
+  // waking up at |now| or later, and the wake-up time is the latest one that
+  // leaves |required_render_time| before the target.
+  static std::pair<zx_time_t, zx_time_t>
+  ComputeTargetPresentationAndWakeupTimes(zx_time_t requested_presentation_time,
+                                          zx_time_t last_vsync_time,
+                                          zx_duration_t vsync_interval,
+                                          zx_time_t now,
+                                          zx_duration_t required_render_time);
+
+  // Used when predictive scheduling is disabled, and as the prediction until
+  // the first frame is presented.
+  static constexpr zx_duration_t kDefaultFrameRenderTime = 8'000'000;  // 8ms
+
  private:
   // Update the global scene and then draw it... maybe.  There are multiple
   // reasons why this might not happen.  For example, the swapchain might apply
@@ -118,6 +141,11 @@ class FrameScheduler {
   bool back_pressure_applied_ = false;
   bool render_continuously_ = false;
 
+  // Always fed with the timings of presented frames, so that its prediction is
+  // up to date if predictive scheduling is enabled later.
+  FramePredictor frame_predictor_;
+  bool predictive_scheduling_ = false;
+
   fxl::WeakPtrFactory<FrameScheduler> weak_factory_;  // must be last
 
   FXL_DISALLOW_COPY_AND_ASSIGN(FrameScheduler);
@@ -4,6 +4,8 @@
 
 #include "garnet/lib/ui/gfx/engine/frame_timings.h"
 
+#include <algorithm>
+
 #include "garnet/lib/ui/gfx/engine/frame_scheduler.h"
 
 namespace scenic_impl {
@@ -13,10 +15,12 @@ FrameTimings::FrameTimings() : FrameTimings(nullptr, 0, 0) {}
 
 FrameTimings::FrameTimings(FrameScheduler* frame_scheduler,
                            uint64_t frame_number,
-                           zx_time_t target_presentation_time)
+                           zx_time_t target_presentation_time,
+                           zx_time_t rendering_started_time)
     : frame_scheduler_(frame_scheduler),
       frame_number_(frame_number),
-      target_presentation_time_(target_presentation_time) {}
+      target_presentation_time_(target_presentation_time),
+      rendering_started_time_(rendering_started_time) {}
 
 size_t FrameTimings::AddSwapchain(Swapchain* swapchain) {
   // All swapchains that we are timing must be added before any of them finish.
@@ -28,6 +32,13 @@ size_t FrameTimings::AddSwapchain(Swapchain* swapchain) {
   return swapchain_records_.size() - 1;
 }
 
+void FrameTimings::OnUpdatesApplied(zx_time_t time) {
+  FXL_DCHECK(updates_applied_time_ == 0);
+  FXL_DCHECK(frame_rendered_count_ == 0);
+  FXL_DCHECK(time >= rendering_started_time_);
+  updates_applied_time_ = time;
+}
+
 void FrameTimings::OnFrameRendered(size_t swapchain_index, zx_time_t time) {
   FXL_DCHECK(swapchain_index < swapchain_records_.size());
   FXL_DCHECK(frame_rendered_count_ < swapchain_records_.size());
@@ -93,6 +104,15 @@ void FrameTimings::OnFrameDropped(size_t swapchain_index) {
   Finalize();
 }
 
+zx_time_t FrameTimings::rendering_finished_time() const {
+  FXL_DCHECK(!frame_was_dropped());
+  zx_time_t time = 0;
+  for (auto& record : swapchain_records_) {
+    time = std::max(time, record.frame_rendered_time);
+  }
+  return time;
+}
+
 void FrameTimings::Finalize() {
   FXL_DCHECK(!finalized());
   finalized_ = true;
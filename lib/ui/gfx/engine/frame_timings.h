@@ -26,13 +26,18 @@ class FrameTimings : public escher::Reffable {
  public:
   FrameTimings();
   FrameTimings(FrameScheduler* frame_scheduler, uint64_t frame_number,
-               zx_time_t target_presentation_time);
+               zx_time_t target_presentation_time,
+               zx_time_t rendering_started_time = 0);
 
   // Add a swapchain that is used as a render target this frame.  Return an
   // index that can be used to indicate when rendering for that swapchain is
   // finished, and when the frame is actually presented on that swapchain.
   size_t AddSwapchain(Swapchain* swapchain);
 
+  // Called once all session updates for the frame have been applied, before
+  // any swapchain starts rendering.
+  void OnUpdatesApplied(zx_time_t time);
+
   void OnFrameRendered(size_t swapchain_index, zx_time_t time);
   void OnFramePresented(size_t swapchain_index, zx_time_t time);
   void OnFrameDropped(size_t swapchain_index);
@@ -51,6 +56,15 @@ class FrameTimings : public escher::Reffable {
     return target_presentation_time_;
   }
 
+  // Time at which the FrameScheduler started the frame, i.e. before session
+  // updates were applied.
+  zx_time_t rendering_started_time() const { return rendering_started_time_; }
+  // Zero if OnUpdatesApplied() was never called.
+  zx_time_t updates_applied_time() const { return updates_applied_time_; }
+  // The latest time at which a swapchain finished rendering.  Should only be
+  // called if frame_was_dropped returns false.
+  zx_time_t rendering_finished_time() const;
+
   bool frame_was_dropped() const {
     return actual_presentation_time_ == ZX_TIME_INFINITE;
   }
@@ -79,6 +93,8 @@ class FrameTimings : public escher::Reffable {
   FrameScheduler* const frame_scheduler_;
   const uint64_t frame_number_;
   const zx_time_t target_presentation_time_;
+  const zx_time_t rendering_started_time_;
+  zx_time_t updates_applied_time_ = 0;
   zx_time_t actual_presentation_time_ = 0;
   size_t frame_rendered_count_ = 0;
   size_t frame_presented_count_ = 0;
@@ -4,9 +4,12 @@
 
 #include "garnet/lib/ui/gfx/engine/hit_tester.h"
 
+#include <float.h>
+
 #include "garnet/lib/ui/gfx/engine/session.h"
 #include "garnet/lib/ui/gfx/resources/nodes/traversal.h"
 #include "garnet/lib/ui/gfx/resources/view.h"
+#include "lib/escher/geometry/intersection.h"
 #include "lib/escher/geometry/types.h"
 #include "lib/fxl/logging.h"
 
@@ -68,6 +71,10 @@ void HitTester::AccumulateHitsLocal(Node* node) {
       ::fuchsia::ui::gfx::HitTestBehavior::kSuppress)
     return;
 
+  // Bail if the ray misses everything in the subtree.
+  if (!IsRayWithinBoundsInner(node, ray_info_->ray))
+    return;
+
   // Session-based hit testing may encounter nodes that don't participate.
   if (!should_participate(node)) {
     AccumulateHitsInner(node);
@@ -104,6 +111,24 @@ void HitTester::AccumulateHitsInner(Node* node) {
       *node, [this](Node* node) { AccumulateHitsOuter(node); });
 }
 
+bool HitTester::IsRayWithinBoundsInner(Node* node, const escher::ray4& ray) {
+  // The bounds can only be tested against finite rays whose origin is a
+  // point; anything else is conservatively treated as a potential hit.
+  if (ray.origin.w != 1.f ||
+      !glm::all(glm::lessThan(glm::abs(ray.origin), escher::vec4(FLT_MAX))) ||
+      !glm::all(glm::lessThan(glm::abs(ray.direction), escher::vec4(FLT_MAX))))
+    return true;
+
+  escher::BoundingBox bounds;
+  if (!node->GetHitTestBounds(&bounds))
+    return true;
+  if (bounds.is_empty())
+    return false;
+
+  float distance;
+  return escher::IntersectRayBox(ray, bounds, &distance);
+}
+
 bool HitTester::IsRayWithinPartsInner(Node* node, const escher::ray4& ray) {
   return ForEachPartFrontToBackUntilTrue(*node, [&ray](Node* node) {
     return IsRayWithinClippedContentOuter(node, ray);
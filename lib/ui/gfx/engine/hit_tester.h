@@ -74,6 +74,11 @@ class HitTester {
   // |ray_info_| must be in the node's local coordinate system.
   void AccumulateHitsInner(Node* node);
 
+  // Returns false if the ray cannot intersect the node or its descendants,
+  // according to Node::GetHitTestBounds().
+  // |ray| must be in the node's local coordinate system.
+  static bool IsRayWithinBoundsInner(Node* node, const escher::ray4& ray);
+
   // Returns true if the ray passes through the node's parts.
   // |ray| must be in the node's local coordinate system.
   static bool IsRayWithinPartsInner(Node* node, const escher::ray4& ray);
@@ -4,39 +4,128 @@
 
 #include "garnet/lib/ui/gfx/engine/resource_map.h"
 
+#include <algorithm>
+
 namespace scenic_impl {
 namespace gfx {
 
+namespace {
+
+constexpr size_t kInitialSlotCount = 16;
+
+}  // anonymous namespace
+
 ResourceMap::ResourceMap(ErrorReporter* error_reporter)
     : error_reporter_(error_reporter) {}
 
 ResourceMap::~ResourceMap() {}
 
-void ResourceMap::Clear() { resources_.clear(); }
+void ResourceMap::Clear() {
+  // Destroying a resource may cause others to be destroyed, so the map must
+  // be in a consistent state before any of them are released.
+  std::vector<Slot> slots;
+  slots.swap(slots_);
+  size_ = 0;
+  hash_shift_ = 32;
+  cached_index_ = 0;
+}
 
 bool ResourceMap::AddResource(ResourceId id, ResourcePtr resource) {
   FXL_DCHECK(resource);
 
-  auto result = resources_.insert(std::make_pair(id, std::move(resource)));
-  if (!result.second) {
+  if (4 * (size_ + 1) > 3 * slots_.size()) {
+    Grow();
+  }
+
+  size_t index = Probe(id);
+  if (slots_[index].resource) {
     error_reporter_->ERROR()
         << "scenic::gfx::ResourceMap::AddResource(): resource with ID " << id
         << " already exists.";
     return false;
   }
+  slots_[index].id = id;
+  slots_[index].resource = std::move(resource);
+  cached_index_ = index;
+  ++size_;
   return true;
 }
 
 bool ResourceMap::RemoveResource(ResourceId id) {
-  size_t erased_count = resources_.erase(id);
-  if (erased_count == 0) {
+  size_t index = slots_.empty() ? 0 : Probe(id);
+  if (slots_.empty() || !slots_[index].resource) {
     error_reporter_->ERROR()
         << "scenic::gfx::ResourceMap::RemoveResource(): no resource with ID "
         << id;
     return false;
   }
+
+  // Released at the end, once the map is consistent; see Clear().
+  ResourcePtr removed = std::move(slots_[index].resource);
+  --size_;
+
+  // Fill the hole by shifting back any later entries in the same cluster whose
+  // probe sequences pass through it, so that lookups never need to skip over
+  // deleted entries.
+  const size_t mask = slots_.size() - 1;
+  size_t hole = index;
+  for (size_t i = (hole + 1) & mask; slots_[i].resource; i = (i + 1) & mask) {
+    // The entry must stay put if its home lies cyclically within (hole, i].
+    size_t home = HomeIndex(slots_[i].id);
+    if (((i - home) & mask) < ((i - hole) & mask)) {
+      continue;
+    }
+    slots_[hole] = std::move(slots_[i]);
+    hole = i;
+  }
   return true;
 }
 
+Resource* ResourceMap::FindUncached(ResourceId id) {
+  if (slots_.empty()) {
+    return nullptr;
+  }
+  size_t index = Probe(id);
+  if (!slots_[index].resource) {
+    return nullptr;
+  }
+  cached_index_ = index;
+  return slots_[index].resource.get();
+}
+
+size_t ResourceMap::Probe(ResourceId id) const {
+  FXL_DCHECK(!slots_.empty());
+  const size_t mask = slots_.size() - 1;
+  size_t index = HomeIndex(id);
+  while (slots_[index].resource && slots_[index].id != id) {
+    index = (index + 1) & mask;
+  }
+  return index;
+}
+
+size_t ResourceMap::HomeIndex(ResourceId id) const {
+  // Fibonacci hashing: take the high bits of the product, which depend on all
+  // bits of the ID.  Sequential IDs, as most clients allocate, are spread
+  // evenly across the table.
+  return (static_cast<uint32_t>(id) * 2654435769u) >> hash_shift_;
+}
+
+void ResourceMap::Grow() {
+  std::vector<Slot> old_slots(
+      std::max(kInitialSlotCount, 2 * slots_.size()));
+  old_slots.swap(slots_);
+  hash_shift_ = 32;
+  for (size_t count = slots_.size(); count > 1; count >>= 1) {
+    --hash_shift_;
+  }
+  for (auto& slot : old_slots) {
+    if (slot.resource) {
+      size_t index = Probe(slot.id);
+      slots_[index] = std::move(slot);
+    }
+  }
+  cached_index_ = 0;
+}
+
 }  // namespace gfx
 }  // namespace scenic_impl
@@ -9,11 +9,18 @@
 #include "garnet/lib/ui/gfx/resources/variable.h"
 #include "garnet/lib/ui/scenic/util/error_reporter.h"
 
-#include <unordered_map>
+#include <vector>
 
 namespace scenic_impl {
 namespace gfx {
 
+// Maps the ResourceIds chosen by a client to the corresponding resources.
+//
+// Every command that a session applies looks up at least one resource, so the
+// map is a flat open-addressing hash table rather than a node-based one: a
+// lookup usually touches a single cache line.  In addition, the most recently
+// found entry is remembered, since consecutive commands frequently refer to
+// the same resource (e.g. when creating and then configuring it).
 class ResourceMap {
  public:
   explicit ResourceMap(
@@ -30,7 +37,7 @@ class ResourceMap {
   // false if the ID was not present in the map.
   bool RemoveResource(ResourceId id);
 
-  size_t size() const { return resources_.size(); }
+  size_t size() const { return size_; }
 
   enum class ErrorBehavior { kDontReportErrors, kReportErrors };
 
@@ -44,21 +51,21 @@ class ResourceMap {
   fxl::RefPtr<ResourceT> FindResource(
       ResourceId id,
       ErrorBehavior report_errors = ErrorBehavior::kReportErrors) {
-    auto it = resources_.find(id);
+    Resource* resource = Find(id);
 
-    if (it == resources_.end()) {
+    if (resource == nullptr) {
       if (report_errors == ErrorBehavior::kReportErrors) {
         error_reporter_->ERROR() << "No resource exists with ID " << id;
       }
       return fxl::RefPtr<ResourceT>();
     };
 
-    auto resource_ptr = it->second->GetDelegate(ResourceT::kTypeInfo);
+    auto resource_ptr = resource->GetDelegate(ResourceT::kTypeInfo);
     if (resource_ptr == nullptr) {
       if (report_errors == ErrorBehavior::kReportErrors) {
         error_reporter_->ERROR()
             << "Type mismatch for resource ID " << id << ": actual type is "
-            << it->second->type_info().name << ", expected a sub-type of "
+            << resource->type_info().name << ", expected a sub-type of "
             << ResourceT::kTypeInfo.name;
       }
       return fxl::RefPtr<ResourceT>();
@@ -69,19 +76,19 @@ class ResourceMap {
 
   template <class ResourceT>
   fxl::RefPtr<ResourceT> FindVariableResource(ResourceId id) {
-    auto it = resources_.find(id);
+    Resource* resource = Find(id);
 
-    if (it == resources_.end()) {
+    if (resource == nullptr) {
       error_reporter_->ERROR() << "No resource exists with ID " << id;
       return fxl::RefPtr<ResourceT>();
     };
 
-    auto resource_ptr = it->second->GetDelegate(Variable::kTypeInfo);
+    auto resource_ptr = resource->GetDelegate(Variable::kTypeInfo);
 
     if (resource_ptr == nullptr) {
       error_reporter_->ERROR()
           << "Type mismatch for resource ID " << id << ": actual type is "
-          << it->second->type_info().name << ", expected a sub-type of "
+          << resource->type_info().name << ", expected a sub-type of "
           << Variable::kTypeInfo.name;
       return fxl::RefPtr<ResourceT>();
     }
@@ -99,7 +106,39 @@ class ResourceMap {
   }
 
  private:
-  std::unordered_map<ResourceId, ResourcePtr> resources_;
+  // An empty slot has a null |resource|.
+  struct Slot {
+    ResourceId id = 0;
+    ResourcePtr resource;
+  };
+
+  // Return the resource with the specified ID, or nullptr if there is none.
+  Resource* Find(ResourceId id) {
+    if (cached_index_ < slots_.size() && slots_[cached_index_].id == id &&
+        slots_[cached_index_].resource) {
+      return slots_[cached_index_].resource.get();
+    }
+    return FindUncached(id);
+  }
+  Resource* FindUncached(ResourceId id);
+
+  // Return the index of the slot containing |id|, or of the empty slot where
+  // it would be inserted.  |slots_| must not be empty.
+  size_t Probe(ResourceId id) const;
+
+  // Return the index of the slot at which probing for |id| begins.
+  size_t HomeIndex(ResourceId id) const;
+
+  // Double the number of slots, and reinsert all resources.
+  void Grow();
+
+  // The number of slots is zero or a power of two, and at most 3/4 of them
+  // are occupied, so that probe sequences stay short.
+  std::vector<Slot> slots_;
+  size_t size_ = 0;
+  // 32 - log2(slots_.size()); see HomeIndex().
+  uint32_t hash_shift_ = 32;
+  size_t cached_index_ = 0;
   ErrorReporter* const error_reporter_;
 };
 
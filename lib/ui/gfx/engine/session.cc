@@ -1549,7 +1549,8 @@ bool Session::ApplyScheduledUpdates(uint64_t presentation_time,
                     scheduled_updates_.front().presentation_time / 1000);
       break;
     }
-    if (ApplyUpdate(std::move(scheduled_updates_.front().commands))) {
+    if (ApplyUpdate(&scheduled_updates_.front().commands)) {
+      RecycleCommandBuffer(std::move(scheduled_updates_.front().commands));
       needs_render = true;
       auto info = fuchsia::images::PresentationInfo();
       info.presentation_time = presentation_time;
@@ -1616,16 +1617,26 @@ void Session::EnqueueEvent(::fuchsia::ui::input::InputEvent event) {
   event_reporter_->EnqueueEvent(std::move(event));
 }
 
-bool Session::ApplyUpdate(std::vector<::fuchsia::ui::gfx::Command> commands) {
-  TRACE_DURATION("gfx", "Session::ApplyUpdate");
+bool Session::ApplyUpdate(std::vector<::fuchsia::ui::gfx::Command>* commands) {
+  TRACE_DURATION("gfx", "Session::ApplyUpdate", "count", commands->size());
   if (is_valid()) {
-    for (auto& command : commands) {
-      if (!ApplyCommand(std::move(command))) {
+    ::fuchsia::ui::gfx::Command* const commands_end =
+        commands->data() + commands->size();
+    ::fuchsia::ui::gfx::Command* run_begin = commands->data();
+    while (run_begin != commands_end) {
+      ::fuchsia::ui::gfx::Command* run_end = run_begin + 1;
+      while (run_end != commands_end &&
+             run_end->Which() == run_begin->Which()) {
+        ++run_end;
+      }
+      ::fuchsia::ui::gfx::Command* failed = nullptr;
+      if (!ApplyCommandRun(run_begin, run_end, &failed)) {
         error_reporter_->ERROR() << "scenic_impl::gfx::Session::ApplyCommand() "
                                     "failed to apply Command: "
-                                 << command;
+                                 << *failed;
         return false;
       }
+      run_begin = run_end;
     }
   }
   return true;
@@ -1633,6 +1644,79 @@ bool Session::ApplyUpdate(std::vector<::fuchsia::ui::gfx::Command> commands) {
   // consumed by the FrameScheduler.
 }
 
+bool Session::ApplyCommandRun(::fuchsia::ui::gfx::Command* begin,
+                              ::fuchsia::ui::gfx::Command* end,
+                              ::fuchsia::ui::gfx::Command** failed_out) {
+  // Applies |apply| to each command in the run, without the per-command
+  // dispatch and tracing of ApplyCommand().
+  auto apply_each = [begin, end, failed_out](auto apply) {
+    for (auto it = begin; it != end; ++it) {
+      if (!apply(it)) {
+        *failed_out = it;
+        return false;
+      }
+    }
+    return true;
+  };
+
+  // Clients that animate many nodes typically send long runs of these.
+  const size_t count = end - begin;
+  switch (begin->Which()) {
+    case ::fuchsia::ui::gfx::Command::Tag::kSetTranslation: {
+      TRACE_DURATION("gfx", "Session::ApplySetTranslationCmds", "count", count);
+      return apply_each([this](::fuchsia::ui::gfx::Command* command) {
+        return ApplySetTranslationCmd(std::move(command->set_translation()));
+      });
+    }
+    case ::fuchsia::ui::gfx::Command::Tag::kSetScale: {
+      TRACE_DURATION("gfx", "Session::ApplySetScaleCmds", "count", count);
+      return apply_each([this](::fuchsia::ui::gfx::Command* command) {
+        return ApplySetScaleCmd(std::move(command->set_scale()));
+      });
+    }
+    case ::fuchsia::ui::gfx::Command::Tag::kSetRotation: {
+      TRACE_DURATION("gfx", "Session::ApplySetRotationCmds", "count", count);
+      return apply_each([this](::fuchsia::ui::gfx::Command* command) {
+        return ApplySetRotationCmd(std::move(command->set_rotation()));
+      });
+    }
+    case ::fuchsia::ui::gfx::Command::Tag::kSetOpacity: {
+      TRACE_DURATION("gfx", "Session::ApplySetOpacityCmds", "count", count);
+      return apply_each([this](::fuchsia::ui::gfx::Command* command) {
+        return ApplySetOpacityCmd(command->set_opacity());
+      });
+    }
+    default:
+      return apply_each([this](::fuchsia::ui::gfx::Command* command) {
+        return ApplyCommand(std::move(*command));
+      });
+  }
+}
+
+std::vector<::fuchsia::ui::gfx::Command> Session::TakeCommandBuffer() {
+  if (free_command_buffers_.empty()) {
+    return std::vector<::fuchsia::ui::gfx::Command>();
+  }
+  std::vector<::fuchsia::ui::gfx::Command> buffer =
+      std::move(free_command_buffers_.back());
+  free_command_buffers_.pop_back();
+  return buffer;
+}
+
+void Session::RecycleCommandBuffer(
+    std::vector<::fuchsia::ui::gfx::Command> buffer) {
+  // One spare buffer suffices if updates are applied as fast as they are
+  // presented; keep another for clients that are one update ahead.  Don't hold
+  // on to the storage of unusually large updates.
+  constexpr size_t kMaxFreeCommandBuffers = 2;
+  constexpr size_t kMaxRecycledCommandBufferCapacity = 1 << 17;
+  if (free_command_buffers_.size() < kMaxFreeCommandBuffers &&
+      buffer.capacity() <= kMaxRecycledCommandBufferCapacity) {
+    buffer.clear();
+    free_command_buffers_.push_back(std::move(buffer));
+  }
+}
+
 void Session::HitTest(uint32_t node_id, ::fuchsia::ui::gfx::vec3 ray_origin,
                       ::fuchsia::ui::gfx::vec3 ray_direction,
                       fuchsia::ui::scenic::Session::HitTestCallback callback) {
@@ -125,6 +125,13 @@ class Session : public fxl::RefCountedThreadSafe<Session> {
   // Called internally to initiate teardown.
   void BeginTearDown();
 
+  // Apply the commands in [begin, end), which must all be of the same type.
+  // Return false, and set |failed_out| to the command that failed, if any
+  // command cannot be applied.
+  bool ApplyCommandRun(::fuchsia::ui::gfx::Command* begin,
+                       ::fuchsia::ui::gfx::Command* end,
+                       ::fuchsia::ui::gfx::Command** failed_out);
+
   // Cmderation application functions, called by ApplyCommand().
   bool ApplyCreateResourceCmd(::fuchsia::ui::gfx::CreateResourceCmd command);
   bool ApplyReleaseResourceCmd(::fuchsia::ui::gfx::ReleaseResourceCmd command);
@@ -308,8 +315,19 @@ class Session : public fxl::RefCountedThreadSafe<Session> {
     // an invocation of |Session.Present()|.
     fuchsia::ui::scenic::Session::PresentCallback present_callback;
   };
-  bool ApplyUpdate(std::vector<::fuchsia::ui::gfx::Command> commands);
+  // Apply the commands in order, stopping at the first failure.  Runs of
+  // consecutive commands of the same type are applied as a batch; see
+  // ApplyCommandRun().  The commands are left in a moved-from state.
+  bool ApplyUpdate(std::vector<::fuchsia::ui::gfx::Command>* commands);
   std::queue<Update> scheduled_updates_;
+
+  // Called by SessionHandler::Present() to obtain an empty vector in which to
+  // buffer the commands for the next update.  Reuses the storage of vectors
+  // whose commands have been applied, so that a client which sends a similar
+  // number of commands every frame causes no reallocation.
+  std::vector<::fuchsia::ui::gfx::Command> TakeCommandBuffer();
+  void RecycleCommandBuffer(std::vector<::fuchsia::ui::gfx::Command> buffer);
+  std::vector<std::vector<::fuchsia::ui::gfx::Command>> free_command_buffers_;
   ::fidl::VectorPtr<zx::event> fences_to_release_on_next_update_;
 
   uint64_t last_applied_update_presentation_time_ = 0;
@@ -38,7 +38,7 @@ void SessionHandler::Present(
           std::move(callback))) {
     BeginTearDown();
   }
-  buffered_commands_.clear();
+  buffered_commands_ = session_->TakeCommandBuffer();
 }
 
 void SessionHandler::HitTest(
@@ -74,8 +74,8 @@ class SessionHandler : public TempSessionDelegate {
   ErrorReporter* const error_reporter_;
   scenic_impl::gfx::SessionPtr session_;
 
-  // TODO(SCN-710): We reallocate this everytime we std::move it into
-  // ScheduleUpdate().  The bug has some ideas about how to do better.
+  // Moved into ScheduleUpdate() by Present(), then replaced by a recycled
+  // buffer from Session::TakeCommandBuffer().
   std::vector<::fuchsia::ui::gfx::Command> buffered_commands_;
 };
 
@@ -5,6 +5,7 @@
 #include "garnet/lib/ui/gfx/gfx_system.h"
 
 #include <fs/pseudo-file.h>
+#include <lib/async/cpp/task.h>
 
 #include "garnet/lib/ui/gfx/engine/session_handler.h"
 #include "garnet/lib/ui/gfx/screenshotter.h"
@@ -14,11 +15,20 @@
 #include "lib/escher/escher_process_init.h"
 #include "lib/escher/fs/hack_filesystem.h"
 #include "lib/escher/util/check_vulkan_support.h"
+#include "lib/escher/util/stopwatch.h"
 #include "public/lib/syslog/cpp/logger.h"
 
 namespace scenic_impl {
 namespace gfx {
 
+// Compiled shaders and Vulkan pipeline cache data are persisted here, so that
+// they needn't be regenerated each time Scenic starts.
+static const char kEscherCacheDirectory[] = "/data/escher_cache";
+
+// Pipelines are created lazily, as content is first rendered, so the pipeline
+// cache is saved once Scenic has had a chance to render for a while.
+static constexpr zx::duration kSavePipelineCacheDelay = zx::sec(10);
+
 GfxSystem::GfxSystem(SystemContext context,
                      std::unique_ptr<DisplayManager> display_manager)
     : TempSystemDelegate(std::move(context), false),
@@ -128,8 +138,8 @@ std::unique_ptr<escher::Escher> GfxSystem::InitializeEscher() {
 
   // Initialize Escher.
   escher::GlslangInitializeProcess();
-  return std::make_unique<escher::Escher>(vulkan_device_queues_,
-                                          std::move(shader_fs));
+  return std::make_unique<escher::Escher>(
+      vulkan_device_queues_, std::move(shader_fs), kEscherCacheDirectory);
 }
 
 fit::closure GfxSystem::DelayedInitClosure() {
@@ -165,10 +175,22 @@ void GfxSystem::Initialize() {
     }
   }
 
+  escher::Stopwatch stopwatch;
   escher_ = InitializeEscher();
 
   // Initialize the Scenic engine.
   engine_ = InitializeEngine();
+  stopwatch.Stop();
+  FXL_LOG(INFO) << "Graphics system initialized in "
+                << stopwatch.GetElapsedMicroseconds() / 1000 << " ms.";
+
+  async::PostDelayedTask(async_get_default_dispatcher(),
+                         [escher = escher_->GetWeakPtr()] {
+                           if (escher) {
+                             escher->SavePipelineCache();
+                           }
+                         },
+                         kSavePipelineCacheDelay);
 
   // Create a pseudo-file that dumps alls the Scenic scenes.
   context()->app_context()->outgoing().debug_dir()->AddEntry(
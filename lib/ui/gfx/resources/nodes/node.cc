@@ -2,6 +2,7 @@
 // Use of this source code is governed by a BSD-style license that can be
 // found in the LICENSE file.
 
+#include <float.h>
 #include <algorithm>
 
 #include "garnet/lib/ui/gfx/resources/nodes/node.h"
@@ -9,6 +10,7 @@
 #include <fuchsia/ui/gfx/cpp/fidl.h>
 #include "garnet/lib/ui/gfx/engine/session.h"
 #include "garnet/lib/ui/gfx/resources/import.h"
+#include "garnet/lib/ui/gfx/resources/nodes/scene.h"
 #include "garnet/lib/ui/gfx/resources/nodes/traversal.h"
 #include "garnet/lib/ui/gfx/resources/view.h"
 #include "garnet/lib/ui/gfx/resources/view_holder.h"
@@ -32,6 +34,39 @@ constexpr ResourceTypeFlags kHasTransform =
     ResourceType::kShapeNode;
 constexpr ResourceTypeFlags kHasClip = ResourceType::kEntityNode;
 
+// Relative amount by which hit-test bounds are grown; see NewHitTestBounds().
+// This is far larger than the rounding error of the ray and box
+// transformations, while still being small enough to reject nearly all rays
+// which miss the content.
+constexpr float kHitTestBoundsPadding = 0.001f;
+
+bool IsFinite(const escher::vec3& v) {
+  return glm::all(glm::lessThan(glm::abs(v), escher::vec3(FLT_MAX)));
+}
+
+// Computes the corners of the axis-aligned box which contains |box| after
+// transformation by the affine |matrix|.  Unlike operator*(mat4, BoundingBox),
+// this tolerates degenerate results, such as those of a zero scale.
+void TransformBounds(const escher::mat4& matrix, const escher::BoundingBox& box,
+                     escher::vec3* out_min, escher::vec3* out_max) {
+  const escher::vec3 xa = box.min().x * escher::vec3(matrix[0]);
+  const escher::vec3 xb = box.max().x * escher::vec3(matrix[0]);
+  const escher::vec3 ya = box.min().y * escher::vec3(matrix[1]);
+  const escher::vec3 yb = box.max().y * escher::vec3(matrix[1]);
+  const escher::vec3 za = box.min().z * escher::vec3(matrix[2]);
+  const escher::vec3 zb = box.max().z * escher::vec3(matrix[2]);
+  *out_min = glm::min(xa, xb) + glm::min(ya, yb) + glm::min(za, zb) +
+             escher::vec3(matrix[3]);
+  *out_max = glm::max(xa, xb) + glm::max(ya, yb) + glm::max(za, zb) +
+             escher::vec3(matrix[3]);
+}
+
+bool MetricsEquals(const ::fuchsia::ui::gfx::Metrics& a,
+                   const ::fuchsia::ui::gfx::Metrics& b) {
+  return a.scale_x == b.scale_x && a.scale_y == b.scale_y &&
+         a.scale_z == b.scale_z;
+}
+
 }  // anonymous namespace
 
 const ResourceTypeInfo Node::kTypeInfo = {ResourceType::kNode, "Node"};
@@ -64,6 +99,7 @@ bool Node::SetEventMask(uint32_t event_mask) {
   if (!(event_mask & ::fuchsia::ui::gfx::kMetricsEventMask)) {
     reported_metrics_ = ::fuchsia::ui::gfx::Metrics();
   }
+  InvalidateMetrics();
   return true;
 }
 
@@ -117,6 +153,8 @@ void Node::SetParent(Node* parent, ParentRelation relation) {
   parent_ = parent;
   parent_relation_ = relation;
   RefreshScene(parent_->scene());
+  InvalidateGlobalTransform();
+  InvalidateMetrics();
 }
 
 bool Node::AddViewHolder(ViewHolderPtr view_holder) {
@@ -187,6 +225,7 @@ bool Node::DetachChildren() {
     view_holder->Detach();
   }
   view_holders_.clear();
+  InvalidateHitTestBounds();
   return true;
 }
 
@@ -204,6 +243,7 @@ bool Node::SetTransform(const escher::Transform& transform) {
   }
   transform_ = transform;
   InvalidateGlobalTransform();
+  InvalidateMetrics();
   return true;
 }
 
@@ -247,6 +287,7 @@ bool Node::SetScale(const escher::vec3& scale) {
   bound_variables_.erase(NodeProperty::kScale);
   transform_.scale = scale;
   InvalidateGlobalTransform();
+  InvalidateMetrics();
   return true;
 }
 
@@ -261,6 +302,7 @@ bool Node::SetScale(Vector3VariablePtr scale_variable) {
                                                [this](escher::vec3 value) {
                                                  transform_.scale = value;
                                                  InvalidateGlobalTransform();
+                                                 InvalidateMetrics();
                                                });
   return true;
 }
@@ -365,8 +407,10 @@ void Node::AddImport(Import* import) {
   FXL_DCHECK(delegate->parent_relation_ == ParentRelation::kNone);
   delegate->parent_ = this;
   delegate->parent_relation_ = ParentRelation::kImportDelegate;
+  delegate->RefreshScene(scene_);
 
   delegate->InvalidateGlobalTransform();
+  delegate->InvalidateMetrics();
 }
 
 void Node::RemoveImport(Import* import) {
@@ -376,8 +420,10 @@ void Node::RemoveImport(Import* import) {
   FXL_DCHECK(delegate->parent_relation_ == ParentRelation::kImportDelegate);
   delegate->parent_relation_ = ParentRelation::kNone;
   delegate->parent_ = nullptr;
+  delegate->RefreshScene(nullptr);
 
   delegate->InvalidateGlobalTransform();
+  InvalidateHitTestBounds();
 }
 
 bool Node::GetIntersection(const escher::ray4& ray, float* out_distance) const {
@@ -385,20 +431,168 @@ bool Node::GetIntersection(const escher::ray4& ray, float* out_distance) const {
 }
 
 void Node::InvalidateGlobalTransform() {
-  if (!global_transform_dirty_) {
-    global_transform_dirty_ = true;
-    ForEachDirectDescendantFrontToBack(
-        *this, [](Node* node) { node->InvalidateGlobalTransform(); });
+  // Descendants notice that their cached global transforms are stale when
+  // this node's generation changes; see GetGlobalTransform().
+  global_transform_dirty_ = true;
+  if (scene_) {
+    scene_->InvalidateGlobalTransforms();
+  }
+
+  // The node's own hit-test bounds are in its local coordinate system, so
+  // they are unaffected, but its parent's include them transformed.
+  if (parent_) {
+    parent_->InvalidateHitTestBounds();
   }
 }
 
+const escher::mat4& Node::GetGlobalTransform() const {
+  // Only nodes in a scene can skip the walk: every ancestor of such a node is
+  // in the same scene, so any invalidation above it has advanced the epoch.
+  uint64_t epoch = scene_ ? scene_->global_transform_epoch() : 0;
+  if (epoch != 0 && validated_global_transform_epoch_ == epoch) {
+    return global_transform_;
+  }
+  if (parent_) {
+    parent_->GetGlobalTransform();
+    if (parent_->global_transform_generation_ !=
+        parent_global_transform_generation_) {
+      global_transform_dirty_ = true;
+    }
+  }
+  if (global_transform_dirty_) {
+    ComputeGlobalTransform();
+    global_transform_dirty_ = false;
+  }
+  validated_global_transform_epoch_ = epoch;
+  return global_transform_;
+}
+
 void Node::ComputeGlobalTransform() const {
+  // Only called by GetGlobalTransform(), after the parent's global transform
+  // has been brought up to date.
   if (parent_) {
+    FXL_DCHECK(!parent_->global_transform_dirty_);
     global_transform_ =
-        parent_->GetGlobalTransform() * static_cast<escher::mat4>(transform_);
+        parent_->global_transform_ * static_cast<escher::mat4>(transform_);
+    parent_global_transform_generation_ =
+        parent_->global_transform_generation_;
   } else {
     global_transform_ = static_cast<escher::mat4>(transform_);
   }
+  ++global_transform_generation_;
+}
+
+void Node::InvalidateMetrics() {
+  metrics_dirty_ = true;
+  // Stop as soon as an ancestor is found which is already marked; all of its
+  // ancestors are marked too, or it is not (yet) part of a scene.
+  for (Node* node = parent_; node && !node->descendant_metrics_dirty_;
+       node = node->parent_) {
+    node->descendant_metrics_dirty_ = true;
+  }
+}
+
+void Node::UpdateMetrics(std::vector<Node*>* updated_nodes) {
+  ::fuchsia::ui::gfx::Metrics metrics;
+  metrics.scale_x = 1.f;
+  metrics.scale_y = 1.f;
+  metrics.scale_z = 1.f;
+  UpdateMetrics(metrics, false, updated_nodes);
+}
+
+void Node::UpdateMetrics(const ::fuchsia::ui::gfx::Metrics& parent_metrics,
+                         bool parent_metrics_changed,
+                         std::vector<Node*>* updated_nodes) {
+  bool metrics_changed = false;
+  if (parent_metrics_changed || metrics_dirty_) {
+    ::fuchsia::ui::gfx::Metrics local_metrics;
+    local_metrics.scale_x = parent_metrics.scale_x * scale().x;
+    local_metrics.scale_y = parent_metrics.scale_y * scale().y;
+    local_metrics.scale_z = parent_metrics.scale_z * scale().z;
+    metrics_changed = !MetricsEquals(global_metrics_, local_metrics);
+    global_metrics_ = local_metrics;
+
+    if ((event_mask() & ::fuchsia::ui::gfx::kMetricsEventMask) &&
+        !MetricsEquals(reported_metrics_, local_metrics)) {
+      reported_metrics_ = local_metrics;
+      updated_nodes->push_back(this);
+    }
+  } else if (!descendant_metrics_dirty_) {
+    // Nothing in this subtree has changed.
+    return;
+  }
+  metrics_dirty_ = false;
+  descendant_metrics_dirty_ = false;
+
+  // If this node's metrics are unchanged, only the descendants which are
+  // themselves dirty (or have dirty descendants) need to be visited.
+  ForEachDirectDescendantFrontToBack(
+      *this, [this, metrics_changed, updated_nodes](Node* node) {
+        node->UpdateMetrics(global_metrics_, metrics_changed, updated_nodes);
+      });
+}
+
+bool Node::GetContentBounds(escher::BoundingBox* out_bounds) const {
+  *out_bounds = escher::BoundingBox();
+  return true;
+}
+
+bool Node::GetHitTestBounds(escher::BoundingBox* out_bounds) {
+  if (hit_test_bounds_dirty_) {
+    ComputeHitTestBounds();
+    hit_test_bounds_dirty_ = false;
+  }
+  *out_bounds = hit_test_bounds_;
+  return hit_test_bounds_known_;
+}
+
+void Node::ComputeHitTestBounds() {
+  hit_test_bounds_known_ = GetContentBounds(&hit_test_bounds_);
+
+  ForEachDirectDescendantFrontToBack(*this, [this](Node* node) {
+    escher::BoundingBox bounds;
+    if (!node->GetHitTestBounds(&bounds)) {
+      hit_test_bounds_known_ = false;
+    }
+    if (!hit_test_bounds_known_ || bounds.is_empty()) {
+      return;
+    }
+    if (!node->transform().IsIdentity()) {
+      escher::vec3 min, max;
+      TransformBounds(static_cast<escher::mat4>(node->transform()), bounds,
+                      &min, &max);
+      // Bounds which overflow (or involve NaNs) can't reject anything.
+      if (!IsFinite(min) || !IsFinite(max)) {
+        hit_test_bounds_known_ = false;
+        return;
+      }
+      bounds = NewHitTestBounds(min, max);
+    }
+    hit_test_bounds_.Join(bounds);
+  });
+
+  if (!hit_test_bounds_.is_empty() &&
+      !(IsFinite(hit_test_bounds_.min()) && IsFinite(hit_test_bounds_.max()))) {
+    hit_test_bounds_known_ = false;
+  }
+}
+
+void Node::InvalidateHitTestBounds() {
+  for (Node* node = this; node && !node->hit_test_bounds_dirty_;
+       node = node->parent_) {
+    node->hit_test_bounds_dirty_ = true;
+  }
+}
+
+// static
+escher::BoundingBox Node::NewHitTestBounds(const escher::vec3& min,
+                                           const escher::vec3& max) {
+  const escher::vec3 magnitude = glm::max(glm::abs(min), glm::abs(max));
+  const float padding =
+      kHitTestBoundsPadding *
+      (1.f + std::max(magnitude.x, std::max(magnitude.y, magnitude.z)));
+  return escher::BoundingBox(min - escher::vec3(padding),
+                             max + escher::vec3(padding));
 }
 
 void Node::EraseChild(Node* child) {
@@ -407,6 +601,7 @@ void Node::EraseChild(Node* child) {
                    [child](const NodePtr& ptr) { return child == ptr.get(); });
   FXL_DCHECK(it != children_.end());
   children_.erase(it);
+  InvalidateHitTestBounds();
 }
 
 void Node::ErasePart(Node* part) {
@@ -415,6 +610,7 @@ void Node::ErasePart(Node* part) {
                    [part](const NodePtr& ptr) { return part == ptr.get(); });
   FXL_DCHECK(it != parts_.end());
   parts_.erase(it);
+  InvalidateHitTestBounds();
 }
 
 void Node::DetachInternal() {
@@ -431,6 +627,7 @@ void Node::RefreshScene(Scene* new_scene) {
   }
 
   scene_ = new_scene;
+  validated_global_transform_epoch_ = 0;
   for (auto& view_holder : view_holders_) {
     view_holder->RefreshScene();
   }
@@ -12,6 +12,7 @@
 #include "garnet/lib/ui/gfx/resources/nodes/variable_binding.h"
 #include "garnet/lib/ui/gfx/resources/resource.h"
 #include "garnet/lib/ui/gfx/resources/variable.h"
+#include "lib/escher/geometry/bounding_box.h"
 #include "lib/escher/geometry/transform.h"
 #include "lib/fxl/memory/ref_ptr.h"
 
@@ -78,6 +79,16 @@ class Node : public Resource {
     reported_metrics_ = metrics;
   }
 
+  // Recomputes the metrics of this node and its descendants, as if this node
+  // were the root of the tree.  Nodes which subscribe to metrics events and
+  // whose metrics have changed since they were last reported are updated and
+  // appended to |updated_nodes|.
+  //
+  // Only subtrees which may have changed since the previous call are visited:
+  // changing a node's scale, parent or event mask marks the node dirty, and
+  // marks its ancestors as having a dirty descendant.
+  void UpdateMetrics(std::vector<Node*>* updated_nodes);
+
   // |Resource|, DetachCmd.
   bool Detach() override;
 
@@ -115,6 +126,17 @@ class Node : public Resource {
   virtual bool GetIntersection(const escher::ray4& ray,
                                float* out_distance) const;
 
+  // Sets |out_bounds| to a box, in the node's local coordinate system, which
+  // contains every point at which GetIntersection() can succeed for this node
+  // or any of its descendants; the box is empty if there are none.  Returns
+  // false if no such box is known, for example because the subtree contains a
+  // shape whose bounds may change.
+  //
+  // This forms a bounding volume hierarchy which mirrors the node tree, used
+  // by HitTester to skip subtrees that a ray cannot intersect.  The bounds are
+  // cached, and only the nodes on the path to a change are refit.
+  bool GetHitTestBounds(escher::BoundingBox* out_bounds);
+
   // Walk up tree until we find the responsible View; otherwise return nullptr.
   // N.B. Typically the view and node are in the same session, but it's possible
   // to have them inhabit different sessions.
@@ -122,6 +144,21 @@ class Node : public Resource {
 
  protected:
   Node(Session* session, ResourceId node_id, const ResourceTypeInfo& type_info);
+
+  // Sets |out_bounds| to the bounds of the node's own content, excluding its
+  // descendants, for GetHitTestBounds().  Returns false if the bounds are not
+  // known.  The default implementation returns an empty box, matching
+  // GetIntersection().
+  virtual bool GetContentBounds(escher::BoundingBox* out_bounds) const;
+
+  // Marks the cached bounds of this node and its ancestors as stale.
+  void InvalidateHitTestBounds();
+
+  // Returns a box containing |min| and |max|, grown slightly so that ray tests
+  // against it are conservative despite floating-point rounding.
+  static escher::BoundingBox NewHitTestBounds(const escher::vec3& min,
+                                              const escher::vec3& max);
+
   // Protected so that Scene Node can set itself as a Scene.
   Scene* scene_ = nullptr;
 
@@ -134,6 +171,14 @@ class Node : public Resource {
 
   void InvalidateGlobalTransform();
   void ComputeGlobalTransform() const;
+  void ComputeHitTestBounds();
+
+  // Marks this node's metrics as needing to be recomputed by UpdateMetrics(),
+  // along with those of its descendants.
+  void InvalidateMetrics();
+  void UpdateMetrics(const ::fuchsia::ui::gfx::Metrics& parent_metrics,
+                     bool parent_metrics_changed,
+                     std::vector<Node*>* updated_nodes);
 
   void SetParent(Node* parent, ParentRelation relation);
   void EraseChild(Node* part);
@@ -167,8 +212,38 @@ class Node : public Resource {
       bound_variables_;
 
   escher::Transform transform_;
+
+  // The global transform is cached, and recomputed lazily when either the
+  // node's own transform or its parent has changed (|global_transform_dirty_|)
+  // or the parent's global transform has been recomputed since it was last
+  // used here (detected by comparing generations).  This makes invalidation
+  // O(1), instead of requiring a walk of the whole subtree whenever a node is
+  // moved.
   mutable escher::mat4 global_transform_;
   mutable bool global_transform_dirty_ = true;
+  mutable uint64_t global_transform_generation_ = 0;
+  mutable uint64_t parent_global_transform_generation_ = 0;
+
+  // The scene's global transform epoch (see Scene::global_transform_epoch())
+  // at which the cached global transform was last validated.  While it is
+  // current, GetGlobalTransform() returns the cached transform without
+  // consulting the node's ancestors, so that repeated calls for an unchanged
+  // scene are O(1) rather than O(depth).  Reset whenever the node moves to
+  // another scene; nodes outside any scene always consult their ancestors.
+  mutable uint64_t validated_global_transform_epoch_ = 0;
+
+  // Product of the scales of this node and its ancestors, as of the last call
+  // to UpdateMetrics().
+  ::fuchsia::ui::gfx::Metrics global_metrics_;
+  bool metrics_dirty_ = true;
+  bool descendant_metrics_dirty_ = false;
+
+  // Cached result of GetHitTestBounds().  If a node's bounds are dirty, so are
+  // those of all its ancestors.
+  escher::BoundingBox hit_test_bounds_;
+  bool hit_test_bounds_known_ = false;
+  bool hit_test_bounds_dirty_ = true;
+
   bool clip_to_self_ = false;
   ::fuchsia::ui::gfx::HitTestBehavior hit_test_behavior_ =
       ::fuchsia::ui::gfx::HitTestBehavior::kDefault;
@@ -180,16 +255,6 @@ class Node : public Resource {
   friend class View;
 };
 
-// Inline functions.
-
-inline const escher::mat4& Node::GetGlobalTransform() const {
-  if (global_transform_dirty_) {
-    ComputeGlobalTransform();
-    global_transform_dirty_ = false;
-  }
-  return global_transform_;
-}
-
 }  // namespace gfx
 }  // namespace scenic_impl
 
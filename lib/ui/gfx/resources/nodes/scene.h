@@ -43,7 +43,16 @@ class Scene final : public Node {
     return directional_lights_;
   }
 
+  // Advanced whenever the global transform of any node in the scene is
+  // invalidated; see Node::GetGlobalTransform().  Starts above the initial
+  // validated epoch of every node, so that each node computes its global
+  // transform at least once.
+  uint64_t global_transform_epoch() const { return global_transform_epoch_; }
+  void InvalidateGlobalTransforms() { ++global_transform_epoch_; }
+
  private:
+  uint64_t global_transform_epoch_ = 1;
+
   std::vector<AmbientLightPtr> ambient_lights_;
   std::vector<DirectionalLightPtr> directional_lights_;
 
@@ -19,12 +19,28 @@ void ShapeNode::SetMaterial(MaterialPtr material) {
   material_ = std::move(material);
 }
 
-void ShapeNode::SetShape(ShapePtr shape) { shape_ = std::move(shape); }
+void ShapeNode::SetShape(ShapePtr shape) {
+  shape_ = std::move(shape);
+  InvalidateHitTestBounds();
+}
 
 bool ShapeNode::GetIntersection(const escher::ray4& ray,
                                 float* out_distance) const {
   return shape_ && shape_->GetIntersection(ray, out_distance);
 }
 
+bool ShapeNode::GetContentBounds(escher::BoundingBox* out_bounds) const {
+  if (!shape_) {
+    *out_bounds = escher::BoundingBox();
+    return true;
+  }
+  escher::vec3 min, max;
+  if (!shape_->GetBounds(&min, &max)) {
+    return false;
+  }
+  *out_bounds = NewHitTestBounds(min, max);
+  return true;
+}
+
 }  // namespace gfx
 }  // namespace scenic_impl
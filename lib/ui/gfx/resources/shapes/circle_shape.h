@@ -23,6 +23,7 @@ class CircleShape final : public PlanarShape {
 
   // |PlanarShape|.
   bool ContainsPoint(const escher::vec2& point) const override;
+  escher::vec2 GetHalfExtent() const override;
 
   // |Shape|.
   escher::Object GenerateRenderObject(
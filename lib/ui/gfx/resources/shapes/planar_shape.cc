@@ -4,6 +4,8 @@
 
 #include "garnet/lib/ui/gfx/resources/shapes/planar_shape.h"
 
+#include <float.h>
+
 namespace scenic_impl {
 namespace gfx {
 
@@ -37,5 +39,16 @@ bool PlanarShape::GetIntersection(const escher::ray4& ray,
   return true;
 }
 
+bool PlanarShape::GetBounds(escher::vec3* out_min,
+                            escher::vec3* out_max) const {
+  const escher::vec2 half_extent = glm::abs(GetHalfExtent());
+  if (!glm::all(glm::lessThan(half_extent, escher::vec2(FLT_MAX)))) {
+    return false;
+  }
+  *out_min = escher::vec3(-half_extent, 0.f);
+  *out_max = escher::vec3(half_extent, 0.f);
+  return true;
+}
+
 }  // namespace gfx
 }  // namespace scenic_impl
@@ -19,9 +19,16 @@ class PlanarShape : public Shape {
   bool GetIntersection(const escher::ray4& ray,
                        float* out_distance) const override;
 
+  // |Shape|
+  bool GetBounds(escher::vec3* out_min, escher::vec3* out_max) const override;
+
   // Returns if the given point lies within its bounds of this shape.
   virtual bool ContainsPoint(const escher::vec2& point) const = 0;
 
+  // Returns the half-width and half-height of a rectangle centered at the
+  // origin which contains every point for which ContainsPoint() is true.
+  virtual escher::vec2 GetHalfExtent() const = 0;
+
  protected:
   PlanarShape(Session* session, ResourceId id,
               const ResourceTypeInfo& type_info);
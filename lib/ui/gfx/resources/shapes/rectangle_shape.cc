@@ -21,6 +21,10 @@ bool RectangleShape::ContainsPoint(const escher::vec2& point) const {
   return pt.x >= 0.f && pt.y >= 0.f && pt.x <= width_ && pt.y <= height_;
 }
 
+escher::vec2 RectangleShape::GetHalfExtent() const {
+  return escher::vec2(0.5f * width_, 0.5f * height_);
+}
+
 escher::Object RectangleShape::GenerateRenderObject(
     const escher::mat4& transform, const escher::MaterialPtr& material) {
   // Scale Escher's built-in rect mesh to have bounds (0,0),(width,height), then
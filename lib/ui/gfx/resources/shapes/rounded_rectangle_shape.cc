@@ -25,6 +25,10 @@ bool RoundedRectangleShape::ContainsPoint(const escher::vec2& point) const {
   return spec_.ContainsPoint(point);
 }
 
+escher::vec2 RoundedRectangleShape::GetHalfExtent() const {
+  return escher::vec2(0.5f * spec_.width, 0.5f * spec_.height);
+}
+
 escher::Object RoundedRectangleShape::GenerateRenderObject(
     const escher::mat4& transform, const escher::MaterialPtr& material) {
   return escher::Object(transform, mesh_, material);
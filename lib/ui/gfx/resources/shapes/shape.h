@@ -27,6 +27,14 @@ class Shape : public Resource {
   virtual bool GetIntersection(const escher::ray4& ray,
                                float* out_distance) const = 0;
 
+  // Sets |out_min| and |out_max| to the corners of an axis-aligned box which
+  // contains every point of intersection that GetIntersection() can report.
+  // Returns false if the shape's bounds are unknown, or may change over the
+  // shape's lifetime.
+  virtual bool GetBounds(escher::vec3* out_min, escher::vec3* out_max) const {
+    return false;
+  }
+
   // Generate an object to add to an escher::Model.
   virtual escher::Object GenerateRenderObject(
       const escher::mat4& transform, const escher::MaterialPtr& material) = 0;
@@ -0,0 +1,245 @@
+// Copyright 2018 The Fuchsia Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "garnet/lib/ui/gfx/engine/frame_scheduler.h"
+
+#include <algorithm>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "garnet/lib/ui/gfx/engine/frame_predictor.h"
+#include "gtest/gtest.h"
+#include "lib/fxl/logging.h"
+
+namespace scenic_impl {
+namespace gfx {
+namespace test {
+namespace {
+
+constexpr zx_duration_t kMsec = 1'000'000;
+constexpr zx_duration_t kVsyncInterval = 16'666'667;  // 60Hz
+
+FrameDurations MakeDurations(zx_duration_t update, zx_duration_t render) {
+  FrameDurations durations;
+  durations.update = update;
+  durations.render = render;
+  return durations;
+}
+
+// Parses a trace of the update and render durations logged by the
+// "FramePrediction" trace counter: a pair of whitespace-separated durations in
+// microseconds per frame.
+std::vector<FrameDurations> ParseTimingTrace(const std::string& text) {
+  std::vector<FrameDurations> trace;
+  std::istringstream stream(text);
+  int64_t update_usecs, render_usecs;
+  while (stream >> update_usecs >> render_usecs) {
+    trace.push_back(MakeDurations(update_usecs * 1000, render_usecs * 1000));
+  }
+  return trace;
+}
+
+struct SimulationResult {
+  size_t frame_count = 0;
+  // Frames that weren't presented at the time they were scheduled for.
+  size_t dropped_frame_count = 0;
+  // From applying the session updates, i.e. the latest moment at which input
+  // can affect the frame, until the frame is presented.
+  zx_duration_t mean_latency = 0;
+  zx_duration_t max_latency = 0;
+};
+
+std::ostream& operator<<(std::ostream& os, const SimulationResult& result) {
+  return os << result.dropped_frame_count << "/" << result.frame_count
+            << " frames dropped, latency mean "
+            << result.mean_latency / 1000 << "us max "
+            << result.max_latency / 1000 << "us";
+}
+
+// Replays |trace| through the scheduling computation used by FrameScheduler.
+// As with clients that only present their next frame once the previous one
+// has been presented, a frame is requested for as soon as possible right
+// after the previous frame is presented.  Frames are presented at the first
+// vsync after rendering finishes.
+SimulationResult SimulateScheduling(const std::vector<FrameDurations>& trace,
+                                    bool predictive_scheduling) {
+  FramePredictor predictor(FrameScheduler::kDefaultFrameRenderTime);
+  SimulationResult result;
+  zx_time_t last_vsync_time = kVsyncInterval;
+  zx_time_t now = last_vsync_time;
+  zx_duration_t total_latency = 0;
+
+  for (auto& durations : trace) {
+    const zx_duration_t required_render_time =
+        predictive_scheduling ? predictor.PredictRequiredFrameRenderTime()
+                              : FrameScheduler::kDefaultFrameRenderTime;
+    auto times = FrameScheduler::ComputeTargetPresentationAndWakeupTimes(
+        0, last_vsync_time, kVsyncInterval, now, required_render_time);
+    const zx_time_t target_time = times.first;
+    const zx_time_t wakeup_time = times.second;
+    EXPECT_GE(wakeup_time, now);
+
+    const zx_time_t rendered_time =
+        wakeup_time + durations.update + durations.render;
+    const zx_time_t presented_time =
+        (rendered_time + kVsyncInterval - 1) / kVsyncInterval * kVsyncInterval;
+    if (presented_time > target_time) {
+      ++result.dropped_frame_count;
+    }
+    const zx_duration_t latency = presented_time - wakeup_time;
+    total_latency += latency;
+    result.max_latency = std::max(result.max_latency, latency);
+    ++result.frame_count;
+
+    FrameDurations reported = durations;
+    reported.present = presented_time - rendered_time;
+    predictor.ReportFrameDurations(reported);
+    last_vsync_time = presented_time;
+    now = presented_time;
+  }
+
+  if (result.frame_count > 0) {
+    result.mean_latency = total_latency / result.frame_count;
+  }
+  return result;
+}
+
+std::vector<FrameDurations> MakeSteadyTrace(size_t frame_count,
+                                            zx_duration_t update,
+                                            zx_duration_t render) {
+  return std::vector<FrameDurations>(frame_count,
+                                     MakeDurations(update, render));
+}
+
+// Update and render times, in the format above, of a scene with some animation
+// which gradually becomes more expensive to render.
+constexpr char kRecordedTrace[] = R"(
+  412 3921   398 4105   455 3876   401 4012   987 4233   420 3954
+  433 4187   405 4056   392 3998   611 4321   418 4102   429 4399
+  440 4876   421 5012   398 5234   456 5401   413 5587   420 5742
+  437 6013   402 6240   415 6498   881 6712   409 6935   423 7102
+  431 7389   416 7541   404 7802   452 8013   419 8247   427 8391
+  410 8522   433 8705   401 8866   418 9013   425 9104   407 9237
+  436 9312   412 9401   421 9488   408 9533   439 9610   415 9702
+  422 9655   417 9723   405 9687   431 9741   411 9698   426 9755
+)";
+
+}  // namespace
+
+TEST(FramePredictorTest, InitialPrediction) {
+  FramePredictor predictor(8 * kMsec);
+  EXPECT_EQ(8 * kMsec, predictor.PredictRequiredFrameRenderTime());
+  EXPECT_EQ(0u, predictor.frame_count());
+}
+
+TEST(FramePredictorTest, PredictsFromRecentFrames) {
+  FramePredictor predictor(8 * kMsec);
+  for (size_t i = 0; i < FramePredictor::kWindowSize; ++i) {
+    predictor.ReportFrameDurations(MakeDurations(1 * kMsec, 3 * kMsec));
+  }
+  EXPECT_EQ(4 * kMsec + FramePredictor::kMargin,
+            predictor.PredictRequiredFrameRenderTime());
+
+  // Up to 10% of the recent frames can be slower without affecting the
+  // prediction.
+  constexpr size_t kTolerated =
+      FramePredictor::kWindowSize * (100 - FramePredictor::kPercentile) / 100;
+  for (size_t i = 0; i < kTolerated; ++i) {
+    predictor.ReportFrameDurations(MakeDurations(1 * kMsec, 19 * kMsec));
+  }
+  EXPECT_EQ(4 * kMsec + FramePredictor::kMargin,
+            predictor.PredictRequiredFrameRenderTime());
+  predictor.ReportFrameDurations(MakeDurations(1 * kMsec, 19 * kMsec));
+  EXPECT_EQ(20 * kMsec + FramePredictor::kMargin,
+            predictor.PredictRequiredFrameRenderTime());
+
+  // Once the slow frames leave the window, they no longer matter.
+  for (size_t i = 0; i < FramePredictor::kWindowSize; ++i) {
+    predictor.ReportFrameDurations(MakeDurations(1 * kMsec, 2 * kMsec));
+  }
+  EXPECT_EQ(3 * kMsec + FramePredictor::kMargin,
+            predictor.PredictRequiredFrameRenderTime());
+  EXPECT_EQ(2 * FramePredictor::kWindowSize + kTolerated + 1,
+            predictor.frame_count());
+}
+
+TEST(FramePredictorTest, PredictionIsClamped) {
+  FramePredictor predictor(8 * kMsec);
+  predictor.ReportFrameDurations(MakeDurations(0, 0));
+  EXPECT_EQ(FramePredictor::kMinPrediction,
+            predictor.PredictRequiredFrameRenderTime());
+  for (size_t i = 0; i < FramePredictor::kWindowSize; ++i) {
+    predictor.ReportFrameDurations(MakeDurations(0, 100 * kMsec));
+  }
+  EXPECT_EQ(FramePredictor::kMaxPrediction,
+            predictor.PredictRequiredFrameRenderTime());
+}
+
+TEST(FrameSchedulerTest, ComputeTargetPresentationAndWakeupTimes) {
+  constexpr zx_duration_t kInterval = 16 * kMsec;
+  constexpr zx_time_t kLastVsync = 100 * kMsec;
+
+  // As soon as possible: the next vsync, waking up as late as possible.
+  auto times = FrameScheduler::ComputeTargetPresentationAndWakeupTimes(
+      0, kLastVsync, kInterval, 101 * kMsec, 8 * kMsec);
+  EXPECT_EQ(116 * kMsec, times.first);
+  EXPECT_EQ(108 * kMsec, times.second);
+
+  // Too late to render in time for the next vsync.
+  times = FrameScheduler::ComputeTargetPresentationAndWakeupTimes(
+      0, kLastVsync, kInterval, 101 * kMsec, 20 * kMsec);
+  EXPECT_EQ(132 * kMsec, times.first);
+  EXPECT_EQ(112 * kMsec, times.second);
+
+  // A later requested time is rounded up to a vsync.
+  times = FrameScheduler::ComputeTargetPresentationAndWakeupTimes(
+      140 * kMsec, kLastVsync, kInterval, 101 * kMsec, 8 * kMsec);
+  EXPECT_EQ(148 * kMsec, times.first);
+  EXPECT_EQ(140 * kMsec, times.second);
+}
+
+TEST(FrameSchedulerTest, SimulateCheapFrames) {
+  auto trace = MakeSteadyTrace(120, kMsec / 2, 5 * kMsec / 2);
+  auto fixed = SimulateScheduling(trace, false);
+  auto predictive = SimulateScheduling(trace, true);
+  FXL_LOG(INFO) << "fixed: " << fixed;
+  FXL_LOG(INFO) << "predictive: " << predictive;
+
+  EXPECT_EQ(0u, fixed.dropped_frame_count);
+  EXPECT_EQ(0u, predictive.dropped_frame_count);
+  // Cheap frames can start later, closer to their presentation.
+  EXPECT_EQ(FrameScheduler::kDefaultFrameRenderTime, fixed.mean_latency);
+  EXPECT_LT(predictive.mean_latency, 5 * kMsec);
+}
+
+TEST(FrameSchedulerTest, SimulateExpensiveFrames) {
+  auto trace = MakeSteadyTrace(120, 2 * kMsec, 10 * kMsec);
+  auto fixed = SimulateScheduling(trace, false);
+  auto predictive = SimulateScheduling(trace, true);
+  FXL_LOG(INFO) << "fixed: " << fixed;
+  FXL_LOG(INFO) << "predictive: " << predictive;
+
+  // Assuming a fixed render time misses every vsync, but the prediction only
+  // misses until the first frame has been presented.
+  EXPECT_EQ(trace.size(), fixed.dropped_frame_count);
+  EXPECT_EQ(1u, predictive.dropped_frame_count);
+  EXPECT_LT(predictive.mean_latency, fixed.mean_latency);
+}
+
+TEST(FrameSchedulerTest, SimulateRecordedTrace) {
+  auto trace = ParseTimingTrace(kRecordedTrace);
+  ASSERT_EQ(48u, trace.size());
+  auto fixed = SimulateScheduling(trace, false);
+  auto predictive = SimulateScheduling(trace, true);
+  FXL_LOG(INFO) << "fixed: " << fixed;
+  FXL_LOG(INFO) << "predictive: " << predictive;
+
+  EXPECT_LT(predictive.dropped_frame_count, fixed.dropped_frame_count);
+  EXPECT_LT(predictive.mean_latency, fixed.mean_latency);
+}
+
+}  // namespace test
+}  // namespace gfx
+}  // namespace scenic_impl
@@ -4,8 +4,11 @@
 
 #include <math.h>
 
+#include "garnet/lib/ui/gfx/engine/hit_tester.h"
+#include "garnet/lib/ui/gfx/resources/nodes/node.h"
 #include "garnet/lib/ui/gfx/tests/session_test.h"
 #include "garnet/lib/ui/gfx/util/unwrap.h"
+#include "lib/escher/util/stopwatch.h"
 #include "lib/ui/scenic/cpp/commands.h"
 
 #include "gtest/gtest.h"
@@ -296,6 +299,82 @@ TEST_F(HitTestTest, Clipping) {
               {.tag = 100, .tx = 0.f, .ty = 0.f, .tz = 0.f, .d = 8.f}});
 }
 
+TEST_F(HitTestTest, BoundsFollowChanges) {
+  // Nothing is initially at this location.
+  ExpectHits(1, vec3(31.f, 4.f, 10.f), kDownVector, {});
+
+  // Move 30 (via its parent) under the ray.
+  Apply(scenic::NewSetTranslationCmd(7, (float[3]){30.f, 0.f, 1.f}));
+  ExpectHits(1, vec3(31.f, 4.f, 10.f), kDownVector,
+             {{.tag = 30, .tx = -34.f, .ty = -4.f, .tz = -1.f, .d = 9.f},
+              {.tag = 35, .tx = -30.f, .ty = 0.f, .tz = -1.f, .d = 9.f},
+              {.tag = 100, .tx = 0.f, .ty = 0.f, .tz = 0.f, .d = 9.f}});
+
+  // Add a new shape under the ray, within a subtree that was already hit.
+  Apply(scenic::NewCreateShapeNodeCmd(13));
+  Apply(scenic::NewSetTagCmd(13, 40));
+  Apply(scenic::NewSetShapeCmd(13, 20));
+  Apply(scenic::NewSetTranslationCmd(13, (float[3]){28.f, 0.f, 0.f}));
+  Apply(scenic::NewAddChildCmd(9, 13));
+  ExpectHits(1, vec3(31.f, 4.f, 10.f), kDownVector,
+             {{.tag = 30, .tx = -34.f, .ty = -4.f, .tz = -1.f, .d = 9.f},
+              {.tag = 35, .tx = -30.f, .ty = 0.f, .tz = -1.f, .d = 9.f},
+              {.tag = 100, .tx = 0.f, .ty = 0.f, .tz = 0.f, .d = 9.f},
+              {.tag = 40, .tx = -28.f, .ty = 0.f, .tz = 0.f, .d = 10.f},
+              {.tag = 1, .tx = 0.f, .ty = 0.f, .tz = 0.f, .d = 10.f}});
+
+  // Removing nodes removes their hits.
+  Apply(scenic::NewDetachCmd(7));
+  Apply(scenic::NewDetachCmd(13));
+  ExpectHits(1, vec3(31.f, 4.f, 10.f), kDownVector, {});
+}
+
+TEST_F(HitTestTest, DISABLED_DenseSceneBenchmark) {
+  constexpr size_t kGridSize = 100;
+  constexpr size_t kHitTestCount = 1000;
+
+  // Add a grid of 8x8 tagged rectangles, spaced 10 apart, grouped into rows.
+  ResourceId next_id = 1000;
+  for (size_t y = 0; y < kGridSize; ++y) {
+    const ResourceId row_id = next_id++;
+    EXPECT_TRUE(Apply(scenic::NewCreateEntityNodeCmd(row_id)));
+    EXPECT_TRUE(Apply(scenic::NewSetTranslationCmd(
+        row_id, (float[3]){0.f, 10.f * y, 0.f})));
+    EXPECT_TRUE(Apply(scenic::NewAddChildCmd(9, row_id)));
+    for (size_t x = 0; x < kGridSize; ++x) {
+      const ResourceId widget_id = next_id++;
+      EXPECT_TRUE(Apply(scenic::NewCreateShapeNodeCmd(widget_id)));
+      EXPECT_TRUE(Apply(scenic::NewSetTagCmd(widget_id, widget_id)));
+      EXPECT_TRUE(Apply(scenic::NewSetShapeCmd(widget_id, 20)));
+      EXPECT_TRUE(Apply(scenic::NewSetTranslationCmd(
+          widget_id, (float[3]){10.f * x, 0.f, 0.f})));
+      EXPECT_TRUE(Apply(scenic::NewAddChildCmd(row_id, widget_id)));
+    }
+  }
+
+  auto root = FindResource<Node>(1);
+  SessionHitTester session_hit_tester(session_.get());
+  GlobalHitTester global_hit_tester;
+  for (HitTester* hit_tester :
+       std::initializer_list<HitTester*>{&session_hit_tester,
+                                         &global_hit_tester}) {
+    escher::Stopwatch stopwatch;
+    size_t hit_count = 0;
+    for (size_t i = 0; i < kHitTestCount; ++i) {
+      const float x = 1.f + (i * 37 % (kGridSize * 10));
+      const float y = 1.f + (i * 53 % (kGridSize * 10));
+      escher::ray4 ray{escher::vec4(x, y, 10.f, 1.f),
+                       escher::vec4(kDownVector, 0.f)};
+      hit_count += hit_tester->HitTest(root.get(), ray).size();
+    }
+    stopwatch.Stop();
+    FXL_LOG(INFO) << (hit_tester == &global_hit_tester ? "Global" : "Session")
+                  << " hit test: "
+                  << stopwatch.GetElapsedMicroseconds() / kHitTestCount
+                  << " us/test, " << hit_count << " hits";
+  }
+}
+
 }  // namespace test
 }  // namespace gfx
 }  // namespace scenic_impl
@@ -0,0 +1,286 @@
+// Copyright 2018 The Fuchsia Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "garnet/lib/ui/gfx/util/image_formats.h"
+
+#include <string.h>
+#include <algorithm>
+#include <vector>
+
+#include "garnet/lib/ui/yuv/yuv.h"
+#include "gtest/gtest.h"
+#include "lib/escher/util/stopwatch.h"
+#include "lib/fxl/logging.h"
+
+namespace scenic_impl {
+namespace gfx {
+namespace test {
+namespace {
+
+constexpr yuv::Isa kAllIsas[] = {yuv::Isa::kScalar, yuv::Isa::kSse41,
+                                 yuv::Isa::kAvx2, yuv::Isa::kNeon};
+
+// Returns a deterministic sequence of arbitrary bytes.
+std::vector<uint8_t> MakeSamples(size_t size, uint32_t seed) {
+  std::vector<uint8_t> samples(size);
+  for (auto& sample : samples) {
+    seed = seed * 1103515245 + 12345;
+    sample = static_cast<uint8_t>(seed >> 16);
+  }
+  return samples;
+}
+
+// Converts with yuv::YuvToBgra(), one pixel at a time.
+std::vector<uint8_t> ReferenceBgra(const std::vector<uint8_t>& y,
+                                   const std::vector<uint8_t>& u,
+                                   const std::vector<uint8_t>& v,
+                                   uint32_t width, uint32_t height) {
+  std::vector<uint8_t> bgra(width * height * 4);
+  for (uint32_t row = 0; row < height; ++row) {
+    for (uint32_t x = 0; x < width; ++x) {
+      const size_t uv_index = row / 2 * (width / 2) + x / 2;
+      yuv::YuvToBgra(y[row * width + x], u[uv_index], v[uv_index],
+                     &bgra[(row * width + x) * 4]);
+    }
+  }
+  return bgra;
+}
+
+::fuchsia::images::ImageInfo MakeImageInfo(
+    ::fuchsia::images::PixelFormat format, uint32_t width, uint32_t height,
+    uint32_t stride) {
+  ::fuchsia::images::ImageInfo info;
+  info.pixel_format = format;
+  info.width = width;
+  info.height = height;
+  info.stride = stride;
+  return info;
+}
+
+}  // namespace
+
+// Every combination of Y, U and V, with every instruction set, must produce
+// exactly what YuvToBgra() does.
+TEST(YuvTest, RowConversionMatchesReference) {
+  constexpr uint32_t kWidth = 256;
+  uint8_t y_row[kWidth];
+  uint8_t u_row[kWidth / 2];
+  uint8_t v_row[kWidth / 2];
+  uint8_t uv_row[kWidth];
+  uint8_t yuy2_row[kWidth * 2];
+  uint8_t expected[kWidth * 4];
+  uint8_t actual[kWidth * 4];
+  for (uint32_t x = 0; x < kWidth; ++x) {
+    y_row[x] = x;
+    yuy2_row[x * 2] = x;
+  }
+
+  for (yuv::Isa isa : kAllIsas) {
+    if (!yuv::IsIsaSupported(isa)) {
+      continue;
+    }
+    for (uint32_t u = 0; u < 256; ++u) {
+      for (uint32_t v = 0; v < 256; ++v) {
+        memset(u_row, u, sizeof(u_row));
+        memset(v_row, v, sizeof(v_row));
+        for (uint32_t i = 0; i < kWidth / 2; ++i) {
+          uv_row[i * 2] = u;
+          uv_row[i * 2 + 1] = v;
+          yuy2_row[i * 4 + 1] = u;
+          yuy2_row[i * 4 + 3] = v;
+        }
+        for (uint32_t x = 0; x < kWidth; ++x) {
+          yuv::YuvToBgra(x, u, v, &expected[x * 4]);
+        }
+
+        yuv::Yv12RowToBgra(y_row, u_row, v_row, actual, kWidth, isa);
+        ASSERT_EQ(0, memcmp(expected, actual, sizeof(actual)))
+            << "YV12 isa=" << static_cast<int>(isa) << " u=" << u
+            << " v=" << v;
+        yuv::Nv12RowToBgra(y_row, uv_row, actual, kWidth, isa);
+        ASSERT_EQ(0, memcmp(expected, actual, sizeof(actual)))
+            << "NV12 isa=" << static_cast<int>(isa) << " u=" << u
+            << " v=" << v;
+        yuv::Yuy2RowToBgra(yuy2_row, actual, kWidth, isa);
+        ASSERT_EQ(0, memcmp(expected, actual, sizeof(actual)))
+            << "YUY2 isa=" << static_cast<int>(isa) << " u=" << u
+            << " v=" << v;
+      }
+    }
+  }
+}
+
+// Rows that aren't a multiple of the vector width, or that span several
+// chunks, are converted exactly, without writing past the end.
+TEST(YuvTest, RowWidths) {
+  constexpr uint32_t kMaxWidth = 601;
+  auto y = MakeSamples(kMaxWidth, 1);
+  auto u = MakeSamples(kMaxWidth / 2 + 1, 2);
+  auto v = MakeSamples(kMaxWidth / 2 + 1, 3);
+  std::vector<uint8_t> uv(u.size() * 2);
+  std::vector<uint8_t> yuy2(u.size() * 4);
+  for (size_t i = 0; i < u.size(); ++i) {
+    uv[i * 2] = u[i];
+    uv[i * 2 + 1] = v[i];
+    yuy2[i * 4] = y[std::min<size_t>(i * 2, kMaxWidth - 1)];
+    yuy2[i * 4 + 1] = u[i];
+    yuy2[i * 4 + 2] = y[std::min<size_t>(i * 2 + 1, kMaxWidth - 1)];
+    yuy2[i * 4 + 3] = v[i];
+  }
+  std::vector<uint8_t> expected(kMaxWidth * 4);
+  for (uint32_t x = 0; x < kMaxWidth; ++x) {
+    yuv::YuvToBgra(y[x], u[x / 2], v[x / 2], &expected[x * 4]);
+  }
+
+  for (yuv::Isa isa : kAllIsas) {
+    if (!yuv::IsIsaSupported(isa)) {
+      continue;
+    }
+    for (uint32_t width : {1, 2, 3, 7, 8, 9, 31, 255, 256, 257, 600, 601}) {
+      std::vector<uint8_t> actual(kMaxWidth * 4 + 4, 0xab);
+      yuv::Yv12RowToBgra(y.data(), u.data(), v.data(), actual.data(), width,
+                         isa);
+      EXPECT_TRUE(std::equal(expected.begin(), expected.begin() + width * 4,
+                             actual.begin()))
+          << "YV12 isa=" << static_cast<int>(isa) << " width=" << width;
+      EXPECT_EQ(0xab, actual[width * 4]);
+
+      std::fill(actual.begin(), actual.end(), 0xab);
+      yuv::Nv12RowToBgra(y.data(), uv.data(), actual.data(), width, isa);
+      EXPECT_TRUE(std::equal(expected.begin(), expected.begin() + width * 4,
+                             actual.begin()))
+          << "NV12 isa=" << static_cast<int>(isa) << " width=" << width;
+      EXPECT_EQ(0xab, actual[width * 4]);
+
+      if (width % 2 == 0) {
+        std::fill(actual.begin(), actual.end(), 0xab);
+        yuv::Yuy2RowToBgra(yuy2.data(), actual.data(), width, isa);
+        EXPECT_TRUE(std::equal(expected.begin(), expected.begin() + width * 4,
+                               actual.begin()))
+            << "YUY2 isa=" << static_cast<int>(isa) << " width=" << width;
+        EXPECT_EQ(0xab, actual[width * 4]);
+      }
+    }
+  }
+}
+
+TEST(ImageFormatsTest, Nv12ToBgra) {
+  constexpr uint32_t kWidth = 300;
+  constexpr uint32_t kHeight = 6;
+  auto y = MakeSamples(kWidth * kHeight, 4);
+  auto u = MakeSamples(kWidth / 2 * kHeight / 2, 5);
+  auto v = MakeSamples(kWidth / 2 * kHeight / 2, 6);
+  std::vector<uint8_t> nv12(y);
+  for (size_t i = 0; i < u.size(); ++i) {
+    nv12.push_back(u[i]);
+    nv12.push_back(v[i]);
+  }
+
+  auto convert = image_formats::GetFunctionToConvertToBgra8(MakeImageInfo(
+      ::fuchsia::images::PixelFormat::NV12, kWidth, kHeight, kWidth));
+  std::vector<uint8_t> bgra(kWidth * kHeight * 4);
+  convert(bgra.data(), nv12.data(), kWidth, kHeight);
+  EXPECT_EQ(ReferenceBgra(y, u, v, kWidth, kHeight), bgra);
+}
+
+TEST(ImageFormatsTest, Yv12ToBgra) {
+  constexpr uint32_t kWidth = 300;
+  constexpr uint32_t kHeight = 6;
+  auto y = MakeSamples(kWidth * kHeight, 7);
+  auto u = MakeSamples(kWidth / 2 * kHeight / 2, 8);
+  auto v = MakeSamples(kWidth / 2 * kHeight / 2, 9);
+  std::vector<uint8_t> yv12(y);
+  yv12.insert(yv12.end(), v.begin(), v.end());
+  yv12.insert(yv12.end(), u.begin(), u.end());
+
+  auto convert = image_formats::GetFunctionToConvertToBgra8(MakeImageInfo(
+      ::fuchsia::images::PixelFormat::YV12, kWidth, kHeight, kWidth));
+  std::vector<uint8_t> bgra(kWidth * kHeight * 4);
+  convert(bgra.data(), yv12.data(), kWidth, kHeight);
+  EXPECT_EQ(ReferenceBgra(y, u, v, kWidth, kHeight), bgra);
+}
+
+TEST(ImageFormatsTest, Yuy2ToBgra) {
+  constexpr uint32_t kWidth = 300;
+  constexpr uint32_t kHeight = 4;
+  auto yuy2 = MakeSamples(kWidth * kHeight * 2, 10);
+  std::vector<uint8_t> expected(kWidth * kHeight * 4);
+  for (uint32_t i = 0; i < kWidth * kHeight / 2; ++i) {
+    const uint8_t* in = &yuy2[i * 4];
+    yuv::YuvToBgra(in[0], in[1], in[3], &expected[i * 8]);
+    yuv::YuvToBgra(in[2], in[1], in[3], &expected[i * 8 + 4]);
+  }
+
+  auto info = MakeImageInfo(::fuchsia::images::PixelFormat::YUY2, kWidth,
+                            kHeight, kWidth * 2);
+  std::vector<uint8_t> bgra(kWidth * kHeight * 4);
+  image_formats::GetFunctionToConvertToBgra8(info)(bgra.data(), yuy2.data(),
+                                                   kWidth, kHeight);
+  EXPECT_EQ(expected, bgra);
+
+  // Mirrored, each row of pixels is reversed.
+  info.transform = ::fuchsia::images::Transform::FLIP_HORIZONTAL;
+  image_formats::GetFunctionToConvertToBgra8(info)(bgra.data(), yuy2.data(),
+                                                   kWidth, kHeight);
+  for (uint32_t row = 0; row < kHeight; ++row) {
+    for (uint32_t x = 0; x < kWidth; ++x) {
+      EXPECT_EQ(0, memcmp(&expected[(row * kWidth + x) * 4],
+                          &bgra[(row * kWidth + kWidth - 1 - x) * 4], 4));
+    }
+  }
+}
+
+TEST(ImageFormatsTest, DISABLED_YuvConversionBenchmark) {
+  constexpr uint32_t kFrameCount = 20;
+  const std::pair<uint32_t, uint32_t> kResolutions[] = {
+      {640, 480}, {1280, 720}, {1920, 1080}, {3840, 2160}};
+  for (auto& resolution : kResolutions) {
+    const uint32_t width = resolution.first;
+    const uint32_t height = resolution.second;
+    auto in = MakeSamples(width * height * 2, 11);
+    std::vector<uint8_t> out(width * height * 4);
+    for (yuv::Isa isa : kAllIsas) {
+      if (!yuv::IsIsaSupported(isa)) {
+        continue;
+      }
+      // The same row loops as image_formats, with the instruction set forced.
+      escher::Stopwatch nv12_stopwatch;
+      for (uint32_t frame = 0; frame < kFrameCount; ++frame) {
+        for (uint32_t row = 0; row < height; ++row) {
+          yuv::Nv12RowToBgra(&in[row * width],
+                             &in[(height + row / 2) * width],
+                             &out[row * width * 4], width, isa);
+        }
+      }
+      nv12_stopwatch.Stop();
+      escher::Stopwatch yv12_stopwatch;
+      for (uint32_t frame = 0; frame < kFrameCount; ++frame) {
+        for (uint32_t row = 0; row < height; ++row) {
+          const size_t uv_offset = width * height + row / 2 * width / 2;
+          yuv::Yv12RowToBgra(&in[row * width], &in[uv_offset],
+                             &in[uv_offset + width * height / 4],
+                             &out[row * width * 4], width, isa);
+        }
+      }
+      yv12_stopwatch.Stop();
+      escher::Stopwatch yuy2_stopwatch;
+      for (uint32_t frame = 0; frame < kFrameCount; ++frame) {
+        yuv::Yuy2RowToBgra(in.data(), out.data(), width * height, isa);
+      }
+      yuy2_stopwatch.Stop();
+      FXL_LOG(INFO) << width << "x" << height
+                    << " isa=" << static_cast<int>(isa) << ": NV12 "
+                    << nv12_stopwatch.GetElapsedMicroseconds() / kFrameCount
+                    << " us, YV12 "
+                    << yv12_stopwatch.GetElapsedMicroseconds() / kFrameCount
+                    << " us, YUY2 "
+                    << yuy2_stopwatch.GetElapsedMicroseconds() / kFrameCount
+                    << " us per frame";
+    }
+  }
+}
+
+}  // namespace test
+}  // namespace gfx
+}  // namespace scenic_impl
@@ -22,6 +22,8 @@ class SessionForTest : public Session {
                  ErrorReporter* error_reporter = ErrorReporter::Default());
 
   virtual void TearDown() override;
+
+  using Session::ApplyUpdate;
 };
 
 class SessionHandlerForTest : public SessionHandler {
@@ -3,8 +3,10 @@
 // found in the LICENSE file.
 
 #include "garnet/lib/ui/gfx/resources/nodes/entity_node.h"
+#include "garnet/lib/ui/gfx/resources/nodes/scene.h"
 #include "garnet/lib/ui/gfx/resources/nodes/shape_node.h"
 #include "garnet/lib/ui/gfx/tests/session_test.h"
+#include "lib/escher/util/stopwatch.h"
 #include "lib/ui/scenic/cpp/commands.h"
 
 #include "gtest/gtest.h"
@@ -99,6 +101,209 @@ TEST_F(NodeTest, SettingHitTestBehavior) {
             shape_node->hit_test_behavior());
 }
 
+TEST_F(NodeTest, GlobalTransformFollowsAncestors) {
+  const ResourceId kParentId = 1;
+  const ResourceId kChildId = 2;
+  const ResourceId kGrandchildId = 3;
+  const ResourceId kOtherParentId = 4;
+  EXPECT_TRUE(Apply(scenic::NewCreateEntityNodeCmd(kParentId)));
+  EXPECT_TRUE(Apply(scenic::NewCreateEntityNodeCmd(kChildId)));
+  EXPECT_TRUE(Apply(scenic::NewCreateEntityNodeCmd(kGrandchildId)));
+  EXPECT_TRUE(Apply(scenic::NewCreateEntityNodeCmd(kOtherParentId)));
+  EXPECT_TRUE(Apply(scenic::NewAddChildCmd(kParentId, kChildId)));
+  EXPECT_TRUE(Apply(scenic::NewAddChildCmd(kChildId, kGrandchildId)));
+  auto grandchild = FindResource<Node>(kGrandchildId);
+
+  const float kTranslation[3] = {1.f, 2.f, 3.f};
+  EXPECT_TRUE(Apply(scenic::NewSetTranslationCmd(kChildId, kTranslation)));
+  EXPECT_EQ(escher::vec4(1, 2, 3, 1),
+            grandchild->GetGlobalTransform() * escher::vec4(0, 0, 0, 1));
+
+  // Changing an ancestor's transform invalidates the cached global transform.
+  const float kScale[3] = {2.f, 2.f, 2.f};
+  EXPECT_TRUE(Apply(scenic::NewSetScaleCmd(kParentId, kScale)));
+  EXPECT_EQ(escher::vec4(2, 4, 6, 1),
+            grandchild->GetGlobalTransform() * escher::vec4(0, 0, 0, 1));
+
+  // So does moving the subtree to a different parent.
+  EXPECT_TRUE(Apply(scenic::NewAddChildCmd(kOtherParentId, kChildId)));
+  EXPECT_EQ(escher::vec4(1, 2, 3, 1),
+            grandchild->GetGlobalTransform() * escher::vec4(0, 0, 0, 1));
+  EXPECT_TRUE(Apply(scenic::NewDetachCmd(kChildId)));
+  EXPECT_EQ(escher::vec4(1, 2, 3, 1),
+            grandchild->GetGlobalTransform() * escher::vec4(0, 0, 0, 1));
+  EXPECT_TRUE(Apply(scenic::NewAddChildCmd(kParentId, kChildId)));
+  EXPECT_EQ(escher::vec4(2, 4, 6, 1),
+            grandchild->GetGlobalTransform() * escher::vec4(0, 0, 0, 1));
+}
+
+TEST_F(NodeTest, GlobalTransformEpochIsPerScene) {
+  const ResourceId kSceneId = 1;
+  const ResourceId kOtherSceneId = 2;
+  const ResourceId kParentId = 3;
+  const ResourceId kChildId = 4;
+  const ResourceId kOtherParentId = 5;
+  EXPECT_TRUE(Apply(scenic::NewCreateSceneCmd(kSceneId)));
+  EXPECT_TRUE(Apply(scenic::NewCreateSceneCmd(kOtherSceneId)));
+  EXPECT_TRUE(Apply(scenic::NewCreateEntityNodeCmd(kParentId)));
+  EXPECT_TRUE(Apply(scenic::NewCreateEntityNodeCmd(kChildId)));
+  EXPECT_TRUE(Apply(scenic::NewCreateEntityNodeCmd(kOtherParentId)));
+  EXPECT_TRUE(Apply(scenic::NewAddChildCmd(kSceneId, kParentId)));
+  EXPECT_TRUE(Apply(scenic::NewAddChildCmd(kParentId, kChildId)));
+  EXPECT_TRUE(Apply(scenic::NewAddChildCmd(kOtherSceneId, kOtherParentId)));
+  auto scene = FindResource<Scene>(kSceneId);
+  auto child = FindResource<Node>(kChildId);
+
+  const float kTranslation[3] = {1.f, 2.f, 3.f};
+  EXPECT_TRUE(Apply(scenic::NewSetTranslationCmd(kParentId, kTranslation)));
+  EXPECT_EQ(escher::vec4(1, 2, 3, 1),
+            child->GetGlobalTransform() * escher::vec4(0, 0, 0, 1));
+
+  // Changes in another scene leave this scene's cached transforms current.
+  uint64_t epoch = scene->global_transform_epoch();
+  const float kScale[3] = {2.f, 2.f, 2.f};
+  EXPECT_TRUE(Apply(scenic::NewSetScaleCmd(kOtherParentId, kScale)));
+  EXPECT_EQ(epoch, scene->global_transform_epoch());
+
+  // A node moved between scenes does not trust a transform it validated
+  // against the other scene's epoch.
+  EXPECT_TRUE(Apply(scenic::NewAddChildCmd(kOtherParentId, kChildId)));
+  EXPECT_EQ(escher::vec4(0, 0, 0, 1),
+            child->GetGlobalTransform() * escher::vec4(0, 0, 0, 1));
+  EXPECT_TRUE(
+      Apply(scenic::NewSetTranslationCmd(kOtherParentId, kTranslation)));
+  EXPECT_EQ(escher::vec4(1, 2, 3, 1),
+            child->GetGlobalTransform() * escher::vec4(0, 0, 0, 1));
+  EXPECT_EQ(epoch, scene->global_transform_epoch());
+}
+
+TEST_F(NodeTest, MetricsOnlyReportedWhenChanged) {
+  const ResourceId kSceneId = 1;
+  const ResourceId kParentId = 2;
+  const ResourceId kChildId = 3;
+  const ResourceId kSiblingId = 4;
+  EXPECT_TRUE(Apply(scenic::NewCreateSceneCmd(kSceneId)));
+  EXPECT_TRUE(Apply(scenic::NewCreateEntityNodeCmd(kParentId)));
+  EXPECT_TRUE(Apply(scenic::NewCreateEntityNodeCmd(kChildId)));
+  EXPECT_TRUE(Apply(scenic::NewCreateEntityNodeCmd(kSiblingId)));
+  EXPECT_TRUE(Apply(scenic::NewAddChildCmd(kSceneId, kParentId)));
+  EXPECT_TRUE(Apply(scenic::NewAddChildCmd(kSceneId, kSiblingId)));
+  EXPECT_TRUE(Apply(scenic::NewAddChildCmd(kParentId, kChildId)));
+  EXPECT_TRUE(Apply(scenic::NewSetEventMaskCmd(
+      kChildId, ::fuchsia::ui::gfx::kMetricsEventMask)));
+  auto scene = FindResource<Scene>(kSceneId);
+  auto child = FindResource<Node>(kChildId);
+
+  std::vector<Node*> updated_nodes;
+  scene->UpdateMetrics(&updated_nodes);
+  ASSERT_EQ(1U, updated_nodes.size());
+  EXPECT_EQ(child.get(), updated_nodes[0]);
+  EXPECT_EQ(1.f, child->reported_metrics().scale_x);
+
+  // Nothing changed.
+  updated_nodes.clear();
+  scene->UpdateMetrics(&updated_nodes);
+  EXPECT_TRUE(updated_nodes.empty());
+
+  // Changes which don't affect the child's metrics.
+  const float kTranslation[3] = {1.f, 2.f, 3.f};
+  const float kScale[3] = {2.f, 3.f, 4.f};
+  EXPECT_TRUE(Apply(scenic::NewSetTranslationCmd(kParentId, kTranslation)));
+  EXPECT_TRUE(Apply(scenic::NewSetScaleCmd(kSiblingId, kScale)));
+  scene->UpdateMetrics(&updated_nodes);
+  EXPECT_TRUE(updated_nodes.empty());
+
+  // Scaling an ancestor changes the child's metrics.
+  EXPECT_TRUE(Apply(scenic::NewSetScaleCmd(kParentId, kScale)));
+  scene->UpdateMetrics(&updated_nodes);
+  ASSERT_EQ(1U, updated_nodes.size());
+  EXPECT_EQ(2.f, child->reported_metrics().scale_x);
+  EXPECT_EQ(3.f, child->reported_metrics().scale_y);
+  EXPECT_EQ(4.f, child->reported_metrics().scale_z);
+
+  // So does moving the child to a differently-scaled parent.
+  updated_nodes.clear();
+  EXPECT_TRUE(Apply(scenic::NewAddChildCmd(kSiblingId, kChildId)));
+  scene->UpdateMetrics(&updated_nodes);
+  EXPECT_TRUE(updated_nodes.empty());
+  EXPECT_TRUE(Apply(scenic::NewAddChildCmd(kSceneId, kChildId)));
+  scene->UpdateMetrics(&updated_nodes);
+  ASSERT_EQ(1U, updated_nodes.size());
+  EXPECT_EQ(1.f, child->reported_metrics().scale_x);
+
+  // Resubscribing to metrics events reports the current metrics again.
+  updated_nodes.clear();
+  EXPECT_TRUE(Apply(scenic::NewSetEventMaskCmd(kChildId, 0)));
+  scene->UpdateMetrics(&updated_nodes);
+  EXPECT_TRUE(updated_nodes.empty());
+  EXPECT_TRUE(Apply(scenic::NewSetEventMaskCmd(
+      kChildId, ::fuchsia::ui::gfx::kMetricsEventMask)));
+  scene->UpdateMetrics(&updated_nodes);
+  ASSERT_EQ(1U, updated_nodes.size());
+  EXPECT_EQ(1.f, child->reported_metrics().scale_x);
+}
+
+// Reports the per-frame cost of updating metrics and global transforms in a
+// synthetic scene of more than 10k nodes: a scene with 100 "views", each with
+// 100 "widgets", all of which subscribe to metrics events.
+TEST_F(NodeTest, DISABLED_LargeSceneUpdateBenchmark) {
+  constexpr ResourceId kSceneId = 1;
+  constexpr size_t kViewCount = 100;
+  constexpr size_t kWidgetsPerView = 100;
+  constexpr size_t kFrameCount = 100;
+  const float kScale[2][3] = {{1.f, 1.f, 1.f}, {2.f, 2.f, 2.f}};
+
+  EXPECT_TRUE(Apply(scenic::NewCreateSceneCmd(kSceneId)));
+  ResourceId next_id = kSceneId + 1;
+  std::vector<ResourceId> view_ids;
+  std::vector<NodePtr> widgets;
+  for (size_t i = 0; i < kViewCount; ++i) {
+    const ResourceId view_id = next_id++;
+    view_ids.push_back(view_id);
+    EXPECT_TRUE(Apply(scenic::NewCreateEntityNodeCmd(view_id)));
+    EXPECT_TRUE(Apply(scenic::NewAddChildCmd(kSceneId, view_id)));
+    for (size_t j = 0; j < kWidgetsPerView; ++j) {
+      const ResourceId widget_id = next_id++;
+      EXPECT_TRUE(Apply(scenic::NewCreateEntityNodeCmd(widget_id)));
+      EXPECT_TRUE(Apply(scenic::NewAddChildCmd(view_id, widget_id)));
+      EXPECT_TRUE(Apply(scenic::NewSetEventMaskCmd(
+          widget_id, ::fuchsia::ui::gfx::kMetricsEventMask)));
+      widgets.push_back(FindResource<Node>(widget_id));
+    }
+  }
+  auto scene = FindResource<Scene>(kSceneId);
+  std::vector<Node*> updated_nodes;
+  scene->UpdateMetrics(&updated_nodes);
+  EXPECT_EQ(kViewCount * kWidgetsPerView, updated_nodes.size());
+
+  // Each frame, apply |changes_per_frame| scale changes to views, then update
+  // metrics and the global transforms of every widget (as rendering does).
+  for (size_t changes_per_frame : {0, 1, 10, 100}) {
+    escher::Stopwatch metrics_stopwatch(false);
+    escher::Stopwatch transform_stopwatch(false);
+    for (size_t frame = 0; frame < kFrameCount; ++frame) {
+      for (size_t i = 0; i < changes_per_frame; ++i) {
+        EXPECT_TRUE(Apply(
+            scenic::NewSetScaleCmd(view_ids[i], kScale[frame % 2])));
+      }
+      updated_nodes.clear();
+      metrics_stopwatch.Start();
+      scene->UpdateMetrics(&updated_nodes);
+      metrics_stopwatch.Stop();
+      transform_stopwatch.Start();
+      for (auto& widget : widgets) {
+        widget->GetGlobalTransform();
+      }
+      transform_stopwatch.Stop();
+    }
+    FXL_LOG(INFO) << changes_per_frame << " views changed per frame: "
+                  << metrics_stopwatch.GetElapsedMicroseconds() / kFrameCount
+                  << " us/frame updating metrics, "
+                  << transform_stopwatch.GetElapsedMicroseconds() / kFrameCount
+                  << " us/frame computing global transforms";
+  }
+}
+
 }  // namespace test
 }  // namespace gfx
 }  // namespace scenic_impl
@@ -3,9 +3,11 @@
 // found in the LICENSE file.
 
 #include "garnet/lib/ui/gfx/resources/material.h"
+#include "garnet/lib/ui/gfx/resources/nodes/entity_node.h"
 #include "garnet/lib/ui/gfx/resources/nodes/shape_node.h"
 #include "garnet/lib/ui/gfx/resources/shapes/circle_shape.h"
 #include "garnet/lib/ui/gfx/tests/session_test.h"
+#include "lib/escher/util/stopwatch.h"
 #include "lib/ui/scenic/cpp/commands.h"
 
 #include "gtest/gtest.h"
@@ -103,6 +105,87 @@ TEST_F(SessionTest, Labeling) {
             shape_node->label());
 }
 
+TEST_F(SessionTest, ManyResources) {
+  // Enough resources for the ResourceMap to grow several times, with IDs that
+  // are neither small nor sequential.
+  constexpr ResourceId kCount = 1000;
+  auto id = [](ResourceId i) { return (i * 7919) << 8; };
+  for (ResourceId i = 1; i <= kCount; ++i) {
+    EXPECT_TRUE(Apply(scenic::NewCreateEntityNodeCmd(id(i))));
+  }
+  for (ResourceId i = 1; i <= kCount; i += 2) {
+    EXPECT_TRUE(Apply(scenic::NewReleaseResourceCmd(id(i))));
+  }
+  EXPECT_EQ(kCount / 2, session_->GetMappedResourceCount());
+  for (ResourceId i = 1; i <= kCount; ++i) {
+    auto node = session_->resources()->FindResource<EntityNode>(
+        id(i), ResourceMap::ErrorBehavior::kDontReportErrors);
+    EXPECT_EQ(i % 2 == 0, static_cast<bool>(node)) << "i=" << i;
+  }
+  EXPECT_FALSE(Apply(scenic::NewReleaseResourceCmd(id(1))));
+  ExpectLastReportedError(
+      "scenic::gfx::ResourceMap::RemoveResource(): no resource with ID "
+      "2027264");
+}
+
+TEST_F(SessionTest, ApplyUpdate) {
+  EXPECT_TRUE(Apply(scenic::NewCreateEntityNodeCmd(1)));
+  EXPECT_TRUE(Apply(scenic::NewCreateEntityNodeCmd(2)));
+  auto node1 = FindResource<EntityNode>(1);
+  auto node2 = FindResource<EntityNode>(2);
+
+  // Runs of commands are applied in order, and a run stops at the first
+  // failure, leaving later commands unapplied.
+  auto translate = [](ResourceId id, float x) {
+    return scenic::NewSetTranslationCmd(id, (float[3]){x, 0.f, 0.f});
+  };
+  std::vector<::fuchsia::ui::gfx::Command> commands;
+  commands.push_back(translate(1, 1.f));
+  commands.push_back(translate(2, 2.f));
+  commands.push_back(translate(1, 3.f));
+  commands.push_back(scenic::NewSetScaleCmd(2, (float[3]){2.f, 2.f, 2.f}));
+  commands.push_back(scenic::NewSetTagCmd(1, 10));
+  commands.push_back(translate(3, 4.f));
+  commands.push_back(translate(2, 5.f));
+  EXPECT_FALSE(session_->ApplyUpdate(&commands));
+  EXPECT_EQ(escher::vec3(3.f, 0.f, 0.f), node1->translation());
+  EXPECT_EQ(escher::vec3(2.f, 0.f, 0.f), node2->translation());
+  EXPECT_EQ(escher::vec3(2.f, 2.f, 2.f), node2->scale());
+  EXPECT_EQ(10U, node1->tag_value());
+}
+
+TEST_F(SessionTest, DISABLED_ApplyUpdateBenchmark) {
+  constexpr ResourceId kNodeCount = 1000;
+  constexpr size_t kCommandsPerFrame = 100000;
+  constexpr size_t kFrameCount = 10;
+  for (ResourceId id = 1; id <= kNodeCount; ++id) {
+    EXPECT_TRUE(Apply(scenic::NewCreateEntityNodeCmd(id)));
+  }
+
+  // Each frame translates and scales every node many times over, as an
+  // animating client with a large scene would.
+  escher::Stopwatch stopwatch(false);
+  std::vector<::fuchsia::ui::gfx::Command> commands;
+  for (size_t frame = 0; frame < kFrameCount; ++frame) {
+    commands.clear();
+    const float value[3] = {1.f + frame, 1.f, 1.f};
+    while (commands.size() < kCommandsPerFrame) {
+      for (ResourceId id = 1; id <= kNodeCount; ++id) {
+        commands.push_back(scenic::NewSetTranslationCmd(id, value));
+      }
+      for (ResourceId id = 1; id <= kNodeCount; ++id) {
+        commands.push_back(scenic::NewSetScaleCmd(id, value));
+      }
+    }
+    stopwatch.Start();
+    EXPECT_TRUE(session_->ApplyUpdate(&commands));
+    stopwatch.Stop();
+  }
+  FXL_LOG(INFO) << "Applied " << kCommandsPerFrame << " commands in "
+                << stopwatch.GetElapsedMicroseconds() / kFrameCount
+                << " us/frame";
+}
+
 // TODO:
 // - test that FindResource() cannot return resources that have the wrong type.
 
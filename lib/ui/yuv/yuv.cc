@@ -4,6 +4,18 @@
 
 #include "garnet/lib/ui/yuv/yuv.h"
 
+#include <string.h>
+#include <algorithm>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <cpuid.h>
+#include <immintrin.h>
+#define YUV_HAS_X86 1
+#elif defined(__aarch64__)
+#include <arm_neon.h>
+#define YUV_HAS_NEON 1
+#endif
+
 namespace {
 
 uint8_t clip(int in) {
@@ -11,6 +23,219 @@ uint8_t clip(int in) {
   return out > 255 ? 255 : (out & 0xff);
 }
 
+// Converts |count| pixels from planar Y, U and V samples, where pixel i uses
+// U and V sample i / 2.  The row functions for the interleaved formats
+// separate the planes a chunk at a time, so that each instruction set needs
+// only this one kernel.
+//
+// The SIMD kernels compute the same integer expressions as YuvToBgra(), but
+// shift rather than divide by 256.  The two only differ for negative values,
+// which are clipped to 0 either way.
+using ConvertPixelsFunction = void (*)(const uint8_t* y, const uint8_t* u,
+                                       const uint8_t* v, uint8_t* bgra,
+                                       uint32_t count);
+
+// The number of pixels in each chunk of an interleaved row; must be even.
+constexpr uint32_t kChunkSize = 256;
+
+void ConvertPixelsScalar(const uint8_t* y, const uint8_t* u, const uint8_t* v,
+                         uint8_t* bgra, uint32_t count) {
+  for (uint32_t i = 0; i < count; ++i) {
+    yuv::YuvToBgra(y[i], u[i / 2], v[i / 2], bgra + 4 * i);
+  }
+}
+
+uint32_t Load32(const uint8_t* p) {
+  uint32_t value;
+  memcpy(&value, p, sizeof(value));
+  return value;
+}
+
+#if YUV_HAS_X86
+
+uint16_t Load16(const uint8_t* p) {
+  uint16_t value;
+  memcpy(&value, p, sizeof(value));
+  return value;
+}
+
+__m128i Load64(const uint8_t* p) {
+  return _mm_loadl_epi64(reinterpret_cast<const __m128i*>(p));
+}
+
+// Converts 4 pixels at a time, in 32-bit lanes: 298 * 255 doesn't fit in 16.
+__attribute__((target("sse4.1"))) void ConvertPixelsSse41(
+    const uint8_t* y, const uint8_t* u, const uint8_t* v, uint8_t* bgra,
+    uint32_t count) {
+  const __m128i k16 = _mm_set1_epi32(16);
+  const __m128i k128 = _mm_set1_epi32(128);
+  const __m128i k255 = _mm_set1_epi32(255);
+  const __m128i kZero = _mm_setzero_si128();
+  const __m128i kAlpha = _mm_set1_epi32(static_cast<int32_t>(0xff000000));
+  uint32_t i = 0;
+  for (; i + 4 <= count; i += 4) {
+    __m128i yy = _mm_cvtepu8_epi32(_mm_cvtsi32_si128(Load32(y + i)));
+    // Duplicate each of 2 U and V samples for 2 pixels.
+    __m128i uu = _mm_shuffle_epi32(
+        _mm_cvtepu8_epi32(_mm_cvtsi32_si128(Load16(u + i / 2))), 0x50);
+    __m128i vv = _mm_shuffle_epi32(
+        _mm_cvtepu8_epi32(_mm_cvtsi32_si128(Load16(v + i / 2))), 0x50);
+    yy = _mm_add_epi32(
+        _mm_mullo_epi32(_mm_sub_epi32(yy, k16), _mm_set1_epi32(298)), k128);
+    uu = _mm_sub_epi32(uu, k128);
+    vv = _mm_sub_epi32(vv, k128);
+
+    __m128i b = _mm_add_epi32(yy, _mm_mullo_epi32(uu, _mm_set1_epi32(516)));
+    __m128i g = _mm_sub_epi32(
+        _mm_sub_epi32(yy, _mm_mullo_epi32(vv, _mm_set1_epi32(208))),
+        _mm_mullo_epi32(uu, _mm_set1_epi32(100)));
+    __m128i r = _mm_add_epi32(yy, _mm_mullo_epi32(vv, _mm_set1_epi32(409)));
+    b = _mm_min_epi32(_mm_max_epi32(_mm_srai_epi32(b, 8), kZero), k255);
+    g = _mm_min_epi32(_mm_max_epi32(_mm_srai_epi32(g, 8), kZero), k255);
+    r = _mm_min_epi32(_mm_max_epi32(_mm_srai_epi32(r, 8), kZero), k255);
+
+    __m128i bgra_pixels = _mm_or_si128(
+        _mm_or_si128(b, _mm_slli_epi32(g, 8)),
+        _mm_or_si128(_mm_slli_epi32(r, 16), kAlpha));
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(bgra + 4 * i), bgra_pixels);
+  }
+  ConvertPixelsScalar(y + i, u + i / 2, v + i / 2, bgra + 4 * i, count - i);
+}
+
+// The same as ConvertPixelsSse41(), but 8 pixels at a time.
+__attribute__((target("avx2"))) void ConvertPixelsAvx2(
+    const uint8_t* y, const uint8_t* u, const uint8_t* v, uint8_t* bgra,
+    uint32_t count) {
+  const __m256i k16 = _mm256_set1_epi32(16);
+  const __m256i k128 = _mm256_set1_epi32(128);
+  const __m256i k255 = _mm256_set1_epi32(255);
+  const __m256i kZero = _mm256_setzero_si256();
+  const __m256i kAlpha = _mm256_set1_epi32(static_cast<int32_t>(0xff000000));
+  const __m256i kDuplicate = _mm256_setr_epi32(0, 0, 1, 1, 2, 2, 3, 3);
+  uint32_t i = 0;
+  for (; i + 8 <= count; i += 8) {
+    __m256i yy = _mm256_cvtepu8_epi32(Load64(y + i));
+    __m256i uu = _mm256_permutevar8x32_epi32(
+        _mm256_cvtepu8_epi32(_mm_cvtsi32_si128(Load32(u + i / 2))),
+        kDuplicate);
+    __m256i vv = _mm256_permutevar8x32_epi32(
+        _mm256_cvtepu8_epi32(_mm_cvtsi32_si128(Load32(v + i / 2))),
+        kDuplicate);
+    yy = _mm256_add_epi32(
+        _mm256_mullo_epi32(_mm256_sub_epi32(yy, k16), _mm256_set1_epi32(298)),
+        k128);
+    uu = _mm256_sub_epi32(uu, k128);
+    vv = _mm256_sub_epi32(vv, k128);
+
+    __m256i b =
+        _mm256_add_epi32(yy, _mm256_mullo_epi32(uu, _mm256_set1_epi32(516)));
+    __m256i g = _mm256_sub_epi32(
+        _mm256_sub_epi32(yy, _mm256_mullo_epi32(vv, _mm256_set1_epi32(208))),
+        _mm256_mullo_epi32(uu, _mm256_set1_epi32(100)));
+    __m256i r =
+        _mm256_add_epi32(yy, _mm256_mullo_epi32(vv, _mm256_set1_epi32(409)));
+    b = _mm256_min_epi32(_mm256_max_epi32(_mm256_srai_epi32(b, 8), kZero),
+                         k255);
+    g = _mm256_min_epi32(_mm256_max_epi32(_mm256_srai_epi32(g, 8), kZero),
+                         k255);
+    r = _mm256_min_epi32(_mm256_max_epi32(_mm256_srai_epi32(r, 8), kZero),
+                         k255);
+
+    __m256i bgra_pixels = _mm256_or_si256(
+        _mm256_or_si256(b, _mm256_slli_epi32(g, 8)),
+        _mm256_or_si256(_mm256_slli_epi32(r, 16), kAlpha));
+    _mm256_storeu_si256(reinterpret_cast<__m256i*>(bgra + 4 * i),
+                        bgra_pixels);
+  }
+  ConvertPixelsScalar(y + i, u + i / 2, v + i / 2, bgra + 4 * i, count - i);
+}
+
+bool CpuSupportsSse41() {
+  unsigned int eax, ebx, ecx, edx;
+  return __get_cpuid(1, &eax, &ebx, &ecx, &edx) && (ecx & bit_SSE4_1);
+}
+
+bool CpuSupportsAvx2() {
+  unsigned int eax, ebx, ecx, edx;
+  if (!__get_cpuid(1, &eax, &ebx, &ecx, &edx) || !(ecx & bit_OSXSAVE)) {
+    return false;
+  }
+  // The OS must also save the AVX registers on context switches.
+  uint32_t xcr0_low, xcr0_high;
+  __asm__("xgetbv" : "=a"(xcr0_low), "=d"(xcr0_high) : "c"(0));
+  if ((xcr0_low & 0x6) != 0x6) {
+    return false;
+  }
+  return __get_cpuid_count(7, 0, &eax, &ebx, &ecx, &edx) && (ebx & bit_AVX2);
+}
+
+#endif  // YUV_HAS_X86
+
+#if YUV_HAS_NEON
+
+// Converts 8 pixels at a time.  Products are accumulated in 32-bit lanes, and
+// the saturating narrowing shift and move perform the clipping.
+void ConvertPixelsNeon(const uint8_t* y, const uint8_t* u, const uint8_t* v,
+                       uint8_t* bgra, uint32_t count) {
+  const int16x8_t k16 = vdupq_n_s16(16);
+  const int16x8_t k128 = vdupq_n_s16(128);
+  const int32x4_t k128_32 = vdupq_n_s32(128);
+  uint32_t i = 0;
+  for (; i + 8 <= count; i += 8) {
+    int16x8_t yy =
+        vsubq_s16(vreinterpretq_s16_u16(vmovl_u8(vld1_u8(y + i))), k16);
+    // Duplicate each of 4 U and V samples for 2 pixels.
+    uint8x8_t u4 = vreinterpret_u8_u32(vdup_n_u32(Load32(u + i / 2)));
+    uint8x8_t v4 = vreinterpret_u8_u32(vdup_n_u32(Load32(v + i / 2)));
+    int16x8_t uu = vsubq_s16(
+        vreinterpretq_s16_u16(vmovl_u8(vzip_u8(u4, u4).val[0])), k128);
+    int16x8_t vv = vsubq_s16(
+        vreinterpretq_s16_u16(vmovl_u8(vzip_u8(v4, v4).val[0])), k128);
+
+    int32x4_t y_lo = vmlal_n_s16(k128_32, vget_low_s16(yy), 298);
+    int32x4_t y_hi = vmlal_n_s16(k128_32, vget_high_s16(yy), 298);
+
+    int32x4_t b_lo = vmlal_n_s16(y_lo, vget_low_s16(uu), 516);
+    int32x4_t b_hi = vmlal_n_s16(y_hi, vget_high_s16(uu), 516);
+    int32x4_t g_lo = vmlsl_n_s16(vmlsl_n_s16(y_lo, vget_low_s16(vv), 208),
+                                 vget_low_s16(uu), 100);
+    int32x4_t g_hi = vmlsl_n_s16(vmlsl_n_s16(y_hi, vget_high_s16(vv), 208),
+                                 vget_high_s16(uu), 100);
+    int32x4_t r_lo = vmlal_n_s16(y_lo, vget_low_s16(vv), 409);
+    int32x4_t r_hi = vmlal_n_s16(y_hi, vget_high_s16(vv), 409);
+
+    uint8x8x4_t bgra_pixels;
+    bgra_pixels.val[0] = vqmovn_u16(
+        vcombine_u16(vqshrun_n_s32(b_lo, 8), vqshrun_n_s32(b_hi, 8)));
+    bgra_pixels.val[1] = vqmovn_u16(
+        vcombine_u16(vqshrun_n_s32(g_lo, 8), vqshrun_n_s32(g_hi, 8)));
+    bgra_pixels.val[2] = vqmovn_u16(
+        vcombine_u16(vqshrun_n_s32(r_lo, 8), vqshrun_n_s32(r_hi, 8)));
+    bgra_pixels.val[3] = vdup_n_u8(0xff);
+    vst4_u8(bgra + 4 * i, bgra_pixels);
+  }
+  ConvertPixelsScalar(y + i, u + i / 2, v + i / 2, bgra + 4 * i, count - i);
+}
+
+#endif  // YUV_HAS_NEON
+
+ConvertPixelsFunction GetConvertPixelsFunction(yuv::Isa isa) {
+  switch (isa) {
+#if YUV_HAS_X86
+    case yuv::Isa::kSse41:
+      return ConvertPixelsSse41;
+    case yuv::Isa::kAvx2:
+      return ConvertPixelsAvx2;
+#endif
+#if YUV_HAS_NEON
+    case yuv::Isa::kNeon:
+      return ConvertPixelsNeon;
+#endif
+    default:
+      return ConvertPixelsScalar;
+  }
+}
+
 }  // namespace
 
 namespace yuv {
@@ -26,4 +251,76 @@ void YuvToBgra(uint8_t y_raw, uint8_t u_raw, uint8_t v_raw, uint8_t* bgra) {
   bgra[3] = 0xff;                                         // alpha
 }
 
+bool IsIsaSupported(Isa isa) {
+  switch (isa) {
+    case Isa::kScalar:
+      return true;
+#if YUV_HAS_X86
+    case Isa::kSse41:
+      return CpuSupportsSse41();
+    case Isa::kAvx2:
+      return CpuSupportsAvx2();
+#endif
+#if YUV_HAS_NEON
+    case Isa::kNeon:
+      // NEON is mandatory on arm64.
+      return true;
+#endif
+    default:
+      return false;
+  }
+}
+
+Isa GetBestIsa() {
+  static const Isa best_isa = [] {
+    for (Isa isa : {Isa::kAvx2, Isa::kSse41, Isa::kNeon}) {
+      if (IsIsaSupported(isa)) {
+        return isa;
+      }
+    }
+    return Isa::kScalar;
+  }();
+  return best_isa;
+}
+
+void Nv12RowToBgra(const uint8_t* y, const uint8_t* uv, uint8_t* bgra,
+                   uint32_t width, Isa isa) {
+  ConvertPixelsFunction convert = GetConvertPixelsFunction(isa);
+  uint8_t u_chunk[kChunkSize / 2];
+  uint8_t v_chunk[kChunkSize / 2];
+  for (uint32_t x = 0; x < width; x += kChunkSize) {
+    const uint32_t count = std::min(kChunkSize, width - x);
+    const uint8_t* uv_iter = uv + x;
+    for (uint32_t i = 0; i < (count + 1) / 2; ++i) {
+      u_chunk[i] = uv_iter[2 * i];
+      v_chunk[i] = uv_iter[2 * i + 1];
+    }
+    convert(y + x, u_chunk, v_chunk, bgra + 4 * x, count);
+  }
+}
+
+void Yv12RowToBgra(const uint8_t* y, const uint8_t* u, const uint8_t* v,
+                   uint8_t* bgra, uint32_t width, Isa isa) {
+  GetConvertPixelsFunction(isa)(y, u, v, bgra, width);
+}
+
+void Yuy2RowToBgra(const uint8_t* yuy2, uint8_t* bgra, uint32_t width,
+                   Isa isa) {
+  ConvertPixelsFunction convert = GetConvertPixelsFunction(isa);
+  uint8_t y_chunk[kChunkSize];
+  uint8_t u_chunk[kChunkSize / 2];
+  uint8_t v_chunk[kChunkSize / 2];
+  for (uint32_t x = 0; x < width; x += kChunkSize) {
+    const uint32_t count = std::min(kChunkSize, width - x);
+    const uint8_t* yuy2_iter = yuy2 + 2 * x;
+    for (uint32_t i = 0; i < count / 2; ++i) {
+      y_chunk[2 * i] = yuy2_iter[4 * i];
+      u_chunk[i] = yuy2_iter[4 * i + 1];
+      y_chunk[2 * i + 1] = yuy2_iter[4 * i + 2];
+      v_chunk[i] = yuy2_iter[4 * i + 3];
+    }
+    convert(y_chunk, u_chunk, v_chunk, bgra + 4 * x, count);
+  }
+}
+
 }  // namespace yuv
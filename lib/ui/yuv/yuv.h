@@ -9,8 +9,42 @@
 
 namespace yuv {
 
+// Converts a single pixel.  This is the reference for all of the functions
+// below, which produce bit-identical results.
 void YuvToBgra(uint8_t y_raw, uint8_t u_raw, uint8_t v_raw, uint8_t* bgra);
 
+// The instruction sets with which rows of pixels can be converted.
+enum class Isa {
+  kScalar,
+  kSse41,
+  kAvx2,
+  kNeon,
+};
+
+// Returns true if the current CPU can execute |isa|.
+bool IsIsaSupported(Isa isa);
+
+// Returns the fastest instruction set supported by the current CPU.  This is
+// the default for the row conversion functions, and is only determined once.
+Isa GetBestIsa();
+
+// Each of the following converts one row of |width| pixels to BGRA, writing
+// |width| * 4 bytes to |bgra|.  The U and V samples are horizontally
+// subsampled: pixel x uses sample x / 2.  |isa| must be supported.
+
+// NV12: |uv| holds interleaved U and V samples.
+void Nv12RowToBgra(const uint8_t* y, const uint8_t* uv, uint8_t* bgra,
+                   uint32_t width, Isa isa = GetBestIsa());
+
+// YV12 (and I420): |u| and |v| are separate planes.
+void Yv12RowToBgra(const uint8_t* y, const uint8_t* u, const uint8_t* v,
+                   uint8_t* bgra, uint32_t width, Isa isa = GetBestIsa());
+
+// YUY2: |yuy2| holds 4 bytes (Y0, U, Y1, V) for each pair of pixels, so
+// |width| must be even.
+void Yuy2RowToBgra(const uint8_t* yuy2, uint8_t* bgra, uint32_t width,
+                   Isa isa = GetBestIsa());
+
 }  // namespace yuv
 
 #endif  // GARNET_LIB_UI_YUV_YUV_H_
@@ -737,6 +737,7 @@ struct AmsduSubframeHeader {
     uint16_t msdu_len_be;  // Stored in network byte order. Use accessors.
 
     uint16_t msdu_len() const { return be16toh(msdu_len_be); }
+    void set_msdu_len(uint16_t msdu_len) { msdu_len_be = htobe16(msdu_len); }
 
     constexpr size_t len() const { return sizeof(*this); }
     static constexpr size_t max_len() { return sizeof(AmsduSubframeHeader); }
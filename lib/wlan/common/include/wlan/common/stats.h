@@ -123,6 +123,8 @@ struct ClientMlmeStats {
     PacketCounter mgmt_frame;
     PacketCounter tx_frame;
     PacketCounter rx_frame;
+    PacketCounter amsdu;
+    PacketCounter msdu;
     RssiStats assoc_data_rssi;
     RssiStats beacon_rssi;
     ::fuchsia::wlan::stats::ClientMlmeStats ToFidl() const {
@@ -131,6 +133,8 @@ struct ClientMlmeStats {
                                                        .mgmt_frame = mgmt_frame.ToFidl(),
                                                        .tx_frame = tx_frame.ToFidl(),
                                                        .rx_frame = rx_frame.ToFidl(),
+                                                       .amsdu = amsdu.ToFidl(),
+                                                       .msdu = msdu.ToFidl(),
                                                        .assoc_data_rssi = assoc_data_rssi.ToFidl(),
                                                        .beacon_rssi = beacon_rssi.ToFidl()};
     };
@@ -140,6 +144,8 @@ struct ClientMlmeStats {
         mgmt_frame.Reset();
         tx_frame.Reset();
         rx_frame.Reset();
+        amsdu.Reset();
+        msdu.Reset();
         assoc_data_rssi.Reset();
         beacon_rssi.Reset();
     }
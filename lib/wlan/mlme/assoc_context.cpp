@@ -126,4 +126,18 @@ zx_status_t ParseAssocRespIe(const uint8_t* ie_chains, size_t ie_chains_len,
     return ZX_OK;
 }
 
+size_t AssocContext::MaxTxAmsduLen() const {
+    // A-MSDUs are carried in QoS data frames, which are only sent to HT and VHT peers.
+    if (!ht_cap.has_value() || (phy != WLAN_PHY_HT && phy != WLAN_PHY_VHT)) { return 0; }
+
+    // Once associated, |ht_cap| is the intersection of both sides' capabilities, so this is no
+    // larger than what the peer can receive. IEEE Std 802.11-2016, 9.4.2.56.2
+    switch (ht_cap->ht_cap_info.max_amsdu_len()) {
+    case HtCapabilityInfo::OCTETS_7935:
+        return 7935;
+    default:
+        return 3839;
+    }
+}
+
 }  // namespace wlan
@@ -653,6 +653,8 @@ zx_status_t Station::HandleDataFrame(DataFrame<LlcHeader>&& frame) {
     const auto& src = data_hdr->addr3;
     const auto& dest = data_hdr->addr1;
     size_t llc_payload_len = llc_frame.body_len();
+    WLAN_STATS_INC(msdu.in);
+    WLAN_STATS_ADD(llc_payload_len, msdu.in_bytes);
     return HandleLlcFrame(llc_frame, llc_payload_len, src, dest);
 }
 
@@ -695,15 +697,22 @@ zx_status_t Station::HandleAmsduFrame(DataFrame<AmsduSubframeHeader>&& frame) {
     // Non-DMG stations use basic subframe format only.
     if (data_amsdu_frame.body_len() == 0) { return ZX_OK; }
     finspect("Inbound AMSDU: len %zu\n", data_amsdu_frame.body_len());
+    WLAN_STATS_INC(amsdu.in);
+    WLAN_STATS_ADD(data_amsdu_frame.body_len(), amsdu.in_bytes);
 
     // TODO(porce): The received AMSDU should not be greater than max_amsdu_len, specified in
     // HtCapabilities IE of Association. Warn or discard if violated.
 
     const auto& src = data_amsdu_frame.hdr()->addr3;
     const auto& dest = data_amsdu_frame.hdr()->addr1;
-    DeaggregateAmsdu(data_amsdu_frame, [&](FrameView<LlcHeader> llc_frame, size_t payload_len) {
-        HandleLlcFrame(llc_frame, payload_len, src, dest);
-    });
+    auto status = DeaggregateAmsdu(
+        data_amsdu_frame, [&](FrameView<LlcHeader> llc_frame, size_t payload_len) {
+            WLAN_STATS_INC(msdu.in);
+            WLAN_STATS_ADD(payload_len, msdu.in_bytes);
+            HandleLlcFrame(llc_frame, payload_len, src, dest);
+        });
+    // MSDUs which precede a malformed subframe have been delivered already.
+    if (status != ZX_OK) { WLAN_STATS_INC(amsdu.drop); }
 
     return ZX_OK;
 }
@@ -793,8 +802,14 @@ zx_status_t Station::HandleEthFrame(EthFrame&& eth_frame) {
     finspect("  frame   : %s\n", debug::HexDump(packet->data(), packet->len()).c_str());
 
     auto status = SendWlan(fbl::move(packet), cbw, phy);
-    if (status != ZX_OK) { errorf("could not send wlan data: %d\n", status); }
-    return status;
+    if (status != ZX_OK) {
+        errorf("could not send wlan data: %d\n", status);
+        WLAN_STATS_INC(msdu.drop);
+        return status;
+    }
+    WLAN_STATS_INC(msdu.out);
+    WLAN_STATS_ADD(eth_frame.body_len(), msdu.out_bytes);
+    return ZX_OK;
 }
 
 zx_status_t Station::HandleTimeout() {
@@ -1045,12 +1060,110 @@ void Station::BackToMainChannel() {
 }
 
 void Station::SendBufferedUnits() {
+    // Buffered frames are sent back to back, so they are aggregated into A-MSDUs if the association
+    // allows it. A-MSDUs are kept small enough for a large buffer, as huge buffers are scarce.
+    const size_t max_amsdu_len = std::min(assoc_ctx_.MaxTxAmsduLen(),
+                                          kLargeBufferSize - DataFrameHeader::max_len());
+    std::vector<EthFrame> msdus;
+    size_t amsdu_len = 0;
     while (bu_queue_.size() > 0) {
         fbl::unique_ptr<Packet> packet = bu_queue_.Dequeue();
         debugps("sending buffered frame; queue size at: %lu\n", bu_queue_.size());
         ZX_DEBUG_ASSERT(packet->peer() == Packet::Peer::kEthernet);
-        HandleEthFrame(EthFrame(fbl::move(packet)));
+        EthFrame eth_frame(fbl::move(packet));
+
+        size_t subframe_len = AmsduSubframeLen(amsdu_len, eth_frame);
+        if (amsdu_len + subframe_len > max_amsdu_len) {
+            SendMsdus(&msdus);
+            amsdu_len = 0;
+            subframe_len = AmsduSubframeLen(amsdu_len, eth_frame);
+        }
+        msdus.push_back(fbl::move(eth_frame));
+        amsdu_len += subframe_len;
+
+        // Frames which cannot be aggregated at all are sent on their own.
+        if (amsdu_len > max_amsdu_len) {
+            SendMsdus(&msdus);
+            amsdu_len = 0;
+        }
+    }
+    SendMsdus(&msdus);
+}
+
+void Station::SendMsdus(std::vector<EthFrame>* msdus) {
+    ZX_DEBUG_ASSERT(msdus != nullptr);
+    if (msdus->size() == 1) {
+        HandleEthFrame(fbl::move(msdus->front()));
+    } else if (msdus->size() > 1) {
+        SendAmsdu(*msdus);
     }
+    msdus->clear();
+}
+
+zx_status_t Station::SendAmsdu(const std::vector<EthFrame>& msdus) {
+    debugfn();
+    ZX_DEBUG_ASSERT(!msdus.empty());
+    ZX_DEBUG_ASSERT(IsQosReady());
+
+    size_t amsdu_len = 0;
+    for (const auto& msdu : msdus) {
+        amsdu_len += AmsduSubframeLen(amsdu_len, msdu);
+    }
+    auto packet = GetWlanPacket(DataFrameHeader::max_len() + amsdu_len);
+    if (packet == nullptr) { return ZX_ERR_NO_RESOURCES; }
+
+    bool needs_protection =
+        !join_ctx_->bss()->rsn.is_null() && controlled_port_ == eapol::PortState::kOpen;
+    BufferWriter w(*packet);
+
+    // The source and destination of each MSDU are carried in its subframe header.
+    // IEEE Std 802.11-2016, 9.2.4.7.1, Table 9-26
+    auto data_hdr = w.Write<DataFrameHeader>();
+    data_hdr->fc.set_type(FrameType::kData);
+    data_hdr->fc.set_subtype(DataSubtype::kQosdata);
+    data_hdr->fc.set_to_ds(1);
+    data_hdr->fc.set_from_ds(0);
+    data_hdr->fc.set_protected_frame(needs_protection);
+    data_hdr->addr1 = join_ctx_->bssid();
+    data_hdr->addr2 = self_addr();
+    data_hdr->addr3 = join_ctx_->bssid();
+
+    auto qos_ctrl = w.Write<QosControl>();
+    qos_ctrl->set_tid(GetTid(msdus.front()));
+    qos_ctrl->set_eosp(0);
+    qos_ctrl->set_ack_policy(ack_policy::kNormalAck);
+    qos_ctrl->set_amsdu_present(1);
+    qos_ctrl->set_byte(0);
+    SetSeqNo(data_hdr, &seq_);
+
+    const size_t amsdu_offset = w.WrittenBytes();
+    for (const auto& msdu : msdus) {
+        WriteAmsduSubframe(&w, amsdu_offset, msdu);
+    }
+    packet->set_len(w.WrittenBytes());
+
+    finspect("Outbound A-MSDU: %zu MSDUs, len %zu\n", msdus.size(), w.WrittenBytes());
+    finspect("  wlan hdr: %s\n", debug::Describe(*data_hdr).c_str());
+
+    // As for a single MSDU (see HandleEthFrame()), only use CBW40 when every destination is
+    // unicast.
+    bool all_ucast = std::all_of(msdus.begin(), msdus.end(),
+                                 [](const EthFrame& msdu) { return msdu.hdr()->dest.IsUcast(); });
+    CBW cbw = (assoc_ctx_.is_cbw40_tx && all_ucast ? CBW40 : CBW20);
+    auto status = SendWlan(fbl::move(packet), cbw, WLAN_PHY_HT);
+    if (status != ZX_OK) {
+        errorf("could not send A-MSDU: %d\n", status);
+        WLAN_STATS_INC(amsdu.drop);
+        WLAN_STATS_ADD(msdus.size(), msdu.drop);
+        return status;
+    }
+    WLAN_STATS_INC(amsdu.out);
+    WLAN_STATS_ADD(amsdu_len, amsdu.out_bytes);
+    for (const auto& eth_frame : msdus) {
+        WLAN_STATS_INC(msdu.out);
+        WLAN_STATS_ADD(eth_frame.body_len(), msdu.out_bytes);
+    }
+    return ZX_OK;
 }
 
 void Station::DumpDataFrame(const DataFrameView<>& frame) {
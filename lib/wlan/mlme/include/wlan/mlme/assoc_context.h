@@ -50,6 +50,10 @@ struct AssocContext {
     bool is_cbw40_tx = false;
 
     void set_aid(uint16_t aid) { aid = aid & kAidMask; }
+
+    // Returns the length of the largest A-MSDU which may be sent within this association, or 0 if
+    // A-MSDUs must not be sent.
+    size_t MaxTxAmsduLen() const;
 };
 
 zx_status_t ParseAssocRespIe(const uint8_t* ie_chains, size_t ie_chains_len,
@@ -104,6 +104,9 @@ class Station {
     zx_status_t SendPsPoll();
     zx_status_t SendDeauthFrame(::fuchsia::wlan::mlme::ReasonCode reason_code);
     void SendBufferedUnits();
+    // Sends |msdus| in a single frame, as an A-MSDU if there is more than one.
+    void SendMsdus(std::vector<EthFrame>* msdus);
+    zx_status_t SendAmsdu(const std::vector<EthFrame>& msdus);
     zx_status_t SendWlan(fbl::unique_ptr<Packet> packet, CBW cbw, PHY phy, uint32_t flags = 0);
     void DumpDataFrame(const DataFrameView<>&);
 
@@ -11,6 +11,7 @@
 #include <fbl/unique_ptr.h>
 #include <lib/zx/time.h>
 #include <wlan/common/bitfield.h>
+#include <wlan/common/buffer_writer.h>
 #include <wlan/common/mac_frame.h>
 #include <wlan/common/macaddr.h>
 #include <wlan/mlme/frame_validation.h>
@@ -279,9 +280,19 @@ void SetSeqNo(DataFrameHeader* hdr, Sequence* seq);
 
 using MsduCallback = std::function<void(FrameView<LlcHeader>, size_t)>;
 
-// Returns a list of all LLC frames carried in an AMSDU data frame.
+// Passes all LLC frames carried in an AMSDU data frame to the callback, along with the length of
+// their payload. The LLC frames are views into the AMSDU's packet; no MSDU is copied.
 zx_status_t DeaggregateAmsdu(const DataFrameView<AmsduSubframeHeader>&, MsduCallback);
 
+// Returns the number of bytes by which an A-MSDU of |amsdu_len| bytes grows when |eth_frame|'s MSDU
+// is appended to it, including the padding of the preceding subframe.
+size_t AmsduSubframeLen(size_t amsdu_len, const EthFrame& eth_frame);
+
+// Appends |eth_frame|'s MSDU as an A-MSDU subframe to the A-MSDU which starts at offset
+// |amsdu_offset| of |w|. The preceding subframe, if any, is padded first.
+// IEEE Std 802.11-2016, 9.3.2.2.2
+void WriteAmsduSubframe(BufferWriter* w, size_t amsdu_offset, const EthFrame& eth_frame);
+
 }  // namespace wlan
 
 #endif  // GARNET_LIB_WLAN_MLME_INCLUDE_WLAN_MLME_MAC_FRAME_H_
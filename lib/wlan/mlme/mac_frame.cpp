@@ -10,6 +10,8 @@
 #include <fbl/algorithm.h>
 #include <wlan/protocol/mac.h>
 
+#include <cstring>
+
 namespace wlan {
 
 // IEEE Std 802.11-2016, 10.3.2.11.2 Table 10-3 SNS1
@@ -78,8 +80,9 @@ zx_status_t DeaggregateAmsdu(const DataFrameView<AmsduSubframeHeader>& data_amsd
         // Note: msdu_len == 0 is valid
         size_t msdu_len = amsdu_subframe.hdr()->msdu_len();
         if (msdu_len > 0) {
-            if (auto llc_frame =
-                    amsdu_subframe.CheckBodyType<LlcHeader>().CheckLength().SkipHeader()) {
+            auto llc_frame = amsdu_subframe.CheckBodyType<LlcHeader>().CheckLength().SkipHeader();
+            if (llc_frame && msdu_len >= llc_frame.hdr()->len() &&
+                msdu_len <= amsdu_subframe.body_len()) {
                 size_t payload_len = msdu_len - llc_frame.hdr()->len();
                 cb(llc_frame, payload_len);
             } else {
@@ -99,4 +102,32 @@ zx_status_t DeaggregateAmsdu(const DataFrameView<AmsduSubframeHeader>& data_amsd
     return ZX_OK;
 }
 
+size_t AmsduSubframeLen(size_t amsdu_len, const EthFrame& eth_frame) {
+    size_t padding = fbl::round_up(amsdu_len, 4u) - amsdu_len;
+    return padding + AmsduSubframeHeader::max_len() + LlcHeader::max_len() + eth_frame.body_len();
+}
+
+void WriteAmsduSubframe(BufferWriter* w, size_t amsdu_offset, const EthFrame& eth_frame) {
+    ZX_DEBUG_ASSERT(w != nullptr && w->WrittenBytes() >= amsdu_offset);
+
+    // Every subframe but the last one is padded to a multiple of four bytes.
+    size_t amsdu_len = w->WrittenBytes() - amsdu_offset;
+    size_t padding = fbl::round_up(amsdu_len, 4u) - amsdu_len;
+    for (size_t i = 0; i < padding; i++) { w->WriteByte(0); }
+
+    auto eth_hdr = eth_frame.hdr();
+    auto subframe_hdr = w->Write<AmsduSubframeHeader>();
+    subframe_hdr->da = eth_hdr->dest;
+    subframe_hdr->sa = eth_hdr->src;
+    subframe_hdr->set_msdu_len(static_cast<uint16_t>(LlcHeader::max_len() + eth_frame.body_len()));
+
+    auto llc_hdr = w->Write<LlcHeader>();
+    llc_hdr->dsap = kLlcSnapExtension;
+    llc_hdr->ssap = kLlcSnapExtension;
+    llc_hdr->control = kLlcUnnumberedInformation;
+    std::memcpy(llc_hdr->oui, kLlcOui, sizeof(llc_hdr->oui));
+    llc_hdr->protocol_id = eth_hdr->ether_type;
+    w->Write({eth_hdr->payload, eth_frame.body_len()});
+}
+
 }  // namespace wlan
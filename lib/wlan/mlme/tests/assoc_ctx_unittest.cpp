@@ -3,6 +3,7 @@
 // found in the LICENSE file.
 
 #include <wlan/common/element.h>
+#include <wlan/mlme/assoc_context.h>
 #include <wlan/mlme/client/station.h>
 
 #include <fuchsia/wlan/mlme/cpp/fidl.h>
@@ -81,5 +82,31 @@ TEST(AssociationRatesTest, FailureApBasicRatesPartiallySupported) {
         .want_rates = {},
     });
 }
+
+TEST(AssocContextTest, MaxTxAmsduLen) {
+    AssocContext ctx{};
+    ctx.phy = WLAN_PHY_OFDM;
+    EXPECT_EQ(ctx.MaxTxAmsduLen(), static_cast<size_t>(0));
+
+    // HT PHY without negotiated HT capabilities.
+    ctx.phy = WLAN_PHY_HT;
+    EXPECT_EQ(ctx.MaxTxAmsduLen(), static_cast<size_t>(0));
+
+    HtCapabilities ht_cap{};
+    ht_cap.ht_cap_info.set_max_amsdu_len(HtCapabilityInfo::OCTETS_3839);
+    ctx.ht_cap = ht_cap;
+    EXPECT_EQ(ctx.MaxTxAmsduLen(), static_cast<size_t>(3839));
+
+    ctx.ht_cap->ht_cap_info.set_max_amsdu_len(HtCapabilityInfo::OCTETS_7935);
+    EXPECT_EQ(ctx.MaxTxAmsduLen(), static_cast<size_t>(7935));
+
+    ctx.phy = WLAN_PHY_VHT;
+    EXPECT_EQ(ctx.MaxTxAmsduLen(), static_cast<size_t>(7935));
+
+    // A-MSDUs are not sent to non-HT peers, even if HT capabilities were parsed.
+    ctx.phy = WLAN_PHY_ERP;
+    EXPECT_EQ(ctx.MaxTxAmsduLen(), static_cast<size_t>(0));
+}
+
 }  // namespace
 }  // namespace wlan
@@ -17,6 +17,7 @@
 
 #include "mock_device.h"
 #include "test_bss.h"
+#include "test_data.h"
 
 #include <gtest/gtest.h>
 
@@ -128,6 +129,24 @@ struct ClientTest : public ::testing::Test {
         station.HandleTimeout();
     }
 
+    void ConnectWithHt() {
+        // Both the device and the AP support HT, so the association uses it.
+        auto info = &device.wlanmac_info.ifc_info;
+        info->supported_phys |= WLAN_PHY_HT;
+        info->bands[0].ht_supported = true;
+
+        Authenticate();
+        SendMlmeMsg<wlan_mlme::AssociateRequest>();
+        fbl::unique_ptr<Packet> pkt;
+        ASSERT_EQ(CreateAssocRespFrame(&pkt, true), ZX_OK);
+        station.HandleAnyWlanFrame(fbl::move(pkt));
+        device.svc_queue.clear();
+        device.wlan_queue.clear();
+        station.HandleTimeout();
+        chan_sched.HandleTimeout();
+        station.HandleTimeout();
+    }
+
     zx::duration BeaconPeriodsToDuration(size_t periods) {
         return zx::usec(1024) * (periods * kBeaconPeriodTu);
     }
@@ -610,6 +629,144 @@ TEST_F(ClientTest, BufferFramesWhileOffChannelAndSendWhenOnChannel) {
     ASSERT_EQ(std::memcmp(llc_hdr->payload, kTestPayload, sizeof(kTestPayload)), 0);
 }
 
+TEST_F(ClientTest, BufferedFramesAreNotAggregatedWithoutHt) {
+    Connect();
+
+    constexpr size_t kFrameCount = 3;
+    GoOffChannel();
+    for (size_t i = 0; i < kFrameCount; i++) {
+        SendEthFrame();
+    }
+    ASSERT_TRUE(device.wlan_queue.empty());
+
+    // The BSS was joined without HT, so every MSDU is sent in a frame of its own.
+    GoBackToMainChannel();
+    ASSERT_EQ(device.wlan_queue.size(), kFrameCount);
+    for (auto& pkt : device.wlan_queue) {
+        ASSERT_EQ(pkt->peer(), Packet::Peer::kWlan);
+        ASSERT_FALSE(DataFrameView<AmsduSubframeHeader>::CheckType(pkt.get()));
+        auto frame = DataFrameView<LlcHeader>::CheckType(pkt.get()).CheckLength();
+        ASSERT_TRUE(frame);
+        ASSERT_EQ(frame.body_len() - frame.body()->len(), sizeof(kTestPayload));
+    }
+
+    auto stats = station.stats();
+    EXPECT_EQ(stats.amsdu.out.count, 0u);
+    EXPECT_EQ(stats.msdu.out.count, kFrameCount);
+    EXPECT_EQ(stats.msdu.out_bytes.count, kFrameCount * sizeof(kTestPayload));
+}
+
+TEST_F(ClientTest, BufferedFramesAreAggregatedWithHt) {
+    ConnectWithHt();
+
+    // Full-sized MSDUs, two of which fit into the 3839 octet A-MSDUs both sides support.
+    // The destination isn't the BSSID, which an A-MSDU carries in its subframe headers only.
+    constexpr size_t kEthernetMtu = 1500;
+    constexpr size_t kFrameCount = 5;
+    constexpr size_t kMsdusPerAmsdu = 2;
+    constexpr size_t kMaxAmsduLen = 3839;
+    constexpr uint8_t kDestAddr[] = {0x12, 0x34, 0x56, 0x78, 0x9a, 0xbc};
+    std::vector<std::vector<uint8_t>> payloads;
+    GoOffChannel();
+    for (size_t i = 0; i < kFrameCount; i++) {
+        payloads.emplace_back(kEthernetMtu, static_cast<uint8_t>(i + 1));
+        auto eth_frame = CreateEthFrame(payloads.back().data(), payloads.back().size());
+        ASSERT_FALSE(eth_frame.IsEmpty());
+        eth_frame.hdr()->dest = common::MacAddr(kDestAddr);
+        station.HandleEthFrame(EthFrame(eth_frame.Take()));
+    }
+    ASSERT_TRUE(device.wlan_queue.empty());
+
+    // The buffered MSDUs go out as two A-MSDUs, followed by the remaining MSDU on its own.
+    GoBackToMainChannel();
+    ASSERT_EQ(device.wlan_queue.size(), static_cast<size_t>(3));
+
+    size_t msdu_count = 0;
+    for (size_t i = 0; i < 2; i++) {
+        auto& pkt = device.wlan_queue[i];
+        ASSERT_EQ(pkt->peer(), Packet::Peer::kWlan);
+        ASSERT_TRUE(pkt->has_ctrl_data<wlan_tx_info_t>());
+        EXPECT_EQ(pkt->ctrl_data<wlan_tx_info_t>()->phy, WLAN_PHY_HT);
+        // The association doesn't enable CBW40 transmission.
+        EXPECT_EQ(pkt->ctrl_data<wlan_tx_info_t>()->cbw, CBW20);
+
+        auto frame = DataFrameView<AmsduSubframeHeader>::CheckType(pkt.get()).CheckLength();
+        ASSERT_TRUE(frame);
+        auto hdr = frame.hdr();
+        EXPECT_EQ(hdr->fc.subtype(), DataSubtype::kQosdata);
+        EXPECT_EQ(hdr->fc.to_ds(), 1);
+        EXPECT_EQ(hdr->fc.from_ds(), 0);
+        EXPECT_EQ(hdr->fc.protected_frame(), 0);
+        EXPECT_EQ(std::memcmp(hdr->addr1.byte, kBssid1, 6), 0);
+        EXPECT_EQ(std::memcmp(hdr->addr2.byte, kClientAddress, 6), 0);
+        EXPECT_EQ(std::memcmp(hdr->addr3.byte, kBssid1, 6), 0);
+        ASSERT_NE(hdr->qos_ctrl(), nullptr);
+        EXPECT_EQ(hdr->qos_ctrl()->amsdu_present(), 1);
+        EXPECT_LE(frame.body_len(), kMaxAmsduLen);
+        EXPECT_EQ(std::memcmp(frame.body()->da.byte, kDestAddr, 6), 0);
+        EXPECT_EQ(std::memcmp(frame.body()->sa.byte, kClientAddress, 6), 0);
+
+        size_t amsdu_msdu_count = 0;
+        auto status =
+            DeaggregateAmsdu(frame, [&](FrameView<LlcHeader> llc_frame, size_t payload_len) {
+                ASSERT_LT(msdu_count, kFrameCount);
+                ASSERT_EQ(payload_len, kEthernetMtu);
+                EXPECT_EQ(std::memcmp(llc_frame.body()->data, payloads[msdu_count].data(),
+                                      payload_len),
+                          0);
+                msdu_count++;
+                amsdu_msdu_count++;
+            });
+        ASSERT_EQ(status, ZX_OK);
+        ASSERT_EQ(amsdu_msdu_count, kMsdusPerAmsdu);
+    }
+
+    auto& pkt = device.wlan_queue[2];
+    ASSERT_FALSE(DataFrameView<AmsduSubframeHeader>::CheckType(pkt.get()));
+    auto frame = DataFrameView<LlcHeader>::CheckType(pkt.get()).CheckLength();
+    ASSERT_TRUE(frame);
+    EXPECT_EQ(frame.hdr()->fc.subtype(), DataSubtype::kQosdata);
+    EXPECT_EQ(std::memcmp(frame.hdr()->addr3.byte, kDestAddr, 6), 0);
+    ASSERT_EQ(frame.body_len() - frame.body()->len(), kEthernetMtu);
+    EXPECT_EQ(std::memcmp(frame.body()->payload, payloads[msdu_count].data(), kEthernetMtu), 0);
+    EXPECT_EQ(pkt->ctrl_data<wlan_tx_info_t>()->phy, WLAN_PHY_HT);
+
+    auto stats = station.stats();
+    EXPECT_EQ(stats.amsdu.out.count, 2u);
+    EXPECT_EQ(stats.amsdu.drop.count, 0u);
+    EXPECT_EQ(stats.msdu.out.count, kFrameCount);
+    EXPECT_EQ(stats.msdu.out_bytes.count, kFrameCount * kEthernetMtu);
+}
+
+TEST_F(ClientTest, ReceivedAmsduIsDeaggregated) {
+    Connect();
+
+    // The A-MSDU from the test data, sent to us by the BSS.
+    auto frame_data = test_data::kAmsduDataFrame;
+    auto pkt = GetWlanPacket(frame_data.size());
+    ASSERT_TRUE(pkt != nullptr);
+    pkt->CopyFrom(frame_data.data(), frame_data.size(), 0);
+    pkt->set_len(frame_data.size());
+    wlan_rx_info_t rx_info{.rx_flags = 0};
+    pkt->CopyCtrlFrom(rx_info);
+    auto hdr = pkt->mut_field<DataFrameHeader>(0);
+    hdr->fc.set_to_ds(0);
+    hdr->fc.set_from_ds(1);
+    hdr->addr1 = common::MacAddr(kClientAddress);
+    hdr->addr2 = common::MacAddr(kBssid1);
+    station.HandleAnyWlanFrame(fbl::move(pkt));
+
+    // Each of its two MSDUs is delivered as an Ethernet frame of its own.
+    auto eth_frames = device.GetEthPackets();
+    ASSERT_EQ(eth_frames.size(), static_cast<size_t>(2));
+
+    auto stats = station.stats();
+    EXPECT_EQ(stats.amsdu.in.count, 1u);
+    EXPECT_EQ(stats.amsdu.drop.count, 0u);
+    EXPECT_EQ(stats.msdu.in.count, 2u);
+    EXPECT_EQ(stats.msdu.in_bytes.count, 108u + 94u);
+}
+
 TEST_F(ClientTest, InvalidAuthenticationResponse) {
     // Send AUTHENTICATION.request. Verify that no confirmation was sent yet.
     ASSERT_EQ(SendMlmeMsg<wlan_mlme::AuthenticateRequest>(), ZX_OK);
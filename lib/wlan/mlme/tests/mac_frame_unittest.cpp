@@ -2,6 +2,7 @@
 // Use of this source code is governed by a BSD-style license that can be
 // found in the LICENSE file.
 
+#include "test_bss.h"
 #include "test_data.h"
 
 #include <wlan/common/buffer_writer.h>
@@ -13,8 +14,10 @@
 
 #include <gtest/gtest.h>
 
+#include <cstring>
 #include <memory>
 #include <utility>
+#include <vector>
 
 namespace wlan {
 namespace {
@@ -401,6 +404,121 @@ TEST(Frame, DeaggregateAmsdu) {
     ASSERT_EQ(llc_frames[1].second, static_cast<size_t>(94));
 }
 
+TEST(Frame, DeaggregateAmsduWithoutCopying) {
+    auto frame_data = test_data::kAmsduDataFrame;
+    auto pkt = GetPacket(frame_data.size());
+    pkt->CopyFrom(frame_data.data(), frame_data.size(), 0);
+
+    auto data_amsdu_frame = DataFrameView<AmsduSubframeHeader>::CheckType(pkt.get()).CheckLength();
+    ASSERT_TRUE(data_amsdu_frame);
+
+    // Every MSDU is handed out as a view into the A-MSDU's own buffer.
+    const uint8_t* pkt_begin = pkt->data();
+    const uint8_t* pkt_end = pkt->data() + pkt->len();
+    size_t msdu_count = 0;
+    auto status = DeaggregateAmsdu(
+        data_amsdu_frame, [&](FrameView<LlcHeader> llc_frame, size_t payload_len) {
+            auto llc_hdr = reinterpret_cast<const uint8_t*>(llc_frame.hdr());
+            EXPECT_GE(llc_hdr, pkt_begin);
+            EXPECT_LE(llc_frame.body()->data + payload_len, pkt_end);
+            msdu_count++;
+        });
+    ASSERT_EQ(status, ZX_OK);
+    ASSERT_EQ(msdu_count, static_cast<size_t>(2));
+}
+
+TEST(Frame, DeaggregateAmsduWithInvalidMsduLength) {
+    // Claim that the second MSDU is longer than what remains of the frame.
+    constexpr size_t kSecondMsduLenOffset = 170;
+    auto frame_data = test_data::kAmsduDataFrame;
+    frame_data[kSecondMsduLenOffset] = 0x00;
+    frame_data[kSecondMsduLenOffset + 1] = 0x67;
+    auto pkt = GetPacket(frame_data.size());
+    pkt->CopyFrom(frame_data.data(), frame_data.size(), 0);
+
+    auto data_amsdu_frame = DataFrameView<AmsduSubframeHeader>::CheckType(pkt.get()).CheckLength();
+    ASSERT_TRUE(data_amsdu_frame);
+
+    std::vector<size_t> payload_lens;
+    auto status = DeaggregateAmsdu(
+        data_amsdu_frame, [&](FrameView<LlcHeader> llc_frame, size_t payload_len) {
+            payload_lens.push_back(payload_len);
+        });
+    ASSERT_EQ(status, ZX_ERR_IO);
+    ASSERT_EQ(payload_lens.size(), static_cast<size_t>(1));
+    ASSERT_EQ(payload_lens[0], static_cast<size_t>(108));
+}
+
+TEST(Frame, AggregateAndDeaggregateAmsdu) {
+    // MSDUs of different lengths, so that the subframes need different amounts of padding.
+    constexpr size_t kMsduCount = 5;
+    std::vector<std::vector<uint8_t>> payloads;
+    std::vector<EthFrame> msdus;
+    size_t amsdu_len = 0;
+    for (size_t i = 0; i < kMsduCount; i++) {
+        payloads.emplace_back(100 + i, static_cast<uint8_t>(i + 1));
+        auto eth_frame = CreateEthFrame(payloads.back().data(), payloads.back().size());
+        ASSERT_FALSE(eth_frame.IsEmpty());
+        amsdu_len += AmsduSubframeLen(amsdu_len, eth_frame);
+        msdus.push_back(std::move(eth_frame));
+    }
+
+    auto pkt = GetPacket(DataFrameHeader::max_len() + amsdu_len);
+    BufferWriter w(*pkt);
+    auto data_hdr = w.Write<DataFrameHeader>();
+    data_hdr->fc.set_type(FrameType::kData);
+    data_hdr->fc.set_subtype(DataSubtype::kQosdata);
+    w.Write<QosControl>()->set_amsdu_present(1);
+    const size_t amsdu_offset = w.WrittenBytes();
+    for (const auto& msdu : msdus) {
+        WriteAmsduSubframe(&w, amsdu_offset, msdu);
+    }
+    ASSERT_EQ(w.WrittenBytes() - amsdu_offset, amsdu_len);
+    pkt->set_len(w.WrittenBytes());
+
+    auto data_amsdu_frame = DataFrameView<AmsduSubframeHeader>::CheckType(pkt.get()).CheckLength();
+    ASSERT_TRUE(data_amsdu_frame);
+
+    // All MSDUs come back out of the single frame, in order.
+    size_t msdu_count = 0;
+    auto status = DeaggregateAmsdu(
+        data_amsdu_frame, [&](FrameView<LlcHeader> llc_frame, size_t payload_len) {
+            ASSERT_LT(msdu_count, kMsduCount);
+            EXPECT_EQ(llc_frame.hdr()->protocol_id, msdus[msdu_count].hdr()->ether_type);
+            ASSERT_EQ(payload_len, payloads[msdu_count].size());
+            EXPECT_EQ(std::memcmp(llc_frame.body()->data, payloads[msdu_count].data(), payload_len),
+                      0);
+            msdu_count++;
+        });
+    ASSERT_EQ(status, ZX_OK);
+    ASSERT_EQ(msdu_count, kMsduCount);
+}
+
+TEST(Frame, AmsduSubframeLen) {
+    constexpr size_t kEthernetMtu = 1500;
+    std::vector<uint8_t> payload(kEthernetMtu);
+    auto eth_frame = CreateEthFrame(payload.data(), payload.size());
+    ASSERT_FALSE(eth_frame.IsEmpty());
+
+    // Subframe header, LLC header and MSDU, plus the preceding subframe's padding.
+    ASSERT_EQ(AmsduSubframeLen(0, eth_frame), static_cast<size_t>(1522));
+    ASSERT_EQ(AmsduSubframeLen(1522, eth_frame), static_cast<size_t>(1524));
+    ASSERT_EQ(AmsduSubframeLen(3046, eth_frame), static_cast<size_t>(1524));
+
+    // MSDUs per A-MSDU for full-sized Ethernet frames, for both HT A-MSDU length limits.
+    auto msdus_per_amsdu = [&](size_t max_amsdu_len) {
+        size_t amsdu_len = 0;
+        size_t msdus = 0;
+        while (amsdu_len + AmsduSubframeLen(amsdu_len, eth_frame) <= max_amsdu_len) {
+            amsdu_len += AmsduSubframeLen(amsdu_len, eth_frame);
+            msdus++;
+        }
+        return msdus;
+    };
+    EXPECT_EQ(msdus_per_amsdu(3839), static_cast<size_t>(2));
+    EXPECT_EQ(msdus_per_amsdu(7935), static_cast<size_t>(5));
+}
+
 TEST(Frame, DdkConversion) {
     // DDK uint32_t to class CapabilityInfo
     uint32_t ddk_caps = 0;
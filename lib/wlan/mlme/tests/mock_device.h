@@ -83,6 +83,13 @@ struct MockDevice : public DeviceInterface {
 
     zx_status_t SendWlan(fbl::unique_ptr<Packet> packet, CBW cbw, PHY phy,
                          uint32_t flags) override final {
+        // Keep the requested PHY and channel width with the packet, as the device does.
+        wlan_tx_info_t tx_info{};
+        tx_info.tx_flags = flags;
+        tx_info.valid_fields = WLAN_TX_INFO_VALID_PHY | WLAN_TX_INFO_VALID_CHAN_WIDTH;
+        tx_info.phy = phy;
+        tx_info.cbw = cbw;
+        packet->CopyCtrlFrom(tx_info);
         wlan_queue.push_back(fbl::move(packet));
         return ZX_OK;
     }
@@ -10,6 +10,7 @@
 #include <wlan/common/write_element.h>
 #include <wlan/mlme/ap/bss_interface.h>
 #include <wlan/mlme/debug.h>
+#include <wlan/mlme/ht.h>
 #include <wlan/mlme/mac_frame.h>
 #include <wlan/mlme/packet.h>
 #include <wlan/mlme/rates_elements.h>
@@ -414,11 +415,13 @@ zx_status_t CreateAssocReqFrame(fbl::unique_ptr<Packet>* out_packet, Span<const
     return ZX_OK;
 }
 
-zx_status_t CreateAssocRespFrame(fbl::unique_ptr<Packet>* out_packet) {
+zx_status_t CreateAssocRespFrame(fbl::unique_ptr<Packet>* out_packet, bool ht) {
     common::MacAddr bssid(kBssid1);
     common::MacAddr client(kClientAddress);
 
-    constexpr size_t max_frame_len = MgmtFrameHeader::max_len() + AssociationResponse::max_len();
+    constexpr size_t max_frame_len = MgmtFrameHeader::max_len() + AssociationResponse::max_len() +
+                                     sizeof(ElementHeader) + sizeof(HtCapabilities) +
+                                     sizeof(ElementHeader) + sizeof(HtOperation);
     auto packet = GetWlanPacket(max_frame_len);
     if (packet == nullptr) { return ZX_ERR_NO_RESOURCES; }
 
@@ -438,7 +441,14 @@ zx_status_t CreateAssocRespFrame(fbl::unique_ptr<Packet>* out_packet) {
     assoc->cap = cap;
     assoc->status_code = status_code::kSuccess;
 
-    packet->set_len(w.WrittenBytes());
+    BufferWriter elem_w({assoc->elements, w.RemainingBytes()});
+    if (ht) {
+        HtConfig ht_cfg{.ready = true, .cbw_40_rx_ready = false, .cbw_40_tx_ready = false};
+        common::WriteHtCapabilities(&elem_w, BuildHtCapabilities(ht_cfg));
+        common::WriteHtOperation(&elem_w, BuildHtOperation(kBssChannel));
+    }
+
+    packet->set_len(w.WrittenBytes() + elem_w.WrittenBytes());
 
     wlan_rx_info_t rx_info{.rx_flags = 0};
     packet->CopyCtrlFrom(rx_info);
@@ -79,7 +79,7 @@ zx_status_t CreateBeaconFrame(fbl::unique_ptr<Packet>*);
 zx_status_t CreateBeaconFrameWithBssid(fbl::unique_ptr<Packet>*, common::MacAddr);
 zx_status_t CreateProbeRequest(fbl::unique_ptr<Packet>*);
 zx_status_t CreateAssocReqFrame(fbl::unique_ptr<Packet>*, Span<const uint8_t> ssid, bool rsn);
-zx_status_t CreateAssocRespFrame(fbl::unique_ptr<Packet>*);
+zx_status_t CreateAssocRespFrame(fbl::unique_ptr<Packet>*, bool ht = false);
 zx_status_t CreateDisassocFrame(fbl::unique_ptr<Packet>*);
 DataFrame<LlcHeader> CreateDataFrame(const uint8_t* payload, size_t len);
 DataFrame<> CreateNullDataFrame();
@@ -3,13 +3,18 @@
 // found in the LICENSE file.
 
 #include "lib/escher/escher.h"
+
+#include <cstring>
+
 #include "lib/escher/defaults/default_shader_program_factory.h"
 #include "lib/escher/impl/command_buffer_pool.h"
 #include "lib/escher/impl/frame_manager.h"
 #include "lib/escher/impl/glsl_compiler.h"
 #include "lib/escher/impl/image_cache.h"
 #include "lib/escher/impl/mesh_manager.h"
+#include "lib/escher/impl/spirv_cache.h"
 #include "lib/escher/impl/vk/pipeline_cache.h"
+#include "lib/escher/impl/vulkan_utils.h"
 #include "lib/escher/profiling/timestamp_profiler.h"
 #include "lib/escher/renderer/buffer_cache.h"
 #include "lib/escher/renderer/frame.h"
@@ -24,12 +29,67 @@
 #include "lib/escher/vk/impl/render_pass_cache.h"
 #include "lib/escher/vk/naive_gpu_allocator.h"
 #include "lib/escher/vk/texture.h"
+#include "lib/fxl/files/file.h"
 #include "third_party/shaderc/libshaderc/include/shaderc/shaderc.hpp"
 
 namespace escher {
 
 namespace {
 
+// Locations of the caches within the directory passed to the constructor.
+constexpr char kSpirvCacheSubdirectory[] = "/spirv";
+constexpr char kPipelineCacheFile[] = "/pipeline_cache";
+
+// Returns true if |data| begins with a pipeline cache header that matches
+// |physical_device|.  Drivers are required to ignore data that they didn't
+// generate, but checking here protects against those that don't, e.g. after
+// a driver update.
+bool IsPipelineCacheDataCompatible(const std::string& data,
+                                   vk::PhysicalDevice physical_device) {
+  // The header is defined by the Vulkan spec, as a sequence of uint32_t
+  // fields: header length, header version, vendor ID, device ID, followed by
+  // the pipeline cache UUID.
+  constexpr size_t kHeaderSize = 4 * sizeof(uint32_t) + VK_UUID_SIZE;
+  if (data.size() < kHeaderSize) {
+    return false;
+  }
+  uint32_t fields[4];
+  memcpy(fields, data.data(), sizeof(fields));
+  auto properties = physical_device.getProperties();
+  return fields[1] == VK_PIPELINE_CACHE_HEADER_VERSION_ONE &&
+         fields[2] == properties.vendorID &&
+         fields[3] == properties.deviceID &&
+         memcmp(data.data() + sizeof(fields), properties.pipelineCacheUUID,
+                VK_UUID_SIZE) == 0;
+}
+
+// Constructor helper.
+std::unique_ptr<impl::SpirvCache> NewSpirvCache(
+    const std::string& cache_directory) {
+  return std::make_unique<impl::SpirvCache>(
+      cache_directory.empty() ? std::string()
+                              : cache_directory + kSpirvCacheSubdirectory);
+}
+
+// Constructor helper.  The pipeline cache is initialized with the data saved
+// by the last call to SavePipelineCache(), if any.
+vk::PipelineCache NewPipelineCache(const VulkanContext& context,
+                                   const std::string& cache_directory) {
+  TRACE_DURATION("gfx", "escher::NewPipelineCache");
+  std::string data;
+  if (!cache_directory.empty() &&
+      files::ReadFileToString(cache_directory + kPipelineCacheFile, &data) &&
+      !IsPipelineCacheDataCompatible(data, context.physical_device)) {
+    FXL_LOG(INFO) << "Escher: ignoring incompatible pipeline cache data.";
+    data.clear();
+  }
+
+  vk::PipelineCacheCreateInfo info;
+  info.initialDataSize = data.size();
+  info.pInitialData = data.data();
+  return ESCHER_CHECKED_VK_RESULT(context.device.createPipelineCache(info));
+}
+
 // Constructor helper.
 std::unique_ptr<impl::CommandBufferPool> NewCommandBufferPool(
     const VulkanContext& context, impl::CommandBufferSequencer* sequencer) {
@@ -73,7 +133,8 @@ std::unique_ptr<impl::MeshManager> NewMeshManager(
 Escher::Escher(VulkanDeviceQueuesPtr device)
     : Escher(std::move(device), HackFilesystem::New()) {}
 
-Escher::Escher(VulkanDeviceQueuesPtr device, HackFilesystemPtr filesystem)
+Escher::Escher(VulkanDeviceQueuesPtr device, HackFilesystemPtr filesystem,
+               std::string cache_directory)
     : renderer_count_(0),
       device_(std::move(device)),
       vulkan_context_(device_->GetVulkanContext()),
@@ -84,7 +145,11 @@ Escher::Escher(VulkanDeviceQueuesPtr device, HackFilesystemPtr filesystem)
           vulkan_context_, command_buffer_sequencer_.get())),
       transfer_command_buffer_pool_(NewTransferCommandBufferPool(
           vulkan_context_, command_buffer_sequencer_.get())),
-      glsl_compiler_(std::make_unique<impl::GlslToSpirvCompiler>()),
+      cache_directory_(std::move(cache_directory)),
+      spirv_cache_(NewSpirvCache(cache_directory_)),
+      vk_pipeline_cache_(NewPipelineCache(vulkan_context_, cache_directory_)),
+      glsl_compiler_(
+          std::make_unique<impl::GlslToSpirvCompiler>(spirv_cache_.get())),
       shaderc_compiler_(std::make_unique<shaderc::Compiler>()),
       pipeline_cache_(std::make_unique<impl::PipelineCache>()),
       weak_factory_(this) {
@@ -125,6 +190,17 @@ Escher::Escher(VulkanDeviceQueuesPtr device, HackFilesystemPtr filesystem)
       vk_physical_device()
           .getQueueFamilyProperties()[vulkan_context_.queue_family_index];
   supports_timer_queries_ = queue_properties.timestampValidBits > 0;
+
+  if (!cache_directory_.empty()) {
+    // Together with the hit/miss counts logged by SavePipelineCache(), this
+    // distinguishes cold starts from warm ones.
+    size_t pipeline_cache_size = 0;
+    vk_device().getPipelineCacheData(vk_pipeline_cache_, &pipeline_cache_size,
+                                     nullptr);
+    FXL_LOG(INFO) << "Escher: loaded " << spirv_cache_->size()
+                  << " SPIR-V cache entries and " << pipeline_cache_size
+                  << " bytes of pipeline cache data from " << cache_directory_;
+  }
 }
 
 Escher::~Escher() {
@@ -145,6 +221,44 @@ Escher::~Escher() {
   resource_recycler_.reset();
   gpu_uploader_.reset();
   buffer_cache_.reset();
+
+  SavePipelineCache();
+  vk_device().destroyPipelineCache(vk_pipeline_cache_);
+}
+
+bool Escher::SavePipelineCache() {
+  TRACE_DURATION("gfx", "escher::Escher::SavePipelineCache");
+  if (cache_directory_.empty()) {
+    return false;
+  }
+
+  size_t size = 0;
+  std::vector<char> data;
+  vk::Result result;
+  do {
+    result = vk_device().getPipelineCacheData(vk_pipeline_cache_, &size,
+                                              nullptr);
+    if (result != vk::Result::eSuccess) {
+      break;
+    }
+    data.resize(size);
+    result = vk_device().getPipelineCacheData(vk_pipeline_cache_, &size,
+                                              data.data());
+  } while (result == vk::Result::eIncomplete);
+
+  if (result != vk::Result::eSuccess ||
+      !files::WriteFileInTwoPhases(cache_directory_ + kPipelineCacheFile,
+                                   fxl::StringView(data.data(), size),
+                                   cache_directory_)) {
+    FXL_LOG(WARNING) << "Escher: failed to save pipeline cache.";
+    return false;
+  }
+
+  FXL_LOG(INFO) << "Escher: saved " << size
+                << " bytes of pipeline cache data; SPIR-V cache hits: "
+                << spirv_cache_->hit_count()
+                << " misses: " << spirv_cache_->miss_count();
+  return true;
 }
 
 bool Escher::Cleanup() {
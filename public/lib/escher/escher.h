@@ -6,6 +6,7 @@
 #define LIB_ESCHER_ESCHER_H_
 
 #include <memory>
+#include <string>
 
 #include "lib/escher/forward_declarations.h"
 #include "lib/escher/shape/mesh_builder_factory.h"
@@ -30,8 +31,14 @@ class Escher : public MeshBuilderFactory, public ShaderProgramFactory {
   // Escher does not take ownership of the objects in the Vulkan context.  It is
   // up to the application to eventually destroy them, and also to ensure that
   // they outlive the Escher instance.
+  //
+  // If |cache_directory| is not empty, compiled SPIR-V and Vulkan pipeline
+  // cache data are loaded from it at construction, and saved to it as they are
+  // generated (SPIR-V) and by SavePipelineCache().  This avoids recompiling
+  // shaders and rebuilding pipelines each time the process starts.
   explicit Escher(VulkanDeviceQueuesPtr device);
-  Escher(VulkanDeviceQueuesPtr device, HackFilesystemPtr filesystem);
+  Escher(VulkanDeviceQueuesPtr device, HackFilesystemPtr filesystem,
+         std::string cache_directory = std::string());
   ~Escher();
 
   EscherWeakPtr GetWeakPtr() { return weak_factory_.GetWeakPtr(); }
@@ -111,6 +118,13 @@ class Escher : public MeshBuilderFactory, public ShaderProgramFactory {
   // again).
   bool Cleanup();
 
+  // Writes the contents of vk_pipeline_cache() to the cache directory, if one
+  // was provided to the constructor.  This is also done upon destruction, but
+  // since processes are often killed rather than shut down cleanly, clients
+  // should also call this once startup is complete.  Returns false if there
+  // is no cache directory, or if writing fails.
+  bool SavePipelineCache();
+
   VulkanDeviceQueues* device() const { return device_.get(); }
   vk::Device vk_device() const { return device_->vk_device(); }
   vk::PhysicalDevice vk_physical_device() const {
@@ -125,6 +139,10 @@ class Escher : public MeshBuilderFactory, public ShaderProgramFactory {
     return command_buffer_sequencer_.get();
   }
   impl::GlslToSpirvCompiler* glsl_compiler() { return glsl_compiler_.get(); }
+  impl::SpirvCache* spirv_cache() { return spirv_cache_.get(); }
+  // Passed to all Vulkan pipeline creation, so that pipelines created by a
+  // previous process can be reused; see SavePipelineCache().
+  vk::PipelineCache vk_pipeline_cache() const { return vk_pipeline_cache_; }
   shaderc::Compiler* shaderc_compiler() { return shaderc_compiler_.get(); }
   impl::ImageCache* image_cache() { return image_cache_.get(); }
   BufferCache* buffer_cache() { return buffer_cache_.get(); }
@@ -176,6 +194,9 @@ class Escher : public MeshBuilderFactory, public ShaderProgramFactory {
   std::unique_ptr<impl::CommandBufferSequencer> command_buffer_sequencer_;
   std::unique_ptr<impl::CommandBufferPool> command_buffer_pool_;
   std::unique_ptr<impl::CommandBufferPool> transfer_command_buffer_pool_;
+  const std::string cache_directory_;
+  std::unique_ptr<impl::SpirvCache> spirv_cache_;
+  vk::PipelineCache vk_pipeline_cache_;
   std::unique_ptr<impl::GlslToSpirvCompiler> glsl_compiler_;
   std::unique_ptr<shaderc::Compiler> shaderc_compiler_;
   std::unique_ptr<impl::PipelineCache> pipeline_cache_;
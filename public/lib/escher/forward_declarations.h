@@ -107,6 +107,7 @@ class ModelRenderer;
 class ModelRenderPass;
 class Pipeline;
 class PipelineCache;
+class SpirvCache;
 class SsdoAccelerator;
 class SsdoSampler;
 class UniformBufferPool;
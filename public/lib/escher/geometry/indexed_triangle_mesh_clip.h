@@ -5,6 +5,8 @@
 #ifndef LIB_ESCHER_GEOMETRY_INDEXED_TRIANGLE_MESH_CLIP_H_
 #define LIB_ESCHER_GEOMETRY_INDEXED_TRIANGLE_MESH_CLIP_H_
 
+#include <algorithm>
+#include <limits>
 #include <unordered_map>
 #include <utility>
 #include <vector>
@@ -131,8 +133,11 @@ auto IndexedTriangleMeshClip(MeshT input_mesh, const PlaneT* planes,
 
   // Storage for |remapped_index_for_unclipped_vertex| and
   // |get_index_for_split_edge_vertex| closures, below.  Outside the loop so
-  // that the memory can be reused between iterations.
-  std::unordered_map<Index, Index> reordered_indices;
+  // that the memory can be reused between iterations.  Since every input
+  // vertex may need to be remapped, |reordered_indices| is a flat table
+  // indexed by input vertex, rather than a hash map.
+  constexpr Index kUnmappedIndex = std::numeric_limits<Index>::max();
+  std::vector<Index> reordered_indices;
   std::unordered_map<Edge, Index, PairHasher> new_edge_vertex_indices;
 
   for (size_t plane_index = 0; plane_index < num_planes; ++plane_index) {
@@ -150,19 +155,24 @@ auto IndexedTriangleMeshClip(MeshT input_mesh, const PlaneT* planes,
 
       plane_clipped_vertices = false;
       clipped_vertices.ClearAll();
-      reordered_indices.clear();
       new_edge_vertex_indices.clear();
     }
 
-    // Mark all the vertices that are clipped by the current plane.
+    // Mark all the vertices that are clipped by the current plane, 32 at a
+    // time (one word of the bitmap).
     const size_t num_input_vertices = input_mesh.positions.size();
+    if (clipped_vertices.GetSize() < num_input_vertices) {
+      clipped_vertices.SetSize(num_input_vertices * 2);
+    }
     {
       TRACE_DURATION("gfx", "escher::IndexedTriangleMeshClip[clip_verts]");
-      for (size_t i = 0; i < num_input_vertices; ++i) {
-        if (PlaneClipsPoint(plane, input_mesh.positions[i])) {
-          clipped_vertices.Set(i);
-          plane_clipped_vertices = true;
-        }
+      const Position* positions = input_mesh.positions.data();
+      for (size_t i = 0; i < num_input_vertices; i += 32) {
+        const uint32_t count =
+            std::min(num_input_vertices - i, static_cast<size_t>(32));
+        const uint32_t mask = PlaneClipsPoints(plane, positions + i, count);
+        clipped_vertices.SetBlock(i, mask);
+        plane_clipped_vertices |= mask != 0;
       }
     }
     if (!plane_clipped_vertices) {
@@ -179,6 +189,7 @@ auto IndexedTriangleMeshClip(MeshT input_mesh, const PlaneT* planes,
     // The plane clipped at least one vertex, so we must iterate through the
     // triangles to generate a clipped mesh.
     output_planes.push_back(plane);
+    reordered_indices.assign(num_input_vertices, kUnmappedIndex);
 
     // Helper closure.
     // For each plane where at least one vertex is clipped, a new output mesh is
@@ -190,20 +201,19 @@ auto IndexedTriangleMeshClip(MeshT input_mesh, const PlaneT* planes,
     auto remapped_index_for_unclipped_vertex =
         [&reordered_indices, &input_mesh,
          &output_mesh](Index original_index) -> Index {
-      auto it = reordered_indices.find(original_index);
-      if (it != reordered_indices.end()) {
+      FXL_DCHECK(original_index < input_mesh.vertex_count());
+      Index& new_index = reordered_indices[original_index];
+      if (new_index != kUnmappedIndex) {
         // The input vertex was already seen, so return the index of the
         // corresponding output vertex.
-        return it->second;
+        return new_index;
       }
       // The input vertex was not previously seen, so we:
       // - copy/append the vertex data to the output mesh
       // - map the input index to the corresponding index of the output mesh
-      Index new_index = output_mesh.positions.size();
-      FXL_DCHECK(original_index < input_mesh.vertex_count());
+      new_index = output_mesh.positions.size();
       IndexedTriangleMeshPushCopiedAttributes(&output_mesh, &input_mesh,
                                               original_index);
-      reordered_indices.insert(it, {original_index, new_index});
       return new_index;
     };
 
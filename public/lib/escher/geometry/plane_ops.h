@@ -86,6 +86,51 @@ bool PlaneClipsPoint(const PlaneT& plane, const VecT& point) {
   return PlaneDistanceToPoint(plane, point) < 0.f;
 }
 
+// Batched version of PlaneClipsPoint(): returns a mask where bit i is set iff
+// |points[i]| is clipped by |plane|.  |count| must be no greater than 32.
+//
+// The points are first transposed into one array per coordinate, so that the
+// distance computation is a sequence of independent multiply-adds which the
+// compiler can vectorize, testing 4 or 8 points at once depending on the
+// target.  The result is identical to calling PlaneClipsPoint() per point.
+template <typename PlaneT, typename VecT>
+uint32_t PlaneClipsPoints(const PlaneT& plane, const VecT* points,
+                          uint32_t count) {
+  // Only coordinates shared by the plane and the points contribute to the
+  // distance; see the promoting/demoting PlaneDistanceToPoint() overloads.
+  constexpr size_t kPlaneDims =
+      sizeof(typename PlaneT::VectorType) / sizeof(float);
+  constexpr size_t kPointDims = sizeof(VecT) / sizeof(float);
+  constexpr size_t kDims = kPlaneDims < kPointDims ? kPlaneDims : kPointDims;
+  FXL_DCHECK(count <= 32);
+
+  alignas(32) float coords[kDims][32];
+  for (uint32_t i = 0; i < count; ++i) {
+    for (size_t d = 0; d < kDims; ++d) {
+      coords[d][i] = points[i][d];
+    }
+  }
+
+  alignas(32) float distances[32];
+  const float dir0 = plane.dir()[0];
+  for (uint32_t i = 0; i < count; ++i) {
+    distances[i] = coords[0][i] * dir0;
+  }
+  for (size_t d = 1; d < kDims; ++d) {
+    const float dir_d = plane.dir()[d];
+    for (uint32_t i = 0; i < count; ++i) {
+      distances[i] += coords[d][i] * dir_d;
+    }
+  }
+
+  const float dist = plane.dist();
+  uint32_t mask = 0;
+  for (uint32_t i = 0; i < count; ++i) {
+    mask |= static_cast<uint32_t>(distances[i] - dist < 0.f) << i;
+  }
+  return mask;
+}
+
 }  // namespace escher
 
 #endif  // LIB_ESCHER_GEOMETRY_PLANE_OPS_H_
@@ -6,6 +6,7 @@
 
 #include <math.h>
 #include <algorithm>
+#include <vector>
 
 #include "lib/escher/impl/model_data.h"
 #include "lib/escher/shape/mesh_builder.h"
@@ -91,15 +92,30 @@ IndexedTriangleMesh2d<vec2> NewCircleIndexedTriangleMesh(const MeshSpec& spec,
   pos += 1;
   uv += 1;
 
-  // Outer vertices.
+  // Outer vertices.  The vertex count is a multiple of 4, so only the first
+  // quadrant's directions need to be computed; each is then rotated by 90
+  // degrees to obtain the corresponding vertex in the other three quadrants.
+  // This requires a quarter of the sin/cos evaluations, and leaves a simple
+  // loop for the position/UV computation.
+  const size_t quadrant_vertex_count = outer_vertex_count / 4;
   const float radian_step = 2 * M_PI / outer_vertex_count;
-  for (size_t i = 0; i < outer_vertex_count; ++i) {
-    // Direction of the current vertex from the center of the circle.
+  std::vector<vec2> quadrant_dirs(quadrant_vertex_count);
+  for (size_t i = 0; i < quadrant_vertex_count; ++i) {
     float radians = i * radian_step;
-    vec2 dir(sin(radians), cos(radians));
-
-    pos[i] = dir * radius + center;
-    uv[i] = 0.5f * (dir + vec2(1.f, 1.f));
+    quadrant_dirs[i] = vec2(sin(radians), cos(radians));
+  }
+  for (size_t quadrant = 0; quadrant < 4; ++quadrant) {
+    for (size_t i = 0; i < quadrant_vertex_count; ++i) {
+      // Direction of the current vertex from the center of the circle.
+      vec2& dir = quadrant_dirs[i];
+      pos[i] = dir * radius + center;
+      uv[i] = 0.5f * (dir + vec2(1.f, 1.f));
+
+      // Rotate by 90 degrees, for the next quadrant.
+      dir = vec2(dir.y, -dir.x);
+    }
+    pos += quadrant_vertex_count;
+    uv += quadrant_vertex_count;
   }
 
   // Generate triangle indices.
@@ -13,13 +13,39 @@
 #include "spirv-tools/libspirv.hpp"
 #include "spirv-tools/optimizer.hpp"
 
+#include "lib/escher/util/hasher.h"
 #include "lib/escher/util/trace_macros.h"
 #include "lib/fxl/logging.h"
 
 namespace escher {
 namespace impl {
 
-GlslToSpirvCompiler::GlslToSpirvCompiler() : active_compile_count_(0) {}
+namespace {
+
+// Compile options.  They are part of the SpirvCache key.
+constexpr int kDefaultGlslVersion = 450;
+constexpr EShMessages kMessageFlags =
+    static_cast<EShMessages>(EShMsgVulkanRules | EShMsgSpvRules);
+constexpr spv_target_env kTargetEnv = SPV_ENV_VULKAN_1_0;
+// TODO(ES-24): Find a central place for all code that makes reference to a
+// particular version of Vulkan.
+constexpr char kVulkanMinorVersion[] = "42";
+
+// Hashes the versions of glslang and SPIRV-Tools and the compile options, so
+// that cached SPIR-V isn't used after any of them changes.
+void HashCompilerConfiguration(Hasher* h) {
+  h->i32(glslang::GetSpirvGeneratorVersion());
+  h->const_chars(spvSoftwareVersionDetailsString());
+  h->i32(kDefaultGlslVersion);
+  h->u32(kMessageFlags);
+  h->u32(kTargetEnv);
+  h->const_chars(kVulkanMinorVersion);
+}
+
+}  // anonymous namespace
+
+GlslToSpirvCompiler::GlslToSpirvCompiler(SpirvCache* cache)
+    : cache_(cache), active_compile_count_(0) {}
 
 GlslToSpirvCompiler::~GlslToSpirvCompiler() {
   FXL_CHECK(active_compile_count_ == 0);
@@ -47,11 +73,35 @@ SpirvData GlslToSpirvCompiler::SynchronousCompile(
     std::string preamble, std::string entry_point) {
   TRACE_DURATION("gfx", "escher::GlslToSpirvCompiler::SynchronousCompile");
 
+  // The key covers all inputs; the sources are self-contained, so there are
+  // no dependencies to validate.
+  Hash key;
+  SpirvData result;
+  if (cache_) {
+    Hasher h;
+    HashCompilerConfiguration(&h);
+    h.u32(static_cast<uint32_t>(stage));
+    h.u32(static_cast<uint32_t>(source_code.size()));
+    for (auto& source : source_code) {
+      h.string(source);
+    }
+    h.string(preamble);
+    h.string(entry_point);
+    key = h.value();
+    if (cache_->Load(key, &result)) {
+      --active_compile_count_;
+      return result;
+    }
+  }
+
   // SynchronousCompileImpl has many return points; wrap it so that we don't
   // forget to --active_compile_count_ at one of them.
-  auto result =
+  result =
       SynchronousCompileImpl(stage, std::move(source_code), std::move(preamble),
                              std::move(entry_point));
+  if (cache_ && !result.empty()) {
+    cache_->Store(key, result);
+  }
   // Count was already incremented by Compile().
   --active_compile_count_;
   return result;
@@ -104,10 +154,6 @@ SpirvData GlslToSpirvCompiler::SynchronousCompileImpl(
     shader.setEntryPoint(entry_point.c_str());
   }
 
-  constexpr int kDefaultGlslVersion = 450;
-  constexpr EShMessages kMessageFlags =
-      static_cast<EShMessages>(EShMsgVulkanRules | EShMsgSpvRules);
-
   if (!shader.parse(&glslang::DefaultTBuiltInResource, kDefaultGlslVersion,
                     false, kMessageFlags)) {
     FXL_LOG(WARNING) << "failed to parse shader \n\tinfo log: "
@@ -142,11 +188,7 @@ SpirvData GlslToSpirvCompiler::SynchronousCompileImpl(
                      << logger.getAllMessages();
   }
 
-  // TODO(ES-24): Find a central place for all code that makes reference to a
-  // particular version of Vulkan.
-  const char* kVulkanMinorVersion = "42";
-
-  spvtools::Optimizer optimizer(SPV_ENV_VULKAN_1_0);
+  spvtools::Optimizer optimizer(kTargetEnv);
   optimizer.RegisterPass(spvtools::CreateSetSpecConstantDefaultValuePass(
       {{1, kVulkanMinorVersion}}));
   optimizer.RegisterPass(spvtools::CreateFreezeSpecConstantValuePass());
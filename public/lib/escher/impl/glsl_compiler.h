@@ -9,16 +9,18 @@
 #include <vector>
 #include <vulkan/vulkan.hpp>
 
+#include "lib/escher/impl/spirv_cache.h"
+
 namespace escher {
 namespace impl {
 
-typedef std::vector<uint32_t> SpirvData;
-
 // Wraps the reference GLSL compiler provided by Khronos.
 // TODO: GLSL standard library functions are currently not available.
 class GlslToSpirvCompiler {
  public:
-  GlslToSpirvCompiler();
+  // If |cache| is not null, compilation results are looked up in, and added
+  // to, the cache.  It must outlive the compiler.
+  explicit GlslToSpirvCompiler(SpirvCache* cache = nullptr);
   ~GlslToSpirvCompiler();
 
   // Compile and link the provided source code snippets into a single SPIR-V
@@ -41,6 +43,7 @@ class GlslToSpirvCompiler {
                                    std::string preamble,
                                    std::string entry_point);
 
+  SpirvCache* const cache_;
   std::atomic<uint32_t> active_compile_count_;
 };
 
@@ -4,6 +4,7 @@
 
 #include "lib/escher/impl/model_pipeline_cache.h"
 
+#include "lib/escher/escher.h"
 #include "lib/escher/geometry/types.h"
 #include "lib/escher/impl/glsl_compiler.h"
 #include "lib/escher/impl/mesh_shader_binding.h"
@@ -27,7 +28,8 @@ ModelPipelineCache::ModelPipelineCache(ResourceRecycler* recycler,
     : Resource(recycler),
       model_data_(std::move(model_data)),
       render_pass_(render_pass),
-      compiler_(std::make_unique<GlslToSpirvCompiler>()) {
+      compiler_(
+          std::make_unique<GlslToSpirvCompiler>(escher()->spirv_cache())) {
   FXL_DCHECK(model_data_);
   FXL_DCHECK(render_pass_);
 }
@@ -54,7 +56,8 @@ std::pair<vk::Pipeline, vk::PipelineLayout> NewPipelineHelper(
     bool enable_depth_write, bool enable_blending,
     vk::CompareOp depth_compare_op, vk::RenderPass render_pass,
     std::vector<vk::DescriptorSetLayout> descriptor_set_layouts,
-    const ModelPipelineSpec& spec, vk::SampleCountFlagBits sample_count) {
+    const ModelPipelineSpec& spec, vk::SampleCountFlagBits sample_count,
+    vk::PipelineCache pipeline_cache) {
   vk::Device device = model_data->device();
 
   // Depending on configuration, more dynamic states may be added later.
@@ -262,7 +265,7 @@ std::pair<vk::Pipeline, vk::PipelineLayout> NewPipelineHelper(
   pipeline_info.basePipelineHandle = vk::Pipeline();
 
   vk::Pipeline pipeline = ESCHER_CHECKED_VK_RESULT(
-      device.createGraphicsPipeline(nullptr, pipeline_info));
+      device.createGraphicsPipeline(pipeline_cache, pipeline_info));
 
   return {pipeline, pipeline_layout};
 }
@@ -326,7 +329,8 @@ std::unique_ptr<ModelPipeline> ModelPipelineCache::NewPipeline(
       model_data_.get(), vertex_module, fragment_module, enable_depth_test,
       enable_depth_write, enable_blending, depth_compare_op, render_pass_->vk(),
       {model_data_->per_model_layout(), model_data_->per_object_layout()}, spec,
-      SampleCountFlagBitsFromInt(render_pass_->sample_count()));
+      SampleCountFlagBitsFromInt(render_pass_->sample_count()),
+      escher()->vk_pipeline_cache());
 
   device.destroyShaderModule(vertex_module);
   if (fragment_module) {
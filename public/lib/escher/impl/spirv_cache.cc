@@ -0,0 +1,276 @@
+// Copyright 2018 The Fuchsia Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "lib/escher/impl/spirv_cache.h"
+
+#include <sys/stat.h>
+#include <sys/time.h>
+
+#include <algorithm>
+#include <cinttypes>
+#include <cstdio>
+#include <cstring>
+
+#include "lib/escher/util/hasher.h"
+#include "lib/escher/util/trace_macros.h"
+#include "lib/fxl/files/directory.h"
+#include "lib/fxl/files/file.h"
+#include "lib/fxl/logging.h"
+
+namespace escher {
+namespace impl {
+
+namespace {
+
+// Entry files begin with this magic number and format version.  Bump the
+// version whenever the file format, or the way that callers compute keys,
+// changes; files with a different version are ignored.
+constexpr uint32_t kEntryMagic = 0x56505345;  // "ESPV"
+constexpr uint32_t kEntryVersion = 2;
+constexpr char kEntrySuffix[] = ".spv";
+
+void Append(std::string* out, const void* data, size_t size) {
+  out->append(static_cast<const char*>(data), size);
+}
+
+template <typename T>
+void AppendValue(std::string* out, T value) {
+  Append(out, &value, sizeof(value));
+}
+
+// Reads sequentially from serialized entry data, failing (rather than reading
+// out of bounds) if the data is truncated.
+class Reader {
+ public:
+  explicit Reader(const std::string& data) : data_(data) {}
+
+  bool Read(void* out, size_t size) {
+    if (data_.size() - position_ < size) {
+      return false;
+    }
+    memcpy(out, data_.data() + position_, size);
+    position_ += size;
+    return true;
+  }
+
+  template <typename T>
+  bool ReadValue(T* out) {
+    return Read(out, sizeof(T));
+  }
+
+  bool AtEnd() const { return position_ == data_.size(); }
+
+ private:
+  const std::string& data_;
+  size_t position_ = 0;
+};
+
+}  // anonymous namespace
+
+SpirvCache::SpirvCache(std::string directory, size_t max_directory_size)
+    : directory_(std::move(directory)),
+      max_directory_size_(max_directory_size),
+      hit_count_(0),
+      miss_count_(0) {
+  if (!directory_.empty()) {
+    LoadDirectory();
+  }
+}
+
+SpirvCache::~SpirvCache() = default;
+
+bool SpirvCache::Load(const Hash& key, const DependencyReader& reader,
+                      SpirvData* spirv_out) {
+  FXL_DCHECK(spirv_out);
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto it = entries_.find(key);
+    if (it == entries_.end()) {
+      ++miss_count_;
+      return false;
+    }
+
+    auto& entry = it->second;
+    for (auto& dependency : entry.dependencies) {
+      if (!reader ||
+          HashContents(reader(dependency.first)) != dependency.second) {
+        // The entry is stale; it will be replaced when the caller stores the
+        // result of recompiling.
+        entries_.erase(it);
+        ++miss_count_;
+        return false;
+      }
+    }
+
+    *spirv_out = entry.spirv;
+    ++hit_count_;
+  }
+
+  // Pruning uses the modification time as the time of last use.
+  if (!directory_.empty()) {
+    utimes(EntryPath(key).c_str(), nullptr);
+  }
+  return true;
+}
+
+void SpirvCache::Store(const Hash& key, SpirvData spirv,
+                       std::vector<Dependency> dependencies) {
+  TRACE_DURATION("gfx", "escher::SpirvCache::Store");
+  Entry entry{std::move(spirv), std::move(dependencies)};
+  if (!directory_.empty()) {
+    // Write to a temporary file first, so that a crash cannot leave a
+    // truncated entry behind.
+    if (!files::WriteFileInTwoPhases(EntryPath(key), Serialize(key, entry),
+                                     directory_)) {
+      FXL_LOG(WARNING) << "SpirvCache: failed to write " << EntryPath(key);
+    }
+  }
+
+  std::lock_guard<std::mutex> lock(mutex_);
+  entries_[key] = std::move(entry);
+}
+
+// static
+Hash SpirvCache::HashContents(const std::string& contents) {
+  Hasher h;
+  h.string(contents);
+  return h.value();
+}
+
+size_t SpirvCache::size() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return entries_.size();
+}
+
+void SpirvCache::LoadDirectory() {
+  TRACE_DURATION("gfx", "escher::SpirvCache::LoadDirectory");
+  if (!files::IsDirectory(directory_) &&
+      !files::CreateDirectory(directory_)) {
+    FXL_LOG(WARNING) << "SpirvCache: cannot create " << directory_;
+    return;
+  }
+
+  std::vector<std::string> names;
+  if (!files::ReadDirContents(directory_, &names)) {
+    return;
+  }
+
+  struct EntryFile {
+    std::string path;
+    size_t size;
+    time_t last_use;
+  };
+  std::vector<EntryFile> entry_files;
+  const size_t suffix_length = strlen(kEntrySuffix);
+  for (auto& name : names) {
+    if (name.size() <= suffix_length ||
+        name.compare(name.size() - suffix_length, suffix_length,
+                     kEntrySuffix) != 0) {
+      continue;
+    }
+
+    std::string path = directory_ + "/" + name;
+    struct stat file_stat;
+    if (stat(path.c_str(), &file_stat) == 0) {
+      entry_files.push_back({std::move(path),
+                             static_cast<size_t>(file_stat.st_size),
+                             file_stat.st_mtime});
+    }
+  }
+
+  // Keep the most recently used entries that fit, and delete the rest.
+  std::sort(entry_files.begin(), entry_files.end(),
+            [](const EntryFile& a, const EntryFile& b) {
+              return a.last_use > b.last_use;
+            });
+  size_t directory_size = 0;
+  bool full = false;
+  for (auto& file : entry_files) {
+    const std::string& path = file.path;
+    if (full || directory_size + file.size > max_directory_size_) {
+      // Older entries are deleted too, even if they would fit.
+      full = true;
+      FXL_VLOG(1) << "SpirvCache: pruning " << path;
+      std::remove(path.c_str());
+      continue;
+    }
+    directory_size += file.size;
+
+    std::string data;
+    Hash key;
+    Entry entry;
+    if (files::ReadFileToString(path, &data) &&
+        Deserialize(data, &key, &entry) && EntryPath(key) == path) {
+      entries_[key] = std::move(entry);
+    } else {
+      // Most likely written by a build with a different format version.
+      FXL_VLOG(1) << "SpirvCache: discarding " << path;
+      std::remove(path.c_str());
+    }
+  }
+}
+
+std::string SpirvCache::EntryPath(const Hash& key) const {
+  char name[17];
+  snprintf(name, sizeof(name), "%016" PRIx64, key.val);
+  return directory_ + "/" + name + kEntrySuffix;
+}
+
+// static
+std::string SpirvCache::Serialize(const Hash& key, const Entry& entry) {
+  std::string out;
+  AppendValue(&out, kEntryMagic);
+  AppendValue(&out, kEntryVersion);
+  AppendValue(&out, key.val);
+  AppendValue(&out, static_cast<uint32_t>(entry.dependencies.size()));
+  for (auto& dependency : entry.dependencies) {
+    AppendValue(&out, static_cast<uint32_t>(dependency.first.size()));
+    Append(&out, dependency.first.data(), dependency.first.size());
+    AppendValue(&out, dependency.second.val);
+  }
+  AppendValue(&out, static_cast<uint32_t>(entry.spirv.size()));
+  Append(&out, entry.spirv.data(), entry.spirv.size() * sizeof(uint32_t));
+  return out;
+}
+
+// static
+bool SpirvCache::Deserialize(const std::string& data, Hash* key_out,
+                             Entry* entry_out) {
+  Reader reader(data);
+  uint32_t magic;
+  uint32_t version;
+  uint32_t dependency_count;
+  if (!reader.ReadValue(&magic) || magic != kEntryMagic ||
+      !reader.ReadValue(&version) || version != kEntryVersion ||
+      !reader.ReadValue(&key_out->val) ||
+      !reader.ReadValue(&dependency_count)) {
+    return false;
+  }
+
+  for (uint32_t i = 0; i < dependency_count; ++i) {
+    uint32_t path_length;
+    if (!reader.ReadValue(&path_length) || path_length > data.size()) {
+      return false;
+    }
+    Dependency dependency;
+    dependency.first.resize(path_length);
+    if (!reader.Read(&dependency.first[0], path_length) ||
+        !reader.ReadValue(&dependency.second.val)) {
+      return false;
+    }
+    entry_out->dependencies.push_back(std::move(dependency));
+  }
+
+  uint32_t word_count;
+  if (!reader.ReadValue(&word_count) ||
+      word_count > data.size() / sizeof(uint32_t)) {
+    return false;
+  }
+  entry_out->spirv.resize(word_count);
+  return reader.Read(entry_out->spirv.data(), word_count * sizeof(uint32_t)) &&
+         reader.AtEnd() && word_count > 0;
+}
+
+}  // namespace impl
+}  // namespace escher
@@ -0,0 +1,109 @@
+// Copyright 2018 The Fuchsia Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef LIB_ESCHER_IMPL_SPIRV_CACHE_H_
+#define LIB_ESCHER_IMPL_SPIRV_CACHE_H_
+
+#include <atomic>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "lib/escher/util/hash.h"
+#include "lib/escher/util/hash_map.h"
+#include "lib/fxl/macros.h"
+
+namespace escher {
+namespace impl {
+
+typedef std::vector<uint32_t> SpirvData;
+
+// A thread-safe cache of compiled SPIR-V, keyed by a hash of everything that
+// determines the compilation result (source code, shader stage, preprocessor
+// definitions, etc.).  Computing the key is up to the caller.
+//
+// If a directory is provided, each entry is also written to a file in that
+// directory, and entries found there are loaded at construction, so that
+// shaders compiled by a previous process need not be compiled again.
+//
+// Entries may record "dependencies": files that were #included during
+// compilation, along with a hash of their contents.  An entry is only used if
+// all of its dependencies still have the same contents.
+//
+// The directory is kept to a maximum size by deleting the least recently used
+// entry files at construction.  Between constructions it can exceed the
+// maximum by the size of the entries stored in the meantime.
+class SpirvCache {
+ public:
+  // The path and contents-hash of a file used during compilation.
+  using Dependency = std::pair<std::string, Hash>;
+
+  // Returns the current contents of the file at |path|, for validating
+  // dependencies.
+  using DependencyReader = std::function<std::string(const std::string&)>;
+
+  static constexpr size_t kDefaultMaxDirectorySize = 16 * 1024 * 1024;
+
+  // If |directory| is empty, the cache is held in memory only.  Otherwise, the
+  // least recently used entry files in it are deleted until the remainder fit
+  // in |max_directory_size| bytes.
+  explicit SpirvCache(std::string directory = "",
+                      size_t max_directory_size = kDefaultMaxDirectorySize);
+  ~SpirvCache();
+
+  // Returns true and sets |spirv_out| if there is a valid entry for |key|.  If
+  // the entry has dependencies, each is read via |reader| and hashed; if any
+  // of them has changed, the entry is discarded and false is returned.  A hit
+  // marks the entry's file as recently used.
+  bool Load(const Hash& key, const DependencyReader& reader,
+            SpirvData* spirv_out);
+  bool Load(const Hash& key, SpirvData* spirv_out) {
+    return Load(key, nullptr, spirv_out);
+  }
+
+  // Adds an entry, replacing any existing entry for |key|.
+  void Store(const Hash& key, SpirvData spirv,
+             std::vector<Dependency> dependencies = {});
+
+  // Returns the hash that Store() expects for a dependency with |contents|.
+  static Hash HashContents(const std::string& contents);
+
+  const std::string& directory() const { return directory_; }
+  uint32_t hit_count() const { return hit_count_; }
+  uint32_t miss_count() const { return miss_count_; }
+  size_t size() const;
+
+ private:
+  struct Entry {
+    SpirvData spirv;
+    std::vector<Dependency> dependencies;
+  };
+
+  // Loads all entries from |directory_|, first deleting the least recently
+  // used ones that don't fit in |max_directory_size_|.  Called by the
+  // constructor.
+  void LoadDirectory();
+
+  // Serialization of entries in |directory_|.
+  std::string EntryPath(const Hash& key) const;
+  static std::string Serialize(const Hash& key, const Entry& entry);
+  static bool Deserialize(const std::string& data, Hash* key_out,
+                          Entry* entry_out);
+
+  const std::string directory_;
+  const size_t max_directory_size_;
+  mutable std::mutex mutex_;
+  HashMap<Hash, Entry> entries_;
+  std::atomic<uint32_t> hit_count_;
+  std::atomic<uint32_t> miss_count_;
+
+  FXL_DISALLOW_COPY_AND_ASSIGN(SpirvCache);
+};
+
+}  // namespace impl
+}  // namespace escher
+
+#endif  // LIB_ESCHER_IMPL_SPIRV_CACHE_H_
@@ -4,18 +4,109 @@
 
 #include "lib/escher/renderer/render_queue.h"
 
+#include <algorithm>
+#include <array>
+
 #include "lib/escher/renderer/render_queue_context.h"
 
 namespace escher {
 
+namespace {
+
+// Below this many items, a comparison sort beats the fixed cost of building
+// radix histograms.
+constexpr size_t kMinRadixSortSize = 256;
+
+constexpr size_t kRadixBits = 8;
+constexpr size_t kRadixSize = 1 << kRadixBits;
+constexpr size_t kRadixPasses = 64 / kRadixBits;
+
+}  // namespace
+
 RenderQueue::RenderQueue() = default;
 RenderQueue::~RenderQueue() = default;
 
 void RenderQueue::Sort() {
-  std::stable_sort(items_.begin(), items_.end(),
-                   [](const RenderQueueItem& a, const RenderQueueItem& b) {
-                     return a.sort_key < b.sort_key;
-                   });
+  const size_t item_count = items_.size();
+  if (item_count < kMinRadixSortSize) {
+    std::stable_sort(items_.begin(), items_.end(),
+                     [](const RenderQueueItem& a, const RenderQueueItem& b) {
+                       return a.sort_key < b.sort_key;
+                     });
+    return;
+  }
+
+  // Build the histograms for all passes at once, so that the items are read
+  // only once before scattering.
+  std::array<std::array<size_t, kRadixSize>, kRadixPasses> histograms = {};
+  for (auto& item : items_) {
+    uint64_t key = item.sort_key;
+    for (size_t pass = 0; pass < kRadixPasses; ++pass) {
+      ++histograms[pass][(key >> (pass * kRadixBits)) & (kRadixSize - 1)];
+    }
+  }
+
+  sort_scratch_.resize(item_count);
+  for (size_t pass = 0; pass < kRadixPasses; ++pass) {
+    auto& histogram = histograms[pass];
+    const size_t shift = pass * kRadixBits;
+
+    // Sort keys typically pack a few fields into the 64 bits, leaving many
+    // bytes identical across all items; those passes would not move anything.
+    if (histogram[(items_[0].sort_key >> shift) & (kRadixSize - 1)] ==
+        item_count) {
+      continue;
+    }
+
+    size_t offset = 0;
+    for (auto& count : histogram) {
+      size_t bucket_size = count;
+      count = offset;
+      offset += bucket_size;
+    }
+
+    // Scattering in order keeps each pass, and therefore the sort, stable.
+    for (auto& item : items_) {
+      sort_scratch_[histogram[(item.sort_key >> shift) & (kRadixSize - 1)]++] =
+          item;
+    }
+    items_.swap(sort_scratch_);
+  }
+}
+
+std::vector<RenderQueue::Range> RenderQueue::SplitIntoRanges(
+    const RenderQueueContext* context, size_t max_range_count) const {
+  FXL_DCHECK(max_range_count > 0);
+  std::vector<Range> ranges;
+  const size_t item_count = items_.size();
+  if (item_count == 0) {
+    return ranges;
+  }
+
+  const uint32_t func_index = context ? context->render_queue_func_to_use : 0;
+  const size_t target_count =
+      (item_count + max_range_count - 1) / max_range_count;
+  ranges.reserve(max_range_count);
+
+  size_t start_index = 0;
+  while (start_index < item_count) {
+    size_t end_index = std::min(start_index + target_count, item_count);
+    while (end_index < item_count && ContinuesBatch(end_index, func_index)) {
+      ++end_index;
+    }
+    ranges.push_back({start_index, end_index - start_index});
+    start_index = end_index;
+  }
+  return ranges;
+}
+
+bool RenderQueue::ContinuesBatch(size_t index, uint32_t func_index) const {
+  FXL_DCHECK(index > 0 && index < items_.size());
+  auto& prev = items_[index - 1];
+  auto& item = items_[index];
+  return prev.object_data == item.object_data &&
+         prev.render_queue_funcs[func_index] ==
+             item.render_queue_funcs[func_index];
 }
 
 void RenderQueue::GenerateCommands(CommandBuffer* cmd_buf,
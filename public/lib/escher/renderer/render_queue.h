@@ -5,6 +5,8 @@
 #ifndef LIB_ESCHER_RENDERER_RENDER_QUEUE_H_
 #define LIB_ESCHER_RENDERER_RENDER_QUEUE_H_
 
+#include <vector>
+
 #include "lib/escher/renderer/render_queue_item.h"
 #include "lib/escher/vk/command_buffer.h"
 
@@ -42,6 +44,9 @@ class RenderQueue final {
   // degree of flexibility in defining sort criteria.  For example, translucent
   // objects must be sorted back-to-front after all opaque objects, whereas
   // opaque objects are more efficiently rendered front-to-back.
+  //
+  // Large queues are sorted with an LSD radix sort, which skips any byte of
+  // the key that is the same for all items.
   void Sort();
 
   // Generate Vulkan commands for items in the queue, by iterating over the
@@ -59,17 +64,42 @@ class RenderQueue final {
 
   // This variant of GenerateCommands() behaves similarly to the one above,
   // except that it only generates commands for a sub-range of the items in the
-  // queue.  This is typically used for debugging.
+  // queue.  This is used for debugging, and to record the ranges returned by
+  // SplitIntoRanges() into separate command buffers.  The queue must not be
+  // modified while commands are being generated.
   void GenerateCommands(CommandBuffer* cmd_buf,
                         const CommandBuffer::SavedState* state,
                         const RenderQueueContext* context, size_t start_index,
                         size_t count) const;
 
+  // A contiguous sub-range of the queue's items, suitable for passing to the
+  // ranged variant of GenerateCommands().
+  struct Range {
+    size_t start_index;
+    size_t count;
+  };
+
+  // Splits the queue into at most |max_range_count| contiguous ranges of
+  // roughly equal size, so that commands for each range can be generated
+  // independently (e.g. on separate threads).  Range boundaries never split a
+  // batch of instances that GenerateCommands() would otherwise render with a
+  // single RenderFunc invocation, given the same |context|.
+  std::vector<Range> SplitIntoRanges(const RenderQueueContext* context,
+                                     size_t max_range_count) const;
+
   void clear() { items_.clear(); }
   size_t size() const { return items_.size(); }
 
  protected:
   std::vector<RenderQueueItem> items_;
+
+ private:
+  // Returns true if the item at |index| would be batched with the item before
+  // it by GenerateCommands(), when using render func |func_index|.
+  bool ContinuesBatch(size_t index, uint32_t func_index) const;
+
+  // Scratch storage for Sort(), retained to avoid reallocating every frame.
+  std::vector<RenderQueueItem> sort_scratch_;
 };
 
 // Inline function definitions.
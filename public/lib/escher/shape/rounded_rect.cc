@@ -159,6 +159,28 @@ void GenerateRoundedRectIndices(const RoundedRectSpec& spec,
 
 namespace {
 
+// Return the unit-length directions, from the center of a rounded corner, of
+// the vertices that subdivide the corner's quarter-circle.  The angles are in
+// the first quadrant, in increasing order.  They are the same for every
+// rounded-rect, so they are computed only once instead of once per corner of
+// each tessellated rounded-rect.
+const vec2* GetRoundedRectCornerDirections() {
+  struct CornerDirections {
+    CornerDirections() {
+      constexpr float kPI = 3.14159265f;
+      constexpr float kAngleStep = kPI / 2 / (kCornerDivisions + 1);
+      float angle = kAngleStep;
+      for (size_t i = 0; i < kCornerDivisions; ++i) {
+        dirs[i] = vec2(cos(angle), sin(angle));
+        angle += kAngleStep;
+      }
+    }
+    vec2 dirs[kCornerDivisions];
+  };
+  static const CornerDirections directions;
+  return directions.dirs;
+}
+
 // Helper for GenerateRoundedRectVertices().
 template <typename VertT>
 void GenerateRoundedRectVertexUVs(const RoundedRectSpec& spec, VertT* verts) {
@@ -196,42 +218,38 @@ void GenerateRoundedRectVertexUVs(const RoundedRectSpec& spec, VertT* verts) {
   // We start at index 13; indices 0-12 were computed above.
   uint32_t out = 13;
 
-  constexpr float kPI = 3.14159265f;
-  constexpr float kAngleStep = kPI / 2 / (kCornerDivisions + 1);
+  // All four corners use the same angles, rotated by multiples of 90 degrees,
+  // so the directions are looked up rather than computed.  Starting from the
+  // first-quadrant direction (c, s), the top-left corner (which begins at 180
+  // degrees) uses (-c, -s), the top-right uses (s, -c), the bottom-right uses
+  // (c, s), and the bottom-left uses (-s, c).
+  const vec2* const dirs = GetRoundedRectCornerDirections();
 
   // Generate UV coordinates for top-left corner.
-  float angle = kPI + kAngleStep;
   vec2 scale =
       vec2(spec.top_left_radius / width, spec.top_left_radius / height);
   for (size_t i = 0; i < kCornerDivisions; ++i) {
-    verts[out++].uv = verts[1].uv + vec2(cos(angle), sin(angle)) * scale;
-    angle += kAngleStep;
+    verts[out++].uv = verts[1].uv + vec2(-dirs[i].x, -dirs[i].y) * scale;
   }
 
   // Generate UV coordinates for top-right corner.
-  angle = 1.5f * kPI + kAngleStep;
   scale = vec2(spec.top_right_radius / width, spec.top_right_radius / height);
   for (size_t i = 0; i < kCornerDivisions; ++i) {
-    verts[out++].uv = verts[2].uv + vec2(cos(angle), sin(angle)) * scale;
-    angle += kAngleStep;
+    verts[out++].uv = verts[2].uv + vec2(dirs[i].y, -dirs[i].x) * scale;
   }
 
   // Generate UV coordinates for bottom-right corner.
-  angle = kAngleStep;
   scale =
       vec2(spec.bottom_right_radius / width, spec.bottom_right_radius / height);
   for (size_t i = 0; i < kCornerDivisions; ++i) {
-    verts[out++].uv = verts[3].uv + vec2(cos(angle), sin(angle)) * scale;
-    angle += kAngleStep;
+    verts[out++].uv = verts[3].uv + dirs[i] * scale;
   }
 
-  // Generate UV coordinates for bottom-right corner.
-  angle = 0.5f * kPI + kAngleStep;
+  // Generate UV coordinates for bottom-left corner.
   scale =
       vec2(spec.bottom_left_radius / width, spec.bottom_left_radius / height);
   for (size_t i = 0; i < kCornerDivisions; ++i) {
-    verts[out++].uv = verts[4].uv + vec2(cos(angle), sin(angle)) * scale;
-    angle += kAngleStep;
+    verts[out++].uv = verts[4].uv + vec2(-dirs[i].y, dirs[i].x) * scale;
   }
 }
 
@@ -4,7 +4,11 @@
 
 #include "lib/escher/geometry/indexed_triangle_mesh_clip.h"
 
+#include <random>
+
 #include "gtest/gtest.h"
+#include "lib/escher/util/stopwatch.h"
+#include "lib/fxl/logging.h"
 
 namespace {
 
@@ -210,4 +214,133 @@ TEST(IndexedTriangleMeshClip, MultipleClips3d) {
                     GetStandardTestMeshBoundingPlanes3d());
 }
 
+// Helper function that returns a grid of |n| x |n| quads spanning [-1,1] in
+// both dimensions, each split into two triangles.  Each vertex has its UV
+// coordinates as an attribute.
+IndexedTriangleMesh2d<vec2> GetGridTestMesh2d(uint32_t n) {
+  IndexedTriangleMesh2d<vec2> mesh;
+  for (uint32_t y = 0; y <= n; ++y) {
+    for (uint32_t x = 0; x <= n; ++x) {
+      vec2 uv(static_cast<float>(x) / n, static_cast<float>(y) / n);
+      mesh.positions.push_back(uv * 2.f - vec2(1, 1));
+      mesh.attributes1.push_back(uv);
+    }
+  }
+  for (uint32_t y = 0; y < n; ++y) {
+    for (uint32_t x = 0; x < n; ++x) {
+      uint32_t i = y * (n + 1) + x;
+      mesh.indices.insert(mesh.indices.end(),
+                          {i, i + 1, i + n + 1, i + 1, i + n + 2, i + n + 1});
+    }
+  }
+  return mesh;
+}
+
+// Planes which clip a diamond out of the grid mesh, so that every plane splits
+// many triangles.
+std::vector<plane2> GetGridTestMeshClipPlanes2d() {
+  const float kDist = -0.7f;
+  return std::vector<plane2>{{glm::normalize(vec2(-1, -1)), kDist},
+                             {glm::normalize(vec2(1, -1)), kDist},
+                             {glm::normalize(vec2(1, 1)), kDist},
+                             {glm::normalize(vec2(-1, 1)), kDist}};
+}
+
+// The batched point test must agree exactly with the single-point version, for
+// every combination of 2D/3D planes and points, and any number of points.
+TEST(IndexedTriangleMeshClip, PlaneClipsPoints) {
+  std::mt19937 generator(1);
+  std::uniform_real_distribution<float> coord(-2.f, 2.f);
+  std::vector<vec3> points3d;
+  std::vector<vec2> points2d;
+  for (size_t i = 0; i < 32; ++i) {
+    points3d.push_back(vec3(coord(generator), coord(generator), 1.f));
+    points2d.push_back(vec2(points3d.back()));
+  }
+  // Include points exactly on the plane.
+  points3d[7] = vec3(0.5f, 0.f, 0.f);
+  points2d[7] = vec2(0.5f, 0.f);
+
+  plane2 p2(vec2(1, 0), 0.5f);
+  plane3 p3(glm::normalize(vec3(1, 2, 3)), 0.25f);
+  for (uint32_t count = 0; count <= 32; ++count) {
+    uint32_t expected_2_2 = 0, expected_2_3 = 0;
+    uint32_t expected_3_2 = 0, expected_3_3 = 0;
+    for (uint32_t i = 0; i < count; ++i) {
+      expected_2_2 |= (PlaneClipsPoint(p2, points2d[i]) ? 1U : 0U) << i;
+      expected_2_3 |= (PlaneClipsPoint(p2, points3d[i]) ? 1U : 0U) << i;
+      expected_3_2 |= (PlaneClipsPoint(p3, points2d[i]) ? 1U : 0U) << i;
+      expected_3_3 |= (PlaneClipsPoint(p3, points3d[i]) ? 1U : 0U) << i;
+    }
+    EXPECT_EQ(expected_2_2, PlaneClipsPoints(p2, points2d.data(), count));
+    EXPECT_EQ(expected_2_3, PlaneClipsPoints(p2, points3d.data(), count));
+    EXPECT_EQ(expected_3_2, PlaneClipsPoints(p3, points2d.data(), count));
+    EXPECT_EQ(expected_3_3, PlaneClipsPoints(p3, points3d.data(), count));
+  }
+}
+
+// Clip a mesh with more vertices than fit in a single word of the clip bitmap,
+// and verify that the output is a valid mesh which lies within the planes.
+TEST(IndexedTriangleMeshClip, GridMesh) {
+  auto mesh = GetGridTestMesh2d(20);
+  auto planes = GetGridTestMeshClipPlanes2d();
+  auto result = IndexedTriangleMeshClip(mesh, planes);
+  auto& output_mesh = result.first;
+  EXPECT_TRUE(output_mesh.IsValid());
+  EXPECT_EQ(planes.size(), result.second.size());
+  EXPECT_GT(output_mesh.triangle_count(), 0U);
+  EXPECT_LT(output_mesh.vertex_count(), mesh.vertex_count());
+
+  for (size_t i = 0; i < output_mesh.vertex_count(); ++i) {
+    auto& pos = output_mesh.positions[i];
+    for (auto& plane : planes) {
+      EXPECT_GT(PlaneDistanceToPoint(plane, pos), -kEpsilon);
+    }
+    // UV coordinates are interpolated along with the position.
+    vec2 expected_uv = 0.5f * (pos + vec2(1, 1));
+    EXPECT_NEAR(expected_uv.x, output_mesh.attributes1[i].x, 0.0001f);
+    EXPECT_NEAR(expected_uv.y, output_mesh.attributes1[i].y, 0.0001f);
+  }
+
+  // Every vertex of the output mesh is used by at least one triangle; no
+  // redundant vertices are generated.
+  std::vector<bool> used(output_mesh.vertex_count(), false);
+  for (auto index : output_mesh.indices) {
+    used[index] = true;
+  }
+  EXPECT_EQ(std::vector<bool>(output_mesh.vertex_count(), true), used);
+}
+
+// Reports the per-triangle cost of clipping meshes of various sizes, both for
+// planes that clip the mesh and for planes that do not (in which case only the
+// per-vertex plane tests are performed).
+TEST(IndexedTriangleMeshClip, DISABLED_Benchmark) {
+  constexpr size_t kIterations = 100;
+  auto clip_planes = GetGridTestMeshClipPlanes2d();
+  std::vector<plane2> unclipped_planes;
+  for (auto& plane : clip_planes) {
+    unclipped_planes.push_back(plane2(plane.dir(), -2.f));
+  }
+
+  for (uint32_t n : {4, 16, 64, 256}) {
+    auto mesh = GetGridTestMesh2d(n);
+    for (auto* planes : {&clip_planes, &unclipped_planes}) {
+      Stopwatch stopwatch;
+      size_t output_triangles = 0;
+      for (size_t i = 0; i < kIterations; ++i) {
+        output_triangles +=
+            IndexedTriangleMeshClip(mesh, *planes).first.triangle_count();
+      }
+      stopwatch.Stop();
+      const double ns_per_triangle = stopwatch.GetElapsedSeconds() * 1e9 /
+                                     (kIterations * mesh.triangle_count());
+      FXL_LOG(INFO) << "IndexedTriangleMeshClip "
+                    << (planes == &clip_planes ? "clipped" : "unclipped")
+                    << ": " << mesh.triangle_count() << " triangles, "
+                    << ns_per_triangle << " ns/triangle ("
+                    << output_triangles / kIterations << " output triangles)";
+    }
+  }
+}
+
 }  // namespace
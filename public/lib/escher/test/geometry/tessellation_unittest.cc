@@ -0,0 +1,91 @@
+// Copyright 2018 The Fuchsia Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "lib/escher/geometry/tessellation.h"
+
+#include <math.h>
+
+#include "gtest/gtest.h"
+#include "lib/escher/shape/mesh_spec.h"
+#include "lib/escher/shape/rounded_rect.h"
+#include "lib/escher/util/stopwatch.h"
+#include "lib/fxl/logging.h"
+
+namespace {
+
+using namespace escher;
+
+const MeshSpec kCircleMeshSpec{
+    .attributes = {MeshAttribute::kPosition2D, MeshAttribute::kUV}};
+
+TEST(Tessellation, CircleIndexedTriangleMesh) {
+  const vec2 center(3, 5);
+  const float radius = 2.f;
+  for (uint32_t subdivisions = 0; subdivisions < 6; ++subdivisions) {
+    auto mesh = NewCircleIndexedTriangleMesh(kCircleMeshSpec, subdivisions,
+                                             center, radius);
+    EXPECT_TRUE(mesh.IsValid());
+    const size_t outer_vertex_count = 4U << subdivisions;
+    ASSERT_EQ(outer_vertex_count + 1, mesh.vertex_count());
+    EXPECT_EQ(outer_vertex_count, mesh.triangle_count());
+    EXPECT_EQ(center, mesh.positions[0]);
+    EXPECT_EQ(vec2(0.5f, 0.5f), mesh.attributes1[0]);
+
+    // Outer vertices are evenly spaced around the circle, starting at +y and
+    // proceeding clockwise.
+    const float radian_step = 2 * M_PI / outer_vertex_count;
+    for (size_t i = 0; i < outer_vertex_count; ++i) {
+      const vec2 dir(sin(i * radian_step), cos(i * radian_step));
+      const vec2& pos = mesh.positions[i + 1];
+      const vec2& uv = mesh.attributes1[i + 1];
+      EXPECT_NEAR(center.x + radius * dir.x, pos.x, 0.00001f);
+      EXPECT_NEAR(center.y + radius * dir.y, pos.y, 0.00001f);
+      EXPECT_NEAR(0.5f * (dir.x + 1.f), uv.x, 0.00001f);
+      EXPECT_NEAR(0.5f * (dir.y + 1.f), uv.y, 0.00001f);
+    }
+  }
+}
+
+// Reports the per-triangle cost of the tessellation that PaperShapeCache
+// performs on a cache miss.
+TEST(Tessellation, DISABLED_Benchmark) {
+  constexpr size_t kIterations = 10000;
+
+  for (uint32_t subdivisions : {2, 4, 6}) {
+    size_t triangle_count = 0;
+    Stopwatch stopwatch;
+    for (size_t i = 0; i < kIterations; ++i) {
+      triangle_count += NewCircleIndexedTriangleMesh(
+                            kCircleMeshSpec, subdivisions, vec2(0, 0), 1.f)
+                            .triangle_count();
+    }
+    stopwatch.Stop();
+    FXL_LOG(INFO) << "circle, " << subdivisions << " subdivisions: "
+                  << stopwatch.GetElapsedSeconds() * 1e9 / triangle_count
+                  << " ns/triangle";
+  }
+
+  {
+    RoundedRectSpec spec(100, 500, 10, 20, 30, 40);
+    MeshSpec mesh_spec{MeshAttribute::kPosition2D | MeshAttribute::kUV};
+    auto counts = GetRoundedRectMeshVertexAndIndexCounts(spec);
+    std::vector<uint8_t> vertices(counts.first * mesh_spec.stride(0));
+    std::vector<uint32_t> indices(counts.second);
+
+    Stopwatch stopwatch;
+    for (size_t i = 0; i < kIterations; ++i) {
+      GenerateRoundedRectVertices(spec, mesh_spec, vertices.data(),
+                                  vertices.size());
+      GenerateRoundedRectIndices(spec, mesh_spec, indices.data(),
+                                 indices.size() * sizeof(uint32_t));
+    }
+    stopwatch.Stop();
+    FXL_LOG(INFO) << "rounded-rect: "
+                  << stopwatch.GetElapsedSeconds() * 1e9 /
+                         (kIterations * counts.second / 3)
+                  << " ns/triangle";
+  }
+}
+
+}  // namespace
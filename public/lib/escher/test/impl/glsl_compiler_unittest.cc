@@ -4,6 +4,9 @@
 
 #include "lib/escher/impl/glsl_compiler.h"
 #include "gtest/gtest.h"
+#include "lib/escher/impl/spirv_cache.h"
+#include "lib/escher/util/stopwatch.h"
+#include "lib/fxl/files/scoped_temp_dir.h"
 #include "lib/fxl/logging.h"
 
 namespace escher {
@@ -81,6 +84,39 @@ TEST(GlslCompiler, DISABLED_CompileInParallel) {
   EXPECT_GT(result2.get().size(), 0U);
 }
 
+// Compiles with a persistent SpirvCache, first with an empty cache directory
+// and then with a new cache over the same directory, as after a restart.
+// TODO(ES-125): disabled due to memory leak in SPIRV-tools.
+TEST(GlslCompiler, DISABLED_ColdAndWarmCache) {
+  files::ScopedTempDir temp_dir;
+  std::vector<std::string> vertex = {{vertex_src}};
+  std::vector<std::string> fragment = {{fragment_src}};
+  SpirvData cold_spirv;
+
+  for (const char* label : {"cold", "warm"}) {
+    SpirvCache cache(temp_dir.path());
+    GlslToSpirvCompiler compiler(&cache);
+    Stopwatch stopwatch;
+    SpirvData spirv =
+        compiler.Compile(vk::ShaderStageFlagBits::eVertex, vertex, "", "main")
+            .get();
+    compiler.Compile(vk::ShaderStageFlagBits::eFragment, fragment, "", "main")
+        .get();
+    stopwatch.Stop();
+    FXL_LOG(INFO) << label << ": " << stopwatch.GetElapsedMicroseconds()
+                  << " us, " << cache.hit_count() << " hits, "
+                  << cache.miss_count() << " misses";
+
+    if (cold_spirv.empty()) {
+      EXPECT_EQ(0U, cache.hit_count());
+      cold_spirv = spirv;
+    } else {
+      EXPECT_EQ(2U, cache.hit_count());
+      EXPECT_EQ(cold_spirv, spirv);
+    }
+  }
+}
+
 }  // namespace
 }  // namespace impl
 }  // namespace escher
@@ -0,0 +1,174 @@
+// Copyright 2018 The Fuchsia Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "lib/escher/impl/spirv_cache.h"
+
+#include <sys/time.h>
+
+#include <map>
+
+#include "gtest/gtest.h"
+#include "lib/fxl/files/directory.h"
+#include "lib/fxl/files/file.h"
+#include "lib/fxl/files/scoped_temp_dir.h"
+
+namespace escher {
+namespace impl {
+namespace {
+
+const Hash kKey1 = {1};
+const Hash kKey2 = {2};
+const Hash kKey3 = {3};
+const SpirvData kSpirv1 = {0x07230203, 1, 2, 3};
+const SpirvData kSpirv2 = {0x07230203, 4, 5, 6, 7};
+
+TEST(SpirvCache, InMemory) {
+  SpirvCache cache;
+  SpirvData spirv;
+  EXPECT_FALSE(cache.Load(kKey1, &spirv));
+
+  cache.Store(kKey1, kSpirv1);
+  cache.Store(kKey2, kSpirv2);
+  EXPECT_TRUE(cache.Load(kKey1, &spirv));
+  EXPECT_EQ(kSpirv1, spirv);
+  EXPECT_TRUE(cache.Load(kKey2, &spirv));
+  EXPECT_EQ(kSpirv2, spirv);
+
+  EXPECT_EQ(2U, cache.size());
+  EXPECT_EQ(2U, cache.hit_count());
+  EXPECT_EQ(1U, cache.miss_count());
+}
+
+TEST(SpirvCache, Dependencies) {
+  std::map<std::string, std::string> files = {{"a.glsl", "foo"},
+                                              {"b.glsl", "bar"}};
+  auto reader = [&files](const std::string& path) { return files[path]; };
+
+  SpirvCache cache;
+  cache.Store(kKey1, kSpirv1,
+              {{"a.glsl", SpirvCache::HashContents("foo")},
+               {"b.glsl", SpirvCache::HashContents("bar")}});
+
+  SpirvData spirv;
+  EXPECT_TRUE(cache.Load(kKey1, reader, &spirv));
+  EXPECT_EQ(kSpirv1, spirv);
+
+  // Entries with dependencies can't be used without a way to validate them.
+  EXPECT_FALSE(cache.Load(kKey1, &spirv));
+  cache.Store(kKey1, kSpirv1,
+              {{"a.glsl", SpirvCache::HashContents("foo")},
+               {"b.glsl", SpirvCache::HashContents("bar")}});
+
+  // Changing a dependency invalidates the entry.
+  files["b.glsl"] = "baz";
+  EXPECT_FALSE(cache.Load(kKey1, reader, &spirv));
+  files["b.glsl"] = "bar";
+  EXPECT_FALSE(cache.Load(kKey1, reader, &spirv));
+  EXPECT_EQ(0U, cache.size());
+}
+
+TEST(SpirvCache, Persistence) {
+  files::ScopedTempDir temp_dir;
+  std::string directory = temp_dir.path() + "/spirv";
+
+  {
+    SpirvCache cache(directory);
+    EXPECT_EQ(0U, cache.size());
+    cache.Store(kKey1, kSpirv1);
+    cache.Store(kKey2, kSpirv2, {{"a.glsl", SpirvCache::HashContents("foo")}});
+  }
+
+  // A new cache, as in a new process, loads the entries written by the first.
+  SpirvCache cache(directory);
+  EXPECT_EQ(2U, cache.size());
+  SpirvData spirv;
+  EXPECT_TRUE(cache.Load(kKey1, &spirv));
+  EXPECT_EQ(kSpirv1, spirv);
+  EXPECT_TRUE(cache.Load(
+      kKey2, [](const std::string& path) { return std::string("foo"); },
+      &spirv));
+  EXPECT_EQ(kSpirv2, spirv);
+}
+
+TEST(SpirvCache, CorruptEntriesAreDiscarded) {
+  files::ScopedTempDir temp_dir;
+  std::string directory = temp_dir.path();
+
+  {
+    SpirvCache cache(directory);
+    cache.Store(kKey1, kSpirv1);
+  }
+  std::vector<std::string> names;
+  ASSERT_TRUE(files::ReadDirContents(directory, &names));
+  std::string path;
+  for (auto& name : names) {
+    if (name != "." && name != "..") {
+      path = directory + "/" + name;
+    }
+  }
+  ASSERT_FALSE(path.empty());
+
+  // Truncate the entry.
+  std::string data;
+  ASSERT_TRUE(files::ReadFileToString(path, &data));
+  data.resize(data.size() - 1);
+  ASSERT_TRUE(files::WriteFile(path, data.data(), data.size()));
+
+  SpirvCache cache(directory);
+  EXPECT_EQ(0U, cache.size());
+  EXPECT_FALSE(files::IsFile(path));
+}
+
+// Sets the time of last use of an entry file, as seen by pruning.
+bool SetLastUse(const std::string& path, time_t seconds_ago) {
+  struct timeval now;
+  gettimeofday(&now, nullptr);
+  struct timeval times[2] = {now, now};
+  times[0].tv_sec -= seconds_ago;
+  times[1].tv_sec -= seconds_ago;
+  return utimes(path.c_str(), times) == 0;
+}
+
+TEST(SpirvCache, PruningKeepsRecentlyUsedEntries) {
+  files::ScopedTempDir temp_dir;
+  std::string directory = temp_dir.path();
+  const std::string path1 = directory + "/0000000000000001.spv";
+  const std::string path2 = directory + "/0000000000000002.spv";
+  const std::string path3 = directory + "/0000000000000003.spv";
+
+  {
+    SpirvCache cache(directory);
+    cache.Store(kKey1, kSpirv1);
+    cache.Store(kKey2, kSpirv1);
+    cache.Store(kKey3, kSpirv1);
+  }
+  ASSERT_TRUE(SetLastUse(path1, 300));
+  ASSERT_TRUE(SetLastUse(path2, 200));
+  ASSERT_TRUE(SetLastUse(path3, 100));
+  std::string data;
+  ASSERT_TRUE(files::ReadFileToString(path1, &data));
+  const size_t entry_size = data.size();
+
+  // Within the limit, nothing is pruned.  Using the oldest entry makes it the
+  // most recently used one.
+  {
+    SpirvCache cache(directory, 3 * entry_size);
+    EXPECT_EQ(3U, cache.size());
+    SpirvData spirv;
+    EXPECT_TRUE(cache.Load(kKey1, &spirv));
+  }
+
+  // Over the limit, the least recently used entry is deleted.
+  SpirvCache cache(directory, 2 * entry_size);
+  EXPECT_EQ(2U, cache.size());
+  SpirvData spirv;
+  EXPECT_TRUE(cache.Load(kKey1, &spirv));
+  EXPECT_TRUE(cache.Load(kKey3, &spirv));
+  EXPECT_FALSE(cache.Load(kKey2, &spirv));
+  EXPECT_FALSE(files::IsFile(path2));
+}
+
+}  // namespace
+}  // namespace impl
+}  // namespace escher
@@ -4,7 +4,16 @@
 
 #include "lib/escher/renderer/render_queue.h"
 
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <random>
+#include <thread>
+
+#include <vulkan/vulkan.hpp>
+
 #include "lib/escher/renderer/render_queue_context.h"
+#include "lib/fxl/logging.h"
 
 #include "gtest/gtest.h"
 
@@ -264,4 +273,225 @@ TEST(RenderQueue, MultipleFuncs) {
   EXPECT_EQ(2U, stats.invocations[3].instance_data.size());
 }
 
+// Large enough that Sort() uses a radix sort rather than a comparison sort.
+TEST(RenderQueue, SortLargeQueue) {
+  constexpr uint32_t kItemCount = 10000;
+  RenderQueue queue;
+  TestStatistics stats;
+  std::vector<TestRenderObject> objects(kItemCount);
+  TestRenderInstance inst;
+
+  // Use few distinct keys, so that there are many ties, and vary both low and
+  // high bytes so that several radix passes are required.
+  std::mt19937_64 random(1);
+  for (uint32_t i = 0; i < kItemCount; ++i) {
+    objects[i] = {.id = i, .stats = &stats};
+    uint64_t sort_key = (random() % 50) << 40 | (random() % 50);
+    queue.Push(sort_key, &objects[i], &inst, {RenderFuncOne});
+  }
+
+  queue.Sort();
+  queue.GenerateCommands(nullptr, nullptr);
+
+  // Each item has its own object, so there is one invocation per item.  Items
+  // must appear in order of their sort-key, and items with equal sort-keys
+  // must appear in the order they were pushed.
+  ASSERT_EQ(kItemCount, stats.invocations.size());
+  for (uint32_t i = 1; i < kItemCount; ++i) {
+    auto& prev = stats.invocations[i - 1];
+    auto& cur = stats.invocations[i];
+    ASSERT_LE(prev.sort_keys[0], cur.sort_keys[0]);
+    if (prev.sort_keys[0] == cur.sort_keys[0]) {
+      ASSERT_LT(prev.obj_id, cur.obj_id);
+    }
+  }
+}
+
+TEST(RenderQueue, SplitIntoRanges) {
+  RenderQueue queue;
+  TestStatistics stats;
+  TestRenderObject one = {.id = 1, .stats = &stats};
+  TestRenderObject two = {.id = 2, .stats = &stats};
+  TestRenderObject three = {.id = 3, .stats = &stats};
+  TestRenderInstance inst;
+
+  // Batches of 5, 1, 4 and 2 instances.
+  for (int i = 0; i < 5; ++i) {
+    queue.Push(0, &one, &inst, {RenderFuncOne});
+  }
+  queue.Push(0, &two, &inst, {RenderFuncOne});
+  for (int i = 0; i < 4; ++i) {
+    queue.Push(0, &three, &inst, {RenderFuncOne});
+  }
+  for (int i = 0; i < 2; ++i) {
+    queue.Push(0, &three, &inst, {RenderFuncTwo});
+  }
+
+  EXPECT_TRUE(RenderQueue().SplitIntoRanges(nullptr, 4).empty());
+
+  auto whole = queue.SplitIntoRanges(nullptr, 1);
+  ASSERT_EQ(1U, whole.size());
+  EXPECT_EQ(0U, whole[0].start_index);
+  EXPECT_EQ(12U, whole[0].count);
+
+  // The first range would hold 3 items, but is extended to the end of the
+  // first batch.  The second range would end after item 8, in the middle of
+  // the third batch.
+  auto ranges = queue.SplitIntoRanges(nullptr, 4);
+  ASSERT_EQ(3U, ranges.size());
+  EXPECT_EQ(0U, ranges[0].start_index);
+  EXPECT_EQ(5U, ranges[0].count);
+  EXPECT_EQ(5U, ranges[1].start_index);
+  EXPECT_EQ(5U, ranges[1].count);
+  EXPECT_EQ(10U, ranges[2].start_index);
+  EXPECT_EQ(2U, ranges[2].count);
+
+  // Generating commands range-by-range yields the same invocations as
+  // generating them for the whole queue.
+  for (auto& range : ranges) {
+    queue.GenerateCommands(nullptr, nullptr, nullptr, range.start_index,
+                           range.count);
+  }
+  ASSERT_EQ(4U, stats.invocations.size());
+  EXPECT_EQ(5U, stats.invocations[0].instance_data.size());
+  EXPECT_EQ(1U, stats.invocations[1].instance_data.size());
+  EXPECT_EQ(4U, stats.invocations[2].instance_data.size());
+  EXPECT_EQ(2U, stats.invocations[3].instance_data.size());
+}
+
+// The benchmark below records Vulkan commands with null handles, which only
+// escher_null_vulkan accepts.
+#ifdef ESCHER_USE_NULL_VULKAN
+
+// Per-object data for the benchmark below: the state that a mesh draw binds.
+// escher_null_vulkan's commands ignore their arguments, so null handles do.
+struct BenchmarkRenderObject {
+  vk::Pipeline pipeline;
+  vk::PipelineLayout pipeline_layout;
+  vk::DescriptorSet descriptor_set;
+  vk::Buffer vertex_buffer;
+  vk::Buffer index_buffer;
+  uint32_t index_count = 36;
+};
+
+// Per-draw-call data for the benchmark below: where the instance's uniforms
+// live in a dynamic uniform buffer.
+struct BenchmarkRenderInstance {
+  uint32_t uniform_offset = 0;
+};
+
+// Counts the instances rendered on the calling thread, so that the benchmark
+// below can generate commands on several threads without contention.
+thread_local uint64_t benchmark_instance_count = 0;
+
+// Records the Vulkan commands of a batch of mesh draws, as ModelRenderer does:
+// bind the object's pipeline and mesh once, then bind each instance's
+// uniforms and draw it.
+void BenchmarkRenderFunc(CommandBuffer* cb, const RenderQueueContext* context,
+                         const RenderQueueItem* items,
+                         uint32_t instance_count) {
+  auto* obj = static_cast<const BenchmarkRenderObject*>(items[0].object_data);
+  vk::CommandBuffer vk_command_buffer;
+  vk::DeviceSize vertex_offset = 0;
+  vk_command_buffer.bindPipeline(vk::PipelineBindPoint::eGraphics,
+                                 obj->pipeline);
+  vk_command_buffer.bindVertexBuffers(0, 1, &obj->vertex_buffer,
+                                      &vertex_offset);
+  vk_command_buffer.bindIndexBuffer(obj->index_buffer, 0,
+                                    vk::IndexType::eUint32);
+  for (uint32_t i = 0; i < instance_count; ++i) {
+    auto* inst =
+        static_cast<const BenchmarkRenderInstance*>(items[i].instance_data);
+    vk_command_buffer.bindDescriptorSets(
+        vk::PipelineBindPoint::eGraphics, obj->pipeline_layout, 0, 1,
+        &obj->descriptor_set, 1, &inst->uniform_offset);
+    vk_command_buffer.drawIndexed(obj->index_count, 1, 0, 0, 0);
+  }
+  benchmark_instance_count += instance_count;
+}
+
+double MillisecondsSince(std::chrono::steady_clock::time_point start) {
+  return std::chrono::duration<double, std::milli>(
+             std::chrono::steady_clock::now() - start)
+      .count();
+}
+
+// Reports CPU time spent sorting and generating commands, for a range of
+// queue sizes.  Commands are generated both on one thread and split across
+// one thread per core, as they would be when recording a command buffer per
+// thread.  The render-func records real Vulkan commands, which land in
+// escher_null_vulkan's no-op implementation, so the times cover the queue and
+// the Vulkan entry points but not a driver.
+TEST(RenderQueue, DISABLED_SortAndGenerateBenchmark) {
+  constexpr size_t kInstancesPerObject = 4;
+  const size_t thread_count = std::max(1U, std::thread::hardware_concurrency());
+  FXL_LOG(INFO) << "RenderQueue benchmark: " << thread_count << " threads";
+
+  for (size_t item_count : {1000, 10000, 100000, 1000000}) {
+    std::vector<BenchmarkRenderObject> objects(item_count /
+                                               kInstancesPerObject);
+    std::vector<BenchmarkRenderInstance> instances(item_count);
+    std::mt19937_64 random(1);
+
+    // Depth-like keys: a few bits of pipeline in the high bytes, and a
+    // per-object depth in the low bytes.
+    RenderQueue queue;
+    std::vector<RenderQueueItem> items;
+    for (size_t i = 0; i < item_count; ++i) {
+      instances[i].uniform_offset = static_cast<uint32_t>(i * 256);
+      uint64_t sort_key = (random() % 8) << 48 | (random() & 0xffffff);
+      items.push_back({sort_key, &objects[i / kInstancesPerObject],
+                       &instances[i], {BenchmarkRenderFunc}});
+      queue.Push(items.back());
+    }
+
+    auto start = std::chrono::steady_clock::now();
+    std::stable_sort(items.begin(), items.end(),
+                     [](const RenderQueueItem& a, const RenderQueueItem& b) {
+                       return a.sort_key < b.sort_key;
+                     });
+    double stable_sort_ms = MillisecondsSince(start);
+
+    start = std::chrono::steady_clock::now();
+    queue.Sort();
+    double sort_ms = MillisecondsSince(start);
+
+    // Re-push in object order, so that instances are batched.
+    queue.clear();
+    for (size_t i = 0; i < item_count; ++i) {
+      queue.Push(i, &objects[i / kInstancesPerObject], &instances[i],
+                 {BenchmarkRenderFunc});
+    }
+
+    start = std::chrono::steady_clock::now();
+    queue.GenerateCommands(nullptr, nullptr);
+    double generate_ms = MillisecondsSince(start);
+    EXPECT_EQ(item_count, benchmark_instance_count);
+    benchmark_instance_count = 0;
+
+    start = std::chrono::steady_clock::now();
+    std::vector<std::thread> threads;
+    std::atomic<uint64_t> total_instance_count(0);
+    for (auto& range : queue.SplitIntoRanges(nullptr, thread_count)) {
+      threads.emplace_back([&queue, &total_instance_count, range] {
+        queue.GenerateCommands(nullptr, nullptr, nullptr, range.start_index,
+                               range.count);
+        total_instance_count += benchmark_instance_count;
+      });
+    }
+    for (auto& thread : threads) {
+      thread.join();
+    }
+    double parallel_generate_ms = MillisecondsSince(start);
+    EXPECT_EQ(item_count, total_instance_count);
+
+    FXL_LOG(INFO) << item_count << " items: sort " << sort_ms
+                  << " ms (stable_sort " << stable_sort_ms << " ms), generate "
+                  << generate_ms << " ms (" << threads.size() << " threads "
+                  << parallel_generate_ms << " ms)";
+  }
+}
+
+#endif  // ESCHER_USE_NULL_VULKAN
+
 }  // namespace
@@ -25,6 +25,7 @@
 
 #include "lib/escher/third_party/granite/vk/command_buffer_pipeline_state.h"
 
+#include "lib/escher/escher.h"
 #include "lib/escher/impl/vulkan_utils.h"
 #include "lib/escher/third_party/granite/vk/pipeline_layout.h"
 #include "lib/escher/third_party/granite/vk/render_pass.h"
@@ -337,8 +338,8 @@ vk::Pipeline CommandBufferPipelineState::BuildGraphicsPipeline(
   pipeline_info.stageCount = num_stages;
 
   TRACE_DURATION("gfx", "escher::CommandBuffer::BuildGraphicsPipeline[vulkan]");
-  return ESCHER_CHECKED_VK_RESULT(
-      program->vk_device().createGraphicsPipeline(nullptr, pipeline_info));
+  return ESCHER_CHECKED_VK_RESULT(program->vk_device().createGraphicsPipeline(
+      program->escher()->vk_pipeline_cache(), pipeline_info));
 }
 
 void CommandBufferPipelineState::SetVertexAttributes(uint32_t binding,
@@ -40,6 +40,13 @@ class Bitmap {
     *bits &= ~(1 << shift);
   }
 
+  // Overwrite the 32 values starting at |offset|, which must be a multiple of
+  // 32; bit i of |bits| becomes the value at |offset + i|.
+  void SetBlock(uint32_t offset, uint32_t bits) {
+    FXL_DCHECK(offset % 32 == 0);
+    *GetBits(offset) = bits;
+  }
+
   // Clear all values in the bitmap to 0.
   void ClearAll() {
     for (uint32_t i = 0; i < bits_size_; ++i) {
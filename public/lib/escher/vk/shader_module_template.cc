@@ -4,13 +4,39 @@
 
 #include "lib/escher/vk/shader_module_template.h"
 
+#include "lib/escher/impl/spirv_cache.h"
 #include "lib/escher/util/hasher.h"
+#include "lib/escher/util/trace_macros.h"
+#include "spirv-tools/libspirv.h"
 #include "third_party/shaderc/libshaderc/include/shaderc/shaderc.hpp"
 
 namespace escher {
 
 namespace {
 
+// Compile options shared by all variants.  They are part of the SpirvCache key.
+constexpr shaderc_optimization_level kOptimizationLevel =
+    shaderc_optimization_level_performance;
+constexpr shaderc_target_env kTargetEnv = shaderc_target_env_vulkan;
+// TODO(SCN-665): update this once we can rely upon Vulkan 1.1.
+constexpr uint32_t kTargetEnvVersion = shaderc_env_version_vulkan_1_0;
+
+// Hashes the compiler version and the shared compile options, so that cached
+// SPIR-V isn't used after either changes.  shaderc doesn't report its own
+// version, so the SPIR-V version it generates and the version of the
+// SPIRV-Tools it optimizes with stand in for it.
+void HashCompilerConfiguration(Hasher* h) {
+  unsigned int spirv_version;
+  unsigned int spirv_revision;
+  shaderc_get_spv_version(&spirv_version, &spirv_revision);
+  h->u32(spirv_version);
+  h->u32(spirv_revision);
+  h->const_chars(spvSoftwareVersionDetailsString());
+  h->u32(kOptimizationLevel);
+  h->u32(kTargetEnv);
+  h->u32(kTargetEnvVersion);
+}
+
 shaderc_shader_kind ShaderStageToKind(ShaderStage stage) {
   switch (stage) {
     case ShaderStage::kVertex:
@@ -33,8 +59,11 @@ shaderc_shader_kind ShaderStageToKind(ShaderStage stage) {
 
 class Includer : public shaderc::CompileOptions::IncluderInterface {
  public:
-  explicit Includer(HackFilesystemWatcher* filesystem_watcher)
-      : filesystem_watcher_(filesystem_watcher) {}
+  // The path and contents-hash of each included file are appended to
+  // |dependencies|, if it is not null.
+  Includer(HackFilesystemWatcher* filesystem_watcher,
+           std::vector<impl::SpirvCache::Dependency>* dependencies)
+      : filesystem_watcher_(filesystem_watcher), dependencies_(dependencies) {}
 
   ~Includer() override {
     FXL_DCHECK(result_map_.empty())
@@ -67,6 +96,11 @@ class Includer : public shaderc::CompileOptions::IncluderInterface {
 
     record->file_path = requested_source;
     record->file_contents = filesystem_watcher_->ReadFile(record->file_path);
+    if (dependencies_) {
+      dependencies_->emplace_back(
+          record->file_path,
+          impl::SpirvCache::HashContents(record->file_contents));
+    }
 
     if (record->file_contents.empty()) {
       record->error_msg = "ShaderModuleTemplate: file not found.";
@@ -87,6 +121,7 @@ class Includer : public shaderc::CompileOptions::IncluderInterface {
 
  private:
   HackFilesystemWatcher* const filesystem_watcher_;
+  std::vector<impl::SpirvCache::Dependency>* const dependencies_;
   std::unordered_map<shaderc_include_result*, std::unique_ptr<ResultRecord>>
       result_map_;
 };
@@ -97,9 +132,11 @@ ShaderModuleTemplate::ShaderModuleTemplate(vk::Device device,
                                            shaderc::Compiler* compiler,
                                            ShaderStage shader_stage,
                                            HackFilePath path,
-                                           HackFilesystemPtr filesystem)
+                                           HackFilesystemPtr filesystem,
+                                           impl::SpirvCache* spirv_cache)
     : device_(device),
       compiler_(compiler),
+      spirv_cache_(spirv_cache),
       shader_stage_(shader_stage),
       path_(std::move(path)),
       filesystem_(std::move(filesystem)) {}
@@ -169,31 +206,67 @@ void ShaderModuleTemplate::Variant::ScheduleCompilation() {
 }
 
 void ShaderModuleTemplate::Variant::Compile() {
+  TRACE_DURATION("gfx", "escher::ShaderModuleTemplate::Variant::Compile");
   // Clear watcher paths; we'll gather new ones during compilation.
   filesystem_watcher_->ClearPaths();
 
+  auto main_file = filesystem_watcher_->ReadFile(template_->path_);
+
+  // Reading the dependencies of a cached entry also watches them, just as
+  // compilation would.
+  impl::SpirvCache* const spirv_cache = template_->spirv_cache_;
+  Hash cache_key;
+  if (spirv_cache) {
+    Hasher h;
+    HashCompilerConfiguration(&h);
+    h.u32(static_cast<uint32_t>(shader_stage()));
+    h.string(template_->path_);
+    h.string(main_file);
+    for (auto& define : args_.definitions()) {
+      h.string(define.first);
+      h.string(define.second);
+    }
+    cache_key = h.value();
+
+    std::vector<uint32_t> spirv;
+    if (spirv_cache->Load(cache_key,
+                          [this](const std::string& path) {
+                            return filesystem_watcher_->ReadFile(path);
+                          },
+                          &spirv)) {
+      RecreateModuleFromSpirvAndNotifyListeners(std::move(spirv));
+      return;
+    }
+    // The failed lookup may have watched paths that the new compilation
+    // doesn't use.
+    filesystem_watcher_->ClearPaths();
+    filesystem_watcher_->AddPath(template_->path_);
+  }
+
   // Initialize compilation options.
+  std::vector<impl::SpirvCache::Dependency> dependencies;
   shaderc::CompileOptions options;
   for (auto& define : args_.definitions()) {
     options.AddMacroDefinition(define.first, define.second);
   }
-  options.SetOptimizationLevel(shaderc_optimization_level_performance);
-  options.SetIncluder(std::make_unique<Includer>(filesystem_watcher_.get()));
-  // TODO(SCN-665): update this once we can rely upon Vulkan 1.1.
-  options.SetTargetEnvironment(shaderc_target_env_vulkan,
-                               shaderc_env_version_vulkan_1_0);
+  options.SetOptimizationLevel(kOptimizationLevel);
+  options.SetIncluder(std::make_unique<Includer>(
+      filesystem_watcher_.get(), spirv_cache ? &dependencies : nullptr));
+  options.SetTargetEnvironment(kTargetEnv, kTargetEnvVersion);
   options.SetWarningsAsErrors();
 
   // Compile GLSL to SPIR-V, keeping track of paths as we go.
-  auto main_file = filesystem_watcher_->ReadFile(template_->path_);
-
   auto result = template_->compiler_->CompileGlslToSpv(
       main_file.data(), main_file.size(), ShaderStageToKind(shader_stage()),
       template_->path_.c_str(), "main", options);
 
   auto status = result.GetCompilationStatus();
   if (status == shaderc_compilation_status_success) {
-    RecreateModuleFromSpirvAndNotifyListeners({result.cbegin(), result.cend()});
+    std::vector<uint32_t> spirv(result.cbegin(), result.cend());
+    if (spirv_cache) {
+      spirv_cache->Store(cache_key, spirv, std::move(dependencies));
+    }
+    RecreateModuleFromSpirvAndNotifyListeners(std::move(spirv));
   } else {
     FXL_LOG(ERROR) << "Shader compilation failed with status: " << status
                    << " msg: " << result.GetErrorMessage();
@@ -29,12 +29,17 @@ using ShaderModuleTemplatePtr = fxl::RefPtr<ShaderModuleTemplate>;
 // preprocessor definitions.  The base file can #include other files, and
 // different variants may include different sets of files, depending on whether
 // various #include directives are "#ifdeffed out".
+//
+// If a SpirvCache is provided, compiled variants are looked up in it before
+// compiling.  Each cache entry records the files that were #included, so that
+// the entry is not used if any of them has changed.
 class ShaderModuleTemplate
     : public fxl::RefCountedThreadSafe<ShaderModuleTemplate> {
  public:
   ShaderModuleTemplate(vk::Device device, shaderc::Compiler* compiler,
                        ShaderStage shader_stage, HackFilePath path,
-                       HackFilesystemPtr filesystem);
+                       HackFilesystemPtr filesystem,
+                       impl::SpirvCache* spirv_cache = nullptr);
 
   ~ShaderModuleTemplate();
 
@@ -94,6 +99,7 @@ class ShaderModuleTemplate
   // that's where they came from).
   vk::Device device_;
   shaderc::Compiler* const compiler_;
+  impl::SpirvCache* const spirv_cache_;
 
   ShaderStage shader_stage_;
   HackFilePath path_;
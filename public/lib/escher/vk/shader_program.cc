@@ -131,7 +131,7 @@ void ShaderProgram::ObtainPipelineLayout() {
     info.stage.module = compute_module->vk();
     info.stage.pName = "main";
     compute_pipeline_ = ESCHER_CHECKED_VK_RESULT(
-        vk_device().createComputePipeline(nullptr, info));
+        vk_device().createComputePipeline(escher()->vk_pipeline_cache(), info));
   }
 }
 
@@ -6,6 +6,7 @@
 
 #include <fbl/algorithm.h>
 #include <math.h>
+#include <algorithm>
 
 #include "garnet/public/lib/fxl/logging.h"
 #include "garnet/public/lib/media/audio_dfx/audio_device_fx.h"
@@ -57,10 +58,10 @@ DfxDelay* DfxDelay::Create(uint32_t frame_rate, uint16_t channels_in,
 DfxDelay::DfxDelay(uint32_t frame_rate, uint16_t channels)
     : DfxBase(Effect::Delay, kNumControls, frame_rate, channels, channels,
               kLatencyFrames, kLatencyFrames) {
-  // This buff must accomodate our maximum delay, plus the largest 'num_frames'
-  // required by process_inplace -- which can be as large as frame_rate.
-  delay_buff_ =
-      std::make_unique<float[]>((kMaxDelayFrames + frame_rate) * channels);
+  // These buffs must accomodate our maximum delay. Samples pass through them as
+  // a ring, so they need not also hold the largest process_inplace buffer.
+  delay_buff_ = std::make_unique<float[]>(kMaxDelayFrames * channels);
+  spare_buff_ = std::make_unique<float[]>(kMaxDelayFrames * channels);
 
   Reset();
 }
@@ -97,28 +98,59 @@ bool DfxDelay::Reset() {
 
 // Delay the incoming stream by the number of frames specified in control 0.
 //
-// TODO: with circular buffer, optimize 2N+D to N+min(N,D), where N=num_frames;
-// D=delay. Suggested algorithm: 1.copy min(N,D) from aud_buf to cache;
-// 2.shift max(N-D,0) within aud_buf; 3.copy min(N,D) from cache to aud_buf.
+// The delay line is a ring, so unlike a linear cache it never needs shifting
+// down; each call costs N+min(N,D) sample moves (N=num_frames, D=delay).
 bool DfxDelay::ProcessInplace(uint32_t num_frames, float* audio_buff) {
-  if (delay_samples_ > 0) {
-    uint32_t audio_buff_bytes = num_frames * channels_in_ * sizeof(float);
-
-    // DfxDelay maintains a "delay cache" containing the next samples to emit.
-    // 1) Copy all samples from audio_buff to delay cache (after previous ones).
-    ::memcpy(delay_buff_.get() + delay_samples_, audio_buff, audio_buff_bytes);
-    // 2) Fill audio_buff, from front of the delay cache.
-    ::memcpy(audio_buff, delay_buff_.get(), audio_buff_bytes);
-    // 3) Shift the remaining cached samples to the front of the delay cache.
-    ::memmove(delay_buff_.get(), delay_buff_.get() + num_frames * channels_in_,
-              delay_samples_ * sizeof(float));
+  if (delay_samples_ == 0) {
+    return true;
+  }
+
+  uint32_t num_samples = num_frames * channels_in_;
+
+  if (num_samples >= delay_samples_) {
+    // The entire delay line is emitted, and replaced by the end of audio_buff.
+    // 1) Copy the last D samples of audio_buff into the spare buffer.
+    // 2) Shift the remaining N-D samples to the end of audio_buff.
+    // 3) Fill the start of audio_buff from the delay line, oldest first.
+    // 4) The spare buffer becomes the delay line, starting at position 0.
+    uint32_t shift_samples = num_samples - delay_samples_;
+    ::memcpy(spare_buff_.get(), audio_buff + shift_samples,
+             delay_samples_ * sizeof(float));
+    ::memmove(audio_buff + delay_samples_, audio_buff,
+              shift_samples * sizeof(float));
+
+    uint32_t first_samples = delay_samples_ - ring_pos_;
+    ::memcpy(audio_buff, delay_buff_.get() + ring_pos_,
+             first_samples * sizeof(float));
+    ::memcpy(audio_buff + first_samples, delay_buff_.get(),
+             ring_pos_ * sizeof(float));
+
+    delay_buff_.swap(spare_buff_);
+    ring_pos_ = 0;
+  } else {
+    // Only part of the delay line is emitted: each incoming sample trades
+    // places with the sample that entered the delay line D samples earlier.
+    while (num_samples > 0) {
+      uint32_t samples = std::min(num_samples, delay_samples_ - ring_pos_);
+      std::swap_ranges(audio_buff, audio_buff + samples,
+                       delay_buff_.get() + ring_pos_);
+
+      audio_buff += samples;
+      num_samples -= samples;
+      ring_pos_ += samples;
+      if (ring_pos_ == delay_samples_) {
+        ring_pos_ = 0;
+      }
+    }
   }
 
   return true;
 }
+
 // Retain control settings but drop any accumulated state or history.
 bool DfxDelay::Flush() {
   ::memset(delay_buff_.get(), 0, delay_samples_ * sizeof(float));
+  ring_pos_ = 0;
 
   return true;
 }
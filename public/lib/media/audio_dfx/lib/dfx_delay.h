@@ -55,9 +55,13 @@ class DfxDelay : public DfxBase {
 
  protected:
   uint32_t delay_samples_;
-  // This buff must accomodate the largest process_inplace call, plus our delay.
-  // N.B.: 'num_frames' for process_inplace can be as large as frame_rate.
+  // The delay line is a ring of delay_samples_ samples, sized for our maximum
+  // delay. The oldest cached sample (the next one to emit) is at ring_pos_.
+  // When a single call emits the entire delay line, the new delay line is
+  // built in spare_buff_, and the two buffers then trade places.
   std::unique_ptr<float[]> delay_buff_;
+  std::unique_ptr<float[]> spare_buff_;
+  uint32_t ring_pos_ = 0;
 };
 
 }  // namespace audio_dfx_test
@@ -12,6 +12,7 @@
 
 #include "garnet/public/lib/media/audio_dfx/audio_device_fx.h"
 #include "garnet/public/lib/media/audio_dfx/lib/dfx_base.h"
+#include "garnet/public/lib/media/audio_dfx/lib/dfx_simd.h"
 
 namespace media {
 namespace audio_dfx_test {
@@ -58,28 +59,16 @@ class DfxRechannel : public DfxBase {
   // Right = FR + FC*sqr(.5) - BL*sqr(.25) - BR*sqr(.75)
   // To normalize: div by (1+.7071+.8660+.5) or *= .32540090689572506
   bool Process(uint32_t num_frames, const float* buff_in, float* buff_out) {
-    for (uint32_t frame = 0; frame < num_frames; ++frame) {
-      uint32_t out = frame * channels_out_;
-      uint32_t in = frame * channels_in_;
-      if (!encode_) {
-        buff_out[out] =
-            (buff_in[in] + (0.707106781f * buff_in[in + 2]) + buff_in[in + 4]) *
-            0.369398062f;
-        buff_out[out + 1] =
-            (buff_in[in + 1] + (0.707106781f * buff_in[in + 2]) +
-             buff_in[in + 5]) *
-            0.369398062f;
-      } else {
-        buff_out[out] =
-            (buff_in[in] + (0.707106781f * buff_in[in + 2]) +
-             (0.866025403f * buff_in[in + 4]) + (0.5f * buff_in[in + 5])) *
-            0.325400906f;
-        buff_out[out + 1] =
-            (buff_in[in + 1] + (0.707106781f * buff_in[in + 2]) -
-             (0.5f * buff_in[in + 4]) - (0.866025403f * buff_in[in + 5])) *
-            0.325400906f;
-      }
-    }
+    static constexpr simd::DownmixCoefficients kStereoCoefficients = {
+        0.707106781f, {1.0f, 0.0f}, {0.0f, 1.0f}, 0.369398062f};
+    static constexpr simd::DownmixCoefficients kDplCoefficients = {
+        0.707106781f,
+        {0.866025403f, -0.5f},
+        {0.5f, -0.866025403f},
+        0.325400906f};
+
+    simd::Downmix51ToStereo(encode_ ? kDplCoefficients : kStereoCoefficients,
+                            num_frames, buff_in, buff_out);
     return true;
   }
 
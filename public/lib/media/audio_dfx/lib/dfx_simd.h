@@ -0,0 +1,132 @@
+// Copyright 2018 The Fuchsia Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef LIB_MEDIA_AUDIO_DFX_LIB_DFX_SIMD_H_
+#define LIB_MEDIA_AUDIO_DFX_LIB_DFX_SIMD_H_
+
+#include <stdint.h>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#elif defined(__ARM_NEON)
+#include <arm_neon.h>
+#endif
+
+namespace media {
+namespace audio_dfx_test {
+namespace simd {
+
+// dfx_simd.h contains the inner loops of the test effects. Each kernel uses the
+// baseline vector ISA of the architecture (SSE2 on x64, NEON on arm64) for the
+// bulk of the buffer, then finishes any leftover frames with scalar code. The
+// vector code performs the same float operations in the same order as the
+// scalar code, so results do not depend on how a buffer happens to be split.
+
+#if defined(__SSE2__) || defined(__ARM_NEON)
+constexpr bool kEnabled = true;
+#else
+constexpr bool kEnabled = false;
+#endif
+
+// Exchange the left and right samples of each frame of a stereo buffer.
+inline void SwapStereoInPlace(float* buff, uint32_t num_frames) {
+  uint32_t frame = 0;
+#if defined(__SSE2__)
+  for (; frame + 2 <= num_frames; frame += 2) {
+    __m128 val = _mm_loadu_ps(buff + frame * 2);
+    _mm_storeu_ps(buff + frame * 2,
+                  _mm_shuffle_ps(val, val, _MM_SHUFFLE(2, 3, 0, 1)));
+  }
+#elif defined(__ARM_NEON)
+  for (; frame + 2 <= num_frames; frame += 2) {
+    vst1q_f32(buff + frame * 2, vrev64q_f32(vld1q_f32(buff + frame * 2)));
+  }
+#endif
+  for (; frame < num_frames; ++frame) {
+    float temp = buff[frame * 2];
+    buff[frame * 2] = buff[frame * 2 + 1];
+    buff[frame * 2 + 1] = temp;
+  }
+}
+
+// Coefficients of a 5.1-to-stereo downmix. Each output channel is
+//   (((front + center * center_gain) + back_left * back_left_gain[ch]) +
+//     back_right * back_right_gain[ch]) * normalize
+// where front is FL for the left output and FR for the right output. LFE is
+// not included.
+struct DownmixCoefficients {
+  float center_gain;
+  float back_left_gain[2];
+  float back_right_gain[2];
+  float normalize;
+};
+
+// Downmix [num_frames] frames of 5.1 audio (FL, FR, FC, LFE, BL, BR) in
+// [buff_in] into stereo in [buff_out]. The buffers must not overlap.
+inline void Downmix51ToStereo(const DownmixCoefficients& coefficients,
+                              uint32_t num_frames, const float* buff_in,
+                              float* buff_out) {
+  uint32_t frame = 0;
+#if defined(__SSE2__)
+  // Two frames (three vectors) in, two frames (one vector) out.
+  const __m128 center_gain = _mm_set1_ps(coefficients.center_gain);
+  const __m128 back_left_gain = _mm_setr_ps(
+      coefficients.back_left_gain[0], coefficients.back_left_gain[1],
+      coefficients.back_left_gain[0], coefficients.back_left_gain[1]);
+  const __m128 back_right_gain = _mm_setr_ps(
+      coefficients.back_right_gain[0], coefficients.back_right_gain[1],
+      coefficients.back_right_gain[0], coefficients.back_right_gain[1]);
+  const __m128 normalize = _mm_set1_ps(coefficients.normalize);
+
+  for (; frame + 2 <= num_frames; frame += 2) {
+    const float* in = buff_in + frame * 6;
+    __m128 v0 = _mm_loadu_ps(in);      // FL0 FR0 FC0 LFE0
+    __m128 v1 = _mm_loadu_ps(in + 4);  // BL0 BR0 FL1 FR1
+    __m128 v2 = _mm_loadu_ps(in + 8);  // FC1 LFE1 BL1 BR1
+
+    __m128 front = _mm_shuffle_ps(v0, v1, _MM_SHUFFLE(3, 2, 1, 0));
+    __m128 center = _mm_shuffle_ps(v0, v2, _MM_SHUFFLE(0, 0, 2, 2));
+    __m128 back_left = _mm_shuffle_ps(v1, v2, _MM_SHUFFLE(2, 2, 0, 0));
+    __m128 back_right = _mm_shuffle_ps(v1, v2, _MM_SHUFFLE(3, 3, 1, 1));
+
+    __m128 out = _mm_add_ps(front, _mm_mul_ps(center, center_gain));
+    out = _mm_add_ps(out, _mm_mul_ps(back_left, back_left_gain));
+    out = _mm_add_ps(out, _mm_mul_ps(back_right, back_right_gain));
+    _mm_storeu_ps(buff_out + frame * 2, _mm_mul_ps(out, normalize));
+  }
+#elif defined(__ARM_NEON)
+  // One frame per iteration, with both output channels in one vector.
+  const float32x2_t center_gain = vdup_n_f32(coefficients.center_gain);
+  const float32x2_t back_left_gain = vld1_f32(coefficients.back_left_gain);
+  const float32x2_t back_right_gain = vld1_f32(coefficients.back_right_gain);
+  const float32x2_t normalize = vdup_n_f32(coefficients.normalize);
+
+  for (; frame < num_frames; ++frame) {
+    const float* in = buff_in + frame * 6;
+    float32x2_t front = vld1_f32(in);
+    float32x2_t back = vld1_f32(in + 4);
+
+    float32x2_t out =
+        vadd_f32(front, vmul_f32(vdup_n_f32(in[2]), center_gain));
+    out = vadd_f32(out, vmul_f32(vdup_lane_f32(back, 0), back_left_gain));
+    out = vadd_f32(out, vmul_f32(vdup_lane_f32(back, 1), back_right_gain));
+    vst1_f32(buff_out + frame * 2, vmul_f32(out, normalize));
+  }
+#endif
+  for (; frame < num_frames; ++frame) {
+    const float* in = buff_in + frame * 6;
+    for (uint32_t chan = 0; chan < 2; ++chan) {
+      float out = in[chan] + in[2] * coefficients.center_gain;
+      out += in[4] * coefficients.back_left_gain[chan];
+      out += in[5] * coefficients.back_right_gain[chan];
+      buff_out[frame * 2 + chan] = out * coefficients.normalize;
+    }
+  }
+}
+
+}  // namespace simd
+}  // namespace audio_dfx_test
+}  // namespace media
+
+#endif  // LIB_MEDIA_AUDIO_DFX_LIB_DFX_SIMD_H_
@@ -12,6 +12,7 @@
 
 #include "garnet/public/lib/media/audio_dfx/audio_device_fx.h"
 #include "garnet/public/lib/media/audio_dfx/lib/dfx_base.h"
+#include "garnet/public/lib/media/audio_dfx/lib/dfx_simd.h"
 
 namespace media {
 namespace audio_dfx_test {
@@ -50,12 +51,7 @@ class DfxSwap : public DfxBase {
                 kLatencyFrames, kLatencyFrames) {}
 
   bool ProcessInplace(uint32_t num_frames, float* audio_buff) {
-    for (uint32_t sample = 0; sample < num_frames * channels_in_;
-         sample += channels_in_) {
-      float temp = audio_buff[sample];
-      audio_buff[sample] = audio_buff[sample + 1];
-      audio_buff[sample + 1] = temp;
-    }
+    simd::SwapStereoInPlace(audio_buff, num_frames);
     return true;
   }
 };
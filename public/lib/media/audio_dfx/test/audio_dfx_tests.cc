@@ -3,7 +3,10 @@
 // found in the LICENSE file.
 
 #include <dlfcn.h>
+#include <zircon/syscalls.h>
+#include <algorithm>
 #include <cmath>
+#include <cstdio>
 
 #include "garnet/bin/media/audio_core/mixer/fx_loader.h"
 #include "garnet/bin/media/audio_core/mixer/fx_processor.h"
@@ -11,6 +14,7 @@
 #include "garnet/public/lib/media/audio_dfx/lib/dfx_base.h"
 #include "garnet/public/lib/media/audio_dfx/lib/dfx_delay.h"
 #include "garnet/public/lib/media/audio_dfx/lib/dfx_rechannel.h"
+#include "garnet/public/lib/media/audio_dfx/lib/dfx_simd.h"
 #include "garnet/public/lib/media/audio_dfx/lib/dfx_swap.h"
 #include "gtest/gtest.h"
 
@@ -608,6 +612,40 @@ TEST_F(FxRechannelTest, Process) {
   EXPECT_EQ(fx_loader_.DeleteFx(dfx_token), ZX_OK);
 }
 
+// Verifies that every frame of a multi-frame buffer is downmixed identically,
+// whether it is handled by the vectorized loop or the scalar remainder.
+TEST_F(FxRechannelTest, Process_MultiFrame) {
+  constexpr uint32_t kNumFrames = 5;
+  float audio_buff_in[kNumFrames * DfxRechannel::kNumChannelsIn];
+  float audio_buff_out[kNumFrames * DfxRechannel::kNumChannelsOut] = {0.0f};
+  const float frame_in[DfxRechannel::kNumChannelsIn] = {
+      1.0f, -1.0f, 0.25f, -1.0f, 0.98765432f, -0.09876544f};
+  const float expected[DfxRechannel::kNumChannelsOut] = {0.799536645f,
+                                                         -0.340580851f};
+
+  for (uint32_t frame = 0; frame < kNumFrames; ++frame) {
+    std::copy(frame_in, frame_in + DfxRechannel::kNumChannelsIn,
+              audio_buff_in + frame * DfxRechannel::kNumChannelsIn);
+  }
+
+  fx_token_t dfx_token = fx_loader_.CreateFx(Effect::Rechannel, 48000,
+                                             DfxRechannel::kNumChannelsIn,
+                                             DfxRechannel::kNumChannelsOut);
+  ASSERT_NE(dfx_token, FUCHSIA_AUDIO_DFX_INVALID_TOKEN);
+
+  EXPECT_EQ(fx_loader_.FxProcess(dfx_token, kNumFrames, audio_buff_in,
+                                 audio_buff_out),
+            ZX_OK);
+  for (uint32_t sample = 0;
+       sample < kNumFrames * DfxRechannel::kNumChannelsOut; ++sample) {
+    EXPECT_EQ(audio_buff_out[sample],
+              expected[sample % DfxRechannel::kNumChannelsOut])
+        << sample;
+  }
+
+  EXPECT_EQ(fx_loader_.DeleteFx(dfx_token), ZX_OK);
+}
+
 // Tests cases in which we expect process to fail.
 TEST_F(FxSwapTest, Process) {
   constexpr uint32_t kNumFrames = 1;
@@ -917,5 +955,164 @@ TEST_F(FxProcessorTest, ProcessInPlaceFlush) {
   EXPECT_EQ(fx_processor_->Flush(), ZX_OK);
 }
 
+// Verify that a chain run block-by-block over a large buffer produces the same
+// output as running each instance over the entire buffer in turn.
+TEST_F(FxProcessorTest, ProcessInPlace_Blocks) {
+  constexpr uint32_t kNumFrames = 10007;
+  constexpr uint32_t kNumSamples = kNumFrames * kTestChans;
+  constexpr float kDelays[] = {100.0f, 37.0f};
+
+  std::unique_ptr<float[]> buff = std::make_unique<float[]>(kNumSamples);
+  std::unique_ptr<float[]> expect = std::make_unique<float[]>(kNumSamples);
+  for (uint32_t i = 0; i < kNumSamples; ++i) {
+    buff[i] = expect[i] = static_cast<float>(i + 1);
+  }
+
+  // The chain under test: [delay, swap, delay].
+  fx_token_t chain[3] = {
+      fx_processor_->CreateFx(Effect::Delay, kTestChans, kTestChans, 0),
+      fx_processor_->CreateFx(Effect::Swap, kTestChans, kTestChans, 1),
+      fx_processor_->CreateFx(Effect::Delay, kTestChans, kTestChans, 2)};
+  // An identical set of instances, which we call directly with whole buffers.
+  fx_token_t reference[3] = {
+      fx_loader_.CreateFx(Effect::Delay, 48000, kTestChans, kTestChans),
+      fx_loader_.CreateFx(Effect::Swap, 48000, kTestChans, kTestChans),
+      fx_loader_.CreateFx(Effect::Delay, 48000, kTestChans, kTestChans)};
+  for (uint32_t i = 0; i < 3; ++i) {
+    ASSERT_NE(chain[i], FUCHSIA_AUDIO_DFX_INVALID_TOKEN);
+    ASSERT_NE(reference[i], FUCHSIA_AUDIO_DFX_INVALID_TOKEN);
+  }
+  ASSERT_EQ(fx_loader_.FxSetControlValue(chain[0], 0, kDelays[0]), ZX_OK);
+  ASSERT_EQ(fx_loader_.FxSetControlValue(chain[2], 0, kDelays[1]), ZX_OK);
+  ASSERT_EQ(fx_loader_.FxSetControlValue(reference[0], 0, kDelays[0]), ZX_OK);
+  ASSERT_EQ(fx_loader_.FxSetControlValue(reference[2], 0, kDelays[1]), ZX_OK);
+
+  for (uint32_t pass = 0; pass < 2; ++pass) {
+    EXPECT_EQ(fx_processor_->ProcessInPlace(kNumFrames, buff.get()), ZX_OK);
+    for (auto token : reference) {
+      EXPECT_EQ(fx_loader_.FxProcessInPlace(token, kNumFrames, expect.get()),
+                ZX_OK);
+    }
+
+    for (uint32_t sample = 0; sample < kNumSamples; ++sample) {
+      ASSERT_EQ(buff[sample], expect[sample]) << pass << ":" << sample;
+    }
+  }
+
+  for (auto token : reference) {
+    EXPECT_EQ(fx_loader_.DeleteFx(token), ZX_OK);
+  }
+}
+
+//
+// Profiling of the test effects, individually and chained. These do not
+// validate anything, so they are disabled by default; to include them, run
+// audio_dfx_tests with --gtest_also_run_disabled_tests.
+//
+class FxProfileTest : public FxProcessorTest {
+ protected:
+  static constexpr uint32_t kProfileFrames = 4800;
+  static constexpr uint32_t kProfileRuns = 200;
+  static constexpr float kProfileDelayFrames = 480.0f;
+
+  // Run [process] kProfileRuns times, printing mean and best ns per frame.
+  template <typename ProcessFunc>
+  void Profile(const char* config, ProcessFunc process) {
+    zx_duration_t total = 0;
+    zx_duration_t best = 0;
+
+    for (uint32_t run = 0; run < kProfileRuns; ++run) {
+      zx_time_t start_time = zx_clock_get(ZX_CLOCK_MONOTONIC);
+      process();
+      zx_duration_t elapsed = zx_clock_get(ZX_CLOCK_MONOTONIC) - start_time;
+
+      best = (run == 0 ? elapsed : std::min(best, elapsed));
+      total += elapsed;
+    }
+
+    double mean = static_cast<double>(total) / kProfileRuns;
+    printf("%-24s\t%9.3lf\t%9.3lf\n", config, mean / kProfileFrames,
+           static_cast<double>(best) / kProfileFrames);
+  }
+
+  static void DisplayColumnHeader(const char* title) {
+    printf("\n   %s: elapsed ns per frame, for %u-frame buffers\n", title,
+           kProfileFrames);
+    printf("Configuration\t\t\t     Mean\t     Best\n");
+  }
+};
+
+// Each test effect in isolation.
+TEST_F(FxProfileTest, DISABLED_Effects) {
+  printf("\n   Vectorized effect kernels are %s\n",
+         (simd::kEnabled ? "enabled" : "disabled"));
+  DisplayColumnHeader("Effects");
+
+  std::unique_ptr<float[]> buff_in =
+      std::make_unique<float[]>(kProfileFrames * FUCHSIA_AUDIO_DFX_CHANNELS_MAX);
+  std::unique_ptr<float[]> buff_out =
+      std::make_unique<float[]>(kProfileFrames * FUCHSIA_AUDIO_DFX_CHANNELS_MAX);
+
+  for (uint16_t chans : {1, 2, 8}) {
+    fx_token_t token = fx_loader_.CreateFx(Effect::Delay, 48000, chans, chans);
+    ASSERT_NE(token, FUCHSIA_AUDIO_DFX_INVALID_TOKEN);
+    ASSERT_EQ(fx_loader_.FxSetControlValue(token, 0, kProfileDelayFrames),
+              ZX_OK);
+
+    char config[32];
+    snprintf(config, sizeof(config), "Delay %u-chan", chans);
+    Profile(config, [this, token, &buff_in]() {
+      fx_loader_.FxProcessInPlace(token, kProfileFrames, buff_in.get());
+    });
+    EXPECT_EQ(fx_loader_.DeleteFx(token), ZX_OK);
+  }
+
+  fx_token_t token =
+      fx_loader_.CreateFx(Effect::Swap, 48000, kTestChans, kTestChans);
+  ASSERT_NE(token, FUCHSIA_AUDIO_DFX_INVALID_TOKEN);
+  Profile("Swap", [this, token, &buff_in]() {
+    fx_loader_.FxProcessInPlace(token, kProfileFrames, buff_in.get());
+  });
+  EXPECT_EQ(fx_loader_.DeleteFx(token), ZX_OK);
+
+  token = fx_loader_.CreateFx(Effect::Rechannel, 48000,
+                              DfxRechannel::kNumChannelsIn,
+                              DfxRechannel::kNumChannelsOut);
+  ASSERT_NE(token, FUCHSIA_AUDIO_DFX_INVALID_TOKEN);
+  Profile("Rechannel", [this, token, &buff_in, &buff_out]() {
+    fx_loader_.FxProcess(token, kProfileFrames, buff_in.get(), buff_out.get());
+  });
+  EXPECT_EQ(fx_loader_.DeleteFx(token), ZX_OK);
+}
+
+// Stereo chains of alternating delay and swap instances, run by FxProcessor.
+TEST_F(FxProfileTest, DISABLED_Chains) {
+  DisplayColumnHeader("Chains");
+
+  std::unique_ptr<float[]> buff =
+      std::make_unique<float[]>(kProfileFrames * kTestChans);
+
+  for (uint8_t length = 1; length <= 8; length *= 2) {
+    while (fx_processor_->GetNumFx() < length) {
+      uint8_t position = fx_processor_->GetNumFx();
+      bool delay = (position % 2 == 0);
+      fx_token_t token = fx_processor_->CreateFx(
+          (delay ? Effect::Delay : Effect::Swap), kTestChans, kTestChans,
+          position);
+      ASSERT_NE(token, FUCHSIA_AUDIO_DFX_INVALID_TOKEN);
+      if (delay) {
+        ASSERT_EQ(fx_loader_.FxSetControlValue(token, 0, kProfileDelayFrames),
+                  ZX_OK);
+      }
+    }
+
+    char config[32];
+    snprintf(config, sizeof(config), "Chain of %u", length);
+    Profile(config, [this, &buff]() {
+      fx_processor_->ProcessInPlace(kProfileFrames, buff.get());
+    });
+  }
+}
+
 }  // namespace audio_dfx_test
 }  // namespace media